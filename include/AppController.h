@@ -3,8 +3,11 @@
     Propósito: Declara a classe AppController, responsável por orquestrar o
     funcionamento do firmware como um todo. Ela mantém a Máquina de Estados
     Finitos (FSM), integra o leitor RFID, o gerenciador de rede, o buffer de UIDs
-    e o cliente HTTP. Mantemos apenas as declarações no .h e a implementação no .cpp
-    para acelerar recompilações e reduzir acoplamento.
+    e o cliente HTTP. O loop() é uma passada do TaskScheduler: a consulta ao
+    leitor é a tarefa de maior prioridade e o trabalho pesado (restauração,
+    coleta na LAN, snapshot) roda em fatias na folga. Mantemos apenas as
+    declarações no .h e a implementação no .cpp para acelerar recompilações e
+    reduzir acoplamento.
 */
 
 #pragma once // Garante inclusão única deste cabeçalho durante a compilação
@@ -15,26 +18,72 @@
 #include "HttpSender.h" // Cliente HTTP/HTTPS com política de retries
 #include "Log.h" // Macros de logging por nível
 #include "PersistentStore.h" // Persistência (NVS) opcional do buffer
+#include "MemTelemetry.h" // Telemetria de heap/pilha e sinal de modo degradado
+#include "Clock.h" // Relógio injetável (sistema no ESP32, virtual no host)
+#include "RuntimeConfig.h" // Parâmetros ajustáveis em tempo de execução (NVS + download remoto)
+#include "LanPullServer.h" // Coleta do backlog por um gateway na LAN (stream chunked + ack)
+#include "EdgeAggregator.h" // Resumos por janela (modo agregado)
+#include "BootProfile.h" // Marcas de tempo por fase do boot
+#include "UdpUplink.h" // Uplink alternativo em datagramas UDP (lotes + ACK seletivo)
+#include "UplinkGovernor.h" // Ritmo do envio HTTP (fichas, Retry-After, backoff, disjuntor)
+#include "TaskScheduler.h" // Escalonador cooperativo (prazos, prioridades, fatias de fundo)
 
 // Controlador principal da aplicação (padrão façade/orquestrador)
 class AppController { // Início da definição da classe que orquestra o firmware
 public: // Seção pública: API exposta a outros módulos
-    AppController(); // Construtor: inicializa membros e estado interno
-    void begin(); // Inicialização: Serial, dispositivos, rede, NTP e persistência
-    void loop(); // Iteração da FSM: leitura, reconexão e envio de fila
+    explicit AppController(Clock &clock = defaultClock()); // Construtor: inicializa membros e estado interno
+    void begin(); // Inicialização: Serial, leitor RFID, configuração, rede e início da restauração do backlog
+    void loop(); // Uma passada do escalonador: leitura, rede, envio e trabalho de fundo na folga
+    size_t queueDepth() const { return _buffer.size(); } // Itens pendentes na fila (diagnóstico/simulação)
+    size_t queueDropped() const { return _buffer.dropped(); } // Itens descartados por overflow desde o boot
+    const RfidInventoryStats &rfidStats() const { return _rfid.stats(); } // Tempo por ciclo e cartões/s do leitor
+    const RfidBlockStats &rfidBlockStats() const { return _rfid.blockStats(); } // Acertos do cache e latência da leitura de bloco
+    const RuntimeConfig &config() const { return _cfg; } // Parâmetros efetivos e métricas do download
+    const LanPullServer &lanPull() const { return _lan; } // Época e métricas da coleta na LAN
+    const EdgeAggregator &aggregator() const { return _agg; } // Modo agregado: janela, resumos pendentes e métricas
+    const BootProfile &bootProfile() const { return _boot; } // Tempo por fase do boot e custo da restauração
+    const UdpUplink &udpUplink() const { return _udp; } // Época, janela e métricas do uplink UDP
+    const UplinkGovernor &uplinkGovernor() const { return _gov; } // Disjuntor e métricas do ritmo de envio HTTP
+    const MemTelemetry &memory() const { return _mem; } // Saúde do heap (amostrada) e estatísticas por trecho
+    const TaskScheduler &scheduler() const { return _sched; } // Tarefas, estouros, prazos perdidos e tempos por tarefa
 private: // Seção privada: detalhes internos não expostos
     // Estados de alto nível: Init (decisão), Connecting (Wi‑Fi), Sending (drena fila), Idle (standby conectado)
     enum class State { INIT, CONNECTING, SENDING_QUEUE, IDLE }; // Enum que modela a FSM
 
+    Clock &_clock; // Fonte de tempo compartilhada com os subcomponentes
+    RuntimeConfig _cfg; // Parâmetros de desempenho (padrões de compilação, NVS, backend)
     UidBuffer _buffer; // Fila circular de UIDs capturadas (sem alocação dinâmica)
+    LanPullServer _lan; // Servidor de coleta na LAN (lê e libera itens de _buffer)
+    EdgeAggregator _agg; // Agregação por janela (desligada com agg_window_ms = 0)
+    UdpUplink _udp; // Fila em datagramas ao coletor (UDP_UPLINK_ENABLE; lê e libera itens de _buffer)
     RfidReader _rfid; // Leitor MFRC522 + deduplicação temporal por UID (impede reenvio < janela)
     NetManager _net; // Wi‑Fi com backoff exponencial e eventos
     HttpSender _http; // Cliente HTTP para enviar eventos ao endpoint
+    UplinkGovernor _gov; // Decide quando o próximo POST pode sair (UPLINK_GOVERNOR)
     State _state; // Estado atual da FSM
-    unsigned long _lastQueueAttempt; // Controle de cadência de envio da fila (ms)
     bool _timeInitialized; // Indica se NTP/RTC já foi configurado (para timestamp ISO)
+    bool _snapshotPending; // Snapshot devido (retido durante a restauração; com coalescimento, até a tarefa "persist")
     PersistentStore _persist; // Persistência opcional do buffer (NVS)
+    MemTelemetry _mem; // Amostras de heap/pilha; health() orienta o ritmo de envio
+    BootProfile _boot; // Marcas de fase do boot (origem em begin())
+    TaskScheduler _sched; // Passadas do loop(): periódicas por prioridade + fundo na folga
+    int8_t _tUplink; // Tarefa da FSM/envio (período = drain_ms)
+    int8_t _tPersist; // Tarefa de fundo do snapshot (-1: gravação imediata ou sem PERSIST_BUFFER)
 
+    void registerTasks(); // Registra as tarefas do escalonador (begin())
     void serviceRfid(); // Lê RFID de forma não‑bloqueante e enfileira
-    void serviceQueueSend(); // Tenta enviar o item mais antigo da fila (se conectado)
+    void serviceUplink(); // FSM de conexão/envio (tarefa "uplink", uma vez por drain_ms)
+    uint32_t uplinkIntervalMs() const; // Período da tarefa "uplink": drain_ms (x MEM_DEGRADED_DRAIN_FACTOR com memória degradada)
+    bool serviceRestoreSlice(uint32_t budgetUs); // Fundo: um trecho da restauração do tamanho da fatia; true se resta trabalho
+    bool serviceLanSlice(uint32_t budgetUs); // Fundo: atendimento da coleta na LAN dentro da fatia
+    void logSchedStats(); // Registra no log as métricas por tarefa
+    void logBlockStats(); // Registra no log as métricas da leitura de bloco (RFID_BLOCK_READ)
+    void serviceQueueSend(); // Tenta enviar o resumo ou item mais antigo (se conectado)
+    bool uplinkPending() const; // Há resumo pendente ou (fora do modo agregado e sem UDP) item na fila
+    void persistSnapshot(); // Snapshot devido: grava já ou acorda a tarefa "persist"
+    void writeSnapshot(); // Grava o snapshot do buffer (instrumentado por MemScope)
+    void serviceRestore(size_t maxItems); // Restaura mais um trecho do backlog persistido (boot)
+    void logBootProfile(); // Registra no log as fases do boot
+    void serviceConfig(); // Baixa a configuração remota quando vence o período (se conectado)
+    void applyConfig(uint32_t mask); // Repassa aos componentes os parâmetros alterados (máscara 1 << id)
 }; // Fim da classe AppController
@@ -0,0 +1,74 @@
+/*
+    Arquivo: include/BootProfile.h
+    Propósito: Marcas de tempo por fase do boot (leitor pronto, configuração,
+    rede iniciada, primeiro loop, backlog restaurado, primeira leitura, link
+    Wi‑Fi) e custo da restauração incremental do snapshot. Cada fase guarda o
+    primeiro instante em que foi atingida, em ms desde a entrada em
+    AppController::begin(); startMs() é o millis() nesse ponto (no ESP32, o
+    tempo gasto pelo bootloader e pela inicialização estática). Serve para
+    medir e regredir o tempo até a primeira leitura (sim_boot no host).
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <stdint.h> // Tipos inteiros de largura fixa
+#include "Clock.h" // Relógio injetável
+
+#ifndef BOOT_SERIAL_SETTLE_MS // Espera após Serial.begin() no boot
+#define BOOT_SERIAL_SETTLE_MS 0 // UART não precisa; >0 só para monitores USB‑CDC que perdem as primeiras linhas
+#endif // fim: BOOT_SERIAL_SETTLE_MS default
+
+// Fases do boot, na ordem típica (FIRST_READ e LINK_UP podem ocorrer antes de RESTORED)
+enum BootPhase : uint8_t { // Índices de BootProfile::at()
+    BOOT_RFID_READY = 0, // MFRC522 inicializado (leitor aceita cartões a partir do primeiro loop)
+    BOOT_CONFIG, // RuntimeConfig carregado e aplicado
+    BOOT_NET_STARTED, // Wi‑Fi em modo STA e primeira tentativa disparada (assíncrona)
+    BOOT_LOOP, // begin() concluído: loop() passa a rodar
+    BOOT_RESTORED, // Backlog persistido de volta ao UidBuffer
+    BOOT_FIRST_READ, // Primeira UID aceita
+    BOOT_LINK_UP, // Primeira conexão Wi‑Fi
+    BOOT_PHASE_COUNT // Quantidade de fases
+}; // fim: enum BootPhase
+
+// Perfil de um boot (sem alocação; preenchido pelo AppController)
+class BootProfile { // Início da definição da classe BootProfile
+public: // Seção pública: API exposta a outros módulos
+    BootProfile() : _clock(nullptr), _startMs(0), _mask(0), _restoreUs(0), _restoreMaxStepUs(0), _restored(0) {} // Vazio
+
+    // start(): zera o perfil e fixa a origem (entrada de begin())
+    void start(Clock &clock) { // Início: start()
+        _clock = &clock; // Fonte de tempo
+        _startMs = clock.nowMs(); // Origem
+        _mask = 0; // Nenhuma fase atingida
+        _restoreUs = 0; _restoreMaxStepUs = 0; _restored = 0; // Restauração não começou
+    } // fim: start()
+
+    // mark(): registra a fase na primeira vez (chamadas seguintes são ignoradas); true se registrou agora
+    bool mark(BootPhase p) { // Início: mark()
+        if (!_clock || has(p)) return false; // Antes de start() ou já registrada
+        _at[p] = _clock->nowMs() - _startMs; // ms desde begin() (seguro no wrap)
+        _mask |= (uint16_t)(1u << p); // Marca
+        return true; // Registrada agora
+    } // fim: mark()
+
+    // addRestoreStep(): contabiliza um passo da restauração (custo no loop e entradas recuperadas)
+    void addRestoreStep(uint32_t us, uint32_t entries) { // Início: addRestoreStep()
+        _restoreUs += us; // Tempo total
+        if (us > _restoreMaxStepUs) _restoreMaxStepUs = us; // Maior passo (atraso imposto ao loop)
+        _restored += entries; // Entradas recuperadas
+    } // fim: addRestoreStep()
+
+    bool has(BootPhase p) const { return (_mask >> p) & 1u; } // Fase já atingida?
+    uint32_t at(BootPhase p) const { return has(p) ? _at[p] : 0; } // ms desde begin() (0 se ainda não)
+    uint32_t startMs() const { return _startMs; } // millis() na entrada de begin()
+    uint32_t restoreUs() const { return _restoreUs; } // Tempo somado dos passos de restauração (µs)
+    uint32_t restoreMaxStepUs() const { return _restoreMaxStepUs; } // Maior passo (µs)
+    uint32_t restored() const { return _restored; } // Entradas recuperadas do snapshot
+private: // Seção privada: estado interno
+    Clock *_clock; // Fonte de tempo (definida em start())
+    uint32_t _startMs; // Origem (millis)
+    uint16_t _mask; // Bit p = fase p atingida
+    uint32_t _at[BOOT_PHASE_COUNT]; // ms desde a origem por fase
+    uint32_t _restoreUs; // Soma dos passos de restauração
+    uint32_t _restoreMaxStepUs; // Maior passo
+    uint32_t _restored; // Entradas recuperadas
+}; // Fim da classe BootProfile
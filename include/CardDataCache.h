@@ -0,0 +1,89 @@
+/*
+    Arquivo: include/CardDataCache.h
+    Propósito: Cache limitado UID -> conteúdo decodificado do bloco do cartão
+    (RFID_BLOCK_READ). Um visitante frequente é reconhecido pela UID e pula a
+    autenticação MIFARE e a leitura do bloco (dezenas de ms com novas
+    tentativas). Array fixo de RFID_BLOCK_CACHE_SIZE entradas (sem alocação),
+    substituição da entrada usada há mais tempo e validade de
+    RFID_BLOCK_CACHE_TTL_MS (cartão regravado é relido depois dela). Só
+    leituras bem-sucedidas entram no cache. Lógica pura, testável no host.
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <Arduino.h> // Tipos/utilidades do Arduino (uint32_t, etc.)
+#include <cstring> // strcmp
+#include "StrUtil.h" // copyBounded (cópia limitada com NUL)
+#include "UidBuffer.h" // RFID_BLOCK_DATA_MAX
+
+#ifndef RFID_BLOCK_CACHE_SIZE // Cartões lembrados (dimensiona o array)
+#define RFID_BLOCK_CACHE_SIZE 64 // ~50 bytes por entrada; 0 = sem cache (toda leitura autentica)
+#endif // fim: RFID_BLOCK_CACHE_SIZE default
+#ifndef RFID_BLOCK_CACHE_TTL_MS // Validade de uma entrada desde a leitura do cartão
+#define RFID_BLOCK_CACHE_TTL_MS 86400000UL // 24 h; 0 = não expira
+#endif // fim: RFID_BLOCK_CACHE_TTL_MS default
+
+// Cache UID -> conteúdo do bloco (substitui a entrada usada há mais tempo)
+class CardDataCache { // Início da definição da classe CardDataCache
+public: // Seção pública: API exposta a outros módulos
+    CardDataCache() : _tick(0) { clear(); } // Cache vazio
+
+    // clear(): esquece todos os cartões
+    void clear() { // Início: clear()
+        for (int i = 0; i < kSlots; ++i) { _entries[i].used = false; _entries[i].uid[0] = '\0'; } // Slots livres
+    } // fim: clear()
+
+    // lookup(): true e o conteúdo em 'out' se a UID está no cache e dentro da validade
+    bool lookup(const char *uidHex, uint32_t now, char *out, size_t outLen) { // Início: lookup()
+        int idx = findIndex(uidHex); // Procura a UID
+        if (idx < 0) return false; // Falta
+        Entry &e = _entries[idx]; // Entrada encontrada
+        if (RFID_BLOCK_CACHE_TTL_MS && now - e.storedMs >= RFID_BLOCK_CACHE_TTL_MS) { e.used = false; return false; } // Vencida (seguro no wrap): relê o cartão
+        e.lastUse = ++_tick; // Usada agora
+        copyBounded(out, outLen, e.data); // Copia com limite e terminação NUL
+        return true; // Acerto
+    } // fim: lookup()
+
+    // store(): registra o conteúdo lido do cartão (substitui a entrada usada há mais tempo se cheio)
+    void store(const char *uidHex, const char *data, uint32_t now) { // Início: store()
+        if (RFID_BLOCK_CACHE_SIZE == 0) return; // Cache desligado
+        int idx = findIndex(uidHex); // Já presente (entrada vencida relida)?
+        if (idx < 0) { // Nova UID: slot livre ou o usado há mais tempo
+            idx = 0; // Candidato
+            for (int i = 0; i < kSlots; ++i) { // Varre os slots
+                if (!_entries[i].used) { idx = i; break; } // Livre
+                if (_tick - _entries[i].lastUse > _tick - _entries[idx].lastUse) idx = i; // Mais antigo (seguro no wrap)
+            }
+        }
+        Entry &e = _entries[idx]; // Slot escolhido
+        e.used = true; // Ocupado
+        copyBounded(e.uid, sizeof(e.uid), uidHex); // UID com limite
+        copyBounded(e.data, sizeof(e.data), data); // Conteúdo com limite
+        e.storedMs = now; // Validade conta daqui
+        e.lastUse = ++_tick; // Usada agora
+    } // fim: store()
+
+    // size(): entradas ocupadas (diagnóstico)
+    size_t size() const { // Início: size()
+        size_t n = 0; // Contador
+        for (int i = 0; i < kSlots; ++i) if (_entries[i].used) n++; // Ocupadas
+        return n; // Total
+    } // fim: size()
+
+private: // Seção privada: estado interno
+    static const int kSlots = RFID_BLOCK_CACHE_SIZE; // Slots utilizáveis (0 = cache desligado)
+    struct Entry { // Cartão lembrado
+        bool used; // Slot ocupado
+        char uid[21]; // UID em HEX (até 10 bytes)
+        char data[RFID_BLOCK_DATA_MAX]; // Conteúdo decodificado
+        uint32_t storedMs; // Leitura do cartão (validade)
+        uint32_t lastUse; // Contador do último uso (substituição)
+    }; // fim: struct Entry
+    Entry _entries[RFID_BLOCK_CACHE_SIZE > 0 ? RFID_BLOCK_CACHE_SIZE : 1]; // Array fixo (1 slot mínimo para compilar)
+    uint32_t _tick; // Relógio lógico de uso
+
+    // findIndex(): índice da UID ou -1
+    int findIndex(const char *uidHex) const { // Início: findIndex()
+        for (int i = 0; i < kSlots; ++i) if (_entries[i].used && strcmp(_entries[i].uid, uidHex) == 0) return i; // Achou
+        return -1; // Ausente
+    } // fim: findIndex()
+}; // Fim da classe CardDataCache
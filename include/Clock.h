@@ -0,0 +1,54 @@
+/*
+    Arquivo: include/Clock.h
+    Propósito: Abstração de tempo injetada em todos os componentes que medem ou
+    aguardam tempo (RfidReader, NetManager, HttpSender, AppController). No
+    firmware, SystemClock delega a millis()/delay(); no host, VirtualClock
+    mantém um relógio simulado que só avança quando mandado, permitindo rodar
+    semanas de operação em segundos e exercitar o wrap de 32 bits de millis()
+    (~49,7 dias) de forma determinística.
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <stdint.h> // Tipos inteiros de largura fixa
+
+// Interface de relógio (milissegundos, 32 bits com wrap como millis())
+class Clock { // Início da definição da classe Clock
+public: // Seção pública: API exposta a outros módulos
+    virtual ~Clock() {} // Destrutor virtual (interface polimórfica)
+    virtual uint32_t nowMs() = 0; // Tempo atual em ms (sofre wrap em 2^32, como millis())
+    virtual uint32_t nowUs() = 0; // Tempo atual em µs (wrap em ~71 min, como micros()): só para medir intervalos curtos
+    virtual void delayMs(uint32_t ms) = 0; // Espera bloqueante (no VirtualClock apenas avança o tempo)
+}; // Fim da classe Clock
+
+// Relógio simulado: avança apenas por advance()/delayMs(); guarda o tempo total em µs (64 bits)
+class VirtualClock : public Clock { // Início da definição da classe VirtualClock
+public: // Seção pública
+    explicit VirtualClock(uint64_t startMs = 0) : _us(startMs * 1000) {} // Início arbitrário (ex.: perto do wrap)
+    uint32_t nowMs() override { return (uint32_t)(_us / 1000); } // Visão de 32 bits (com wrap)
+    uint32_t nowUs() override { return (uint32_t)_us; } // Visão de 32 bits em µs (com wrap)
+    void delayMs(uint32_t ms) override { _us += (uint64_t)ms * 1000; } // delay() não bloqueia: só avança
+    void advance(uint64_t ms) { _us += ms * 1000; } // Avança o tempo simulado
+    void advanceUs(uint64_t us) { _us += us; } // Avança frações de ms (custo de operações de RF, SPI)
+    void set(uint64_t ms) { _us = ms * 1000; } // Reposiciona o tempo simulado
+    uint64_t now64() const { return _us / 1000; } // Tempo "verdadeiro" em ms sem wrap (para verificação)
+private: // Seção privada
+    uint64_t _us; // Tempo simulado em µs (64 bits)
+}; // Fim da classe VirtualClock
+
+#ifdef ARDUINO // Firmware: relógio do sistema
+#include <Arduino.h> // millis(), delay()
+
+// Relógio real do ESP32 (millis/delay)
+class SystemClock : public Clock { // Início da definição da classe SystemClock
+public: // Seção pública
+    uint32_t nowMs() override { return millis(); } // ms desde o boot
+    uint32_t nowUs() override { return micros(); } // µs desde o boot
+    void delayMs(uint32_t ms) override { delay(ms); } // Espera bloqueante (cede CPU ao FreeRTOS)
+}; // Fim da classe SystemClock
+
+// Relógio padrão usado quando nenhum é injetado
+inline Clock &defaultClock() { static SystemClock c; return c; } // Instância única do relógio do sistema
+#else // Host: relógio virtual compartilhado
+inline VirtualClock &hostClock() { static VirtualClock c; return c; } // Relógio simulado do processo
+inline Clock &defaultClock() { return hostClock(); } // Componentes sem relógio explícito usam o virtual
+#endif // fim: relógio padrão por plataforma
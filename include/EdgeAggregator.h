@@ -0,0 +1,84 @@
+/*
+    Arquivo: include/EdgeAggregator.h
+    Propósito: Declara o EdgeAggregator, estágio opcional entre o RfidReader e
+    o envio: em vez de um POST por leitura, acumula por janela de tempo
+    (agg_window_ms) a contagem de leituras aceitas, a estimativa de UIDs
+    distintos (HyperLogLog, memória fixa) e a primeira/última UID vista, e
+    fecha um resumo por janela numa fila estática. Janelas sem leitura não
+    geram resumo. Com a janela em 0 o estágio fica desligado (um registro por
+    leitura, como antes). As leituras brutas podem continuar apenas no
+    dispositivo (AGG_KEEP_RAW: UidBuffer, snapshot NVS e coleta na LAN).
+    Implementação em src/EdgeAggregator.cpp.
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <Arduino.h> // Tipos (uint32_t, size_t)
+#include "HllSketch.h" // Estimador de distintos (HyperLogLog)
+#include "Clock.h" // Relógio injetável (fechamento das janelas)
+
+#ifndef AGG_WINDOW_MS // Padrão de compilação (ajustável em tempo de execução: agg_window_ms)
+#define AGG_WINDOW_MS 0 // 0 = desligado (um registro por leitura)
+#endif // fim: AGG_WINDOW_MS default
+#ifndef AGG_WINDOW_MIN_MS // Menor janela aceita quando ligado
+#define AGG_WINDOW_MIN_MS 1000 // Valores entre 1 e este são elevados a ele (ms)
+#endif // fim: AGG_WINDOW_MIN_MS default
+#ifndef AGG_HLL_BITS // Bits de índice do HyperLogLog
+#define AGG_HLL_BITS 8 // 256 registradores (bytes), erro padrão ~6,5%
+#endif // fim: AGG_HLL_BITS default
+#ifndef AGG_QUEUE_CAPACITY // Resumos fechados aguardando envio
+#define AGG_QUEUE_CAPACITY 64 // Com janelas de 1 min: ~1 h sem WAN antes de descartar o mais antigo
+#endif // fim: AGG_QUEUE_CAPACITY default
+#ifndef AGG_KEEP_RAW // Leituras brutas no modo agregado
+#define AGG_KEEP_RAW 0 // 1 = seguem no UidBuffer só localmente (snapshot/coleta LAN), sem POST
+#endif // fim: AGG_KEEP_RAW default
+
+// Resumo de uma janela (registro enviado ao backend)
+struct AggSummary { // Item da fila de resumos
+    uint32_t seq; // Número do resumo desde o boot (lacuna = resumo perdido)
+    uint32_t startMs; // millis() do início da janela
+    uint32_t durationMs; // Duração efetiva (menor que a janela se fechada por reconfiguração)
+    uint32_t reads; // Leituras aceitas (após deduplicação)
+    uint32_t distinct; // UIDs distintas (estimativa HyperLogLog, limitada a reads)
+    char firstUid[32]; // Primeira UID da janela
+    uint32_t firstMs; // Captura da primeira UID (millis)
+    char lastUid[32]; // Última UID da janela
+    uint32_t lastMs; // Captura da última UID (millis)
+}; // fim: struct AggSummary
+
+// Métricas do agregador
+struct AggStats { // Diagnóstico exposto por EdgeAggregator::stats()
+    uint32_t reads; // Leituras agregadas desde o boot
+    uint32_t windows; // Resumos fechados
+    uint32_t dropped; // Resumos descartados por fila cheia
+}; // fim: struct AggStats
+
+// Agregação por janela com memória fixa (sketch + fila circular de resumos)
+class EdgeAggregator { // Início da definição da classe EdgeAggregator
+public: // Seção pública: API exposta a outros módulos
+    explicit EdgeAggregator(Clock &clock = defaultClock()); // Desligado até setWindow()
+    // setWindow(): 0 desliga; mudança fecha a janela aberta (resumo parcial) e abre outra agora
+    void setWindow(uint32_t ms); // Chamado pelo AppController com agg_window_ms
+    bool enabled() const { return _windowMs != 0; } // Modo agregado ativo
+    uint32_t window() const { return _windowMs; } // Janela efetiva (ms)
+    void add(const char *uidHex, uint32_t captureMs); // Conta uma leitura aceita na janela aberta
+    void loop(); // Fecha a janela vencida (chamar a cada iteração)
+    size_t pending() const { return _count; } // Resumos aguardando envio
+    bool peek(AggSummary &out) const; // Resumo mais antigo (não remove)
+    void pop(); // Remove o mais antigo (após envio confirmado)
+    const AggStats &stats() const { return _stats; } // Métricas
+private: // Seção privada: estado interno
+    Clock &_clock; // Fonte de tempo
+    uint32_t _windowMs; // Janela (0 = desligado)
+    uint32_t _startMs; // Início da janela aberta
+    AggSummary _cur; // Janela aberta (seq/distinct preenchidos ao fechar)
+    HllSketch<AGG_HLL_BITS> _hll; // Distintos da janela aberta
+    AggSummary _queue[AGG_QUEUE_CAPACITY]; // Resumos fechados (fila circular)
+    size_t _head; // Próxima posição livre
+    size_t _count; // Resumos na fila
+    uint32_t _nextSeq; // Sequência do próximo resumo
+    AggStats _stats; // Métricas
+
+    void close(uint32_t endMs); // Fecha a janela aberta em endMs (enfileira se houve leitura)
+    void open(uint32_t startMs); // Abre uma janela vazia em startMs
+    void roll(uint32_t t); // Fecha a janela aberta se t passou do fim (loop: agora; add: captura)
+}; // Fim da classe EdgeAggregator
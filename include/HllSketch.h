@@ -0,0 +1,72 @@
+/*
+    Arquivo: include/HllSketch.h
+    Propósito: Estimador de cardinalidade HyperLogLog com memória fixa
+    (2^P registradores de 1 byte), usado pelo EdgeAggregator para contar UIDs
+    distintos por janela sem guardar as UIDs. Erro padrão ≈ 1,04/√(2^P)
+    (P=8: 256 bytes, ~6,5%); abaixo de ~2,5·2^P itens a estimativa usa
+    contagem linear (registradores zerados), praticamente exata. Lógica pura
+    (sem hardware), como o RfidDedupCache.
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <Arduino.h> // Tipos (uint8_t, uint32_t)
+#include <cstring> // memset
+#include <math.h> // logf, ldexpf
+
+// Sketch HyperLogLog com 2^P registradores (4 <= P <= 12)
+template <uint8_t P> // Bits de índice: define memória e precisão
+class HllSketch { // Início da definição da classe HllSketch
+    static_assert(P >= 4 && P <= 12, "HllSketch: P deve estar em 4..12"); // Faixa com constantes conhecidas
+public: // Seção pública: API exposta a outros módulos
+    static const uint16_t kRegisters = 1u << P; // Quantidade de registradores (bytes)
+
+    HllSketch() { clear(); } // Começa vazio
+
+    // clear(): zera os registradores (nova janela)
+    void clear() { memset(_reg, 0, sizeof(_reg)); } // Estimativa volta a 0
+
+    // add(): registra uma UID (hex); repetições não alteram o sketch
+    void add(const char *uidHex) { addHash(hash(uidHex)); } // Hash + registrador
+
+    // addHash(): P bits altos escolhem o registrador; o resto dá a posição do primeiro bit 1
+    void addHash(uint32_t h) { // Início: addHash()
+        uint16_t idx = (uint16_t)(h >> (32 - P)); // Registrador
+        uint32_t w = h << P; // Bits restantes alinhados à esquerda
+        uint8_t rank = w ? (uint8_t)(__builtin_clz(w) + 1) : (uint8_t)(32 - P + 1); // Zeros à esquerda + 1
+        if (rank > _reg[idx]) _reg[idx] = rank; // Guarda o máximo
+    } // fim: addHash()
+
+    // estimate(): cardinalidade estimada (correções de faixa baixa e alta do artigo original)
+    uint32_t estimate() const { // Início: estimate()
+        float sum = 0.0f; // Σ 2^-M[j]
+        uint16_t zeros = 0; // Registradores vazios
+        for (uint16_t i = 0; i < kRegisters; ++i) { // Percorre registradores
+            sum += ldexpf(1.0f, -(int)_reg[i]); // 2^-M[j]
+            if (_reg[i] == 0) zeros++; // Conta vazios
+        }
+        const float m = (float)kRegisters; // m
+        float e = alpha() * m * m / sum; // Estimativa bruta
+        if (e <= 2.5f * m) { // Faixa baixa
+            if (zeros) e = m * logf(m / (float)zeros); // Contagem linear
+        } else if (e > 143165576.0f) { // Faixa alta (> 2^32/30): colisões do hash de 32 bits
+            e = -4294967296.0f * logf(1.0f - e / 4294967296.0f); // Correção
+        }
+        return (uint32_t)(e + 0.5f); // Arredonda
+    } // fim: estimate()
+
+    // hash(): FNV-1a de 32 bits seguido do finalizador do MurmurHash3 (espalha UIDs parecidas)
+    static uint32_t hash(const char *s) { // Início: hash()
+        uint32_t h = 2166136261u; // Base FNV
+        while (*s) { h ^= (uint8_t)*s++; h *= 16777619u; } // FNV-1a
+        h ^= h >> 16; h *= 0x85EBCA6Bu; // fmix32
+        h ^= h >> 13; h *= 0xC2B2AE35u; // ...
+        h ^= h >> 16; // ...
+        return h; // Hash final
+    } // fim: hash()
+private: // Seção privada: estado interno
+    uint8_t _reg[kRegisters]; // Registradores (posição máxima observada)
+
+    static float alpha() { // Constante de correção de viés por m
+        return P == 4 ? 0.673f : P == 5 ? 0.697f : P == 6 ? 0.709f : 0.7213f / (1.0f + 1.079f / (float)kRegisters); // Valores do artigo
+    } // fim: alpha()
+}; // Fim da classe HllSketch
@@ -0,0 +1,111 @@
+/*
+    Arquivo: include/HmacSha256.h
+    Propósito: SHA-256 e HMAC-SHA256 portáveis (C++ puro, sem alocação), usados
+    para autenticar os datagramas do uplink UDP (UdpProto.h). O mesmo código
+    roda no ESP32 e no coletor Linux (tools/collector), o que garante a mesma
+    etiqueta dos dois lados sem depender de mbedTLS ou OpenSSL. Um datagrama
+    de ~400 bytes custa poucos blocos de 64 bytes (dezenas de µs no ESP32).
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <stddef.h> // size_t
+#include <stdint.h> // Tipos inteiros de largura fixa
+#include <string.h> // memcpy, memset
+
+// SHA-256 incremental (FIPS 180-4)
+class Sha256 { // Início da definição da classe Sha256
+public: // Seção pública: API exposta a outros módulos
+    static const size_t kDigest = 32; // Bytes do resumo
+    static const size_t kBlock = 64; // Bytes do bloco
+
+    Sha256() { reset(); } // Pronto para update()
+
+    // reset(): volta ao estado inicial (valores H0..H7 da norma)
+    void reset() { // Início: reset()
+        static const uint32_t iv[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, // H0..H3
+                                       0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19}; // H4..H7
+        memcpy(_h, iv, sizeof(_h)); // Estado inicial
+        _len = 0; // Bytes processados
+        _fill = 0; // Bytes pendentes no bloco
+    } // fim: reset()
+
+    // update(): acrescenta dados à mensagem
+    void update(const uint8_t *data, size_t n) { // Início: update()
+        _len += n; // Tamanho total (para o padding)
+        while (n > 0) { // Consome em blocos
+            size_t take = kBlock - _fill; // Espaço no bloco
+            if (take > n) take = n; // Limita ao disponível
+            memcpy(_buf + _fill, data, take); // Acumula
+            _fill += take; data += take; n -= take; // Avança
+            if (_fill == kBlock) { compress(_buf); _fill = 0; } // Bloco completo
+        }
+    } // fim: update()
+
+    // finish(): padding + tamanho em bits; escreve os 32 bytes do resumo
+    void finish(uint8_t out[kDigest]) { // Início: finish()
+        uint64_t bits = _len * 8; // Tamanho da mensagem em bits
+        uint8_t pad = 0x80; // Bit 1 seguido de zeros
+        update(&pad, 1); // Marca o fim
+        uint8_t zero = 0; // Preenchimento
+        while (_fill != 56) update(&zero, 1); // Até sobrar espaço para o tamanho
+        uint8_t lenBe[8]; // Tamanho big-endian
+        for (int i = 0; i < 8; ++i) lenBe[i] = (uint8_t)(bits >> (56 - 8 * i)); // Serializa
+        update(lenBe, 8); // Último bloco
+        for (int i = 0; i < 8; ++i) { // Estado -> bytes big-endian
+            out[4 * i] = (uint8_t)(_h[i] >> 24); out[4 * i + 1] = (uint8_t)(_h[i] >> 16); // ...
+            out[4 * i + 2] = (uint8_t)(_h[i] >> 8); out[4 * i + 3] = (uint8_t)_h[i]; // ...
+        }
+    } // fim: finish()
+private: // Seção privada: estado interno
+    uint32_t _h[8]; // Estado
+    uint8_t _buf[kBlock]; // Bloco parcial
+    size_t _fill; // Bytes em _buf
+    uint64_t _len; // Bytes da mensagem
+
+    static uint32_t ror(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); } // Rotação à direita
+
+    // compress(): função de compressão sobre um bloco de 64 bytes
+    void compress(const uint8_t *p) { // Início: compress()
+        static const uint32_t k[64] = { // Constantes da norma
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+        uint32_t w[64]; // Agenda de mensagens
+        for (int i = 0; i < 16; ++i) // Palavras do bloco (big-endian)
+            w[i] = ((uint32_t)p[4 * i] << 24) | ((uint32_t)p[4 * i + 1] << 16) | ((uint32_t)p[4 * i + 2] << 8) | p[4 * i + 3]; // ...
+        for (int i = 16; i < 64; ++i) { // Expansão
+            uint32_t s0 = ror(w[i - 15], 7) ^ ror(w[i - 15], 18) ^ (w[i - 15] >> 3); // σ0
+            uint32_t s1 = ror(w[i - 2], 17) ^ ror(w[i - 2], 19) ^ (w[i - 2] >> 10); // σ1
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1; // W[i]
+        }
+        uint32_t a = _h[0], b = _h[1], c = _h[2], d = _h[3], e = _h[4], f = _h[5], g = _h[6], h = _h[7]; // Registradores
+        for (int i = 0; i < 64; ++i) { // 64 rodadas
+            uint32_t t1 = h + (ror(e, 6) ^ ror(e, 11) ^ ror(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i]; // Σ1 + Ch
+            uint32_t t2 = (ror(a, 2) ^ ror(a, 13) ^ ror(a, 22)) + ((a & b) ^ (a & c) ^ (b & c)); // Σ0 + Maj
+            h = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + t2; // Desloca
+        }
+        _h[0] += a; _h[1] += b; _h[2] += c; _h[3] += d; _h[4] += e; _h[5] += f; _h[6] += g; _h[7] += h; // Acumula
+    } // fim: compress()
+}; // Fim da classe Sha256
+
+// HMAC-SHA256 (RFC 2104); out recebe os 32 bytes da etiqueta
+inline void hmacSha256(const uint8_t *key, size_t keyLen, const uint8_t *msg, size_t msgLen, uint8_t out[Sha256::kDigest]) { // Início: hmacSha256()
+    uint8_t k[Sha256::kBlock]; // Chave ajustada ao bloco
+    memset(k, 0, sizeof(k)); // Zeros à direita
+    if (keyLen > Sha256::kBlock) { Sha256 s; s.update(key, keyLen); s.finish(k); } // Chave longa: usa o hash
+    else memcpy(k, key, keyLen); // Chave curta: copia
+    uint8_t pad[Sha256::kBlock]; // ipad/opad
+    Sha256 inner; // H((K ^ ipad) || msg)
+    for (size_t i = 0; i < sizeof(pad); ++i) pad[i] = k[i] ^ 0x36; // ipad
+    inner.update(pad, sizeof(pad)); inner.update(msg, msgLen); // ...
+    uint8_t ih[Sha256::kDigest]; inner.finish(ih); // Hash interno
+    Sha256 outer; // H((K ^ opad) || hash interno)
+    for (size_t i = 0; i < sizeof(pad); ++i) pad[i] = k[i] ^ 0x5c; // opad
+    outer.update(pad, sizeof(pad)); outer.update(ih, sizeof(ih)); // ...
+    outer.finish(out); // Etiqueta
+} // fim: hmacSha256()
@@ -1,8 +1,17 @@
 /*
     Arquivo: include/HttpSender.h
     Propósito: Declara a classe HttpSender responsável por montar e enviar via
-    HTTP/HTTPS os dados de UID lidos, com metadados do dispositivo e política de
-    retry exponencial para códigos 429/5xx ou erros de transporte.
+    HTTP/HTTPS os dados de UID lidos, com metadados do dispositivo e retries curtos
+    (jitter descorrelacionado) para 5xx ou erros de transporte. Também faz o
+    GET condicional (If-None-Match) usado para baixar a configuração remota.
+    No modo agregado, postSummary() envia um resumo por janela (EdgeAggregator)
+    com os mesmos metadados e a mesma política de retry.
+    Timeout e política de retry podem ser trocados em tempo de execução; a
+    espera somada entre retries de uma chamada nunca passa de
+    HTTP_RETRY_WAIT_BUDGET_MS (só de compilação), seja qual for a política remota.
+    O resultado do último POST (código, Retry-After e RateLimit-*) fica em
+    lastResponse() para o UplinkGovernor; 429 e respostas com Retry-After não
+    são repetidas dentro da chamada (o governador decide quando voltar).
 */
 
 #pragma once // Garante inclusão única deste cabeçalho durante a compilação
@@ -13,6 +22,9 @@
 #include <time.h> // time(), gmtime_r, strftime
 #include "Log.h" // Macros de log
 #include "UidBuffer.h" // UidEntry com uid/capture_ms
+#include "EdgeAggregator.h" // AggSummary (resumo por janela)
+#include "Clock.h" // Relógio injetável (timestamp do envio e espera entre retries)
+#include "UplinkGovernor.h" // UplinkResponse (código + cabeçalhos de ritmo)
 // Configuração: tenta usar include/ProjectConfig.h (local, ignorado no Git), ou fallback para include/ProjectConfig.example.h
 #if defined(__has_include)
 #  if __has_include("ProjectConfig.h")
@@ -24,14 +36,42 @@
 #  include "ProjectConfig.h" // Constantes de configuração definidas pelo usuário
 #endif
 
+#ifndef HTTP_RETRY_MAX // Padrão de compilação (ajustável em tempo de execução via setRetryPolicy)
+#define HTTP_RETRY_MAX 0 // Sem retries extras
+#endif // fim: HTTP_RETRY_MAX default
+#ifndef HTTP_RETRY_BASE_DELAY_MS // Padrão de compilação
+#define HTTP_RETRY_BASE_DELAY_MS 100 // Base do backoff entre retries (ms)
+#endif // fim: HTTP_RETRY_BASE_DELAY_MS default
+#ifndef HTTP_RETRY_WAIT_BUDGET_MS // Espera total entre retries de um POST (a chamada bloqueia a tarefa uplink)
+#define HTTP_RETRY_WAIT_BUDGET_MS 2000 // Esgotado, a chamada devolve a falha e o UplinkGovernor agenda a próxima (ms)
+#endif // fim: HTTP_RETRY_WAIT_BUDGET_MS default
+
 // Cliente HTTP/HTTPS responsável por montar payloads e enviar UIDs com retries
 class HttpSender { // Início da definição da classe HttpSender
 public: // Seção pública: API exposta a outros módulos
-    explicit HttpSender(uint32_t timeoutMs = HTTP_TIMEOUT_MS); // Define timeouts do cliente
+    explicit HttpSender(uint32_t timeoutMs = HTTP_TIMEOUT_MS, Clock &clock = defaultClock()); // Define timeouts do cliente
     bool postUid(const UidEntry &entry); // Envia 1 entrada; true em HTTP 2xx
+    bool postSummary(const AggSummary &s); // Envia 1 resumo de janela (AGG_ENDPOINT_URL ou HTTP_ENDPOINT_URL); true em 2xx
+    // GET condicional: envia If-None-Match (se 'etag' não vazio); em 200 preenche corpo e ETag.
+    // Devolve o código HTTP (304 = não modificado) ou <= 0 em erro de transporte/corpo > maxBytes
+    // (com ou sem Content-Length: sem ele, a leitura do stream é abortada ao passar do limite).
+    int fetch(const char *url, const char *etag, size_t maxBytes, String &body, String &etagOut); // Sem retries
+    void setRetryPolicy(uint8_t maxRetries, uint16_t baseDelayMs) { _retryMax = maxRetries; _retryBaseMs = baseDelayMs; } // Vale no próximo POST
+    void setTimeout(uint32_t timeoutMs) { _timeout = timeoutMs; } // Vale na próxima sessão
+    const UplinkResponse &lastResponse() const { return _last; } // Última tentativa do último POST (para o UplinkGovernor)
 private: // Seção privada: detalhes internos não expostos
+    bool configureTls(WiFiClientSecure &client); // CA (HTTPS_SECURITY_MODE=1) ou modo inseguro (DEV)
+    int performGet(HTTPClient &http, const char *etag, size_t maxBytes, String &body, String &etagOut); // GET numa sessão aberta
+    bool readBounded(HTTPClient &http, size_t maxBytes, String &body); // Corpo sem Content-Length com limite de bytes
+    void appendMeta(String &payload); // Acrescenta timestamps do envio e metadados do dispositivo (fecha o JSON)
+    bool postWithRetry(const String &payload, const String &url); // POST + retries; true em 2xx
     bool performPost(const String &payload, const String &url, int &httpCode); // Executa POST
     bool shouldRetry(int httpCode, uint8_t attempt) const; // Decide retry por código/erro
+    void readPacing(HTTPClient &http); // Retry-After / RateLimit-* da resposta em _last
 private: // Campos privados
     uint32_t _timeout; // Timeout em ms para conexão e requisição
+    uint8_t _retryMax; // Tentativas extras por POST
+    uint16_t _retryBaseMs; // Base do backoff entre retries (ms)
+    Clock &_clock; // Fonte de tempo (timestamp_ms e backoff entre retries)
+    UplinkResponse _last; // Resultado da última tentativa
 }; // Fim da classe HttpSender
@@ -0,0 +1,118 @@
+/*
+    Arquivo: include/LanPullServer.h
+    Propósito: Declara o LanPullServer, um servidor HTTP mínimo na LAN para
+    evacuar a fila de UIDs quando o endpoint na nuvem fica inacessível por
+    longos períodos (queda do link WAN com o Wi‑Fi local ativo). Um gateway
+    local puxa o backlog numa única resposta HTTP chunked, montada em blocos
+    pequenos direto do UidBuffer (sem materializar a fila em RAM), e devolve
+    um cursor de confirmação para o leitor liberar o que já foi coletado.
+    Um cliente por vez, atendido de forma não bloqueante a cada loop().
+      GET  /status                     -> {"epoch","first","end","pending","dropped"}
+      GET  /backlog[?from=S&max=N]     -> NDJSON chunked: um registro por linha
+                                          ({"seq","uid","capture_timestamp_ms"[,"card_data"]}) e
+                                          uma linha final {"next","epoch","records"}
+      POST /ack?epoch=E&cursor=S       -> libera os itens com seq < S
+    A época (epoch) muda a cada boot: as sequências recomeçam após um reinício,
+    e um ack de outra época é recusado (409) para nunca liberar item errado.
+    Implementação em src/LanPullServer.cpp.
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <Arduino.h> // Tipos, random()
+#include <WiFi.h> // WiFiServer / WiFiClient
+#include <functional> // std::function (callback de liberação)
+#include "UidBuffer.h" // Fila coletada (sequências e release)
+#include "Clock.h" // Relógio injetável (prazo da requisição, duração do stream)
+// Configuração: tenta usar include/ProjectConfig.h (local, ignorado no Git), ou fallback para include/ProjectConfig.example.h
+#if defined(__has_include)
+#  if __has_include("ProjectConfig.h")
+#    include "ProjectConfig.h" // Constantes de configuração definidas pelo usuário
+#  else
+#    include "ProjectConfig.example.h" // Fallback para CI/builds padrão
+#  endif
+#else
+#  include "ProjectConfig.h" // Constantes de configuração definidas pelo usuário
+#endif
+
+#ifndef LAN_PULL_ENABLE // Permite sobrescrever via build_flags
+#define LAN_PULL_ENABLE 0 // 0=desligado (expõe a fila na LAN; exige LAN_PULL_TOKEN)
+#endif // fim: LAN_PULL_ENABLE default
+#ifndef LAN_PULL_PORT // Porta TCP do servidor
+#define LAN_PULL_PORT 8080 // HTTP sem TLS (rede local)
+#endif // fim: LAN_PULL_PORT default
+#ifndef LAN_PULL_CHUNK_BYTES // Tamanho máximo de um chunk HTTP
+#define LAN_PULL_CHUNK_BYTES 1024 // Buffer estático do stream (bytes)
+#endif // fim: LAN_PULL_CHUNK_BYTES default
+#ifndef LAN_PULL_CHUNKS_PER_LOOP // Chunks escritos por chamada de loop()
+#define LAN_PULL_CHUNKS_PER_LOOP 4 // Limita o tempo do loop ocupado pelo stream
+#endif // fim: LAN_PULL_CHUNKS_PER_LOOP default
+#ifndef LAN_PULL_REQ_TIMEOUT_MS // Prazo para o cliente enviar a requisição
+#define LAN_PULL_REQ_TIMEOUT_MS 2000 // Cliente lento/mudo é desconectado (ms)
+#endif // fim: LAN_PULL_REQ_TIMEOUT_MS default
+#ifndef LAN_PULL_HOLD_MS // Pausa dos POSTs para a nuvem após um atendimento
+#define LAN_PULL_HOLD_MS 5000 // Entre lotes do coletor o loop não fica preso em POSTs sem WAN (ms)
+#endif // fim: LAN_PULL_HOLD_MS default
+#ifndef LAN_PULL_MAX_REQ_BYTES // Maior cabeçalho de requisição aceito
+#define LAN_PULL_MAX_REQ_BYTES 512 // Linha de requisição + cabeçalhos (bytes)
+#endif // fim: LAN_PULL_MAX_REQ_BYTES default
+
+// Métricas do servidor
+struct LanPullStats { // Diagnóstico exposto por LanPullServer::stats()
+    uint32_t requests; // Requisições atendidas (qualquer rota)
+    uint32_t streams; // Respostas /backlog concluídas
+    uint32_t aborted; // Streams interrompidos (cliente saiu, escrita falhou, queda de link)
+    uint32_t records; // Registros enviados em streams
+    uint32_t bytes; // Bytes de corpo enviados em streams
+    uint32_t skipped; // Registros que saíram da fila durante o stream (enviados pela nuvem/descartados)
+    uint32_t released; // Itens liberados por ack
+    uint32_t rejected; // Respostas 4xx (rota, parâmetros, token, época)
+    uint32_t lastStreamMs; // Duração do último stream concluído
+    uint32_t lastStreamRecords; // Registros do último stream concluído
+    uint32_t maxSliceUs; // Maior fatia de loop() com cliente em atendimento (µs)
+}; // fim: struct LanPullStats
+
+// Servidor de coleta do backlog na LAN (um cliente por vez, não bloqueante)
+class LanPullServer { // Início da definição da classe LanPullServer
+public: // Seção pública: API exposta a outros módulos
+    LanPullServer(UidBuffer &buffer, Clock &clock = defaultClock()); // Fila coletada e relógio
+    void begin(); // Sorteia a época deste boot (o socket abre na primeira chamada com link)
+    void loop(bool linkUp); // Aceita cliente, lê a requisição, escreve chunks do stream
+    void onRelease(std::function<void(size_t)> cb) { _onRelease = cb; } // Chamado após um ack liberar itens
+    bool busy() const { return _state != PullState::IDLE; } // Há cliente em atendimento
+    // Coletor ativo: em atendimento ou atendido há menos de LAN_PULL_HOLD_MS (pausa os POSTs para a nuvem)
+    bool active() const { return busy() || (_served && _clock.nowMs() - _lastServedMs < LAN_PULL_HOLD_MS); } // Sessão de coleta
+    uint32_t epoch() const { return _epoch; } // Época das sequências deste boot
+    const LanPullStats &stats() const { return _stats; } // Métricas
+private: // Seção privada: estado interno
+    enum class PullState { IDLE, REQUEST, STREAM }; // Fases do atendimento
+
+    UidBuffer &_buffer; // Fila (sequências, getAt, release)
+    Clock &_clock; // Fonte de tempo
+    WiFiServer _server; // Socket de escuta
+    WiFiClient _client; // Cliente em atendimento
+    bool _listening; // _server.begin() já chamado
+    bool _served; // Algum cliente já foi atendido
+    uint32_t _lastServedMs; // Fim do último atendimento
+    PullState _state; // Fase atual
+    uint32_t _epoch; // Época (muda a cada boot)
+    uint32_t _deadlineMs; // Prazo da requisição
+    uint32_t _streamStartMs; // Início do stream
+    char _req[LAN_PULL_MAX_REQ_BYTES + 1]; // Requisição recebida (cabeçalho)
+    size_t _reqLen; // Bytes em _req
+    uint32_t _nextSeq; // Próximo registro do stream
+    uint32_t _endSeq; // Fim (exclusivo) do stream
+    uint32_t _sent; // Registros enviados no stream atual
+    static const size_t kChunkHead = 8; // Espaço reservado para o tamanho em hex + CRLF
+    char _chunk[kChunkHead + LAN_PULL_CHUNK_BYTES + 2]; // Tamanho + dados + CRLF (um write por chunk)
+    LanPullStats _stats; // Métricas
+    std::function<void(size_t)> _onRelease; // Persistência após ack
+
+    void readRequest(); // Acumula a requisição e despacha ao completar
+    void dispatch(); // Roteia a requisição completa
+    void streamChunks(); // Escreve até LAN_PULL_CHUNKS_PER_LOOP chunks do stream
+    bool writeChunk(size_t len); // Envia os len bytes em _chunk + kChunkHead como um chunk HTTP
+    void respond(int code, const char *reason, const char *json); // Resposta curta e fecha
+    void finish(bool ok); // Encerra o atendimento atual
+    bool authorized() const; // Confere LAN_PULL_TOKEN (tempo constante)
+    static bool queryUInt(const char *query, const char *key, uint32_t &out); // Parâmetro numérico da URL
+}; // Fim da classe LanPullServer
@@ -0,0 +1,129 @@
+/*
+    Arquivo: include/MemTelemetry.h
+    Propósito: Telemetria de memória para operação de longa duração. Amostra
+    heap livre, maior bloco livre (fragmentação), mínimo histórico de heap e a
+    marca d'água de pilha das tasks FreeRTOS; contabiliza alocações nos trechos
+    de envio e persistência (MemScope) e sinaliza modo degradado ANTES de uma
+    falha de alocação, para que o AppController espace/adié envios TLS.
+    No host (sem ARDUINO), com MEM_HOST_WRAP_MALLOC=1, malloc/free são
+    interceptados via -Wl,--wrap e cada alocação é atribuída ao MemScope ativo.
+    O heap que orienta a saúde no host é roteirizado por hostSetHeap().
+    Implementação em src/MemTelemetry.cpp.
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <stdint.h> // Tipos inteiros de largura fixa
+#include <stddef.h> // size_t
+
+#ifndef MEM_SAMPLE_INTERVAL_MS // Período de amostragem do heap
+#define MEM_SAMPLE_INTERVAL_MS 5000 // Amostra a cada 5 s (ms)
+#endif // fim: MEM_SAMPLE_INTERVAL_MS default
+#ifndef MEM_REPORT_INTERVAL_MS // Período do relatório no log
+#define MEM_REPORT_INTERVAL_MS 60000 // Relatório a cada 60 s (ms); 0 desativa
+#endif // fim: MEM_REPORT_INTERVAL_MS default
+#ifndef MEM_DEGRADED_BLOCK_BYTES // Maior bloco livre abaixo disso -> modo degradado
+#define MEM_DEGRADED_BLOCK_BYTES 45000 // Margem para um handshake TLS (~40 KB contíguos)
+#endif // fim: MEM_DEGRADED_BLOCK_BYTES default
+#ifndef MEM_CRITICAL_BLOCK_BYTES // Maior bloco livre abaixo disso -> modo crítico
+#define MEM_CRITICAL_BLOCK_BYTES 20000 // Sem margem para TLS: envios pausados
+#endif // fim: MEM_CRITICAL_BLOCK_BYTES default
+#ifndef MEM_CRITICAL_FREE_BYTES // Heap livre total abaixo disso -> modo crítico
+#define MEM_CRITICAL_FREE_BYTES 30000 // Limite de heap livre (bytes)
+#endif // fim: MEM_CRITICAL_FREE_BYTES default
+#ifndef MEM_SEND_MIN_BLOCK_BYTES // Bloco contíguo exigido antes de abrir uma sessão de envio
+#define MEM_SEND_MIN_BLOCK_BYTES 32000 // Sessão TLS (mbedTLS) precisa de buffers grandes contíguos
+#endif // fim: MEM_SEND_MIN_BLOCK_BYTES default
+#ifndef MEM_DEGRADED_DRAIN_FACTOR // Multiplicador da cadência de envio com memória degradada
+#define MEM_DEGRADED_DRAIN_FACTOR 10 // Espaça sessões TLS para o heap se recompor
+#endif // fim: MEM_DEGRADED_DRAIN_FACTOR default
+#ifndef MEM_WATCH_TASK_MAX // Máximo de tasks acompanhadas
+#define MEM_WATCH_TASK_MAX 6 // loopTask + tasks de sistema por nome
+#endif // fim: MEM_WATCH_TASK_MAX default
+#ifndef MEM_HOST_WRAP_MALLOC // Só no host: intercepta malloc/free (exige -Wl,--wrap no link)
+#define MEM_HOST_WRAP_MALLOC 0 // 1=conta alocações por trecho (tools/CMakeLists.txt liga no Linux)
+#endif // fim: MEM_HOST_WRAP_MALLOC default
+
+// Trechos instrumentados (sites de alocação)
+enum class MemSite : uint8_t { // Índices da tabela de estatísticas
+    HTTP_SEND, // HttpSender::postUid (String do payload + WiFiClientSecure/HTTPClient)
+    PERSIST_SAVE, // PersistentStore::saveSnapshot
+    PERSIST_LOAD, // PersistentStore::load (String por entrada)
+    CONFIG_FETCH, // HttpSender::fetch da configuração remota (corpo + sessão TLS)
+    COUNT // Quantidade de sites (não é um site)
+}; // fim: enum MemSite
+
+// Saúde da memória, com histerese entre níveis
+enum class MemHealth : uint8_t { OK, DEGRADED, CRITICAL }; // OK -> DEGRADED (espaça TLS) -> CRITICAL (pausa envios)
+
+// Amostra instantânea do heap
+struct MemSnapshot { // Preenchida por MemTelemetry::loop()
+    uint32_t freeHeap; // Heap livre total (bytes)
+    uint32_t largestBlock; // Maior bloco livre contíguo (bytes)
+    uint32_t minFreeHeap; // Menor heap livre desde o boot (bytes)
+    uint8_t fragPct; // Fragmentação: 100 - 100*maiorBloco/livre (%)
+}; // fim: struct MemSnapshot
+
+// Estatísticas acumuladas de um site instrumentado
+struct MemSiteStats { // Atualizada no destrutor de MemScope
+    uint32_t calls; // Execuções do trecho
+    uint32_t allocs; // Alocações (host: contagem exata; ESP32: blocos líquidos retidos)
+    int32_t netBytes; // Bytes retidos acumulados após o trecho (vazamento se cresce)
+    uint32_t worstBlockDrop; // Maior queda do maior bloco livre causada pelo trecho (bytes)
+}; // fim: struct MemSiteStats
+
+// Marca d'água de pilha de uma task
+struct MemTaskStats { // Uma entrada por task acompanhada
+    const char *name; // Nome da task (literal)
+    uint32_t stackFreeMin; // Menor pilha livre já observada (bytes)
+}; // fim: struct MemTaskStats
+
+// Amostragem periódica, sinal de saúde e relatório
+class MemTelemetry { // Início da definição da classe MemTelemetry
+public: // Seção pública: API exposta a outros módulos
+    MemTelemetry(); // Construtor: zera amostras e tasks
+    void begin(); // Registra a task atual (loop) e tasks de sistema por nome; primeira amostra
+    void loop(uint32_t now); // Amostra/relata conforme os períodos configurados
+
+    MemHealth health() const { return _health; } // Nível atual (com histerese)
+    const MemSnapshot &last() const { return _last; } // Última amostra
+    size_t taskCount() const { return _taskCount; } // Tasks acompanhadas
+    const MemTaskStats &task(size_t i) const { return _tasks[i].stats; } // Estatísticas da task i
+
+    // Checagem imediata (sem esperar a amostra): há um bloco contíguo de 'bytes'?
+    static bool canAfford(size_t bytes); // Usado antes de abrir sessão TLS
+    static const MemSiteStats &site(MemSite s); // Estatísticas do site
+    static const char *siteName(MemSite s); // Nome legível do site
+#ifndef ARDUINO // Só no host: as simulações levam o heap a DEGRADED/CRITICAL
+    static void hostSetHeap(uint32_t freeBytes, uint32_t largestBlock); // Vale na próxima amostra e já no canAfford()
+#endif // fim: ARDUINO
+
+private: // Seção privada: estado interno
+    struct WatchedTask { void *handle; MemTaskStats stats; }; // Handle FreeRTOS + estatísticas
+    MemSnapshot _last; // Última amostra do heap
+    MemHealth _health; // Nível atual
+    WatchedTask _tasks[MEM_WATCH_TASK_MAX]; // Tasks acompanhadas
+    size_t _taskCount; // Quantidade registrada
+    uint32_t _lastSample; // Momento (ms) da última amostra
+    uint32_t _lastReport; // Momento (ms) do último relatório
+
+    void watch(void *handle, const char *name); // Adiciona task à lista
+    void sample(); // Lê heap e pilhas
+    void updateHealth(); // Aplica limiares com histerese
+    void report() const; // Imprime resumo no log
+}; // Fim da classe MemTelemetry
+
+// Instrumentação RAII de um trecho: atribui alocações e queda de maior bloco ao site
+class MemScope { // Início da definição da classe MemScope
+public: // Seção pública
+    explicit MemScope(MemSite site); // Abre o trecho (captura estado do heap)
+    ~MemScope(); // Fecha o trecho (acumula deltas em MemTelemetry::site)
+    MemScope(const MemScope &) = delete; // Não copiável
+    MemScope &operator=(const MemScope &) = delete; // Não atribuível
+private: // Seção privada
+    MemSite _site; // Site instrumentado
+    MemSite _prevSite; // Site ativo antes deste (escopos aninhados)
+    bool _prevActive; // Havia site ativo antes deste?
+    uint32_t _allocsBefore; // Contador de alocações na abertura
+    uint32_t _bytesBefore; // Bytes alocados na abertura
+    uint32_t _blockBefore; // Maior bloco livre na abertura
+}; // Fim da classe MemScope
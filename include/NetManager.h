@@ -2,6 +2,11 @@
     Arquivo: include/NetManager.h
     Propósito: Declara o gerenciador de rede Wi‑Fi com reconexão (backoff exponencial
     com jitter) e callbacks de conexão/desconexão, mantendo a aplicação responsiva.
+    Inclui reconexão rápida: o último BSSID/canal/lease bons ficam salvos na NVS e
+    são usados numa tentativa direcionada (sem varredura/DHCP) antes do caminho
+    completo. Com várias redes candidatas (WIFI_NETWORKS), faz varreduras
+    assíncronas e roaming por RSSI com histerese (decisão em NetSelector).
+    Implementação em src/NetManager.cpp.
 */
 
 #pragma once // Garante inclusão única deste cabeçalho durante a compilação
@@ -10,6 +15,8 @@
 #include <functional> // std::function para callbacks
 #include <algorithm> // std::max (se necessário)
 #include "Log.h" // Macros de log (INFO/DEBUG/ERROR)
+#include "NetSelector.h" // Seleção de AP e decisão de roaming (lógica pura)
+#include "Clock.h" // Relógio injetável (sistema no ESP32, virtual no host)
 // Configuração: tenta usar include/ProjectConfig.h (local, ignorado no Git), ou fallback para include/ProjectConfig.example.h
 #if defined(__has_include)
 #  if __has_include("ProjectConfig.h")
@@ -21,46 +28,67 @@
 #  include "ProjectConfig.h" // Constantes de configuração definidas pelo usuário
 #endif
 
+#ifndef WIFI_FAST_CONNECT // Permite sobrescrever via build_flags
+#define WIFI_FAST_CONNECT 1 // 1=tenta BSSID/canal em cache antes da varredura completa
+#endif // fim: WIFI_FAST_CONNECT default
+#ifndef WIFI_FAST_CONNECT_TIMEOUT_MS // Prazo da tentativa direcionada
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 1500 // Sem IP nesse prazo -> cai para varredura completa (ms)
+#endif // fim: WIFI_FAST_CONNECT_TIMEOUT_MS default
+#ifndef WIFI_REUSE_DHCP_LEASE // Reaproveita o último lease DHCP como IP fixo no caminho rápido
+#define WIFI_REUSE_DHCP_LEASE 1 // 1=ativa (pula DHCP na reconexão rápida); 0=sempre DHCP
+#endif // fim: WIFI_REUSE_DHCP_LEASE default
+#ifndef WIFI_DHCP_LEASE_MS // Duração do lease do servidor DHCP da instalação (o driver não a expõe pela API Arduino)
+#define WIFI_DHCP_LEASE_MS 3600000UL // 1 h (conservador); o lease só é reaproveitado até a metade (T1 da renovação)
+#endif // fim: WIFI_DHCP_LEASE_MS default
+#ifndef WIFI_LEASE_VERIFY_MS // Janela após uma reconexão com lease reaproveitado
+#define WIFI_LEASE_VERIFY_MS 30000 // Falha de HTTP/DNS nesse prazo descarta o lease e força DHCP (ms)
+#endif // fim: WIFI_LEASE_VERIFY_MS default
+
+#ifndef WIFI_ROAM_CHECK_MS // Período da checagem de RSSI em segundo plano
+#define WIFI_ROAM_CHECK_MS 10000 // Lê RSSI a cada 10 s quando conectado (ms)
+#endif // fim: WIFI_ROAM_CHECK_MS default
+#ifndef WIFI_ROAM_SAME_SSID // Roaming também entre APs do mesmo SSID (mesmo com uma rede só)
+#define WIFI_ROAM_SAME_SSID 1 // 1=considera outros BSSIDs da mesma rede; 0=só com várias redes
+#endif // fim: WIFI_ROAM_SAME_SSID default
+#ifndef WIFI_SCAN_MAX_RESULTS // Limite de APs considerados por varredura
+#define WIFI_SCAN_MAX_RESULTS 16 // Resultados copiados da varredura (itens)
+#endif // fim: WIFI_SCAN_MAX_RESULTS default
+
+#if WIFI_FAST_CONNECT // Cache de conexão só existe com reconexão rápida habilitada
+#include <Preferences.h> // NVS para guardar BSSID/canal/lease entre reinícios
+#endif // fim: include condicional de Preferences
+
+// Métricas das fases de conexão (ms) e contadores do caminho rápido
+struct NetConnectStats { // Estrutura de telemetria exposta por NetManager::stats()
+    uint32_t attempts; // Total de tentativas de conexão (rápidas + completas)
+    uint32_t fastAttempts; // Tentativas pelo caminho rápido (BSSID/canal em cache)
+    uint32_t fastSuccess; // Conexões concluídas pelo caminho rápido
+    uint32_t fullFallbacks; // Vezes em que o caminho rápido expirou e caiu para varredura
+    uint32_t lastLinkMs; // begin() -> associado+autenticado (STA_CONNECTED)
+    uint32_t lastDhcpMs; // associado -> IP obtido (DHCP ou IP fixo)
+    uint32_t lastTotalMs; // begin() -> IP obtido (latência de reconexão ponta a ponta)
+    bool lastWasFast; // true se a última conexão usou o caminho rápido
+    uint32_t scans; // Varreduras assíncronas iniciadas (seleção e roaming)
+    uint32_t roams; // Trocas de AP por link degradado (tentativas; fora de fastAttempts)
+    uint32_t roamSuccess; // Trocas concluídas com IP no AP novo dentro do prazo
+    uint32_t roamFallbacks; // Trocas cujo prazo expirou e caíram para a conexão completa
+    uint32_t leaseReuses; // Conexões com o lease em cache (sem DHCP)
+    uint32_t leaseRevoked; // Leases reaproveitados descartados por falha de HTTP/DNS logo após a reconexão
+    int8_t lastRssi; // Último RSSI lido na checagem periódica (dBm)
+}; // fim: struct NetConnectStats
+
 // Gerenciador da conectividade Wi‑Fi (reconexão com backoff e callbacks)
 class NetManager { // Início da definição da classe NetManager
 public: // Seção pública: API exposta a outros módulos
     // Construtor: configura tempos de backoff e estado inicial
-    NetManager(unsigned long baseRetryMs = 2000, unsigned long maxRetryMs = 30000) // Construtor com tempos padrão
-        : _baseRetry(baseRetryMs), // Tempo base para backoff exponencial (ms)
-        _maxRetry(maxRetryMs), // Tempo máximo entre tentativas (ms)
-        _currentWait(baseRetryMs), // Janela atual de espera para próxima tentativa (ms)
-        _lastAttempt(0), // Timestamp (ms) da última tentativa
-        _onConnect(nullptr), // Callback para evento de conexão (opcional)
-        _onDisconnect(nullptr), // Callback para evento de desconexão (opcional)
-        _wasConnected(false) {} // Memória do estado anterior (conectado?)
+    NetManager(unsigned long baseRetryMs = 2000, unsigned long maxRetryMs = 30000, // Construtor com tempos padrão
+               Clock &clock = defaultClock()); // Relógio injetado
 
     // Inicia o Wi‑Fi em modo estação e dispara a primeira tentativa de conexão
-    void begin() { // Configura Wi‑Fi e inicia a primeira tentativa
-        WiFi.mode(WIFI_STA); // Define modo estação (cliente)
-        WiFi.setAutoReconnect(false); // Desliga auto-reconexão para controlar backoff manualmente
-        WiFi.persistent(false); // Evita gravar credenciais na flash
-        attemptConnect(); // Primeira tentativa imediata de conexão
-    }
+    void begin(); // Configura Wi‑Fi, carrega cache e inicia a primeira tentativa
 
     // Deve ser chamado no loop principal; gerencia transições e reconexão com backoff
-    void loop() { // Chamar frequentemente no loop principal
-        bool connected = isConnected(); // Captura estado atual da conexão
-        if (connected && !_wasConnected) { // Transição: desconectado -> conectado
-            LOG_INFO("Wi-Fi conectado: %s", WiFi.localIP().toString().c_str()); // Loga IP local
-            _currentWait = _baseRetry; // Reseta janela de backoff ao básico
-            if (_onConnect) _onConnect(); // Dispara callback de conexão (se definido)
-        } else if (!connected && _wasConnected) { // Transição: conectado -> desconectado
-            LOG_ERROR("Wi-Fi desconectado"); // Loga perda de conexão
-            if (_onDisconnect) _onDisconnect(); // Dispara callback de desconexão (se definido)
-        }
-        _wasConnected = connected; // Atualiza memória do estado anterior
-        if (connected) return; // Se conectado, não tenta reconectar
-        unsigned long now = millis(); // Leitura do tempo atual (ms desde boot)
-        if (now - _lastAttempt >= _currentWait) { // Se já passou a janela de espera
-            attemptConnect(); // Faz nova tentativa de conexão
-            backoffGrow(); // Cresce janela com backoff e jitter
-        }
-    }
+    void loop(); // Chamar frequentemente no loop principal
 
     // Informa se o Wi‑Fi está conectado (status = WL_CONNECTED)
     bool isConnected() const { return WiFi.status() == WL_CONNECTED; } // Retorna true se Wi‑Fi está conectado
@@ -70,7 +98,29 @@ public: // Seção pública: API exposta a outros módulos
     // Registra callback a ser chamado quando a conexão for perdida
     void onDisconnect(const std::function<void()> &cb) { _onDisconnect = cb; } // Registra callback de desconexão
 
+    // Métricas de conexão (tempos por fase e contadores do caminho rápido)
+    const NetConnectStats &stats() const { return _stats; } // Acesso somente leitura às métricas
+
+    // Falha de transporte (HTTP sem resposta, DNS): logo após reaproveitar o lease, o endereço
+    // pode ter sido entregue a outro host; descarta o lease e reconecta com DHCP
+    void reportTransportFailure(); // Chamado pelo AppController após um POST/GET/resolução sem resposta
+
 private: // Seção privada: detalhes internos não expostos
+    // Último link bom (persistido na NVS) usado pelo caminho rápido
+    struct LinkCache { // Layout gravado como blob na NVS
+        uint8_t bssid[6]; // MAC do AP
+        int32_t channel; // Canal do AP
+        uint32_t ip; // IP local (lease)
+        uint32_t gateway; // Gateway do lease
+        uint32_t subnet; // Máscara do lease
+        uint32_t dns; // DNS primário do lease
+        uint32_t leaseMs; // Duração do lease (0 = sem lease: IP fixo)
+        uint32_t leaseAtMs; // millis() do DHCP que entregou o lease (vale só no boot em que foi obtido)
+        uint8_t net; // Índice da rede candidata (WIFI_NETWORKS)
+        bool valid; // true quando há dados utilizáveis
+    }; // fim: struct LinkCache
+
+    Clock &_clock; // Fonte de tempo para backoff, prazos e métricas
     unsigned long _baseRetry; // Tempo base para primeira/menores esperas (ms)
     unsigned long _maxRetry; // Teto de espera entre tentativas (ms)
     unsigned long _currentWait; // Espera atual antes da próxima tentativa (ms)
@@ -78,24 +128,49 @@ private: // Seção privada: detalhes internos não expostos
     std::function<void()> _onConnect; // Callback para quando conectar
     std::function<void()> _onDisconnect; // Callback para quando desconectar
     bool _wasConnected; // Estado anterior de conexão
+    bool _fastPending; // true enquanto a tentativa rápida aguarda IP
+    bool _roamPending; // true quando a tentativa com prazo é um roaming (contadores próprios)
+    bool _fastSuppressed; // true após falha do caminho rápido (até a próxima conexão)
+    bool _scanning; // true enquanto uma varredura assíncrona está em curso
+    unsigned long _lastRssiCheck; // Momento (ms) da última checagem de RSSI
+    unsigned long _connectedAt; // Momento (ms) da última conexão (janela WIFI_LEASE_VERIFY_MS)
+    bool _leaseBoot; // true após um DHCP neste boot (lease vindo da NVS nunca é reaproveitado)
+    bool _leaseTry; // Tentativa em curso com o lease em cache
+    bool _leaseInUse; // Link atual usa o lease em cache (não passou por DHCP)
+    NetSelector _selector; // Lista de redes candidatas + regras de roaming
+    LinkCache _cache; // Cópia em RAM do último link bom
+    NetConnectStats _stats; // Métricas de conexão
+    volatile uint32_t _tBegin; // millis() do WiFi.begin() corrente (escrito no loop)
+    volatile uint32_t _tLink; // millis() do evento STA_CONNECTED (escrito na task de eventos)
+    volatile uint32_t _tGotIp; // millis() do evento GOT_IP (escrito na task de eventos)
+#if WIFI_FAST_CONNECT // Handler da NVS só existe com reconexão rápida
+    Preferences _prefs; // Namespace "netcache"
+#endif // fim: WIFI_FAST_CONNECT
 
     // Executa uma tentativa de conexão e atualiza o timestamp da última tentativa
-    void attemptConnect() { // Realiza uma tentativa de conexão
-        _lastAttempt = millis(); // Marca hora da tentativa (ms)
-        LOG_DEBUG("Tentando conectar Wi‑Fi (espera=%lums)", _currentWait); // Log de tentativa
-        if (WiFi.status() != WL_CONNECTED) { // Evita begin() redundante quando já conectado
-            WiFi.begin(WIFI_SSID, WIFI_PASSWORD); // Inicia/repete conexão com credenciais
-        }
-    }
-
+    void attemptConnect(); // Escolhe caminho rápido (cache) ou completo (varredura + DHCP)
+    // Caminho completo: uma rede -> WiFi.begin direto; várias -> varredura para escolher o AP
+    void connectFull(); // Decide entre beginFull() e startScan()
+    // Tentativa completa: varredura de canais e DHCP (ou IP fixo configurado)
+    void beginFull(uint8_t net); // WiFi.begin(ssid, senha) sem BSSID/canal
+    // Tentativa direcionada a um AP (cache ou escolha do seletor)
+    void beginTargeted(const LinkCache &t, bool reuseLease, bool fast, bool roam = false); // WiFi.begin(ssid, senha, canal, bssid)
+    // Lease em cache reaproveitável: obtido por DHCP neste boot e antes da metade da duração
+    bool leaseUsable() const; // WIFI_REUSE_DHCP_LEASE + validade do lease
+    // Aplica IP fixo configurado (WIFI_STATIC_IP) ou volta a DHCP
+    void applyIpConfig(const LinkCache *lease); // WiFi.config(...) conforme origem do endereço
+    // Inicia varredura assíncrona (não bloqueia o loop)
+    void startScan(); // WiFi.scanNetworks(true)
+    // Consome o resultado da varredura quando pronta: conecta ou decide roaming
+    void pollScan(); // WiFi.scanComplete() -> NetSelector
+    // Checagem periódica de RSSI quando conectado; dispara varredura se degradado
+    void serviceRoaming(unsigned long now); // Lê RSSI e agenda varredura
     // Atualiza a janela de espera usando backoff exponencial com jitter e limites
-    void backoffGrow() { // Exponencial com jitter (±10%), limitado por _maxRetry
-        unsigned long next = _currentWait * 2; // Dobra a janela atual
-        if (next > _maxRetry) next = _maxRetry; // Aplica teto de espera
-        long jitter = (long)(next * 0.1f); // Calcula 10% de jitter (aleatoriedade)
-        long delta = (long)random(-jitter, jitter); // Offset aleatório no intervalo [−jitter, +jitter)
-        long candidate = (long)next + delta; // Soma jitter à janela dobrada
-        if (candidate < (long)_baseRetry) candidate = (long)_baseRetry; // Garante piso no baseRetry
-        _currentWait = (unsigned long)candidate; // Atualiza a janela resultante
-    }
+    void backoffGrow(); // Exponencial com jitter (±10%), limitado por _maxRetry
+    // Registra handlers de eventos Wi‑Fi para medir as fases da conexão
+    void registerEvents(); // STA_CONNECTED / GOT_IP -> timestamps
+    // Consolida métricas e salva o link atual no cache após conectar
+    void recordConnected(); // Calcula tempos por fase e persiste BSSID/canal/lease
+    void loadCache(); // Lê LinkCache da NVS (se houver)
+    void saveCache(const LinkCache &c); // Grava LinkCache na NVS somente se mudou
 }; // Fim da classe NetManager
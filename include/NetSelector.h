@@ -0,0 +1,137 @@
+/*
+    Arquivo: include/NetSelector.h
+    Propósito: Lógica pura de seleção de rede e roaming entre APs conhecidos.
+    Recebe a lista de redes candidatas (SSID/senha) e resultados de varredura
+    (SSID, BSSID, canal, RSSI) e decide: qual AP usar ao conectar e quando trocar
+    de AP (roaming) com histerese e tempo mínimo de permanência. Não depende da
+    API Wi‑Fi do ESP32, podendo ser exercitada no host com varreduras roteirizadas.
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <stdint.h> // Tipos inteiros de largura fixa
+#include <stddef.h> // size_t
+#include <string.h> // strcmp, memcmp, memcpy
+
+#ifndef WIFI_ROAM_RSSI_DBM // Limiar que dispara a busca por AP melhor
+#define WIFI_ROAM_RSSI_DBM -72 // Abaixo disso (dBm) o link é considerado degradado
+#endif // fim: WIFI_ROAM_RSSI_DBM default
+#ifndef WIFI_ROAM_HYSTERESIS_DB // Vantagem mínima exigida do novo AP
+#define WIFI_ROAM_HYSTERESIS_DB 8 // Novo AP precisa ser ao menos 8 dB mais forte
+#endif // fim: WIFI_ROAM_HYSTERESIS_DB default
+#ifndef WIFI_ROAM_MIN_DWELL_MS // Permanência mínima entre roamings
+#define WIFI_ROAM_MIN_DWELL_MS 60000 // Evita "ping-pong" entre APs (ms)
+#endif // fim: WIFI_ROAM_MIN_DWELL_MS default
+
+// Rede candidata configurada (ponteiros para literais de configuração)
+struct WifiCandidate { // Item da lista WIFI_NETWORKS
+    const char *ssid; // SSID da rede
+    const char *password; // Senha (WPA2/WPA3-PSK) ou "" para rede aberta
+}; // fim: struct WifiCandidate
+
+// Um AP visto na varredura
+struct WifiScanResult { // Cópia compacta de um resultado de WiFi.scanNetworks()
+    char ssid[33]; // SSID (até 32 bytes + NUL)
+    uint8_t bssid[6]; // MAC do AP
+    int32_t channel; // Canal
+    int8_t rssi; // Intensidade do sinal (dBm)
+}; // fim: struct WifiScanResult
+
+// AP escolhido pelo seletor
+struct NetChoice { // Alvo para WiFi.begin(ssid, senha, canal, bssid)
+    uint8_t candidate; // Índice na lista de candidatas
+    uint8_t bssid[6]; // MAC do AP escolhido
+    int32_t channel; // Canal do AP escolhido
+    int8_t rssi; // RSSI observado na varredura
+}; // fim: struct NetChoice
+
+// Seleção de AP e decisão de roaming com histerese
+class NetSelector { // Início da definição da classe NetSelector
+public: // Seção pública: API exposta a outros módulos
+    // Construtor: lista de candidatas (não copiada) e parâmetros de roaming
+    NetSelector(const WifiCandidate *list, uint8_t count, // Lista estática de redes
+                int8_t roamRssiDbm = WIFI_ROAM_RSSI_DBM, // Limiar de link degradado
+                uint8_t hysteresisDb = WIFI_ROAM_HYSTERESIS_DB, // Vantagem mínima do novo AP
+                uint32_t minDwellMs = WIFI_ROAM_MIN_DWELL_MS) // Permanência mínima
+        : _list(list), _count(count), _roamRssi(roamRssiDbm), // Guarda lista e limiar
+          _hysteresis(hysteresisDb), _minDwell(minDwellMs), // Guarda histerese e permanência
+          _connectedAt(0), _hasConnected(false) {} // Ainda sem conexão registrada
+
+    // Quantidade de redes candidatas configuradas
+    uint8_t count() const { return _count; } // Tamanho da lista
+    // Acesso à candidata i (i < count())
+    const WifiCandidate &candidate(uint8_t i) const { return _list[i]; } // Referência para SSID/senha
+
+    // Índice da candidata com este SSID; -1 se não estiver na lista
+    int indexOf(const char *ssid) const { // Busca linear (lista pequena)
+        for (uint8_t i = 0; i < _count; ++i) { // Percorre candidatas
+            if (strcmp(_list[i].ssid, ssid) == 0) return i; // SSID conhecido
+        } // fim: laço de busca
+        return -1; // SSID desconhecido
+    } // fim: indexOf()
+
+    // Escolhe o AP conhecido com maior RSSI (empate: ordem da lista); false se nenhum
+    bool pickBest(const WifiScanResult *res, size_t n, NetChoice &out) const { // Seleção inicial
+        bool found = false; // Nenhum AP conhecido até agora
+        for (size_t i = 0; i < n; ++i) { // Percorre a varredura
+            int idx = indexOf(res[i].ssid); // A rede é uma candidata?
+            if (idx < 0) continue; // Ignora redes desconhecidas
+            if (found && !better(res[i].rssi, (uint8_t)idx, out.rssi, out.candidate)) continue; // Não supera a atual
+            fill(res[i], (uint8_t)idx, out); // Novo melhor AP
+            found = true; // Marca achado
+        } // fim: laço da varredura
+        return found; // true se algum AP conhecido apareceu
+    } // fim: pickBest()
+
+    // Link degradado o suficiente para justificar uma varredura em segundo plano?
+    bool needsScan(int8_t currentRssi, uint32_t now) const { // Checagem periódica de RSSI
+        if (currentRssi >= _roamRssi) return false; // Sinal aceitável
+        return dwellElapsed(now); // Respeita permanência mínima
+    } // fim: needsScan()
+
+    // Decide roaming: melhor AP conhecido, diferente do atual, com vantagem >= histerese
+    bool shouldRoam(int8_t currentRssi, const uint8_t currentBssid[6], // Link atual
+                    const WifiScanResult *res, size_t n, uint32_t now, // Varredura recente
+                    NetChoice &out) const { // Alvo do roaming
+        if (!needsScan(currentRssi, now)) return false; // Link bom ou troca recente
+        bool found = false; // Nenhum alvo até agora
+        for (size_t i = 0; i < n; ++i) { // Percorre a varredura
+            int idx = indexOf(res[i].ssid); // Rede conhecida?
+            if (idx < 0) continue; // Ignora redes desconhecidas
+            if (memcmp(res[i].bssid, currentBssid, 6) == 0) continue; // Mesmo AP: não é roaming
+            if ((int)res[i].rssi < (int)currentRssi + (int)_hysteresis) continue; // Ganho insuficiente
+            if (found && !better(res[i].rssi, (uint8_t)idx, out.rssi, out.candidate)) continue; // Não supera o alvo
+            fill(res[i], (uint8_t)idx, out); // Novo alvo
+            found = true; // Marca achado
+        } // fim: laço da varredura
+        return found; // true se vale trocar de AP
+    } // fim: shouldRoam()
+
+    // Registra o instante da conexão (início da permanência mínima)
+    void noteConnected(uint32_t now) { _connectedAt = now; _hasConnected = true; } // Reinicia contagem de permanência
+
+private: // Seção privada: estado interno
+    const WifiCandidate *_list; // Lista de candidatas (memória estática do chamador)
+    uint8_t _count; // Número de candidatas
+    int8_t _roamRssi; // Limiar de link degradado (dBm)
+    uint8_t _hysteresis; // Vantagem mínima do novo AP (dB)
+    uint32_t _minDwell; // Permanência mínima entre roamings (ms)
+    uint32_t _connectedAt; // Instante da última conexão (ms)
+    bool _hasConnected; // true após a primeira conexão registrada
+
+    // Permanência mínima cumprida? (aritmética sem sinal: segura no wrap de millis)
+    bool dwellElapsed(uint32_t now) const { return !_hasConnected || (now - _connectedAt) >= _minDwell; } // Checa janela
+
+    // Critério de comparação: RSSI maior vence; empate -> candidata de menor índice
+    static bool better(int8_t rssi, uint8_t idx, int8_t bestRssi, uint8_t bestIdx) { // Ordenação dos APs
+        if (rssi != bestRssi) return rssi > bestRssi; // Sinal mais forte
+        return idx < bestIdx; // Prioridade pela ordem da lista
+    } // fim: better()
+
+    // Copia um resultado de varredura para a escolha
+    static void fill(const WifiScanResult &r, uint8_t idx, NetChoice &out) { // Preenche NetChoice
+        out.candidate = idx; // Índice da candidata
+        memcpy(out.bssid, r.bssid, 6); // BSSID do AP
+        out.channel = r.channel; // Canal do AP
+        out.rssi = r.rssi; // RSSI observado
+    } // fim: fill()
+}; // Fim da classe NetSelector
@@ -2,12 +2,20 @@
     Arquivo: include/PersistentStore.h
     Propósito: Persistir um snapshot simples do UidBuffer em NVS (Preferences)
     do ESP32 quando PERSIST_BUFFER=1. Estratégia O(n) adequada a baixa escala
-    para recuperar o estado do buffer após reinicializações.
+    para recuperar o estado do buffer após reinicializações. A restauração é
+    incremental (beginRestore() + restoreStep() a cada loop), do fim para o
+    início com UidBuffer::pushFront(), para que o leitor aceite cartões logo
+    no boot: leituras novas ficam depois do backlog restaurado e, cheio o
+    buffer, as entradas mais antigas são as descartadas. Enquanto restoring()
+    for verdadeiro, o snapshot não deve ser regravado (apagaria entradas
+    ainda não lidas). Com RFID_BLOCK_READ, o conteúdo do bloco de cada item
+    vai numa terceira chave (dat<i>).
 */
 
 #pragma once // Garante inclusão única deste cabeçalho durante a compilação
 #include <Arduino.h> // Tipos/utilidades Arduino (String, uint32_t, etc.)
 #include "UidBuffer.h" // Declarações de UidBuffer e UidEntry
+#include "Log.h" // Macros de log (descarte na restauração)
 // Configuração: tenta usar include/ProjectConfig.h (local, ignorado no Git), ou fallback para include/ProjectConfig.example.h
 #if defined(__has_include)
 #  if __has_include("ProjectConfig.h")
@@ -19,6 +27,10 @@
 #  include "ProjectConfig.h" // Constantes de configuração definidas pelo usuário
 #endif
 
+#ifndef PERSIST_RESTORE_BATCH // Entradas restauradas por iteração do loop no boot
+#define PERSIST_RESTORE_BATCH 32 // 2 leituras de NVS por entrada (3 com RFID_BLOCK_READ); 0 = restaura tudo em begin(), antes do primeiro loop
+#endif // fim: PERSIST_RESTORE_BATCH default
+
 // Habilita a persistência apenas quando definido em ProjectConfig.h (evita custo quando desativado)
 #if PERSIST_BUFFER // Compila bloco real de persistência quando PERSIST_BUFFER=1
 #include <Preferences.h> // API de NVS/Preferences do ESP32
@@ -39,25 +51,55 @@ public: // Seção pública: API exposta a outros módulos
             char keyTs[16]; snprintf(keyTs, sizeof(keyTs), "ts%u", (unsigned)i); // Monta chave timestamp
             _prefs.putString(keyUid, e.uid); // Grava UID como String na NVS
             _prefs.putUInt(keyTs, e.capture_ms); // Grava timestamp (ms) na NVS
+#if RFID_BLOCK_READ // Conteúdo do bloco
+            char keyDat[16]; snprintf(keyDat, sizeof(keyDat), "dat%u", (unsigned)i); // Monta chave do conteúdo
+            _prefs.putString(keyDat, e.data); // Grava conteúdo ("" = não lido)
+#endif // fim: RFID_BLOCK_READ
         } // fim do for
     } // fim: saveSnapshot
 
-    // Carrega snapshot no buffer (respeita a capacidade e ignora entradas vazias)
-    void load(UidBuffer &buf) { // Reconstrói o conteúdo do buffer a partir da NVS
-        uint32_t count = _prefs.getUInt("count", 0); // Lê quantidade de itens
-        if (count > UID_BUFFER_CAPACITY) count = UID_BUFFER_CAPACITY; // Limita à capacidade
-        for (uint32_t i = 0; i < count; ++i) { // Itera sobre as posições salvas
-            char keyUid[16]; snprintf(keyUid, sizeof(keyUid), "uid%u", i); // Chave UID
-            char keyTs[16]; snprintf(keyTs, sizeof(keyTs), "ts%u", i); // Chave timestamp
-            String uid = _prefs.getString(keyUid, ""); // Lê UID (ou vazio)
+    // Inicia a restauração incremental; retorna as entradas registradas no snapshot
+    uint32_t beginRestore() { // Só lê a contagem (barato no boot)
+        _next = _prefs.getUInt("count", 0); // Próximo índice a restaurar + 1 (do fim para o início)
+        return _next; // 0 = nada a restaurar
+    } // fim: beginRestore
+
+    // Restaurando? (snapshot não deve ser regravado até terminar)
+    bool restoring() const { return _next > 0; } // Restam entradas na NVS
+
+    // Restaura até maxItems entradas (as mais novas primeiro, inseridas antes do mais antigo do buffer);
+    // retorna quantas entraram. Buffer cheio encerra: o que falta é mais antigo que tudo no buffer.
+    size_t restoreStep(UidBuffer &buf, size_t maxItems) { // Um passo por iteração do loop
+        size_t n = 0; // Entradas restauradas neste passo
+        while (_next > 0 && maxItems-- > 0) { // Até o início do snapshot ou o limite do passo
+            uint32_t i = _next - 1; // Índice da entrada
+            char keyUid[16]; snprintf(keyUid, sizeof(keyUid), "uid%u", (unsigned)i); // Chave UID
+            char keyTs[16]; snprintf(keyTs, sizeof(keyTs), "ts%u", (unsigned)i); // Chave timestamp
+            char uid[sizeof(((UidEntry *)0)->uid)]; // UID sem String (sem alocação por entrada)
+            if (_prefs.getString(keyUid, uid, sizeof(uid)) == 0) uid[0] = '\0'; // Ausente ou grande demais: slot vazio
             uint32_t ts = _prefs.getUInt(keyTs, 0); // Lê timestamp (ms) (ou 0)
-            if (uid.length() > 0) { // Ignora slots vazios
-                buf.push(uid.c_str(), ts); // Reinsere no buffer na ordem correta
+            char dat[RFID_BLOCK_DATA_MAX] = ""; // Conteúdo do bloco (vazio sem RFID_BLOCK_READ ou em snapshot antigo)
+#if RFID_BLOCK_READ // Terceira chave
+            if (uid[0] != '\0') { // Só com UID válida
+                char keyDat[16]; snprintf(keyDat, sizeof(keyDat), "dat%u", (unsigned)i); // Chave do conteúdo
+                if (_prefs.getString(keyDat, dat, sizeof(dat)) == 0) dat[0] = '\0'; // Ausente: sem conteúdo
             }
-        } // fim do for
-    } // fim: load
+#endif // fim: RFID_BLOCK_READ
+            if (uid[0] != '\0') { // Ignora slots vazios
+                if (!buf.pushFront(uid, ts, dat)) { // Buffer cheio: descarta esta e as mais antigas
+                    LOG_ERROR("Snapshot: %u entradas antigas descartadas (buffer cheio)", (unsigned)_next); // Diagnóstico
+                    _next = 0; // Encerra
+                    break; // Sai do laço
+                }
+                n++; // Conta
+            }
+            _next = i; // Próxima (mais antiga)
+        } // fim do while
+        return n; // Restauradas neste passo
+    } // fim: restoreStep
 private: // Seção privada: estado interno
     Preferences _prefs; // Handler da NVS/Preferences
+    uint32_t _next = 0; // Entradas do snapshot ainda não restauradas (índices 0.._next-1)
 }; // Fim da classe PersistentStore
 #else // PERSIST_BUFFER desabilitado: fornecer stubs sem efeito
 // Stubs no-op quando a persistência estiver desativada por build flag
@@ -67,7 +109,9 @@ public: // API compatível, implementações vazias
     void begin() {} // no-op
     // Salvamento stub: ignorado quando persistência está desabilitada
     void saveSnapshot(const UidBuffer &) {} // no-op
-    // Carregamento stub: ignorado quando persistência está desabilitada
-    void load(UidBuffer &) {} // no-op
+    // Restauração stub: nada a restaurar quando persistência está desabilitada
+    uint32_t beginRestore() { return 0; } // no-op
+    bool restoring() const { return false; } // Nunca restaurando
+    size_t restoreStep(UidBuffer &, size_t) { return 0; } // no-op
 }; // Fim da classe PersistentStore (stub)
 #endif // Fim do controle condicional de PERSIST_BUFFER
@@ -14,12 +14,48 @@
 #define WIFI_SSID "YOUR_WIFI_SSID" // SSID da rede Wi‑Fi
 #define WIFI_PASSWORD "YOUR_WIFI_PASSWORD" // Senha da rede Wi‑Fi
 
+// Opcional: várias redes candidatas (roaming por RSSI). Sem isso, usa só WIFI_SSID/WIFI_PASSWORD.
+// A ordem define a prioridade em caso de empate de sinal.
+// #define WIFI_NETWORKS { { "REDE_PRINCIPAL", "SENHA_1" }, { "REDE_RESERVA", "SENHA_2" } }
+
+// Opcional: IP fixo (pula DHCP em toda conexão). Sem isso, o NetManager usa DHCP e,
+// na reconexão rápida, reaproveita o último lease (WIFI_REUSE_DHCP_LEASE=1) enquanto ele
+// estiver na primeira metade de WIFI_DHCP_LEASE_MS (ajuste para a duração do roteador).
+// #define WIFI_DHCP_LEASE_MS 3600000UL // Duração do lease entregue pelo roteador (ms)
+// #define WIFI_STATIC_IP "192.168.1.50" // IP local do leitor
+// #define WIFI_STATIC_GATEWAY "192.168.1.1" // Gateway (obrigatório com IP fixo)
+// #define WIFI_STATIC_SUBNET "255.255.255.0" // Máscara (padrão /24)
+// #define WIFI_STATIC_DNS "192.168.1.1" // DNS primário (padrão: gateway)
+
 // Endpoint principal HTTP/HTTPS para enviar UIDs via POST (genérico)
 // Exemplos:
 //  - https://api.seusistema.com/entrada-uid
 //  - https://webhook.site/<uuid> (apenas para testes rápidos)
 #define HTTP_ENDPOINT_URL "https://example.com/api/uid" // URL do endpoint
 
+// Opcional: destino dos resumos por janela no modo agregado (agg_window_ms > 0).
+// Sem isso, os resumos vão para HTTP_ENDPOINT_URL com "record":"summary".
+// #define AGG_ENDPOINT_URL "https://example.com/api/uid-summary" // URL dos resumos
+
+// Opcional: documento de configuração em tempo de execução (JSON plano, GET com ETag).
+// Chaves aceitas: dedup_ms, dedup_slots, drain_ms, retry_max, retry_base_ms, http_timeout_ms, buf_cap, agg_window_ms.
+// Sem isso, os parâmetros vêm da NVS (namespace "rtcfg") ou dos padrões de compilação.
+// #define CONFIG_URL "https://example.com/api/config/esp32-leitor-01" // URL do documento
+
+// Opcional: coleta do backlog por um gateway na LAN (habilite com -DLAN_PULL_ENABLE=1).
+// O token é obrigatório (sem ele a compilação falha); GET /status, GET /backlog e POST /ack exigem "Authorization: Bearer <token>".
+// #define LAN_PULL_TOKEN "troque-este-token" // Segredo compartilhado com o gateway
+
+// Opcional: uplink em datagramas UDP para o coletor (tools/collector), habilite com -DUDP_UPLINK_ENABLE=1.
+// A fila deixa de subir por HTTP_ENDPOINT_URL (resumos do modo agregado continuam por HTTP).
+// A chave HMAC é a mesma em toda a frota e no rfid_collector (--key).
+// #define UDP_COLLECTOR_HOST "192.168.1.10" // IP ou nome do coletor (porta UDP_COLLECTOR_PORT, padrão 47474)
+// #define UDP_HMAC_KEY "troque-esta-chave" // Chave HMAC-SHA256 dos datagramas
+
+// Opcional: leitura autenticada de um bloco do cartão (ex.: matrícula), habilite com -DRFID_BLOCK_READ=1 (não combina com UDP_UPLINK_ENABLE).
+// Chaves tentadas em ordem (a última aceita vai primeiro); padrão: só a de fábrica FF..FF.
+// #define RFID_BLOCK_KEYS { { 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5 }, { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF } }
+
 // Opcional: timeout de HTTP em milissegundos
 #define HTTP_TIMEOUT_MS 5000 // Timeout do HTTPClient (ms)
 
@@ -3,28 +3,47 @@
     Propósito: Encapsula a lógica de deduplicação temporal por UID usando um
     cache fixo (tamanho definido por DEDUP_CACHE_SIZE) e uma janela de tempo
     (DEDUP_INTERVAL_MS). Facilita testes unitários sem depender do MFRC522.
+    Toda comparação de tempo usa idade (now - lastMs) em aritmética sem sinal,
+    segura no wrap de millis(); sweep() expira entradas vencidas para que um UID
+    antigo não "ressuscite" como duplicado após ~49,7 dias. A janela e o
+    número de slots ativos podem ser alterados em tempo de execução
+    (setWindow/setSlots, ver RuntimeConfig); DEDUP_CACHE_SIZE é o máximo.
 */
 
 #pragma once // Garante inclusão única deste cabeçalho durante a compilação
 #include <Arduino.h> // Tipos/utilidades do Arduino (uint32_t, etc.)
-#include <cstring> // strcmp, strncpy
+#include <cstring> // strcmp
+#include "StrUtil.h" // copyBounded (cópia limitada com NUL)
 
 #ifndef DEDUP_INTERVAL_MS // Permite sobrescrever via build_flags
 #define DEDUP_INTERVAL_MS 1000 // Janela de deduplicação padrão (ms)
 #endif // fim: DEDUP_INTERVAL_MS default
 #ifndef DEDUP_CACHE_SIZE // Permite sobrescrever via build_flags
-#define DEDUP_CACHE_SIZE 16 // Entradas distintas acompanhadas no cache
+#define DEDUP_CACHE_SIZE 16 // Entradas distintas acompanhadas no cache (máximo; dimensiona o array)
 #endif // fim: DEDUP_CACHE_SIZE default
 
 // Componente de deduplicação temporal por UID (cache + janela)
 class RfidDedupCache { // Início da definição da classe RfidDedupCache
 public: // Seção pública: API exposta a outros módulos
     // Construtor: inicializa o estado do cache
-    RfidDedupCache() { clear(); } // Constrói e limpa o cache imediatamente
+    RfidDedupCache() : _windowMs(DEDUP_INTERVAL_MS), _slots(DEDUP_CACHE_SIZE) { clear(); } // Padrões de compilação; cache limpo
+
+    // setWindow(): nova janela de deduplicação (vale já para a próxima consulta)
+    void setWindow(uint32_t ms) { _windowMs = ms; } // Entradas existentes são reavaliadas com a nova janela
+    uint32_t window() const { return _windowMs; } // Janela atual (ms)
+
+    // setSlots(): quantidade de slots ativos (1..DEDUP_CACHE_SIZE); ao reduzir, libera os excedentes
+    void setSlots(uint16_t n) { // Início: setSlots()
+        if (n < 1) n = 1; // Mínimo de um slot
+        if (n > DEDUP_CACHE_SIZE) n = DEDUP_CACHE_SIZE; // Máximo de compilação
+        for (int i = n; i < DEDUP_CACHE_SIZE; ++i) _entries[i].used = false; // Excedentes deixam de valer
+        _slots = n; // Aplica
+    } // fim: setSlots()
+    uint16_t slots() const { return _slots; } // Slots ativos
 
     // clear(): zera todas as entradas do cache (estado inicial)
     void clear() { // Início: clear()
-        for (int i = 0; i < DEDUP_CACHE_SIZE; ++i) { // Varre todos os slots do cache
+        for (int i = 0; i < DEDUP_CACHE_SIZE; ++i) { // Varre todos os slots do cache (inclusive inativos)
             _entries[i].used = false; // Marca o slot como livre (não usado)
             _entries[i].uid[0] = '\0'; // Limpa o UID armazenado (string vazia)
             _entries[i].lastMs = 0; // Zera o timestamp da última leitura aceita
@@ -35,7 +54,7 @@ public: // Seção pública: API exposta a outros módulos
     bool isDuplicate(const char* uidHex, uint32_t now) const { // Início: isDuplicate()
         int idx = findIndex(uidHex); // Procura índice do UID no cache
         if (idx < 0) return false; // UID não está no cache: não é duplicado
-        return (now - _entries[idx].lastMs) < DEDUP_INTERVAL_MS; // true se ainda dentro da janela
+        return (now - _entries[idx].lastMs) < _windowMs; // true se ainda dentro da janela
     } // fim: isDuplicate()
 
     // remember(): registra/atualiza o UID no cache com timestamp 'now'
@@ -43,20 +62,27 @@ public: // Seção pública: API exposta a outros módulos
         int idx = findIndex(uidHex); // Procura UID já existente no cache
         if (idx >= 0) { _entries[idx].lastMs = now; return; } // Já existe: atualiza timestamp e retorna
         // Procura um slot livre para cadastrar novo UID
-        for (int i = 0; i < DEDUP_CACHE_SIZE; ++i) { // Percorre slots do cache
+        for (int i = 0; i < _slots; ++i) { // Percorre slots ativos do cache
             if (!_entries[i].used) { // Achou slot livre
                 writeSlot(i, uidHex, now); // Grava o UID e o timestamp no slot
                 return; // Sai após gravar em slot livre
             } // fim: condição de slot livre
         } // fim: laço de busca de slot livre
-        // Se o cache estiver cheio: substituir o mais antigo (menor lastMs)
+        // Se o cache estiver cheio: substituir o mais antigo (maior idade now - lastMs, seguro no wrap)
         int oldest = 0; // Índice do slot considerado mais antigo
-        for (int i = 1; i < DEDUP_CACHE_SIZE; ++i) { // Varre para encontrar o menor lastMs
-            if (_entries[i].lastMs < _entries[oldest].lastMs) oldest = i; // Atualiza índice do mais antigo
+        for (int i = 1; i < _slots; ++i) { // Varre para encontrar a maior idade
+            if ((now - _entries[i].lastMs) > (now - _entries[oldest].lastMs)) oldest = i; // Atualiza índice do mais antigo
         } // fim: laço de seleção do mais antigo
         writeSlot(oldest, uidHex, now); // Sobrescreve o slot do mais antigo com o novo UID
     } // fim: remember()
 
+    // sweep(): libera entradas cuja janela já venceu (chamar periodicamente)
+    void sweep(uint32_t now) { // Início: sweep()
+        for (int i = 0; i < _slots; ++i) { // Varre os slots ativos
+            if (_entries[i].used && (now - _entries[i].lastMs) >= _windowMs) _entries[i].used = false; // Janela vencida: libera
+        } // fim: laço de expiração
+    } // fim: sweep()
+
     // contains(): utilitário para testes/diagnóstico (verifica existência no cache)
     bool contains(const char* uidHex) const { return findIndex(uidHex) >= 0; } // true se UID já foi registrado
 
@@ -67,10 +93,12 @@ private: // Seção privada: estrutura interna e helpers
         bool used; // Indica se o slot está ocupado
     }; // fim: struct Entry
     Entry _entries[DEDUP_CACHE_SIZE]; // Array fixo de entradas (cache associativo simples)
+    uint32_t _windowMs; // Janela de deduplicação (ms)
+    uint16_t _slots; // Slots ativos (≤ DEDUP_CACHE_SIZE)
 
     // findIndex(): devolve o índice do UID no cache; -1 se não encontrado
     int findIndex(const char* uidHex) const { // Início: findIndex()
-        for (int i = 0; i < DEDUP_CACHE_SIZE; ++i) { // Percorre todos os slots
+        for (int i = 0; i < _slots; ++i) { // Percorre os slots ativos
             if (_entries[i].used && strcmp(_entries[i].uid, uidHex) == 0) return i; // Achou UID neste slot
         } // fim: laço de busca
         return -1; // Não encontrado
@@ -78,8 +106,7 @@ private: // Seção privada: estrutura interna e helpers
 
     // writeSlot(): grava UID/tempo em um slot específico
     void writeSlot(int i, const char* uidHex, uint32_t now) { // Início: writeSlot()
-        strncpy(_entries[i].uid, uidHex, sizeof(_entries[i].uid) - 1); // Copia UID com limite e sem overflow
-        _entries[i].uid[sizeof(_entries[i].uid) - 1] = '\0'; // Garante terminação NUL do UID
+        copyBounded(_entries[i].uid, sizeof(_entries[i].uid), uidHex); // Copia UID com limite e terminação NUL
         _entries[i].lastMs = now; // Atualiza timestamp do slot
         _entries[i].used = true; // Marca slot como ocupado
     } // fim: writeSlot()
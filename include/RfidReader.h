@@ -3,13 +3,25 @@
     Propósito: Declara a classe RfidReader que encapsula o acesso ao leitor
     MFRC522 via SPI, com deduplicação temporal por UID (janela + cache) para
     evitar reenvio da mesma tag dentro de um período, mesmo alternando com
-    outras tags. Implementação em src/RfidReader.cpp.
+    outras tags. readInventory() enumera todos os cartões presentes no campo
+    num único ciclo (REQA -> anticolisão/SELECT -> HLTA até nenhum responder),
+    com tempo por ciclo e vazão (cartões/s) em stats().
+    Com RFID_BLOCK_READ=1 (UidBuffer.h), cada cartão aceito também tem um bloco
+    MIFARE Classic lido (PCD_Authenticate com as chaves de RFID_BLOCK_KEYS +
+    MIFARE_Read) e decodificado no campo data do registro; um CardDataCache
+    UID -> conteúdo poupa a criptografia de quem já passou, e a leitura de
+    cada cartão tem orçamento de tempo (RFID_BLOCK_READ_BUDGET_US). Acertos,
+    falhas e latência das leituras ficam em blockStats().
+    Implementação em src/RfidReader.cpp.
 */
 
 #pragma once // Garante inclusão única deste cabeçalho durante a compilação
 #include <Arduino.h> // Tipos/utilidades Arduino (uint8_t, size_t, millis, etc.)
 #include <MFRC522.h> // Biblioteca oficial do leitor RFID MFRC522
 #include "RfidDedupCache.h" // Cache de deduplicação por UID (testável)
+#include "CardDataCache.h" // Cache UID -> conteúdo do bloco (RFID_BLOCK_READ)
+#include "UidBuffer.h" // UidEntry (saída do inventário em lote)
+#include "Clock.h" // Relógio injetável (sistema no ESP32, virtual no host)
 
 // Janela de deduplicação (ms): mesmo UID lido dentro da janela é descartado
 #ifndef DEDUP_INTERVAL_MS // Permite sobreposição via build flags/ProjectConfig.h
@@ -21,25 +33,127 @@
 #define DEDUP_CACHE_SIZE 16 // Número de UIDs distintos rastreados na janela
 #endif // DEDUP_CACHE_SIZE
 
+// Modo inventário: todos os cartões do campo por ciclo (0 = um cartão por chamada, via read())
+#ifndef RFID_INVENTORY
+#define RFID_INVENTORY 0 // Desligado por padrão: ligar onde vários cartões chegam juntos ao campo
+#endif // RFID_INVENTORY
+
+// Máximo de seleções por ciclo de inventário (limita o tempo bloqueado no loop)
+#ifndef RFID_INVENTORY_MAX
+#define RFID_INVENTORY_MAX 8 // Cada cartão custa ~30 ms de RF (SELECT + timeout do HLTA)
+#endif // RFID_INVENTORY_MAX
+
+// Métricas do inventário (apenas ciclos com ao menos um cartão)
+struct RfidInventoryStats { // Atualizada por readInventory()
+    uint32_t cycles; // Ciclos com cartão
+    uint32_t cards; // Cartões selecionados (inclui duplicatas)
+    uint32_t accepted; // Cartões aceitos pela deduplicação
+    uint32_t lastCycleUs; // Duração do último ciclo (µs)
+    uint32_t maxCycleUs; // Pior ciclo (µs)
+    uint8_t lastCards; // Cartões no último ciclo
+    uint8_t maxCards; // Maior número de cartões num ciclo
+    uint64_t busyUs; // Soma das durações dos ciclos (µs)
+    // Vazão média: cartões por segundo de RF ocupado
+    uint32_t cardsPerSec() const { return busyUs ? (uint32_t)((uint64_t)cards * 1000000ULL / busyUs) : 0; } // cartões/s
+}; // fim: struct RfidInventoryStats
+
+// Timeout do RC522 para comandos sem resposta (ms). A biblioteca usa 25 ms, pagos a cada
+// REQA com campo vazio e a cada HLTA; o ATQA chega em ~0,1 ms. 0 não toca no timer
+// (TReloadReg fica como o PCD_Init() deixou); só um valor definido no build o encurta.
+#ifndef RFID_RF_TIMEOUT_MS
+#define RFID_RF_TIMEOUT_MS 0 // Valor da biblioteca (25 ms)
+#endif // RFID_RF_TIMEOUT_MS
+#ifndef RFID_BLOCK_MIN_TIMEOUT_MS // Menor timeout que ainda cobre autenticação/leitura MIFARE
+#define RFID_BLOCK_MIN_TIMEOUT_MS 10 // Com RFID_BLOCK_READ, RFID_RF_TIMEOUT_MS abaixo disso não compila
+#endif // RFID_BLOCK_MIN_TIMEOUT_MS
+
+// Leitura do bloco do cartão (RFID_BLOCK_READ=1); chaves em RFID_BLOCK_KEYS (ProjectConfig.h)
+#ifndef RFID_BLOCK_ADDR // Bloco de dados lido (nunca o trailer do setor)
+#define RFID_BLOCK_ADDR 4 // Setor 1, bloco 0
+#endif // RFID_BLOCK_ADDR
+#ifndef RFID_BLOCK_KEY_B // Tipo de chave da autenticação
+#define RFID_BLOCK_KEY_B 0 // 0 = chave A, 1 = chave B
+#endif // RFID_BLOCK_KEY_B
+#ifndef RFID_BLOCK_OFFSET // Primeiro byte usado dentro do bloco
+#define RFID_BLOCK_OFFSET 0 // Início do bloco
+#endif // RFID_BLOCK_OFFSET
+#ifndef RFID_BLOCK_LEN // Bytes usados a partir de RFID_BLOCK_OFFSET
+#define RFID_BLOCK_LEN 16 // Bloco inteiro
+#endif // RFID_BLOCK_LEN
+#ifndef RFID_BLOCK_FORMAT // Decodificação dos bytes no campo data
+#define RFID_BLOCK_FORMAT 0 // 0 = ASCII (sem preenchimento final), 1 = hex, 2 = inteiro big-endian em decimal (até 8 bytes)
+#endif // RFID_BLOCK_FORMAT
+#ifndef RFID_BLOCK_READ_BUDGET_US // Tempo máximo de autenticação + leitura por cartão (inclui novas tentativas)
+#define RFID_BLOCK_READ_BUDGET_US 30000 // Vencido, o registro sai sem conteúdo (a UID nunca se perde)
+#endif // RFID_BLOCK_READ_BUDGET_US
+#ifndef RFID_BLOCK_READ_RETRIES // Novas tentativas após uma leitura perdida (re-seleção do cartão)
+#define RFID_BLOCK_READ_RETRIES 2 // Além de uma tentativa por chave
+#endif // RFID_BLOCK_READ_RETRIES
+
+// Métricas da leitura de bloco (RFID_BLOCK_READ)
+struct RfidBlockStats { // Atualizada por read()/readInventory()
+    uint32_t lookups; // Cartões aceitos (consultas ao cache)
+    uint32_t hits; // Respondidos pelo cache (sem autenticação)
+    uint32_t reads; // Leituras no cartão (falta no cache)
+    uint32_t failures; // Leituras sem sucesso (chave desconhecida, cartão saiu, orçamento): registro sem conteúdo
+    uint32_t authFails; // Autenticações sem resposta (chave errada ou quadro perdido)
+    uint32_t retries; // Re-seleções do cartão após uma falha
+    uint32_t lastReadUs; // Duração da última leitura no cartão (µs)
+    uint32_t maxReadUs; // Pior leitura (µs)
+    uint64_t totalReadUs; // Soma das durações (µs)
+    uint32_t hitRatePct() const { return lookups ? (uint32_t)((uint64_t)hits * 100 / lookups) : 0; } // Taxa de acerto (%)
+    uint32_t avgReadUs() const { return reads ? (uint32_t)(totalReadUs / reads) : 0; } // Latência média de uma falta (µs)
+}; // fim: struct RfidBlockStats
+
 // Leitor RFID MFRC522 com deduplicação temporal por UID (cache + janela)
 class RfidReader { // Início da definição da classe RfidReader
 public: // Seção pública: API do leitor
     // Construtor: define pinos SDA/SS (chip select) e RST do MFRC522
-    RfidReader(uint8_t sda, uint8_t rst); // Construtor do leitor RFID
+    RfidReader(uint8_t sda, uint8_t rst, Clock &clock = defaultClock()); // Construtor do leitor RFID
 
     // Inicializa o barramento SPI e o chip MFRC522 (deve ser chamada no setup)
     void begin(); // Inicialização de hardware do RFID
 
     // Lê um UID, converte para HEX e aplica deduplicação temporal por UID (cache)
-    // Retorna true se uma nova leitura válida foi obtida; outHex recebe o UID em HEX
-    bool read(char *outHex, size_t outLen, uint32_t &captureMs); // Leitura não-bloqueante com dedup
+    // Retorna true se uma nova leitura válida foi obtida; outHex recebe o UID em HEX e,
+    // com RFID_BLOCK_READ, outData o conteúdo do bloco ("" se a leitura falhou)
+    bool read(char *outHex, size_t outLen, uint32_t &captureMs, char *outData = nullptr, size_t dataLen = 0); // Leitura não-bloqueante com dedup
+
+    // Inventário: seleciona e coloca em HALT cada cartão do campo (até 'max'), aplica a
+    // deduplicação a cada um e escreve os aceitos em 'out'. Retorna quantos foram aceitos.
+    size_t readInventory(UidEntry *out, size_t max); // Lote de leituras de um ciclo de RF
+
+    // Ajuste ao vivo da deduplicação (RuntimeConfig): janela e slots ativos do cache
+    void setDedup(uint32_t windowMs, uint16_t slots) { _dedup.setWindow(windowMs); _dedup.setSlots(slots); } // Vale na próxima leitura
+
+    // Métricas do inventário (tempo por ciclo, cartões/s)
+    const RfidInventoryStats &stats() const { return _stats; } // Somente leitura
+
+    // Métricas da leitura de bloco (acertos do cache, latência das leituras no cartão)
+    const RfidBlockStats &blockStats() const { return _blockStats; } // Somente leitura
 
 private: // Seção privada: detalhes internos
     MFRC522 _mfrc522; // Instância do driver MFRC522
+    Clock &_clock; // Fonte de tempo para captura e deduplicação
     char _lastUid[32]; // Mantido por compatibilidade (não é usado para dedup global)
     uint32_t _lastUidCapture; // Mantido por compatibilidade
 
     RfidDedupCache _dedup; // Componente de deduplicação por UID (cache + janela)
+    RfidInventoryStats _stats; // Métricas do inventário
+    RfidBlockStats _blockStats; // Métricas da leitura de bloco (zeradas sem RFID_BLOCK_READ)
+    uint8_t _keyHint; // Índice da última chave aceita (tentada primeiro)
+#if RFID_BLOCK_READ // Só ocupa RAM com a leitura de bloco ligada
+    CardDataCache _cache; // UID -> conteúdo do bloco
+
+    // Conteúdo do bloco do cartão selecionado: cache ou leitura autenticada ("" se falhar)
+    void cardData(MFRC522::Uid &uid, const char *hex, uint32_t now, char *out, size_t outLen); // RFID_BLOCK_READ
+
+    // Autentica (chaves de RFID_BLOCK_KEYS) e lê RFID_BLOCK_ADDR dentro de RFID_BLOCK_READ_BUDGET_US
+    bool readBlock(MFRC522::Uid &uid, char *out, size_t outLen); // true se leu
+
+    // Decodifica os bytes do bloco conforme RFID_BLOCK_FORMAT (sem aspas/barras: seguro em JSON)
+    void decodeBlock(const byte *block, char *out, size_t outLen); // Bytes -> texto
+#endif // fim: RFID_BLOCK_READ
 
     // Verifica se o UID em HEX é duplicado dentro da janela DEDUP_INTERVAL_MS
     bool isDuplicate(const char *hex, uint32_t now); // Retorna true quando for duplicado (delegado ao cache)
@@ -0,0 +1,137 @@
+/*
+    Arquivo: include/RuntimeConfig.h
+    Propósito: Declara o RuntimeConfig, armazenamento tipado dos parâmetros de
+    desempenho ajustáveis em campo (janela/slots de dedup, cadência de envio,
+    política de retry, timeout HTTP, capacidade efetiva do buffer, janela
+    da agregação na borda e ritmo do UplinkGovernor). Os
+    valores partem dos padrões de compilação, são persistidos na NVS
+    (namespace "rtcfg") e podem ser atualizados por um documento JSON plano
+    baixado do backend (GET com ETag/If-None-Match). Os máximos de compilação
+    (UID_BUFFER_CAPACITY, DEDUP_CACHE_SIZE, HTTP_RETRY_MAX_LIMIT) continuam
+    dimensionando os buffers estáticos; o valor em tempo de execução nunca os
+    ultrapassa. Implementação em src/RuntimeConfig.cpp.
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <Arduino.h> // Tipos, String
+#include <Preferences.h> // NVS (valores e ETag)
+#include "UidBuffer.h" // UID_BUFFER_CAPACITY (máximo do buffer)
+#include "RfidDedupCache.h" // DEDUP_INTERVAL_MS / DEDUP_CACHE_SIZE (padrão e máximo)
+#include "EdgeAggregator.h" // AGG_WINDOW_MS (padrão da janela de agregação)
+#include "UplinkGovernor.h" // UPLINK_RATE_PER_MIN / UPLINK_BURST (padrões do balde de fichas)
+#include "Clock.h" // Relógio injetável (agenda do download)
+// Configuração: tenta usar include/ProjectConfig.h (local, ignorado no Git), ou fallback para include/ProjectConfig.example.h
+#if defined(__has_include)
+#  if __has_include("ProjectConfig.h")
+#    include "ProjectConfig.h" // Constantes de configuração definidas pelo usuário
+#  else
+#    include "ProjectConfig.example.h" // Fallback para CI/builds padrão
+#  endif
+#else
+#  include "ProjectConfig.h" // Constantes de configuração definidas pelo usuário
+#endif
+
+#ifndef HTTP_RETRY_MAX // Padrão de compilação (sobrescrevível via build_flags)
+#define HTTP_RETRY_MAX 0 // Sem retries extras
+#endif // fim: HTTP_RETRY_MAX default
+#ifndef HTTP_RETRY_BASE_DELAY_MS // Padrão de compilação
+#define HTTP_RETRY_BASE_DELAY_MS 100 // Base do backoff entre retries (ms)
+#endif // fim: HTTP_RETRY_BASE_DELAY_MS default
+#ifndef QUEUE_DRAIN_INTERVAL_MS // Padrão de compilação
+#define QUEUE_DRAIN_INTERVAL_MS 100 // Cadência mínima entre tentativas de envio (ms)
+#endif // fim: QUEUE_DRAIN_INTERVAL_MS default
+#ifndef HTTP_RETRY_MAX_LIMIT // Teto do valor remoto de retries (a espera entre eles é limitada por HTTP_RETRY_WAIT_BUDGET_MS)
+#define HTTP_RETRY_MAX_LIMIT 5 // Máximo aceito em tempo de execução
+#endif // fim: HTTP_RETRY_MAX_LIMIT default
+#ifndef CONFIG_FETCH_INTERVAL_MS // Período do download da configuração remota
+#define CONFIG_FETCH_INTERVAL_MS 900000UL // 15 min (304 quando nada mudou)
+#endif // fim: CONFIG_FETCH_INTERVAL_MS default
+#ifndef CONFIG_FETCH_RETRY_MS // Nova tentativa após falha no download
+#define CONFIG_FETCH_RETRY_MS 60000UL // 1 min
+#endif // fim: CONFIG_FETCH_RETRY_MS default
+#ifndef CONFIG_MAX_BYTES // Maior documento aceito (JSON plano)
+#define CONFIG_MAX_BYTES 1024 // Protege o heap contra respostas inesperadas
+#endif // fim: CONFIG_MAX_BYTES default
+
+// Identificadores dos parâmetros (índices da tabela de descritores)
+enum RuntimeParamId : uint8_t { // Ordem estável (máscaras de mudança usam 1 << id)
+    RP_DEDUP_MS, // Janela de deduplicação (ms) — ao vivo
+    RP_DEDUP_SLOTS, // Slots ativos do cache de dedup (≤ DEDUP_CACHE_SIZE) — ao vivo
+    RP_DRAIN_MS, // Cadência de envio da fila (ms) — ao vivo
+    RP_RETRY_MAX, // Retries extras por POST (≤ HTTP_RETRY_MAX_LIMIT) — ao vivo
+    RP_RETRY_BASE_MS, // Base do backoff entre retries (ms) — ao vivo
+    RP_HTTP_TIMEOUT_MS, // Timeout de conexão/requisição HTTP (ms) — ao vivo (próxima sessão)
+    RP_BUF_CAP, // Capacidade efetiva do buffer (≤ UID_BUFFER_CAPACITY) — aplicada no boot
+    RP_AGG_WINDOW_MS, // Janela da agregação na borda (ms; 0 = um registro por leitura) — ao vivo
+    RP_UP_RATE_PM, // Fichas de POST por minuto do UplinkGovernor (0 = sem limite) — ao vivo
+    RP_UP_BURST, // Rajada do balde de fichas — ao vivo
+    RP_COUNT // Quantidade de parâmetros
+}; // fim: enum RuntimeParamId
+
+// Descritor de um parâmetro: chave (NVS e JSON), faixa válida, padrão e modo de aplicação
+struct RuntimeParamDesc { // Tabela constante em RuntimeConfig.cpp
+    const char *key; // Chave no JSON remoto e na NVS (≤ 15 caracteres)
+    uint32_t min; // Menor valor aceito
+    uint32_t max; // Maior valor aceito (máximo de compilação quando dimensiona buffer)
+    uint32_t def; // Padrão de compilação
+    bool live; // true: aplicado imediatamente; false: no próximo boot
+}; // fim: struct RuntimeParamDesc
+
+// Métricas do download da configuração
+struct RuntimeConfigStats { // Diagnóstico
+    uint32_t fetches; // GETs tentados
+    uint32_t notModified; // Respostas 304 (ETag igual)
+    uint32_t updates; // Documentos 200 aplicados
+    uint32_t rejected; // Valores fora da faixa descartados
+    uint32_t errors; // Falhas de transporte/HTTP
+    int lastCode; // Último código HTTP (ou erro do cliente)
+}; // fim: struct RuntimeConfigStats
+
+// Armazenamento tipado de parâmetros ajustáveis em tempo de execução
+class RuntimeConfig { // Início da definição da classe RuntimeConfig
+public: // Seção pública: API exposta a outros módulos
+    explicit RuntimeConfig(Clock &clock = defaultClock()); // Valores = padrões de compilação
+    void begin(); // Carrega da NVS (valores fora da faixa voltam ao padrão) e agenda o primeiro download
+
+    // Acesso tipado aos valores efetivos
+    uint32_t dedupIntervalMs() const { return _v[RP_DEDUP_MS]; } // Janela de dedup (ms)
+    uint16_t dedupSlots() const { return (uint16_t)_v[RP_DEDUP_SLOTS]; } // Slots ativos do cache
+    uint32_t drainIntervalMs() const { return _v[RP_DRAIN_MS]; } // Cadência de envio (ms)
+    uint8_t httpRetryMax() const { return (uint8_t)_v[RP_RETRY_MAX]; } // Retries extras
+    uint16_t httpRetryBaseMs() const { return (uint16_t)_v[RP_RETRY_BASE_MS]; } // Base do backoff (ms)
+    uint32_t httpTimeoutMs() const { return _v[RP_HTTP_TIMEOUT_MS]; } // Timeout HTTP (ms)
+    uint16_t bufferCapacity() const { return (uint16_t)_bootBufCap; } // Capacidade efetiva (fixada no boot)
+    uint32_t aggWindowMs() const { return _v[RP_AGG_WINDOW_MS]; } // Janela de agregação (0 = desligada)
+    uint32_t upRatePerMin() const { return _v[RP_UP_RATE_PM]; } // Fichas de POST por minuto (0 = sem limite)
+    uint16_t upBurst() const { return (uint16_t)_v[RP_UP_BURST]; } // Rajada do balde
+    uint32_t get(RuntimeParamId id) const { return _v[id]; } // Acesso genérico (valor persistido)
+
+    // Altera um parâmetro (validado e persistido); true se o valor mudou
+    bool set(RuntimeParamId id, uint32_t value); // false se fora da faixa ou igual
+
+    // Aplica um documento JSON plano {"chave": número, ...}; chaves ausentes voltam ao padrão,
+    // valores inválidos mantêm o atual. Devolve a máscara (1 << id) dos parâmetros alterados.
+    uint32_t applyJson(const char *json); // Usado pelo download e por testes no host
+
+    // Agenda do download: true quando é hora de buscar (chamar apenas com rede)
+    bool fetchDue() const { return (int32_t)(_clock.nowMs() - _nextFetchMs) >= 0; } // Seguro no wrap
+    const char *etag() const { return _etag; } // ETag da última versão aplicada ("" se nenhuma)
+    // Resultado de um GET: 200 aplica 'body' e guarda 'etag'; 304 só reagenda. Devolve a máscara alterada.
+    uint32_t onFetchResult(int httpCode, const String &body, const String &etag); // Reagenda o próximo download
+
+    static const RuntimeParamDesc &desc(RuntimeParamId id); // Descritor do parâmetro
+    static uint32_t liveMask(); // Máscara dos parâmetros aplicados ao vivo
+    const RuntimeConfigStats &stats() const { return _stats; } // Métricas do download
+private: // Seção privada: estado interno
+    Clock &_clock; // Fonte de tempo da agenda
+    Preferences _prefs; // Namespace "rtcfg"
+    bool _open; // begin() já abriu a NVS
+    uint32_t _v[RP_COUNT]; // Valores efetivos (persistidos)
+    uint32_t _bootBufCap; // Capacidade do buffer fixada no boot
+    char _etag[64]; // ETag da versão aplicada
+    uint32_t _nextFetchMs; // Próximo download
+    RuntimeConfigStats _stats; // Métricas
+
+    static bool parseUInt(const char *json, const char *key, uint32_t &out, bool &present); // Busca "key": número
+    void persist(RuntimeParamId id); // Grava um valor na NVS
+}; // Fim da classe RuntimeConfig
@@ -0,0 +1,18 @@
+/*
+    Arquivo: include/StrUtil.h
+    Propósito: Utilitários de texto comuns aos buffers de tamanho fixo (fila,
+    cache de deduplicação, cache do bloco do cartão). copyBounded() substitui
+    o padrão strncpy(dst, src, n - 1) + NUL: não preenche o resto com zeros e
+    não dispara -Wstringop-truncation. Lógica pura (sem hardware).
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <cstddef> // size_t
+#include <cstring> // strnlen, memcpy
+
+// Copia até cap-1 bytes de src e termina com NUL (cap > 0; trunca em silêncio)
+inline void copyBounded(char *dst, size_t cap, const char *src) { // Início: copyBounded
+    size_t n = strnlen(src, cap - 1); // Nunca lê além do que cabe
+    memcpy(dst, src, n); // Copia
+    dst[n] = '\0'; // Terminação NUL
+} // fim: copyBounded
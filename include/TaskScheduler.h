@@ -0,0 +1,103 @@
+/*
+    Arquivo: include/TaskScheduler.h
+    Propósito: Declara o TaskScheduler, escalonador cooperativo que substitui a
+    sequência fixa de chamadas do AppController::loop(). Cada passada
+    (runPass(), uma por loop()) tem um orçamento de tempo (SCHED_PASS_BUDGET_US):
+      - tarefas periódicas (primeiro plano) rodam quando vencem, em ordem de
+        prioridade (0 = mais alta); período 0 = toda passada. O prazo é o
+        próprio período (ou o orçamento da passada, com período 0);
+      - tarefas de fundo (restauração, coleta na LAN, snapshot) só rodam na
+        folga que sobra do orçamento, em fatias com limite de tempo informado
+        à função. A fatia só começa se a folga cobre o custo da última
+        execução; se a tarefa espera mais que maxWaitMs sem folga, roda assim
+        mesmo (execução forçada) para não morrer de fome.
+    Estouros (execução > orçamento da tarefa), prazos perdidos e tempos por
+    tarefa ficam em stats(); tudo sobre o Clock injetado (testável no host).
+    Implementação em src/TaskScheduler.cpp.
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <Arduino.h> // Tipos básicos
+#include <functional> // std::function (mesmo padrão dos callbacks do NetManager)
+#include "Clock.h" // Relógio injetável
+
+#ifndef SCHED_MAX_TASKS // Tarefas registráveis (vetor estático, sem alocação no loop)
+#define SCHED_MAX_TASKS 12 // O AppController registra até 10 (rfid, net, uplink, udp, mem, config, report, restore, lan, persist)
+#endif // fim: SCHED_MAX_TASKS default
+#ifndef SCHED_PASS_BUDGET_US // Orçamento de uma passada: limite desejado entre duas consultas ao leitor
+#define SCHED_PASS_BUDGET_US 20000 // 20 ms: consulta RFID com campo vazio em ~10 ms (RFID_RF_TIMEOUT_MS=10) + folga; com os 25 ms da biblioteca, ~35000
+#endif // fim: SCHED_PASS_BUDGET_US default
+
+// Callback de tarefa periódica
+typedef std::function<void()> SchedFn; // Executa um ciclo da tarefa
+// Callback de tarefa de fundo: recebe o tempo disponível (µs); devolve true se ainda há trabalho
+typedef std::function<bool(uint32_t budgetUs)> SchedSliceFn; // Uma fatia limitada
+
+// Métricas por tarefa
+struct SchedTaskStats { // Diagnóstico exposto por TaskScheduler::stats()
+    uint32_t runs; // Execuções (fatias, no fundo)
+    uint32_t overruns; // Execuções acima do orçamento da tarefa (ou da fatia concedida)
+    uint32_t misses; // Primeiro plano: término após o prazo; fundo: execuções forçadas sem folga
+    uint32_t lastUs; // Duração da última execução (µs)
+    uint32_t maxUs; // Maior duração (µs)
+    uint64_t totalUs; // Tempo total executando (µs)
+    uint32_t maxGapUs; // Maior intervalo entre dois inícios (µs): latência de atendimento
+}; // fim: struct SchedTaskStats
+
+// Métricas das passadas
+struct SchedPassStats { // Diagnóstico exposto por TaskScheduler::passStats()
+    uint32_t passes; // Passadas executadas
+    uint32_t overBudget; // Passadas acima de SCHED_PASS_BUDGET_US
+    uint32_t maxPassUs; // Passada mais longa (µs)
+    uint32_t slices; // Fatias de fundo executadas na folga
+    uint32_t forced; // Fatias de fundo forçadas (maxWaitMs vencido)
+}; // fim: struct SchedPassStats
+
+// Escalonador cooperativo com prazos, prioridades e fatias de fundo
+class TaskScheduler { // Início da definição da classe TaskScheduler
+public: // Seção pública: API exposta a outros módulos
+    explicit TaskScheduler(Clock &clock = defaultClock(), uint32_t passBudgetUs = SCHED_PASS_BUDGET_US); // Sem tarefas
+    // Tarefa periódica (vence já na primeira passada); budgetUs = 0 desliga a detecção de estouro. Devolve o id ou -1.
+    int8_t addPeriodic(const char *name, uint8_t priority, uint32_t periodMs, uint32_t budgetUs, SchedFn fn); // Primeiro plano
+    // Tarefa de fundo (começa com trabalho pendente); maxWaitMs = 0 nunca força. Devolve o id ou -1.
+    int8_t addBackground(const char *name, uint8_t priority, uint32_t sliceUs, uint32_t maxWaitMs, SchedSliceFn fn); // Folga
+    void runPass(); // Uma passada: periódicas vencidas por prioridade, depois fundo na folga
+    void setPeriod(int8_t id, uint32_t periodMs); // Novo período (vale a partir da próxima liberação)
+    void setEnabled(int8_t id, bool on); // Liga/desliga a tarefa (desligada não roda nem conta)
+    void wake(int8_t id); // Fundo: há trabalho novo (o prazo de espera conta a partir de agora)
+    uint8_t count() const { return _count; } // Tarefas registradas
+    const char *name(int8_t id) const { return _tasks[id].name; } // Nome da tarefa
+    bool background(int8_t id) const { return _tasks[id].bg; } // Tarefa de fundo?
+    uint32_t period(int8_t id) const { return _tasks[id].periodMs; } // Período atual (ms)
+    const SchedTaskStats &stats(int8_t id) const { return _tasks[id].st; } // Métricas da tarefa
+    const SchedPassStats &passStats() const { return _pass; } // Métricas das passadas
+    uint32_t passBudgetUs() const { return _budgetUs; } // Orçamento de uma passada (µs)
+    void resetStats(); // Zera métricas (tarefas e passadas)
+private: // Seção privada: estado interno
+    struct Task { // Tarefa registrada
+        const char *name; // Nome (literal)
+        SchedFn fn; // Primeiro plano
+        SchedSliceFn slice; // Fundo
+        uint8_t prio; // 0 = mais alta
+        bool bg; // Tarefa de fundo
+        bool enabled; // Participa das passadas
+        bool pending; // Fundo: há trabalho
+        bool started; // Já rodou (maxGapUs só a partir da segunda)
+        uint32_t periodMs; // Período (0 = toda passada)
+        uint32_t budgetUs; // Orçamento por execução / fatia (µs)
+        uint32_t maxWaitMs; // Fundo: espera máxima sem folga
+        uint32_t releaseMs; // Próxima liberação (periódica) ou início da espera (fundo)
+        uint32_t lastStartUs; // Início da última execução
+        SchedTaskStats st; // Métricas
+    }; // fim: struct Task
+
+    Clock &_clock; // Fonte de tempo
+    uint32_t _budgetUs; // Orçamento da passada
+    Task _tasks[SCHED_MAX_TASKS]; // Tarefas (id = posição de registro)
+    uint8_t _order[SCHED_MAX_TASKS]; // Ids por prioridade (estável: empate mantém a ordem de registro)
+    uint8_t _count; // Tarefas registradas
+    SchedPassStats _pass; // Métricas das passadas
+
+    int8_t add(const char *name, uint8_t priority); // Reserva e ordena uma tarefa
+    uint32_t account(Task &t, uint32_t startUs, uint32_t budgetUs); // Fecha a execução: duração, estouro, intervalo
+}; // Fim da classe TaskScheduler
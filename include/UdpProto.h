@@ -0,0 +1,215 @@
+/*
+    Arquivo: include/UdpProto.h
+    Propósito: Formato dos datagramas do uplink UDP (UdpUplink no firmware,
+    tools/collector no Linux). C++ puro e sem alocação, para que os dois lados
+    compilem exatamente o mesmo codificador. Inteiros em little-endian; todo
+    datagrama termina com os 8 primeiros bytes do HMAC-SHA256 (chave da frota)
+    sobre os bytes anteriores.
+
+      DATA (leitor -> coletor), até kMaxRecords registros consecutivos:
+        A7 | ver<<4|1 | idLen id | epoch u32 | low u32 | first u32 | sentMs u32 |
+        unixS u32 | count u8 | count x (uidLen u8, uid bytes, captureMs u32) | tag[8]
+      ACK (coletor -> leitor):
+        A7 | ver<<4|2 | idLen id | epoch u32 | cum u32 | n u8 |
+        n x (start u32, len u16) | tag[8]
+
+    Os registros de um DATA têm as sequências first, first+1, ... (sequências
+    do UidBuffer na época do boot). 'low' é a sequência mais antiga que o leitor
+    ainda guarda: abaixo dela nada será retransmitido (descarte por overflow),
+    então o coletor pode avançar o cursor. No ACK, 'cum' confirma tudo abaixo
+    dele e as faixas (SACK) confirmam registros recebidos acima do cursor.
+    unixS é o relógio de parede no envio (0 sem NTP): a hora da captura é
+    unixS*1000 - (sentMs - captureMs).
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <stddef.h> // size_t
+#include <stdint.h> // Tipos inteiros de largura fixa
+#include <string.h> // memcpy, memcmp, strlen
+#include "HmacSha256.h" // Etiqueta de autenticação
+
+namespace udpproto { // Formato do uplink UDP
+
+static const uint8_t kMagic = 0xA7; // Primeiro byte de todo datagrama
+static const uint8_t kVersion = 1; // Versão do formato (nibble alto do segundo byte)
+static const uint8_t kTypeData = 1; // Registros do leitor
+static const uint8_t kTypeAck = 2; // Confirmação do coletor
+static const size_t kTagBytes = 8; // HMAC truncado (64 bits)
+static const size_t kMaxDatagram = 1200; // Cabe em qualquer MTU sem fragmentar
+static const size_t kMaxIdLen = 32; // Maior DEVICE_ID aceito
+static const size_t kMaxUidBytes = 15; // UID binária (UidEntry guarda até 31 dígitos hex)
+static const uint8_t kMaxRecords = 48; // Registros por DATA (48 x 20 bytes cabem em kMaxDatagram)
+static const uint8_t kMaxRanges = 8; // Faixas SACK por ACK
+
+// Registro de um DATA (UID binária)
+struct Record { // Uma leitura
+    uint8_t uidLen; // Bytes válidos em uid (0: UID da fila não era hex)
+    uint8_t uid[kMaxUidBytes]; // UID
+    uint32_t captureMs; // millis() da captura no leitor
+}; // fim: struct Record
+
+// Cabeçalho de um DATA
+struct DataHeader { // Campos antes dos registros
+    char id[kMaxIdLen + 1]; // DEVICE_ID (terminado em NUL)
+    uint32_t epoch; // Época do boot (sequências recomeçam a cada reinício)
+    uint32_t low; // Sequência mais antiga ainda guardada pelo leitor
+    uint32_t first; // Sequência do primeiro registro
+    uint32_t sentMs; // millis() no envio
+    uint32_t unixS; // Relógio de parede no envio (0 = sem NTP)
+    uint8_t count; // Registros no datagrama
+}; // fim: struct DataHeader
+
+// Faixa confirmada seletivamente
+struct Range { uint32_t start; uint16_t len; }; // [start, start+len)
+
+// Cabeçalho de um ACK
+struct Ack { // Confirmação para um leitor/época
+    char id[kMaxIdLen + 1]; // DEVICE_ID (terminado em NUL)
+    uint32_t epoch; // Época confirmada
+    uint32_t cum; // Tudo com sequência < cum foi recebido
+    uint8_t nranges; // Faixas válidas em ranges
+    Range ranges[kMaxRanges]; // Recebidos acima de cum
+}; // fim: struct Ack
+
+// Escrita sequencial com limite (ok=false ao estourar)
+struct Writer { // Monta o datagrama em buf
+    uint8_t *buf; size_t cap; size_t len; bool ok; // Destino, capacidade, usado, sem estouro
+    Writer(uint8_t *b, size_t c) : buf(b), cap(c), len(0), ok(true) {} // Vazio
+    void u8(uint8_t v) { if (len + 1 > cap) { ok = false; return; } buf[len++] = v; } // 1 byte
+    void u16(uint16_t v) { u8((uint8_t)v); u8((uint8_t)(v >> 8)); } // LE
+    void u32(uint32_t v) { u16((uint16_t)v); u16((uint16_t)(v >> 16)); } // LE
+    void bytes(const void *p, size_t n) { if (len + n > cap) { ok = false; return; } memcpy(buf + len, p, n); len += n; } // Bloco
+}; // fim: struct Writer
+
+// Leitura sequencial com limite (ok=false ao faltar bytes)
+struct Reader { // Percorre um datagrama recebido
+    const uint8_t *buf; size_t len; size_t pos; bool ok; // Origem, tamanho, posição, sem falta
+    Reader(const uint8_t *b, size_t n) : buf(b), len(n), pos(0), ok(true) {} // Início
+    uint8_t u8() { if (pos + 1 > len) { ok = false; return 0; } return buf[pos++]; } // 1 byte
+    uint16_t u16() { uint16_t a = u8(); return (uint16_t)(a | (u8() << 8)); } // LE
+    uint32_t u32() { uint32_t a = u16(); return a | ((uint32_t)u16() << 16); } // LE
+    void bytes(void *p, size_t n) { if (pos + n > len) { ok = false; return; } memcpy(p, buf + pos, n); pos += n; } // Bloco
+}; // fim: struct Reader
+
+// tag(): primeiros kTagBytes do HMAC-SHA256 de msg
+inline void tag(const uint8_t *key, size_t keyLen, const uint8_t *msg, size_t n, uint8_t out[kTagBytes]) { // Início: tag()
+    uint8_t full[Sha256::kDigest]; // HMAC completo
+    hmacSha256(key, keyLen, msg, n, full); // Calcula
+    memcpy(out, full, kTagBytes); // Trunca
+} // fim: tag()
+
+// seal(): acrescenta a etiqueta; devolve o tamanho final (0 se não coube)
+inline size_t seal(Writer &w, const uint8_t *key, size_t keyLen) { // Início: seal()
+    if (!w.ok || w.len + kTagBytes > w.cap) return 0; // Estourou
+    tag(key, keyLen, w.buf, w.len, w.buf + w.len); // Etiqueta no fim
+    return w.len + kTagBytes; // Tamanho do datagrama
+} // fim: seal()
+
+// verify(): confere a etiqueta (comparação em tempo constante)
+inline bool verify(const uint8_t *key, size_t keyLen, const uint8_t *d, size_t n) { // Início: verify()
+    if (n < kTagBytes + 3) return false; // Curto demais
+    uint8_t t[kTagBytes]; // Etiqueta esperada
+    tag(key, keyLen, d, n - kTagBytes, t); // Recalcula
+    uint8_t diff = 0; // Sem desvio por byte (não vaza a posição do erro)
+    for (size_t i = 0; i < kTagBytes; ++i) diff |= (uint8_t)(t[i] ^ d[n - kTagBytes + i]); // Acumula
+    return diff == 0; // Autêntico
+} // fim: verify()
+
+// type(): tipo do datagrama (0 se magic/versão não conferem)
+inline uint8_t type(const uint8_t *d, size_t n) { // Início: type()
+    if (n < 2 || d[0] != kMagic || (d[1] >> 4) != kVersion) return 0; // Outro protocolo/versão
+    return d[1] & 0x0F; // Tipo
+} // fim: type()
+
+// hexToUid(): "04A1B2C3" -> bytes; false se não for hex de tamanho par
+inline bool hexToUid(const char *hex, Record &r) { // Início: hexToUid()
+    size_t n = strlen(hex); // Dígitos
+    if (n == 0 || (n & 1) || n / 2 > kMaxUidBytes) return false; // Tamanho inválido
+    for (size_t i = 0; i < n / 2; ++i) { // Cada byte
+        uint8_t v = 0; // Valor
+        for (int k = 0; k < 2; ++k) { // Dois dígitos
+            char c = hex[2 * i + k]; // Dígito
+            uint8_t d = (c >= '0' && c <= '9') ? c - '0' : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : 0xFF; // Valor do dígito
+            if (d == 0xFF) return false; // Não é hex
+            v = (uint8_t)(v << 4 | d); // Acumula
+        }
+        r.uid[i] = v; // Byte
+    }
+    r.uidLen = (uint8_t)(n / 2); // Tamanho
+    return true; // Convertido
+} // fim: hexToUid()
+
+// uidToHex(): bytes -> hex maiúsculo (mesmo formato do RfidReader); out precisa de 2*uidLen+1
+inline void uidToHex(const Record &r, char *out) { // Início: uidToHex()
+    static const char digits[] = "0123456789ABCDEF"; // Dígitos
+    for (size_t i = 0; i < r.uidLen; ++i) { out[2 * i] = digits[r.uid[i] >> 4]; out[2 * i + 1] = digits[r.uid[i] & 0x0F]; } // Cada byte
+    out[2 * r.uidLen] = '\0'; // Terminação
+} // fim: uidToHex()
+
+// writeId(): idLen + bytes do DEVICE_ID (truncado em kMaxIdLen)
+inline void writeId(Writer &w, const char *id) { // Início: writeId()
+    size_t n = strlen(id); if (n > kMaxIdLen) n = kMaxIdLen; // Limite
+    w.u8((uint8_t)n); w.bytes(id, n); // Comprimento + bytes
+} // fim: writeId()
+
+// readId(): lê idLen + bytes em out (NUL no fim)
+inline void readId(Reader &r, char out[kMaxIdLen + 1]) { // Início: readId()
+    uint8_t n = r.u8(); // Comprimento
+    if (n > kMaxIdLen) { r.ok = false; n = 0; } // Inválido
+    r.bytes(out, n); out[r.ok ? n : 0] = '\0'; // Bytes + NUL
+} // fim: readId()
+
+// beginData(): escreve o cabeçalho de um DATA com count=0; registros entram com addRecord()
+inline void beginData(Writer &w, const DataHeader &h) { // Início: beginData()
+    w.u8(kMagic); w.u8((uint8_t)(kVersion << 4 | kTypeData)); // Magic + versão/tipo
+    writeId(w, h.id); // Leitor
+    w.u32(h.epoch); w.u32(h.low); w.u32(h.first); w.u32(h.sentMs); w.u32(h.unixS); // Cursores e tempo
+    w.u8(0); // count (atualizado por addRecord)
+} // fim: beginData()
+
+// addRecord(): acrescenta um registro se couber (deixando espaço para a etiqueta); countPos = w.len antes do count
+inline bool addRecord(Writer &w, size_t countPos, const Record &r) { // Início: addRecord()
+    if (w.buf[countPos] >= kMaxRecords) return false; // Limite de registros
+    if (w.len + 1 + r.uidLen + 4 + kTagBytes > w.cap) return false; // Não cabe
+    w.u8(r.uidLen); w.bytes(r.uid, r.uidLen); w.u32(r.captureMs); // Registro
+    w.buf[countPos]++; // count
+    return w.ok; // Escrito
+} // fim: addRecord()
+
+// decodeData(): valida e lê o cabeçalho; recs recebe até kMaxRecords registros. A etiqueta é conferida antes (verify)
+inline bool decodeData(const uint8_t *d, size_t n, DataHeader &h, Record *recs) { // Início: decodeData()
+    if (type(d, n) != kTypeData || n < kTagBytes) return false; // Outro tipo
+    Reader r(d, n - kTagBytes); r.pos = 2; // Sem a etiqueta; após magic/tipo
+    readId(r, h.id); // Leitor
+    h.epoch = r.u32(); h.low = r.u32(); h.first = r.u32(); h.sentMs = r.u32(); h.unixS = r.u32(); // Cursores e tempo
+    h.count = r.u8(); // Registros
+    if (h.count > kMaxRecords) return false; // Inválido
+    for (uint8_t i = 0; i < h.count && r.ok; ++i) { // Cada registro
+        recs[i].uidLen = r.u8(); // Tamanho
+        if (recs[i].uidLen > kMaxUidBytes) return false; // Inválido (0 = UID que não era hex)
+        r.bytes(recs[i].uid, recs[i].uidLen); recs[i].captureMs = r.u32(); // UID + captura
+    }
+    return r.ok && r.pos == r.len; // Sem bytes faltando ou sobrando
+} // fim: decodeData()
+
+// encodeAck(): monta um ACK selado; devolve o tamanho (0 se não coube)
+inline size_t encodeAck(const Ack &a, const uint8_t *key, size_t keyLen, uint8_t *out, size_t cap) { // Início: encodeAck()
+    Writer w(out, cap); // Destino
+    w.u8(kMagic); w.u8((uint8_t)(kVersion << 4 | kTypeAck)); // Magic + versão/tipo
+    writeId(w, a.id); w.u32(a.epoch); w.u32(a.cum); // Leitor, época, cursor
+    uint8_t n = a.nranges > kMaxRanges ? kMaxRanges : a.nranges; // Limite
+    w.u8(n); for (uint8_t i = 0; i < n; ++i) { w.u32(a.ranges[i].start); w.u16(a.ranges[i].len); } // SACK
+    return seal(w, key, keyLen); // Etiqueta
+} // fim: encodeAck()
+
+// decodeAck(): lê um ACK (etiqueta conferida antes com verify)
+inline bool decodeAck(const uint8_t *d, size_t n, Ack &a) { // Início: decodeAck()
+    if (type(d, n) != kTypeAck || n < kTagBytes) return false; // Outro tipo
+    Reader r(d, n - kTagBytes); r.pos = 2; // Sem a etiqueta; após magic/tipo
+    readId(r, a.id); a.epoch = r.u32(); a.cum = r.u32(); a.nranges = r.u8(); // Cabeçalho
+    if (a.nranges > kMaxRanges) return false; // Inválido
+    for (uint8_t i = 0; i < a.nranges; ++i) { a.ranges[i].start = r.u32(); a.ranges[i].len = r.u16(); } // SACK
+    return r.ok && r.pos == r.len; // Sem bytes faltando ou sobrando
+} // fim: decodeAck()
+
+} // namespace udpproto
@@ -0,0 +1,129 @@
+/*
+    Arquivo: include/UdpUplink.h
+    Propósito: Declara o UdpUplink, transporte alternativo ao HttpSender para
+    pisos com centenas de leitores: em vez de um POST HTTPS por leitura, a fila
+    sobe em datagramas UDP compactos (UdpProto.h), autenticados por HMAC e com
+    até UDP_BATCH_MAX registros consecutivos cada. O coletor (tools/collector)
+    responde com ACK cumulativo + faixas seletivas; o leitor libera do UidBuffer
+    o que foi confirmado e retransmite só os datagramas sem confirmação após o
+    RTO (com backoff exponencial). Até UDP_WINDOW datagramas ficam em voo.
+    Nada é copiado para fora do UidBuffer: um datagrama é remontado a partir
+    das sequências a cada (re)envio, e o que sai da fila antes (overflow,
+    coleta na LAN) é recortado. A época muda a cada boot, como no LanPullServer.
+    Implementação em src/UdpUplink.cpp.
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <Arduino.h> // Tipos, random()
+#include <WiFi.h> // hostByName
+#include <WiFiUdp.h> // Socket UDP
+#include <functional> // std::function (callback de liberação)
+#include "UidBuffer.h" // Fila (sequências, getAt, release)
+#include "Clock.h" // Relógio injetável (RTO, espera do lote)
+#include "UdpProto.h" // Formato dos datagramas
+// Configuração: tenta usar include/ProjectConfig.h (local, ignorado no Git), ou fallback para include/ProjectConfig.example.h
+#if defined(__has_include)
+#  if __has_include("ProjectConfig.h")
+#    include "ProjectConfig.h" // Constantes de configuração definidas pelo usuário
+#  else
+#    include "ProjectConfig.example.h" // Fallback para CI/builds padrão
+#  endif
+#else
+#  include "ProjectConfig.h" // Constantes de configuração definidas pelo usuário
+#endif
+
+#ifndef UDP_UPLINK_ENABLE // Permite sobrescrever via build_flags
+#define UDP_UPLINK_ENABLE 0 // 0=fila sobe por HTTP; 1=datagramas ao coletor (exige UDP_COLLECTOR_HOST e UDP_HMAC_KEY)
+#endif // fim: UDP_UPLINK_ENABLE default
+#ifndef UDP_COLLECTOR_PORT // Porta do coletor
+#define UDP_COLLECTOR_PORT 47474 // Mesma do rfid_collector
+#endif // fim: UDP_COLLECTOR_PORT default
+#ifndef UDP_LOCAL_PORT // Porta local (destino dos ACKs)
+#define UDP_LOCAL_PORT 47475 // Fixa: facilita regras de firewall
+#endif // fim: UDP_LOCAL_PORT default
+#ifndef UDP_BATCH_MAX // Registros por datagrama
+#define UDP_BATCH_MAX 32 // ≤ udpproto::kMaxRecords (~700 bytes com UIDs de 7 bytes)
+#endif // fim: UDP_BATCH_MAX default
+#ifndef UDP_BATCH_LINGER_MS // Espera máxima para completar um lote
+#define UDP_BATCH_LINGER_MS 200 // Leitura isolada sai em até 200 ms
+#endif // fim: UDP_BATCH_LINGER_MS default
+#ifndef UDP_WINDOW // Datagramas em voo (sem ACK)
+#define UDP_WINDOW 4 // Até UDP_WINDOW x UDP_BATCH_MAX registros por RTT
+#endif // fim: UDP_WINDOW default
+#ifndef UDP_RTO_MS // Tempo até a primeira retransmissão
+#define UDP_RTO_MS 500 // Maior que o flush do coletor (ACK só após o repasse)
+#endif // fim: UDP_RTO_MS default
+#ifndef UDP_RTO_MAX_MS // Teto do backoff de retransmissão
+#define UDP_RTO_MAX_MS 8000 // Coletor fora do ar: um datagrama a cada 8 s por slot
+#endif // fim: UDP_RTO_MAX_MS default
+#ifndef UDP_TX_PER_LOOP // Datagramas (novos + retransmissões) por chamada de loop()
+#define UDP_TX_PER_LOOP 2 // Limita o tempo do loop (HMAC + cópia para o driver)
+#endif // fim: UDP_TX_PER_LOOP default
+#ifndef UDP_RX_PER_LOOP // ACKs lidos por chamada de loop()
+#define UDP_RX_PER_LOOP 4 // Restante fica no socket até o próximo loop
+#endif // fim: UDP_RX_PER_LOOP default
+#ifndef UDP_RESOLVE_RETRY_MS // Intervalo entre tentativas de resolver UDP_COLLECTOR_HOST
+#define UDP_RESOLVE_RETRY_MS 5000 // DNS falhou: tenta de novo depois
+#endif // fim: UDP_RESOLVE_RETRY_MS default
+
+// Métricas do uplink
+struct UdpUplinkStats { // Diagnóstico exposto por UdpUplink::stats()
+    uint32_t datagrams; // Datagramas enviados (inclui retransmissões)
+    uint32_t retransmits; // Retransmissões por RTO
+    uint32_t records; // Registros enviados pela primeira vez
+    uint32_t bytes; // Bytes enviados (carga UDP)
+    uint32_t acks; // ACKs aceitos
+    uint32_t released; // Itens liberados do UidBuffer por ACK
+    uint32_t rejected; // Datagramas recebidos e descartados (origem, etiqueta, época, cursor)
+    uint32_t lastRttMs; // RTT do último ACK de datagrama não retransmitido
+    uint32_t maxSliceUs; // Maior fatia de loop() (µs)
+    uint32_t resolveFails; // Falhas ao resolver UDP_COLLECTOR_HOST
+}; // fim: struct UdpUplinkStats
+
+// Uplink da fila em datagramas UDP com ACK seletivo
+class UdpUplink { // Início da definição da classe UdpUplink
+public: // Seção pública: API exposta a outros módulos
+    UdpUplink(UidBuffer &buffer, Clock &clock = defaultClock()); // Fila enviada e relógio
+    void begin(); // Sorteia a época deste boot (socket abre e o coletor é resolvido no primeiro link)
+    void loop(bool linkUp); // Lê ACKs, retransmite vencidos, envia lotes novos
+    void onRelease(std::function<void(size_t)> cb) { _onRelease = cb; } // Chamado após um ACK liberar itens
+    bool enabled() const { return UDP_UPLINK_ENABLE && _configured; } // Compilado e com coletor + chave definidos
+    size_t inFlight() const; // Datagramas aguardando ACK
+    uint32_t epoch() const { return _epoch; } // Época das sequências deste boot
+    const UdpUplinkStats &stats() const { return _stats; } // Métricas
+private: // Seção privada: estado interno
+    // Datagrama em voo: faixa de sequências e temporização
+    struct Flight { // Slot da janela
+        bool used; // Slot ocupado
+        uint32_t first; // Primeira sequência
+        uint8_t count; // Registros
+        uint8_t tries; // Envios (1 = original)
+        uint32_t sentMs; // Último envio
+        uint32_t rtoMs; // Espera atual até retransmitir
+    }; // fim: struct Flight
+
+    UidBuffer &_buffer; // Fila (sequências, getAt, release)
+    Clock &_clock; // Fonte de tempo
+    WiFiUDP _udp; // Socket
+    bool _configured; // UDP_COLLECTOR_HOST e UDP_HMAC_KEY definidos
+    bool _bound; // _udp.begin() já chamado
+    bool _resolved; // _collector válido
+    uint32_t _resolveAtMs; // Próxima tentativa de resolução
+    IPAddress _collector; // Endereço do coletor
+    uint32_t _epoch; // Época (muda a cada boot)
+    bool _primed; // _nextSeq já alinhado à fila (após a restauração)
+    uint32_t _nextSeq; // Próxima sequência ainda não enviada
+    bool _lingering; // Há registros esperando completar o lote
+    uint32_t _lingerStartMs; // Desde quando
+    Flight _flight[UDP_WINDOW]; // Janela
+    uint8_t _pkt[udpproto::kMaxDatagram]; // Datagrama (envio e recepção)
+    UdpUplinkStats _stats; // Métricas
+    std::function<void(size_t)> _onRelease; // Persistência após ACK
+
+    void receiveAcks(); // Lê até UDP_RX_PER_LOOP datagramas do coletor
+    void handleAck(const udpproto::Ack &a); // Libera a fila e os slots confirmados
+    void clip(); // Recorta _nextSeq e os slots ao que ainda está na fila
+    int sendDue(int budget); // Retransmite slots vencidos; devolve o orçamento restante
+    void sendNew(int budget); // Envia lotes novos (cheios ou com espera vencida)
+    bool transmit(Flight &f); // Monta o datagrama da faixa do slot e envia (count pode encolher)
+}; // Fim da classe UdpUplink
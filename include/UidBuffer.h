@@ -2,44 +2,99 @@
     Arquivo: include/UidBuffer.h
     Propósito: Define um buffer circular (ring buffer) estático para armazenar
     UIDs lidas do RFID junto com o timestamp (millis) de captura, evitando
-    alocações dinâmicas para maior robustez.
+    alocações dinâmicas para maior robustez. UID_BUFFER_CAPACITY dimensiona o
+    array; setLimit() reduz a capacidade efetiva em tempo de execução. Cada
+    item tem um número de sequência implícito (firstSeq() + índice), usado
+    como cursor pela coleta na LAN (LanPullServer) para liberar o que já saiu.
+    Com RFID_BLOCK_READ=1, cada item também guarda o conteúdo decodificado do
+    bloco do cartão (ex.: matrícula do funcionário; ver RfidReader.h).
 */
 #pragma once // Evita múltiplas inclusões do cabeçalho
 #include <Arduino.h> // Tipos básicos e String (usada em toJson)
-#include <cstring> // strncpy, memset
+#include "StrUtil.h" // copyBounded (cópia limitada com NUL)
 
 #ifndef UID_BUFFER_CAPACITY // Pode ser definido via build_flags em platformio.ini
 #define UID_BUFFER_CAPACITY 64 // Capacidade padrão do ring buffer
 #endif // UID_BUFFER_CAPACITY
 
+#ifndef RFID_BLOCK_READ // Leitura autenticada de um bloco do cartão (RfidReader)
+#define RFID_BLOCK_READ 0 // 0 = só a UID (item sem o campo data)
+#endif // fim: RFID_BLOCK_READ default
+#ifndef RFID_BLOCK_DATA_MAX // Caracteres do conteúdo decodificado por item, com o NUL
+#define RFID_BLOCK_DATA_MAX 17 // 16 bytes em ASCII ou decimal; hex de 16 bytes pede 33
+#endif // fim: RFID_BLOCK_DATA_MAX default
+
 // Estrutura fixa para armazenar UID + timestamp de captura.
 struct UidEntry { // Estrutura do item armazenado no buffer
     char uid[32]; // UID em hexadecimal (até 28 bytes típico, margem extra)
     uint32_t capture_ms; // millis() no momento da leitura
+#if RFID_BLOCK_READ // Só ocupa RAM com a leitura de bloco ligada
+    char data[RFID_BLOCK_DATA_MAX]; // Conteúdo decodificado do bloco ("" = não lido)
+#endif // fim: RFID_BLOCK_READ
 }; // Fim da struct UidEntry
 
+// Conteúdo do bloco de um item ("" sem RFID_BLOCK_READ ou quando a leitura falhou)
+inline const char *uidEntryData(const UidEntry &e) { // Evita #if em cada consumidor
+#if RFID_BLOCK_READ // Campo presente
+    return e.data; // Texto decodificado
+#else // Sem o campo
+    (void)e; // Sem uso
+    return ""; // Vazio
+#endif // fim: RFID_BLOCK_READ
+} // fim: uidEntryData()
+
 // Buffer circular estático sem alocação dinâmica.
 // Política de overwrite: quando cheio, descarta o elemento mais antigo abrindo espaço.
 class UidBuffer { // Início da definição da classe UidBuffer
 public: // Seção pública: API do buffer
     // Construtor: zera índices e tamanho inicial do buffer
-    UidBuffer() : _size(0), _head(0), _tail(0) {} // Inicializa membros com zero
+    UidBuffer() : _size(0), _head(0), _tail(0), _dropped(0), _limit(UID_BUFFER_CAPACITY), _firstSeq(0) {} // Inicializa membros com zero
 
-    // Enfileira uma entrada (UID + timestamp); sobrescreve o mais antigo se cheio
-    bool push(const char* uidHex, uint32_t captureMs) { // Insere elemento no head
+    // Capacidade efetiva (1..UID_BUFFER_CAPACITY); itens além dela são descartados no próximo push
+    void setLimit(size_t n) { // Chamado no boot com o valor do RuntimeConfig
+        if (n < 1) n = 1; // Mínimo de um item
+        if (n > UID_BUFFER_CAPACITY) n = UID_BUFFER_CAPACITY; // Máximo de compilação
+        _limit = n; // Aplica
+    } // fim: setLimit
+
+    // Enfileira uma entrada (UID + timestamp + conteúdo do bloco); sobrescreve o mais antigo se cheio
+    bool push(const char* uidHex, uint32_t captureMs, const char *data = nullptr) { // Insere elemento no head
         if (!uidHex || uidHex[0] == '\0') return false; // Rejeita UID nulo ou vazio
-        if (_size == UID_BUFFER_CAPACITY) { // Detecta buffer cheio
+        while (_size >= _limit) { // Detecta buffer cheio (capacidade efetiva)
             _tail = (_tail + 1) % UID_BUFFER_CAPACITY; // Avança tail para descartar o mais antigo
             _size--; // Ajusta tamanho após overwrite
+            _dropped++; // Contabiliza perda por overflow
+            _firstSeq++; // Sequência do mais antigo avança
         } // fim: tratamento de buffer cheio
-        strncpy(_data[_head].uid, uidHex, sizeof(_data[_head].uid) - 1); // Copia UID com limite
-        _data[_head].uid[sizeof(_data[_head].uid) - 1] = '\0'; // Garante terminação NUL
+        copyBounded(_data[_head].uid, sizeof(_data[_head].uid), uidHex); // Copia UID com limite
         _data[_head].capture_ms = captureMs; // Armazena timestamp de captura
+        setData(_data[_head], data); // Conteúdo do bloco (RFID_BLOCK_READ)
         _head = (_head + 1) % UID_BUFFER_CAPACITY; // Avança head circularmente
         _size++; // Incrementa contagem de itens válidos
         return true; // Indica sucesso
     } // fim: push
 
+    // Enfileira um lote (ex.: inventário de um ciclo de RF); retorna quantos entraram
+    size_t pushBatch(const UidEntry *items, size_t n) { // Mesma política de overwrite do push()
+        size_t ok = 0; // Itens aceitos
+        for (size_t i = 0; i < n; ++i) if (push(items[i].uid, items[i].capture_ms, uidEntryData(items[i]))) ok++; // Insere em ordem
+        return ok; // Total inserido
+    } // fim: pushBatch
+
+    // Insere antes do mais antigo (restauração incremental do snapshot, do fim para o início);
+    // com o buffer cheio recusa: o item seria o mais antigo, o primeiro a ser descartado
+    bool pushFront(const char* uidHex, uint32_t captureMs, const char *data = nullptr) { // Insere elemento antes do tail
+        if (!uidHex || uidHex[0] == '\0') return false; // Rejeita UID nulo ou vazio
+        if (_size >= _limit) return false; // Sem espaço (capacidade efetiva)
+        _tail = (_tail + UID_BUFFER_CAPACITY - 1) % UID_BUFFER_CAPACITY; // Recua tail circularmente
+        copyBounded(_data[_tail].uid, sizeof(_data[_tail].uid), uidHex); // Copia UID com limite
+        _data[_tail].capture_ms = captureMs; // Armazena timestamp de captura
+        setData(_data[_tail], data); // Conteúdo do bloco (RFID_BLOCK_READ)
+        _size++; // Incrementa contagem de itens válidos
+        _firstSeq--; // O novo mais antigo tem a sequência anterior
+        return true; // Indica sucesso
+    } // fim: pushFront
+
     // Lê o elemento mais antigo sem remover
     bool peek(UidEntry &out) const { // Leitura não-destrutiva do tail
         if (_size == 0) return false; // Falha se vazio
@@ -53,18 +108,37 @@ public: // Seção pública: API do buffer
         out = _data[_tail]; // Copia elemento mais antigo
         _tail = (_tail + 1) % UID_BUFFER_CAPACITY; // Avança tail circularmente
         _size--; // Decrementa contagem
+        _firstSeq++; // Sequência do mais antigo avança
         return true; // Sucesso
     } // fim: pop
 
+    // Remove os itens com sequência < cursor (confirmados por um coletor); retorna quantos saíram
+    size_t release(uint32_t cursor) { // Cursor antes de firstSeq() não remove nada
+        size_t n = 0; // Itens removidos
+        UidEntry e; // Descartado
+        while (_size > 0 && (int32_t)(cursor - _firstSeq) > 0 && pop(e)) n++; // Seguro no wrap de 32 bits
+        return n; // Total liberado
+    } // fim: release
+
     // Verdadeiro se o buffer não contém elementos
     bool isEmpty() const { return _size == 0; } // Checa se tamanho é zero
 
     // Quantidade de elementos atualmente armazenados
     size_t size() const { return _size; } // Retorna tamanho atual
 
+    // Itens descartados por overflow desde a construção
+    uint32_t dropped() const { return _dropped; } // Contador de perdas
+
     // Capacidade máxima configurada em tempo de compilação
     size_t capacity() const { return UID_BUFFER_CAPACITY; } // Retorna capacidade
 
+    // Sequência do item mais antigo (avança a cada pop/descarte; o i-ésimo item tem firstSeq() + i)
+    uint32_t firstSeq() const { return _firstSeq; } // Cursor inicial da coleta
+    uint32_t endSeq() const { return _firstSeq + (uint32_t)_size; } // Sequência do próximo push
+
+    // Capacidade efetiva (≤ capacity())
+    size_t limit() const { return _limit; } // Retorna limite atual
+
     // Acessa elemento pelo índice relativo ao mais antigo (0 = elemento em _tail)
     bool getAt(size_t indexFromOldest, UidEntry &out) const { // Acesso relativo ao tail
         if (indexFromOldest >= _size) return false; // Fora do intervalo
@@ -77,13 +151,29 @@ public: // Seção pública: API do buffer
     String toJson(const UidEntry &e) const { // Monta JSON minimalista
         String s = "{"; // Abre objeto JSON
         s += "\"uid\":\""; s += e.uid; s += "\","; // Campo uid (com aspas ao redor do valor)
-        s += "\"capture_timestamp_ms\":"; s += e.capture_ms; s += '}'; // Campo timestamp e fecha objeto
+        s += "\"capture_timestamp_ms\":"; s += e.capture_ms; // Campo timestamp
+#if RFID_BLOCK_READ // Conteúdo do bloco (já sem aspas/barras: ver RfidReader::decodeBlock)
+        s += ",\"card_data\":\""; s += e.data; s += '"'; // Campo card_data
+#endif // fim: RFID_BLOCK_READ
+        s += '}'; // Fecha objeto
         return s; // Retorna JSON gerado
     } // fim: toJson
 
 private: // Seção privada: armazenamento e índices
+    // Copia o conteúdo do bloco para o item (nullptr = vazio); no-op sem RFID_BLOCK_READ
+    static void setData(UidEntry &e, const char *data) { // Início: setData
+#if RFID_BLOCK_READ // Campo presente
+        copyBounded(e.data, sizeof(e.data), data ? data : ""); // Copia com limite
+#else // Sem o campo
+        (void)e; (void)data; // Sem uso
+#endif // fim: RFID_BLOCK_READ
+    } // fim: setData
+
     UidEntry _data[UID_BUFFER_CAPACITY]; // Área estática de armazenamento
     size_t _size; // Número de elementos válidos
     size_t _head; // Próxima posição de escrita (incrementa circularmente)
     size_t _tail; // Próxima posição de leitura (elemento mais antigo)
+    uint32_t _dropped; // Itens sobrescritos por overflow
+    size_t _limit; // Capacidade efetiva (≤ UID_BUFFER_CAPACITY)
+    uint32_t _firstSeq; // Sequência do item em _tail (reinicia no boot)
 }; // Fim da classe UidBuffer
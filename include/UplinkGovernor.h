@@ -0,0 +1,110 @@
+/*
+    Arquivo: include/UplinkGovernor.h
+    Propósito: Declara o UplinkGovernor, que decide quando o AppController pode
+    fazer o próximo POST (leitura ou resumo). Evita que centenas de leitores
+    martelem o backend em sincronia quando ele volta de um incidente:
+      - balde de fichas (up_rate_pm fichas/min, rajada up_burst) por leitor;
+      - ritmo ditado pelo servidor: Retry-After (segundos ou data HTTP) e
+        RateLimit-Remaining/RateLimit-Reset, com um acréscimo aleatório para
+        a frota não voltar toda no mesmo instante;
+      - backoff com jitter descorrelacionado entre falhas
+        (espera = min(teto, aleatório[base, 3 × espera anterior]));
+      - disjuntor: após UPLINK_BREAKER_FAILS falhas seguidas do servidor
+        (transporte, 5xx, 429 sem Retry-After) pausa os envios por
+        UPLINK_BREAKER_OPEN_MS (dobrando a cada sonda que falha) e então
+        libera um único POST de sonda. Com Retry-After, manda o servidor.
+    Lógica pura sobre o Clock, sem rede. Implementação em src/UplinkGovernor.cpp.
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <Arduino.h> // Tipos, random()
+#include <time.h> // time_t (Retry-After em data HTTP)
+#include "Clock.h" // Relógio injetável
+
+#ifndef UPLINK_GOVERNOR // Liga o governador do envio HTTP
+#define UPLINK_GOVERNOR 1 // 0 = comportamento anterior (tentativa a cada drain_ms)
+#endif // fim: UPLINK_GOVERNOR default
+#ifndef UPLINK_RATE_PER_MIN // Padrão de up_rate_pm (ajustável em tempo de execução)
+#define UPLINK_RATE_PER_MIN 600 // Fichas por minuto (600 = a cadência padrão de drain_ms); 0 = sem limite
+#endif // fim: UPLINK_RATE_PER_MIN default
+#ifndef UPLINK_BURST // Padrão de up_burst
+#define UPLINK_BURST 10 // Fichas acumuladas no máximo (rajada após um período ocioso)
+#endif // fim: UPLINK_BURST default
+#ifndef UPLINK_BACKOFF_BASE_MS // Menor espera após uma falha
+#define UPLINK_BACKOFF_BASE_MS 1000 // ms
+#endif // fim: UPLINK_BACKOFF_BASE_MS default
+#ifndef UPLINK_BACKOFF_CAP_MS // Teto do backoff com jitter
+#define UPLINK_BACKOFF_CAP_MS 60000UL // 1 min
+#endif // fim: UPLINK_BACKOFF_CAP_MS default
+#ifndef UPLINK_BREAKER_FAILS // Falhas seguidas que abrem o disjuntor
+#define UPLINK_BREAKER_FAILS 5 // 0 = sem disjuntor
+#endif // fim: UPLINK_BREAKER_FAILS default
+#ifndef UPLINK_BREAKER_OPEN_MS // Pausa ao abrir o disjuntor (dobra a cada sonda que falha)
+#define UPLINK_BREAKER_OPEN_MS 30000UL // 30 s
+#endif // fim: UPLINK_BREAKER_OPEN_MS default
+#ifndef UPLINK_BREAKER_MAX_MS // Teto da pausa do disjuntor
+#define UPLINK_BREAKER_MAX_MS 60000UL // 1 min
+#endif // fim: UPLINK_BREAKER_MAX_MS default
+#ifndef UPLINK_HOLD_SPREAD_PCT // Acréscimo aleatório sobre Retry-After/RateLimit-Reset e a pausa do disjuntor
+#define UPLINK_HOLD_SPREAD_PCT 25 // Espera × (1 + aleatório[0, 25%]): espalha a volta da frota
+#endif // fim: UPLINK_HOLD_SPREAD_PCT default
+#ifndef UPLINK_RETRY_AFTER_MAX_MS // Maior Retry-After respeitado (protege contra valores absurdos)
+#define UPLINK_RETRY_AFTER_MAX_MS 3600000UL // 1 h
+#endif // fim: UPLINK_RETRY_AFTER_MAX_MS default
+
+// Resultado de um POST visto pelo governador (preenchido pelo HttpSender)
+struct UplinkResponse { // Código + cabeçalhos de ritmo
+    int code; // Código HTTP (<= 0: erro de transporte)
+    int32_t retryAfterMs; // Retry-After em ms (-1 se ausente ou inválido)
+    int32_t limitRemaining; // RateLimit-Remaining (-1 se ausente)
+    int32_t limitResetMs; // RateLimit-Reset em ms (-1 se ausente)
+}; // fim: struct UplinkResponse
+
+// Estado do disjuntor
+enum class BreakerState : uint8_t { CLOSED, OPEN, HALF_OPEN }; // Normal, pausado, sonda liberada
+
+// Métricas do governador
+struct UplinkGovernorStats { // Diagnóstico exposto por UplinkGovernor::stats()
+    uint32_t allowed; // POSTs liberados
+    uint32_t throttled; // Adiados por falta de ficha
+    uint32_t held; // Adiados por espera (backoff, servidor ou disjuntor)
+    uint32_t failures; // POSTs sem 2xx
+    uint32_t serverHolds; // Esperas pedidas pelo servidor (Retry-After / RateLimit)
+    uint32_t breakerTrips; // Aberturas do disjuntor
+    uint32_t lastWaitMs; // Última espera imposta após um POST
+}; // fim: struct UplinkGovernorStats
+
+// Governador do envio HTTP (balde de fichas + ritmo do servidor + backoff + disjuntor)
+class UplinkGovernor { // Início da definição da classe UplinkGovernor
+public: // Seção pública: API exposta a outros módulos
+    explicit UplinkGovernor(Clock &clock = defaultClock()); // Balde cheio, disjuntor fechado
+    void setRate(uint32_t perMin, uint16_t burst); // up_rate_pm / up_burst (0 = sem limite)
+    bool allow(); // true: pode enviar agora (consome uma ficha); false: aguardar
+    void onResult(const UplinkResponse &r); // Resultado do POST liberado por allow()
+    uint32_t waitMs(); // Tempo até a próxima liberação possível (0 = agora)
+    BreakerState breaker() const { return _breaker; } // Estado do disjuntor
+    uint16_t consecutiveFailures() const { return _fails; } // Falhas seguidas
+    const UplinkGovernorStats &stats() const { return _stats; } // Métricas
+
+    // Retry-After: segundos ("120") ou data HTTP ("Sun, 06 Nov 1994 08:49:37 GMT", exige nowUnix válido).
+    // Devolve ms (limitado a UPLINK_RETRY_AFTER_MAX_MS) ou -1 se vazio/inválido.
+    static int32_t parseRetryAfter(const char *v, time_t nowUnix); // Usado pelo HttpSender
+private: // Seção privada: estado interno
+    static const uint32_t kUnit = 60000; // Unidades por ficha: recarga exata de 'rate' unidades por ms (rate fichas/min)
+    Clock &_clock; // Fonte de tempo
+    uint32_t _ratePerMin; // Fichas por minuto (0 = sem limite)
+    uint32_t _capacity; // Capacidade do balde (1 ficha = kUnit)
+    uint32_t _credit; // Fichas disponíveis (1 ficha = kUnit)
+    uint32_t _refillMs; // Última recarga
+    bool _hold; // Há espera em curso (backoff, servidor ou disjuntor)
+    uint32_t _notBeforeMs; // Fim da espera em curso
+    uint32_t _sleepMs; // Última espera do backoff descorrelacionado
+    uint32_t _openMs; // Pausa atual do disjuntor
+    uint16_t _fails; // Falhas seguidas do servidor
+    BreakerState _breaker; // Estado do disjuntor
+    UplinkGovernorStats _stats; // Métricas
+
+    void refill(uint32_t now); // Recarga proporcional ao tempo decorrido
+    void holdUntil(uint32_t now, uint32_t ms); // Adia o próximo POST (nunca encurta uma espera maior)
+    static uint32_t spread(uint32_t ms); // ms × (1 + aleatório[0, UPLINK_HOLD_SPREAD_PCT])
+}; // Fim da classe UplinkGovernor
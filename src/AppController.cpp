@@ -22,23 +22,51 @@
 #define STATUS_LED_PIN -1 // Pino de LED opcional; -1 indica desativado
 #endif // fim: STATUS_LED_PIN default
 
-#ifndef QUEUE_DRAIN_INTERVAL_MS // Se não definido externamente
-#define QUEUE_DRAIN_INTERVAL_MS 100 // Cadência mínima entre tentativas de envio (ms)
-#endif // fim: QUEUE_DRAIN_INTERVAL_MS default
+#ifndef SCHED_RFID_BUDGET_US // Orçamento da tarefa "rfid" (acima dele conta estouro)
+#define SCHED_RFID_BUDGET_US 50000 // Consulta com campo vazio ~25 ms (ou RFID_RF_TIMEOUT_MS); cada cartão ~30 ms de RF
+#endif // fim: SCHED_RFID_BUDGET_US default
+#ifndef SCHED_IO_BUDGET_US // Orçamento das tarefas com sessão HTTP bloqueante ("uplink", "config")
+#define SCHED_IO_BUDGET_US 500000 // Um POST/GET TLS na LAN leva ~100-300 ms
+#endif // fim: SCHED_IO_BUDGET_US default
+#ifndef SCHED_SERVICE_PERIOD_MS // Período das tarefas de manutenção ("mem", "config"; cada uma tem agenda própria)
+#define SCHED_SERVICE_PERIOD_MS 100 // ms
+#endif // fim: SCHED_SERVICE_PERIOD_MS default
+#ifndef SCHED_SLICE_US // Fatia nominal das tarefas de fundo
+#define SCHED_SLICE_US 5000 // µs
+#endif // fim: SCHED_SLICE_US default
+#ifndef SCHED_BG_MAX_WAIT_MS // Espera máxima sem folga de "restore" e "lan" antes de uma fatia forçada
+#define SCHED_BG_MAX_WAIT_MS 200 // ms
+#endif // fim: SCHED_BG_MAX_WAIT_MS default
+#ifndef SCHED_PERSIST_MAX_WAIT_MS // Atraso máximo do snapshot na NVS após uma mudança da fila (coalescimento)
+#define SCHED_PERSIST_MAX_WAIT_MS 0 // 0 = grava logo após a mudança (o cartão acabou de sair do campo); > 0 = coalescido na tarefa "persist"
+#endif // fim: SCHED_PERSIST_MAX_WAIT_MS default
+#ifndef SCHED_REPORT_INTERVAL_MS // Relatório periódico das métricas por tarefa
+#define SCHED_REPORT_INTERVAL_MS 300000UL // 5 min; 0 = desligado
+#endif // fim: SCHED_REPORT_INTERVAL_MS default
 
 // Construtor: inicializa subcomponentes e estado interno padrão
-AppController::AppController() // Construtor da classe AppController
-    : _rfid(PIN_SDA, PIN_RST), // Inicializa o leitor MFRC522 com pinos do config.h
-        _net(2000, 30000), // NetManager com backoff: base 2s, máximo 30s
-        _http(HTTP_TIMEOUT_MS), // HttpSender com timeout configurável
+AppController::AppController(Clock &clock) // Construtor da classe AppController
+    : _clock(clock), // Relógio injetado (compartilhado com os subcomponentes)
+        _cfg(clock), // Parâmetros nos padrões de compilação até begin()
+        _lan(_buffer, clock), // Coleta na LAN sobre o mesmo buffer
+        _agg(clock), // Agregação desligada até applyConfig()
+        _udp(_buffer, clock), // Uplink UDP sobre o mesmo buffer
+        _rfid(PIN_SDA, PIN_RST, clock), // Inicializa o leitor MFRC522 com pinos do config.h
+        _net(2000, 30000, clock), // NetManager com backoff: base 2s, máximo 30s
+        _http(HTTP_TIMEOUT_MS, clock), // HttpSender com timeout configurável
+        _gov(clock), // Balde cheio, disjuntor fechado
         _state(State::INIT), // Começa em INIT para decidir o próximo estado
-        _lastQueueAttempt(0), // Zera controle de cadência do envio
-        _timeInitialized(false) {} // NTP ainda não inicializado
+        _timeInitialized(false), // NTP ainda não inicializado
+        _snapshotPending(false), // Nenhum snapshot devido
+        _sched(clock), // Tarefas registradas em begin()
+        _tUplink(-1), // Id da tarefa "uplink" (registerTasks())
+        _tPersist(-1) {} // Id da tarefa "persist" (-1 = sem coalescimento do snapshot)
 
-// begin(): chamada uma vez no boot para preparar todos os serviços
+// begin(): chamada uma vez no boot; o leitor sobe primeiro e o backlog volta aos poucos no loop()
 void AppController::begin() { // Inicializa os subsistemas e o estado inicial
+    _boot.start(_clock); // Origem das marcas de fase
     Serial.begin(115200); // Inicializa porta serial para logs e debug
-    delay(50); // Pequeno atraso para estabilizar a serial
+    if (BOOT_SERIAL_SETTLE_MS) _clock.delayMs(BOOT_SERIAL_SETTLE_MS); // Espera opcional (monitores USB‑CDC)
     Serial.println(); // Linha em branco para separar boots
     LOG_INFO("ESP32 RFID Logger iniciando..."); // Mensagem de início
 
@@ -47,13 +75,28 @@ void AppController::begin() { // Inicializa os subsistemas e o estado inicial
         digitalWrite(STATUS_LED_PIN, LOW); // Indica estado inicial (desconectado)
     }
 
+    _rfid.begin(); // Inicializa o leitor MFRC522 (SPI + PCD_Init) antes de NVS e rede
+    _boot.mark(BOOT_RFID_READY); // Leitor pronto
+
+    _mem.begin(); // Registra tasks e tira a primeira amostra do heap
+
+    _cfg.begin(); // Carrega parâmetros ajustáveis da NVS (padrões de compilação se ausentes)
+    _buffer.setLimit(_cfg.bufferCapacity()); // Capacidade efetiva (antes de restaurar o snapshot)
+    applyConfig(RuntimeConfig::liveMask()); // Repassa todos os parâmetros ao vivo aos componentes
+    _boot.mark(BOOT_CONFIG); // Configuração efetiva
+
     _persist.begin(); // Abre namespace no NVS para persistência
-    if (PERSIST_BUFFER) { // Se persistência ativada via flag
-        _persist.load(_buffer); // Recupera snapshot anterior do buffer
-        LOG_INFO("Buffer restaurado: %u entradas", (unsigned)_buffer.size());
-    } // fim: restauração condicional do buffer persistido
+    uint32_t saved = _persist.beginRestore(); // Só a contagem; as entradas vêm em serviceRestore()
+    if (saved) LOG_INFO("Snapshot: %u entradas a restaurar", (unsigned)saved); // Diagnóstico
 
-    _rfid.begin(); // Inicializa o leitor MFRC522 (SPI + PCD_Init)
+    if (LAN_PULL_ENABLE) { // Coleta na LAN habilitada
+        _lan.onRelease([this](size_t) { persistSnapshot(); }); // Itens liberados por ack saem também da NVS
+        _lan.begin(); // Época deste boot (socket abre com o primeiro link)
+    }
+    if (UDP_UPLINK_ENABLE) { // Fila sobe em datagramas ao coletor
+        _udp.onRelease([this](size_t) { persistSnapshot(); }); // Itens confirmados saem também da NVS
+        _udp.begin(); // Época deste boot (socket abre com o primeiro link)
+    }
 
     // Registra callback chamado quando a rede conecta pela primeira vez
     _net.onConnect([this]() { // Registra lambda chamada quando conectar Wi‑Fi
@@ -61,45 +104,251 @@ void AppController::begin() { // Inicializa os subsistemas e o estado inicial
             configTime(0, 0, "pool.ntp.org", "time.nist.gov"); // NTP servidores
             _timeInitialized = true; // Marca NTP configurado
         } // fim: configuração única de NTP
+        if (_boot.mark(BOOT_LINK_UP)) LOG_INFO("Boot: Wi-Fi conectado %lu ms apos begin()", (unsigned long)_boot.at(BOOT_LINK_UP)); // Primeira conexão
         if (STATUS_LED_PIN >= 0) digitalWrite(STATUS_LED_PIN, HIGH); // LED ON indica conectado
     }); // fim: callback onConnect
 
-    _net.begin(); // Inicia o Wi‑Fi (modo STA) e primeira tentativa de conexão
+    _net.begin(); // Inicia o Wi‑Fi (modo STA) e primeira tentativa de conexão (assíncrona)
+    _boot.mark(BOOT_NET_STARTED); // Associação segue em paralelo com a restauração
     _state = _net.isConnected() ? State::IDLE : State::CONNECTING; // Decide estado inicial
+    if (!PERSIST_RESTORE_BATCH || !_persist.restoring()) serviceRestore(SIZE_MAX); // Síncrona (tudo antes do loop) ou nada a restaurar
+    registerTasks(); // O loop() passa a ser conduzido pelo escalonador
+    _boot.mark(BOOT_LOOP); // Leitor passa a ser atendido pelo loop()
+    if (_boot.has(BOOT_RESTORED)) logBootProfile(); // Restauração já concluída
 } // fim: begin()
 
+// serviceRestore(): traz mais até maxItems entradas do snapshot; ao terminar, registra o boot
+void AppController::serviceRestore(size_t maxItems) { // Início: serviceRestore()
+    if (_boot.has(BOOT_RESTORED)) return; // Já concluída
+    uint32_t t0 = _clock.nowUs(); // Custo do passo no loop
+    size_t n; // Entradas restauradas neste passo
+    { // Escopo instrumentado: leituras da NVS
+        MemScope scope(MemSite::PERSIST_LOAD); // Contabiliza alocações da restauração
+        n = _persist.restoreStep(_buffer, maxItems); // Um trecho (ou tudo)
+    }
+    _boot.addRestoreStep(_clock.nowUs() - t0, (uint32_t)n); // Métricas
+    if (_persist.restoring()) return; // Continua no próximo loop
+    _boot.mark(BOOT_RESTORED); // Backlog completo no buffer
+    LOG_INFO("Buffer restaurado: %u entradas (%lu us em NVS, maior passo %lu us)", (unsigned)_boot.restored(), // Diagnóstico
+             (unsigned long)_boot.restoreUs(), (unsigned long)_boot.restoreMaxStepUs()); // ...
+    if (_snapshotPending) persistSnapshot(); // Leituras feitas durante a restauração
+    if (_boot.has(BOOT_LOOP)) logBootProfile(); // Restauração incremental: boot concluído agora
+} // fim: serviceRestore()
+
+// serviceRestoreSlice(): um trecho dimensionado pela fatia (custo médio por entrada até aqui), no máximo PERSIST_RESTORE_BATCH
+bool AppController::serviceRestoreSlice(uint32_t budgetUs) { // Início: serviceRestoreSlice()
+    uint32_t perEntry = _boot.restored() ? _boot.restoreUs() / _boot.restored() : 0; // µs por entrada (0 = ainda sem medida)
+    size_t n = perEntry ? budgetUs / perEntry : 1; // Entradas que cabem (a primeira fatia mede com uma)
+    if (n == 0) n = 1; // Ao menos uma: a restauração sempre avança
+    if (PERSIST_RESTORE_BATCH && n > PERSIST_RESTORE_BATCH) n = PERSIST_RESTORE_BATCH; // Teto por passo
+    serviceRestore(n); // Um trecho
+    return !_boot.has(BOOT_RESTORED); // Dorme ao concluir
+} // fim: serviceRestoreSlice()
+
+// serviceLanSlice(): chamadas a LanPullServer::loop() enquanto o stream avança e a próxima cabe na fatia
+bool AppController::serviceLanSlice(uint32_t budgetUs) { // Início: serviceLanSlice()
+    if (_persist.restoring()) return true; // Após a restauração: cursores estáveis
+    uint32_t t0 = _clock.nowUs(); // Início da fatia
+    uint32_t step; // Custo da última chamada
+    do { // Ao menos uma chamada (aceita cliente, lê requisição)
+        uint32_t bytes = _lan.stats().bytes; // Progresso antes
+        uint32_t s = _clock.nowUs(); // Início da chamada
+        _lan.loop(_net.isConnected()); // Até LAN_PULL_CHUNKS_PER_LOOP chunks
+        step = _clock.nowUs() - s; // Custo
+        if (_lan.stats().bytes == bytes) break; // Sem progresso (aguardando o cliente): não insiste
+    } while (_lan.busy() && _clock.nowUs() - t0 + step <= budgetUs); // Próxima chamada cabe?
+    return true; // Sempre atento a novas conexões
+} // fim: serviceLanSlice()
+
+// registerTasks(): consulta ao leitor em toda passada; manutenção periódica; trabalho pesado na folga
+void AppController::registerTasks() { // Início: registerTasks()
+    _sched.addPeriodic("rfid", 0, 0, SCHED_RFID_BUDGET_US, [this]() { // Maior prioridade, toda passada
+        _agg.loop(); // Fecha a janela de agregação vencida (antes de contar novas leituras)
+        serviceRfid(); // Lê RFID com prioridade para não perder eventos
+    });
+    _sched.addPeriodic("net", 1, 0, SCHED_SLICE_US, [this]() { _net.loop(); }); // Reconexão Wi‑Fi com backoff
+    _tUplink = _sched.addPeriodic("uplink", 2, _cfg.drainIntervalMs(), SCHED_IO_BUDGET_US, [this]() { serviceUplink(); }); // FSM + um envio
+    if (_udp.enabled()) _sched.addPeriodic("udp", 3, 0, SCHED_SLICE_US, [this]() { // Janela de datagramas
+        if (_persist.restoring() || _agg.enabled() || _lan.active()) return; // Pausado durante a restauração, a agregação e a coleta na LAN
+        uint32_t fails = _udp.stats().resolveFails; // Falhas de DNS até aqui
+        _udp.loop(_net.isConnected()); // Janela de datagramas
+        if (_udp.stats().resolveFails != fails) _net.reportTransportFailure(); // DNS sem resposta: lease reaproveitado suspeito
+    });
+    _sched.addPeriodic("mem", 4, SCHED_SERVICE_PERIOD_MS, SCHED_SLICE_US, [this]() { _mem.loop(_clock.nowMs()); }); // Heap/pilhas e saúde
+    _sched.addPeriodic("config", 5, SCHED_SERVICE_PERIOD_MS, SCHED_IO_BUDGET_US, [this]() { serviceConfig(); }); // Configuração remota
+    if (SCHED_REPORT_INTERVAL_MS) _sched.addPeriodic("report", 6, SCHED_REPORT_INTERVAL_MS, 0, [this]() { logSchedStats(); logBlockStats(); }); // Métricas
+    if (!_boot.has(BOOT_RESTORED)) // Restauração incremental em curso
+        _sched.addBackground("restore", 0, SCHED_SLICE_US, SCHED_BG_MAX_WAIT_MS, [this](uint32_t us) { return serviceRestoreSlice(us); }); // Backlog da NVS
+    if (LAN_PULL_ENABLE) _sched.addBackground("lan", 1, SCHED_SLICE_US, SCHED_BG_MAX_WAIT_MS, [this](uint32_t us) { return serviceLanSlice(us); }); // Coleta na LAN
+    if (PERSIST_BUFFER && SCHED_PERSIST_MAX_WAIT_MS) _tPersist = _sched.addBackground("persist", 2, SCHED_SLICE_US, SCHED_PERSIST_MAX_WAIT_MS, [this](uint32_t) { // Snapshot coalescido
+        if (_snapshotPending && !_persist.restoring()) writeSnapshot(); // Ininterrompível: roda na folga ou ao vencer a espera
+        return false; // Dorme até o próximo persistSnapshot()
+    });
+} // fim: registerTasks()
+
+// logSchedStats(): uma linha por tarefa (execuções, tempo médio/máximo, maior intervalo, estouros, prazos)
+void AppController::logSchedStats() { // Início: logSchedStats()
+    const SchedPassStats &p = _sched.passStats(); // Passadas
+    LOG_INFO("Sched: %lu passadas, max %lu us, %lu acima de %lu us, fundo %lu fatias (%lu forcadas)", (unsigned long)p.passes, // ...
+             (unsigned long)p.maxPassUs, (unsigned long)p.overBudget, (unsigned long)_sched.passBudgetUs(), (unsigned long)p.slices, (unsigned long)p.forced); // ...
+    for (uint8_t i = 0; i < _sched.count(); ++i) { // Cada tarefa
+        const SchedTaskStats &t = _sched.stats(i); // Métricas
+        LOG_INFO("Sched: %-8s n=%lu med=%lu max=%lu us intervalo<=%lu us estouros=%lu prazos=%lu", _sched.name(i), (unsigned long)t.runs, // ...
+                 (unsigned long)(t.runs ? t.totalUs / t.runs : 0), (unsigned long)t.maxUs, (unsigned long)t.maxGapUs, // ...
+                 (unsigned long)t.overruns, (unsigned long)t.misses); // ...
+    }
+} // fim: logSchedStats()
+
+// logBlockStats(): acertos do cache e latência da leitura de bloco (RFID_BLOCK_READ)
+void AppController::logBlockStats() { // Início: logBlockStats()
+#if RFID_BLOCK_READ // Só com a leitura de bloco
+    const RfidBlockStats &b = _rfid.blockStats(); // Métricas
+    LOG_INFO("Bloco: %lu cartoes, cache %lu%% (%lu), leituras %lu med %lu max %lu us, falhas %lu, auth recusadas %lu, re-selecoes %lu", // ...
+             (unsigned long)b.lookups, (unsigned long)b.hitRatePct(), (unsigned long)b.hits, (unsigned long)b.reads, // ...
+             (unsigned long)b.avgReadUs(), (unsigned long)b.maxReadUs, (unsigned long)b.failures, (unsigned long)b.authFails, // ...
+             (unsigned long)b.retries); // ...
+#endif // fim: RFID_BLOCK_READ
+} // fim: logBlockStats()
+
+// logBootProfile(): uma linha com as fases do boot (ms desde begin())
+void AppController::logBootProfile() { // Início: logBootProfile()
+    LOG_INFO("Boot: reset->begin %lu ms | leitor %lu config %lu rede %lu loop %lu restaurado %lu ms", // Fases
+             (unsigned long)_boot.startMs(), (unsigned long)_boot.at(BOOT_RFID_READY), (unsigned long)_boot.at(BOOT_CONFIG), // ...
+             (unsigned long)_boot.at(BOOT_NET_STARTED), (unsigned long)_boot.at(BOOT_LOOP), (unsigned long)_boot.at(BOOT_RESTORED)); // ...
+} // fim: logBootProfile()
+
 // serviceRfid(): tenta ler uma UID (não‑bloqueante) e enfileirar
 void AppController::serviceRfid() { // Lê RFID e enfileira, sem bloquear
+#if RFID_INVENTORY // Todos os cartões do campo num ciclo, enfileirados em lote
+    UidEntry batch[RFID_INVENTORY_MAX]; // Leituras aceitas neste ciclo
+    size_t n = _rfid.readInventory(batch, RFID_INVENTORY_MAX); // Inventário + deduplicação
+    if (n == 0) return; // Nada novo
+    for (size_t i = 0; i < n; ++i) { // Cada UID capturada
+        LOG_INFO("UID: %s", batch[i].uid); // Loga
+        if (_boot.mark(BOOT_FIRST_READ)) LOG_INFO("Boot: primeira leitura %lu ms apos begin()", (unsigned long)_boot.at(BOOT_FIRST_READ)); // Tempo até a primeira leitura
+        _agg.add(batch[i].uid, batch[i].capture_ms); // Conta na janela (sem efeito fora do modo agregado)
+    }
+    if (_agg.enabled() && !AGG_KEEP_RAW) return; // Modo agregado: leitura bruta não é guardada
+    _buffer.pushBatch(batch, n); // Enfileira o lote
+    persistSnapshot(); // Um snapshot por ciclo (não por cartão)
+#else // Um cartão por chamada
     char uid[32]; // Buffer para UID em hexadecimal
+    char data[RFID_BLOCK_DATA_MAX]; // Conteúdo do bloco (RFID_BLOCK_READ; "" sem ele)
     uint32_t capMs = 0; // Timestamp em millis() no momento da captura
-    if (_rfid.read(uid, sizeof(uid), capMs)) { // Somente entra se uma nova UID foi aceita
+    if (_rfid.read(uid, sizeof(uid), capMs, data, sizeof(data))) { // Somente entra se uma nova UID foi aceita
         LOG_INFO("UID: %s", uid); // Loga a UID capturada
-        _buffer.push(uid, capMs); // Enfileira UID + tempo de captura
-        if (PERSIST_BUFFER) _persist.saveSnapshot(_buffer); // Persiste snapshot do buffer
+        if (_boot.mark(BOOT_FIRST_READ)) LOG_INFO("Boot: primeira leitura %lu ms apos begin()", (unsigned long)_boot.at(BOOT_FIRST_READ)); // Tempo até a primeira leitura
+        _agg.add(uid, capMs); // Conta na janela (sem efeito fora do modo agregado)
+        if (_agg.enabled() && !AGG_KEEP_RAW) return; // Modo agregado: leitura bruta não é guardada
+        _buffer.push(uid, capMs, data); // Enfileira UID + tempo de captura + conteúdo do bloco
+        persistSnapshot(); // Persiste snapshot do buffer
     } // fim: bloco se houve nova UID
+#endif // fim: RFID_INVENTORY
 } // fim: serviceRfid()
 
-// serviceQueueSend(): envia o item mais antigo do buffer, se conectado e respeitando cadência
+// applyConfig(): repassa aos componentes os parâmetros que mudaram (os demais não são tocados)
+void AppController::applyConfig(uint32_t mask) { // Início: applyConfig()
+    const uint32_t dedup = (1UL << RP_DEDUP_MS) | (1UL << RP_DEDUP_SLOTS); // Deduplicação
+    const uint32_t retry = (1UL << RP_RETRY_MAX) | (1UL << RP_RETRY_BASE_MS); // Política de retry
+    if (mask & dedup) _rfid.setDedup(_cfg.dedupIntervalMs(), _cfg.dedupSlots()); // Próxima leitura
+    if (mask & retry) _http.setRetryPolicy(_cfg.httpRetryMax(), _cfg.httpRetryBaseMs()); // Próximo POST
+    if (mask & (1UL << RP_HTTP_TIMEOUT_MS)) _http.setTimeout(_cfg.httpTimeoutMs()); // Próxima sessão
+    if (mask & (1UL << RP_AGG_WINDOW_MS)) _agg.setWindow(_cfg.aggWindowMs()); // Fecha a janela em curso e reabre
+    if (mask & ((1UL << RP_UP_RATE_PM) | (1UL << RP_UP_BURST))) _gov.setRate(_cfg.upRatePerMin(), _cfg.upBurst()); // Próximo POST
+    if (mask & (1UL << RP_DRAIN_MS)) _sched.setPeriod(_tUplink, uplinkIntervalMs()); // Período da tarefa "uplink" (próxima liberação)
+    if (mask & (1UL << RP_BUF_CAP)) LOG_INFO("Config: buf_cap=%lu vale no proximo boot", (unsigned long)_cfg.get(RP_BUF_CAP)); // Dimensão do buffer
+    LOG_INFO("Config: dedup=%lu ms/%u slots envio=%lu ms retry=%u x %u ms timeout=%lu ms buffer=%u agregacao=%lu ms ritmo=%lu/min rajada=%u", // Valores efetivos
+             (unsigned long)_cfg.dedupIntervalMs(), (unsigned)_cfg.dedupSlots(), (unsigned long)_cfg.drainIntervalMs(), // ...
+             (unsigned)_cfg.httpRetryMax(), (unsigned)_cfg.httpRetryBaseMs(), (unsigned long)_cfg.httpTimeoutMs(), // ...
+             (unsigned)_buffer.limit(), (unsigned long)_agg.window(), (unsigned long)_cfg.upRatePerMin(), (unsigned)_cfg.upBurst()); // ...
+} // fim: applyConfig()
+
+// serviceConfig(): GET condicional da configuração remota (CONFIG_URL) no período configurado
+void AppController::serviceConfig() { // Início: serviceConfig()
+#ifdef CONFIG_URL // Download remoto habilitado em ProjectConfig.h
+    if (!_net.isConnected() || !_cfg.fetchDue()) return; // Sem rede ou fora do período
+    if (_mem.health() == MemHealth::CRITICAL) return; // Sem margem para TLS (tenta depois)
+    if (!MemTelemetry::canAfford(MEM_SEND_MIN_BLOCK_BYTES)) return; // Idem, checagem imediata
+    String body, etag; // Resposta
+    int code; // Código HTTP
+    { // Escopo instrumentado: sessão + corpo
+        MemScope scope(MemSite::CONFIG_FETCH); // Atribui alocações ao site config_fetch
+        code = _http.fetch(CONFIG_URL, _cfg.etag(), CONFIG_MAX_BYTES, body, etag); // GET com If-None-Match
+    }
+    if (code < 0) _net.reportTransportFailure(); // Sem resposta (conexão/DNS): lease reaproveitado suspeito
+    uint32_t changed = _cfg.onFetchResult(code, body, etag); // Valida, persiste e reagenda
+    if (changed) applyConfig(changed); // Aplica ao vivo o que mudou
+#endif // fim: CONFIG_URL
+} // fim: serviceConfig()
+
+// persistSnapshot(): a fila mudou; grava agora ou acorda a tarefa "persist" (SCHED_PERSIST_MAX_WAIT_MS > 0)
+void AppController::persistSnapshot() { // Ponto único de pedido do snapshot
+    if (!PERSIST_BUFFER) return; // Persistência desativada
+    _snapshotPending = true; // Devido (com a tarefa, mudanças seguidas viram uma só gravação)
+    if (_persist.restoring()) return; // Regravar agora apagaria entradas ainda na NVS (serviceRestore() retoma)
+    if (_tPersist < 0) writeSnapshot(); // Sem coalescimento: grava já
+    else _sched.wake(_tPersist); // Na folga ou ao vencer a espera máxima
+} // fim: persistSnapshot()
+
+// writeSnapshot(): grava o snapshot do buffer na NVS, contabilizando alocações
+void AppController::writeSnapshot() { // Escrita do snapshot (imediata ou pela tarefa "persist")
+    _snapshotPending = false; // Atendido
+    MemScope scope(MemSite::PERSIST_SAVE); // Atribui alocações ao site persist_save
+    _persist.saveSnapshot(_buffer); // Persiste snapshot do buffer
+} // fim: writeSnapshot()
+
+// uplinkPending(): resumos sempre sobem por HTTP; a fila bruta só fora do modo agregado (senão fica local) e sem o uplink UDP
+bool AppController::uplinkPending() const { // Início: uplinkPending()
+    return _agg.pending() > 0 || (!_agg.enabled() && !_udp.enabled() && !_buffer.isEmpty()); // Algo a enviar por HTTP
+} // fim: uplinkPending()
+
+// serviceQueueSend(): envia o resumo ou item mais antigo, se conectado (a cadência é o período da tarefa "uplink")
 void AppController::serviceQueueSend() { // Envia item mais antigo da fila, se possível
     if (!_net.isConnected()) return; // Sem Wi‑Fi não há envio
-    if (_buffer.isEmpty()) return; // Sem dados para enviar
-    unsigned long now = millis(); // Tempo atual do sistema (desde boot)
-    if (now - _lastQueueAttempt < QUEUE_DRAIN_INTERVAL_MS) return; // Respeita intervalo
-    _lastQueueAttempt = now; // Atualiza marca do último envio
+    if (!uplinkPending()) return; // Sem dados para enviar
+    if (_persist.restoring()) return; // Backlog ainda voltando da NVS: enviar agora quebraria a ordem FIFO
+    if (_lan.active()) return; // Coleta na LAN em curso: POST bloqueante atrasaria o stream (e duplicaria entregas)
+    MemHealth mem = _mem.health(); // Saúde do heap (amostrada)
+    if (mem == MemHealth::CRITICAL) return; // Sem margem para TLS: pausa envios (leituras seguem no buffer)
+    if (!MemTelemetry::canAfford(MEM_SEND_MIN_BLOCK_BYTES)) { // Checagem imediata antes de alocar o cliente
+        LOG_DEBUG("Envio adiado: maior bloco livre < %u", (unsigned)MEM_SEND_MIN_BLOCK_BYTES); // Evita falha de alocação no TLS
+        return; // Tenta no próximo intervalo
+    }
+    if (UPLINK_GOVERNOR && !_gov.allow()) return; // Sem ficha, servidor pediu espera, backoff ou disjuntor aberto
+    AggSummary s; // Resumo da frente (modo agregado)
+    if (_agg.peek(s)) { // Resumos têm prioridade (inclusive os fechados ao desligar a agregação)
+        bool sent; // Resultado do envio
+        { // Escopo instrumentado: payload String + HTTPClient/WiFiClientSecure
+            MemScope scope(MemSite::HTTP_SEND); // Mesmo site do envio por leitura
+            sent = _http.postSummary(s); // POST do resumo
+        }
+        if (UPLINK_GOVERNOR) _gov.onResult(_http.lastResponse()); // Ritmo, backoff e disjuntor
+        if (_http.lastResponse().code < 0) _net.reportTransportFailure(); // Sem resposta: lease reaproveitado suspeito
+        if (sent) { // Confirmado
+            _agg.pop(); // Remove da fila de resumos
+            LOG_INFO("Resumo enviado: janela %lu (%lu leituras)", (unsigned long)s.seq, (unsigned long)s.reads); // Diagnóstico
+        }
+        return; // Um envio por intervalo
+    }
+    if (_udp.enabled()) return; // Fila bruta sobe em datagramas (UdpUplink::loop)
     UidEntry e; // Estrutura para obter o item da frente
     if (!_buffer.peek(e)) return; // Leitura não destrutiva; aborta se falhar
-    bool ok = _http.postUid(e); // Faz POST com a entrada atual
+    bool ok; // Resultado do envio
+    { // Escopo instrumentado: payload String + HTTPClient/WiFiClientSecure
+        MemScope scope(MemSite::HTTP_SEND); // Atribui alocações ao site http_send
+        ok = _http.postUid(e); // Faz POST com a entrada atual
+    }
+    if (UPLINK_GOVERNOR) _gov.onResult(_http.lastResponse()); // Ritmo, backoff e disjuntor
+    if (_http.lastResponse().code < 0) _net.reportTransportFailure(); // Sem resposta: lease reaproveitado suspeito
     if (ok) { // Se o envio foi bem-sucedido
         _buffer.pop(e); // Remove definitivamente da fila
         LOG_INFO("UID enviada: %s", e.uid); // Loga UID enviada
-        if (PERSIST_BUFFER) _persist.saveSnapshot(_buffer); // Atualiza persistência
+        persistSnapshot(); // Atualiza persistência
     } // fim: remoção e persistência após envio OK
 } // fim: serviceQueueSend()
 
-// loop(): uma iteração da FSM e serviços não‑bloqueantes
-void AppController::loop() { // Executa uma iteração da FSM e serviços
-    serviceRfid(); // Lê RFID com prioridade para não perder eventos
-    _net.loop(); // Mantém a reconexão Wi‑Fi com backoff
+// serviceUplink(): FSM de conexão/envio; o período da tarefa segue drain_ms (espaçado com memória degradada)
+void AppController::serviceUplink() { // Início: serviceUplink()
     switch (_state) { // Máquina de estados de alto nível
         case State::INIT: // Estado transitório inicial
             _state = _net.isConnected() ? State::IDLE : State::CONNECTING; // Decide proximo
@@ -111,14 +360,27 @@ void AppController::loop() { // Executa uma iteração da FSM e serviços
             } // fim: transição CONNECTING->SENDING_QUEUE
             break; // Permanece tentando caso contrário
         case State::SENDING_QUEUE: // Drenagem de fila quando há conectividade
-            serviceQueueSend(); // Tenta enviar um item conforme cadência
-            if (_buffer.isEmpty()) _state = State::IDLE; // Sem pendências -> IDLE
+            serviceQueueSend(); // Tenta enviar um item
+            if (!uplinkPending()) _state = State::IDLE; // Sem pendências -> IDLE
             if (!_net.isConnected()) _state = State::CONNECTING; // Queda de rede -> CONNECTING
             break; // Fim do caso SENDING_QUEUE
         case State::IDLE: // Conectado e sem pendências
             serviceQueueSend(); // Se chegar item novo, tentar enviar
             if (!_net.isConnected()) _state = State::CONNECTING; // Perdeu rede
-            else if (!_buffer.isEmpty()) _state = State::SENDING_QUEUE; // Há itens -> drenar
+            else if (uplinkPending()) _state = State::SENDING_QUEUE; // Há itens -> drenar
             break; // Fim do caso IDLE
     } // fim: switch(_state)
+    _sched.setPeriod(_tUplink, uplinkIntervalMs()); // Vale a partir da próxima liberação
+} // fim: serviceUplink()
+
+// uplinkIntervalMs(): período da tarefa "uplink" (drain_ms, espaçado com memória degradada)
+uint32_t AppController::uplinkIntervalMs() const { // Início: uplinkIntervalMs()
+    uint32_t interval = _cfg.drainIntervalMs(); // Cadência normal (ajustável em tempo de execução)
+    if (_mem.health() == MemHealth::DEGRADED) interval *= MEM_DEGRADED_DRAIN_FACTOR; // Espaça sessões TLS
+    return interval; // Período (ms)
+} // fim: uplinkIntervalMs()
+
+// loop(): uma passada do escalonador (ver registerTasks())
+void AppController::loop() { // Executa as tarefas vencidas e o fundo na folga
+    _sched.runPass(); // rfid > net > uplink > udp > mem > config; depois restore/lan/persist
 } // fim: loop()
@@ -0,0 +1,103 @@
+/*
+    Arquivo: src/EdgeAggregator.cpp
+    Propósito: Implementa o EdgeAggregator: janelas contíguas de duração fixa
+    (sem lacunas nem sobreposição), fechamento pelo relógio em loop(), e a
+    fila circular de resumos com descarte do mais antigo quando cheia (mesma
+    política do UidBuffer). Comparações de tempo seguras no wrap de millis().
+*/
+
+#include "EdgeAggregator.h" // Declarações da classe
+#include "Log.h" // Macros de log
+#include <string.h> // strncpy, memset
+
+// Construtor: desligado, fila vazia
+EdgeAggregator::EdgeAggregator(Clock &clock) // Início: construtor
+    : _clock(clock), _windowMs(0), _startMs(0), _head(0), _count(0), _nextSeq(0) { // Estado inicial
+    memset(&_cur, 0, sizeof(_cur)); // Janela vazia
+    memset(&_stats, 0, sizeof(_stats)); // Métricas zeradas
+} // fim: EdgeAggregator::EdgeAggregator()
+
+// setWindow(): liga, desliga ou troca a duração; o que já foi contado não se perde
+void EdgeAggregator::setWindow(uint32_t ms) { // Início: setWindow()
+    if (ms != 0 && ms < AGG_WINDOW_MIN_MS) ms = AGG_WINDOW_MIN_MS; // Janelas curtas demais não reduzem o envio
+    if (ms == _windowMs) return; // Sem mudança
+    uint32_t now = _clock.nowMs(); // Agora
+    if (enabled()) close(now); // Resumo parcial da janela em curso
+    _windowMs = ms; // Aplica
+    if (enabled()) open(now); // Nova janela a partir de agora
+    LOG_INFO("Agregacao: %s (janela=%lu ms)", enabled() ? "ligada" : "desligada", (unsigned long)ms); // Diagnóstico
+} // fim: setWindow()
+
+// open(): janela vazia começando em startMs
+void EdgeAggregator::open(uint32_t startMs) { // Início: open()
+    _startMs = startMs; // Início
+    _cur.reads = 0; // Nenhuma leitura
+    _cur.firstUid[0] = '\0'; // Sem primeira
+    _cur.lastUid[0] = '\0'; // Sem última
+    _hll.clear(); // Sketch vazio
+} // fim: open()
+
+// add(): conta uma leitura aceita (o RfidReader já deduplicou)
+void EdgeAggregator::add(const char *uidHex, uint32_t captureMs) { // Início: add()
+    if (!enabled() || !uidHex || uidHex[0] == '\0') return; // Desligado ou UID vazia
+    roll(captureMs); // A leitura pertence à janela do instante de captura
+    if (_cur.reads == 0) { // Primeira da janela
+        strncpy(_cur.firstUid, uidHex, sizeof(_cur.firstUid) - 1); // Copia com limite
+        _cur.firstUid[sizeof(_cur.firstUid) - 1] = '\0'; // Terminação NUL
+        _cur.firstMs = captureMs; // Captura
+    }
+    strncpy(_cur.lastUid, uidHex, sizeof(_cur.lastUid) - 1); // Última até agora
+    _cur.lastUid[sizeof(_cur.lastUid) - 1] = '\0'; // Terminação NUL
+    _cur.lastMs = captureMs; // Captura
+    _cur.reads++; // Conta
+    _hll.add(uidHex); // Distintos
+    _stats.reads++; // Métrica
+} // fim: add()
+
+// loop(): fecha a janela vencida pelo relógio (janelas sem leitura também avançam)
+void EdgeAggregator::loop() { // Início: loop()
+    if (enabled()) roll(_clock.nowMs()); // Avança até agora
+} // fim: loop()
+
+// roll(): fecha a janela aberta se t já passou do fim; janelas inteiras sem leitura são puladas de uma vez
+void EdgeAggregator::roll(uint32_t t) { // Início: roll()
+    if ((int32_t)(t - _startMs) < 0) return; // Instante anterior à janela aberta: conta nela (segura no wrap)
+    uint32_t age = t - _startMs; // Idade da janela
+    if (age < _windowMs) return; // Ainda aberta
+    uint32_t end = _startMs + _windowMs; // Fim nominal
+    close(end); // Fecha (enfileira se houve leitura)
+    open(end + (age / _windowMs - 1) * _windowMs); // Alinha à grade: pula janelas vazias
+} // fim: roll()
+
+// close(): resumo da janela aberta; sem leituras não há resumo
+void EdgeAggregator::close(uint32_t endMs) { // Início: close()
+    if (_cur.reads == 0) return; // Janela vazia
+    _cur.seq = _nextSeq++; // Numeração contínua
+    _cur.startMs = _startMs; // Início
+    _cur.durationMs = endMs - _startMs; // Duração efetiva
+    uint32_t d = _hll.estimate(); // Estimativa de distintos
+    _cur.distinct = d > _cur.reads ? _cur.reads : (d ? d : 1); // Entre 1 e reads
+    if (_count == AGG_QUEUE_CAPACITY) { // Fila cheia: descarta o mais antigo
+        _count--; // Ajusta tamanho (o novo ocupa a posição do mais antigo)
+        _stats.dropped++; // Contabiliza perda
+        LOG_ERROR("Agregacao: fila de resumos cheia; descartando o mais antigo"); // Diagnóstico
+    }
+    _queue[_head] = _cur; // Enfileira
+    _head = (_head + 1) % AGG_QUEUE_CAPACITY; // Avança circularmente
+    _count++; // Conta
+    _stats.windows++; // Métrica
+    LOG_DEBUG("Agregacao: janela %lu fechada (%lu leituras, ~%lu distintas)", (unsigned long)_cur.seq, // Diagnóstico
+              (unsigned long)_cur.reads, (unsigned long)_cur.distinct); // ...
+} // fim: close()
+
+// peek(): resumo mais antigo
+bool EdgeAggregator::peek(AggSummary &out) const { // Início: peek()
+    if (_count == 0) return false; // Fila vazia
+    out = _queue[(_head + AGG_QUEUE_CAPACITY - _count) % AGG_QUEUE_CAPACITY]; // Cauda
+    return true; // Sucesso
+} // fim: peek()
+
+// pop(): remove o mais antigo
+void EdgeAggregator::pop() { // Início: pop()
+    if (_count > 0) _count--; // A cauda avança implicitamente
+} // fim: pop()
@@ -1,8 +1,12 @@
 /*
     Arquivo: src/HttpSender.cpp
-    Propósito: Implementa o envio HTTP/HTTPS das leituras (UidEntry), construindo
-    o payload JSON com metadados e aplicando retries exponenciais em falhas
-    transitórias. Suporta HTTPS com validação de CA ou modo inseguro (DEV).
+    Propósito: Implementa o envio HTTP/HTTPS das leituras (UidEntry) e dos
+    resumos por janela (AggSummary), construindo o payload JSON com metadados
+    e aplicando retries com jitter descorrelacionado em falhas transitórias,
+    com a espera total da chamada limitada a HTTP_RETRY_WAIT_BUDGET_MS.
+    Guarda o código e os cabeçalhos de ritmo da resposta (Retry-After,
+    RateLimit-*) para o UplinkGovernor. Suporta HTTPS com validação de CA ou
+    modo inseguro (DEV).
 */
 
 #include "HttpSender.h" // Declarações da classe
@@ -10,15 +14,57 @@
 #include "Log.h" // Macros de log
 
 // Construtor: define o timeout (ms) aplicado às operações do HTTPClient
-HttpSender::HttpSender(uint32_t timeoutMs) : _timeout(timeoutMs) {} // Inicialização do campo
+HttpSender::HttpSender(uint32_t timeoutMs, Clock &clock) // Início: construtor
+    : _timeout(timeoutMs), _retryMax((uint8_t)HTTP_RETRY_MAX), _retryBaseMs((uint16_t)HTTP_RETRY_BASE_DELAY_MS), _clock(clock), // Padrões de compilação
+      _last{0, -1, -1, -1} {} // Nenhum POST ainda
 
 // postUid(): envia um único UidEntry; monta payload JSON e aplica retries
 bool HttpSender::postUid(const UidEntry &entry) { // Envia um único UidEntry
+    _last = UplinkResponse{HTTPC_ERROR_CONNECTION_REFUSED, -1, -1, -1}; // Caso aborte antes do POST
     if (WiFi.status() != WL_CONNECTED) return false; // Sem rede, aborta cedo
 #ifndef HTTP_ENDPOINT_URL // Se a URL não está definida em config
     return false; // Endpoint não configurado
 #else // Caso a URL exista
-    // Monta payload JSON com metadados
+    String payload = "{"; // Monta JSON manualmente (leve e sem alocação extra)
+    payload += "\"uid\":\""; payload += entry.uid; payload += "\","; // Campo uid
+    payload += "\"capture_timestamp_ms\":"; payload += entry.capture_ms; payload += ','; // ts de captura
+#if RFID_BLOCK_READ // Conteúdo do bloco ("" = não lido; o backend recorre à UID)
+    payload += "\"card_data\":\""; payload += entry.data; payload += "\","; // Campo card_data
+#endif // fim: RFID_BLOCK_READ
+    appendMeta(payload); // Metadados + fecha JSON
+    return postWithRetry(payload, String(HTTP_ENDPOINT_URL)); // Envio com retries
+#endif // HTTP_ENDPOINT_URL
+} // fim: postUid()
+
+// postSummary(): envia o resumo de uma janela do modo agregado
+bool HttpSender::postSummary(const AggSummary &s) { // Envia um AggSummary
+    _last = UplinkResponse{HTTPC_ERROR_CONNECTION_REFUSED, -1, -1, -1}; // Caso aborte antes do POST
+    if (WiFi.status() != WL_CONNECTED) return false; // Sem rede, aborta cedo
+#if !defined(AGG_ENDPOINT_URL) && !defined(HTTP_ENDPOINT_URL) // Nenhum destino configurado
+    return false; // Endpoint não configurado
+#else // Há destino
+    String payload = "{"; // Mesmo formato manual do postUid()
+    payload += "\"record\":\"summary\","; // Distingue do registro por leitura
+    payload += "\"window_seq\":"; payload += s.seq; payload += ','; // Lacuna = resumo perdido
+    payload += "\"window_start_ms\":"; payload += s.startMs; payload += ','; // Início (millis)
+    payload += "\"window_ms\":"; payload += s.durationMs; payload += ','; // Duração efetiva
+    payload += "\"reads\":"; payload += s.reads; payload += ','; // Leituras aceitas
+    payload += "\"distinct_estimate\":"; payload += s.distinct; payload += ','; // HyperLogLog
+    payload += "\"first_uid\":\""; payload += s.firstUid; payload += "\","; // Primeira UID
+    payload += "\"first_seen_ms\":"; payload += s.firstMs; payload += ','; // Captura da primeira
+    payload += "\"last_uid\":\""; payload += s.lastUid; payload += "\","; // Última UID
+    payload += "\"last_seen_ms\":"; payload += s.lastMs; payload += ','; // Captura da última
+    appendMeta(payload); // Metadados + fecha JSON
+#ifdef AGG_ENDPOINT_URL // Endpoint próprio para resumos
+    return postWithRetry(payload, String(AGG_ENDPOINT_URL)); // Envio com retries
+#else // Mesmo endpoint das leituras (campo "record" distingue)
+    return postWithRetry(payload, String(HTTP_ENDPOINT_URL)); // Envio com retries
+#endif // fim: AGG_ENDPOINT_URL
+#endif // fim: destino configurado
+} // fim: postSummary()
+
+// appendMeta(): timestamps do envio e metadados do dispositivo; fecha o JSON
+void HttpSender::appendMeta(String &payload) { // Comum a leituras e resumos
     time_t now = time(nullptr); // Obtém tempo atual (se RTC/NTP configurado)
     bool hasTime = (now > 1609459200); // Considera válido > 2021-01-01
     char iso[25] = {0}; // Buffer para ISO-8601
@@ -27,11 +73,7 @@ bool HttpSender::postUid(const UidEntry &entry) { // Envia um único UidEntry
         gmtime_r(&now, &tmUTC); // Converte para UTC (thread-safe)
         strftime(iso, sizeof(iso), "%Y-%m-%dT%H:%M:%SZ", &tmUTC); // ISO-8601
     }
-
-    String payload = "{"; // Monta JSON manualmente (leve e sem alocação extra)
-    payload += "\"uid\":\""; payload += entry.uid; payload += "\","; // Campo uid
-    payload += "\"capture_timestamp_ms\":"; payload += entry.capture_ms; payload += ','; // ts de captura
-    payload += "\"timestamp_ms\":"; payload += millis(); payload += ','; // ts local do envio
+    payload += "\"timestamp_ms\":"; payload += _clock.nowMs(); payload += ','; // ts local do envio
     payload += "\"timestamp_iso\":\""; payload += hasTime ? iso : ""; payload += "\","; // ISO-8601
     payload += "\"device_id\":\""; payload += DEVICE_ID; payload += "\","; // ID do dispositivo
     payload += "\"site\":\""; payload += DEVICE_SITE; payload += "\","; // Site (fecha aspas antes da vírgula)
@@ -40,58 +82,58 @@ bool HttpSender::postUid(const UidEntry &entry) { // Envia um único UidEntry
     payload += "\"firmware_version\":\""; payload += FW_VERSION; payload += "\","; // FW
     payload += "\"operator_id\":\""; payload += DEVICE_OPERATOR_ID; payload += "\""; // Operador
     payload += '}'; // Fecha JSON
+} // fim: appendMeta()
 
+// postWithRetry(): POST com retries curtos (jitter descorrelacionado) em falhas transitórias
+bool HttpSender::postWithRetry(const String &payload, const String &url) { // Início: postWithRetry()
     int code = -1; // Código HTTP resultante
-    String url = String(HTTP_ENDPOINT_URL); // URL de destino
-    uint8_t maxRetries = (uint8_t)HTTP_RETRY_MAX; // Tentativas extras
-    uint16_t baseDelay = (uint16_t)HTTP_RETRY_BASE_DELAY_MS; // Base de backoff
+    uint8_t maxRetries = _retryMax; // Tentativas extras (ajustáveis em tempo de execução)
+    uint32_t baseDelay = _retryBaseMs; // Base de backoff
+    uint32_t capDelay = baseDelay << maxRetries; // Mesmo teto do backoff exponencial anterior
+    uint32_t waitMs = baseDelay; // Espera anterior (jitter descorrelacionado)
+    uint32_t waitLeft = HTTP_RETRY_WAIT_BUDGET_MS; // Espera ainda permitida nesta chamada (independe da política remota)
 
     for (uint8_t attempt = 0; attempt <= maxRetries; ++attempt) { // Loop de tentativas
+        _last = UplinkResponse{-1, -1, -1, -1}; // Resultado desta tentativa
         if (!performPost(payload, url, code)) { // Faz POST efetivo
             code = -1; // Erro no cliente/transporte
         }
+        _last.code = code; // Para o UplinkGovernor
         if (code >= 200 && code < 300) { // Sucesso 2xx
             LOG_INFO("HTTP %d", code); // Log de sucesso
             return true; // Retorna sucesso
         }
         if (attempt == maxRetries || !shouldRetry(code, attempt)) break; // Não cabe retry
-        uint16_t waitMs = baseDelay * (1 << attempt); // Backoff exponencial simples
-        LOG_DEBUG("Retry HTTP em %ums (tentativa %u)", waitMs, (unsigned)attempt+1); // Log de retry
-        delay(waitMs); // Backoff bloqueante (curto)
+        if (waitLeft == 0) break; // Orçamento de espera gasto: o UplinkGovernor agenda a próxima tentativa
+        waitMs = baseDelay + (uint32_t)random(0, (long)(waitMs * 3 - baseDelay) + 1); // aleatório[base, 3 × anterior]
+        if (waitMs > capDelay) waitMs = capDelay; // Teto
+        if (waitMs > waitLeft) waitMs = waitLeft; // Não passa do orçamento da chamada
+        waitLeft -= waitMs; // Consome o orçamento
+        LOG_DEBUG("Retry HTTP em %lums (tentativa %u)", (unsigned long)waitMs, (unsigned)attempt+1); // Log de retry
+        _clock.delayMs(waitMs); // Backoff bloqueante (curto)
     }
     if (code <= 0) LOG_ERROR("POST erro (client) code=%d", code); // Erro de transporte
     else LOG_ERROR("HTTP falhou code=%d", code); // HTTP != 2xx e sem retry
     return false; // Falha final
-#endif // HTTP_ENDPOINT_URL
-} // fim: postUid()
+} // fim: postWithRetry()
 
 // performPost(): executa POST via HTTPClient (HTTPS/HTTP) com cabeçalhos e retorno do status
 bool HttpSender::performPost(const String &payload, const String &url, int &code) { // Executa POST com HTTPClient
+    static const char *kPacing[] = { "Retry-After", "RateLimit-Remaining", "RateLimit-Reset" }; // Cabeçalhos de ritmo
     HTTPClient http; // Instância do cliente HTTP
     http.setConnectTimeout(_timeout); // Timeout de conexão
     http.setTimeout(_timeout); // Timeout da requisição
+    http.collectHeaders(kPacing, 3); // Guardados na resposta
     if (url.startsWith("https://")) { // Caminho HTTPS
         WiFiClientSecure sclient; // Cliente TLS
-#if HTTPS_SECURITY_MODE == 1 // HTTPS com validação de CA
-        #ifdef HTTPS_CA_CERT_PEM // Se a CA foi fornecida
-        if (!sclient.setCACert(HTTPS_CA_CERT_PEM)) { // Carrega CA em PEM
-            LOG_ERROR("Falha ao carregar CA"); // Loga falha
-            return false; // Aborta
-        }
-        #else // Sem CA definida
-        LOG_ERROR("CA não definida (HTTPS_SECURITY_MODE=1)"); // Alerta de configuração
-        return false; // Aborta (não segue inseguro)
-    #endif // HTTPS_CA_CERT_PEM
-#else // HTTPS sem validação (DEV)
-    sclient.setInsecure(); // Sem validação de CA (apenas DEV)
-    LOG_DEBUG("HTTPS inseguro (DEV)"); // Aviso de modo DEV
-#endif // fim: HTTPS_SECURITY_MODE
+        if (!configureTls(sclient)) return false; // CA ausente/inválida: aborta
         if (!http.begin(sclient, url)) { // Abre sessão HTTPS
             LOG_ERROR("begin HTTPS falhou"); // Falha ao iniciar
             return false; // Aborta
         }
         http.addHeader("Content-Type", "application/json"); // Define cabeçalho
         code = http.POST(payload); // Executa POST
+        readPacing(http); // Retry-After / RateLimit-*
         http.end(); // Libera recursos
     } else { // Caminho HTTP simples
         WiFiClient nclient; // Cliente TCP
@@ -101,15 +143,116 @@ bool HttpSender::performPost(const String &payload, const String &url, int &code
         }
         http.addHeader("Content-Type", "application/json"); // Define cabeçalho
         code = http.POST(payload); // Executa POST
+        readPacing(http); // Retry-After / RateLimit-*
         http.end(); // Libera recursos
     }
     return true; // Sinaliza que a requisição foi tentada
 } // fim: performPost()
 
+// configureTls(): aplica a política HTTPS_SECURITY_MODE ao cliente TLS
+bool HttpSender::configureTls(WiFiClientSecure &sclient) { // Início: configureTls()
+#if HTTPS_SECURITY_MODE == 1 // HTTPS com validação de CA
+    #ifdef HTTPS_CA_CERT_PEM // Se a CA foi fornecida
+    if (!sclient.setCACert(HTTPS_CA_CERT_PEM)) { // Carrega CA em PEM
+        LOG_ERROR("Falha ao carregar CA"); // Loga falha
+        return false; // Aborta
+    }
+    return true; // CA carregada
+    #else // Sem CA definida
+    LOG_ERROR("CA não definida (HTTPS_SECURITY_MODE=1)"); // Alerta de configuração
+    return false; // Aborta (não segue inseguro)
+    #endif // HTTPS_CA_CERT_PEM
+#else // HTTPS sem validação (DEV)
+    sclient.setInsecure(); // Sem validação de CA (apenas DEV)
+    LOG_DEBUG("HTTPS inseguro (DEV)"); // Aviso de modo DEV
+    return true; // Pronto
+#endif // fim: HTTPS_SECURITY_MODE
+} // fim: configureTls()
+
+// fetch(): GET condicional (ETag) com corpo limitado; usado pela configuração remota
+int HttpSender::fetch(const char *url, const char *etag, size_t maxBytes, String &body, String &etagOut) { // Início: fetch()
+    if (WiFi.status() != WL_CONNECTED) return HTTPC_ERROR_CONNECTION_REFUSED; // Sem rede
+    String u = String(url); // URL de destino
+    HTTPClient http; // Instância do cliente HTTP
+    http.setConnectTimeout(_timeout); // Timeout de conexão
+    http.setTimeout(_timeout); // Timeout da requisição
+    if (u.startsWith("https://")) { // Caminho HTTPS
+        WiFiClientSecure sclient; // Cliente TLS
+        if (!configureTls(sclient)) return HTTPC_ERROR_CONNECTION_REFUSED; // CA ausente/inválida
+        if (!http.begin(sclient, u)) { LOG_ERROR("begin HTTPS falhou"); return HTTPC_ERROR_CONNECTION_REFUSED; } // Falha ao iniciar
+        return performGet(http, etag, maxBytes, body, etagOut); // GET + fim da sessão
+    }
+    WiFiClient nclient; // Cliente TCP
+    if (!http.begin(nclient, u)) { LOG_ERROR("begin HTTP falhou"); return HTTPC_ERROR_CONNECTION_REFUSED; } // Falha ao iniciar
+    return performGet(http, etag, maxBytes, body, etagOut); // GET + fim da sessão
+} // fim: fetch()
+
+// performGet(): executa o GET numa sessão aberta e a encerra
+int HttpSender::performGet(HTTPClient &http, const char *etag, size_t maxBytes, String &body, String &etagOut) { // Início: performGet()
+    static const char *kHeaders[] = { "ETag" }; // Cabeçalhos de resposta guardados
+    http.collectHeaders(kHeaders, 1); // Guarda o ETag da resposta
+    if (etag && etag[0]) http.addHeader("If-None-Match", etag); // Versão já aplicada
+    http.useHTTP10(true); // Sem chunked: corpo sem tamanho vem delimitado pelo fechamento (lido cru do stream)
+    int code = http.GET(); // Executa GET
+    if (code == 200) { // Documento novo
+        int len = http.getSize(); // Content-Length (-1 se ausente)
+        bool ok = true; // Corpo dentro do limite?
+        if (len > 0 && (size_t)len > maxBytes) { // Grande demais: não aloca
+            LOG_ERROR("GET: corpo de %d bytes > %u", len, (unsigned)maxBytes); // Diagnóstico
+            ok = false; // Rejeita
+        } else if (len < 0) { // Tamanho desconhecido: getString() alocaria o que viesse
+            ok = readBounded(http, maxBytes, body); // Lê do stream até o fechamento, abortando acima do limite
+        } else { // Tamanho conhecido e aceitável
+            body = http.getString(); // Corpo
+        }
+        if (ok) etagOut = http.header("ETag"); // Versão
+        else { body = String(); code = 0; } // Tratado como erro (nada parcial aplicado)
+    }
+    http.end(); // Libera recursos
+    return code; // Código HTTP (ou erro do cliente)
+} // fim: performGet()
+
+// readBounded(): corpo sem Content-Length lido do stream até o fechamento; false acima de maxBytes ou sem progresso
+bool HttpSender::readBounded(HTTPClient &http, size_t maxBytes, String &body) { // Início: readBounded()
+    WiFiClient *s = http.getStreamPtr(); // Conexão com o corpo cru (HTTP/1.0: sem chunked)
+    if (!s) return false; // Sessão sem stream
+    body = String(); // Começa vazio
+    size_t total = 0; // Bytes lidos
+    char buf[129]; // Bloco de leitura (+ NUL)
+    uint32_t lastData = _clock.nowMs(); // Último progresso (prazo = _timeout)
+    while (s->connected() || s->available() > 0) { // Até o servidor fechar e o buffer esvaziar
+        int avail = s->available(); // Bytes prontos
+        if (avail <= 0) { // Nada ainda
+            if (_clock.nowMs() - lastData >= _timeout) { LOG_ERROR("GET: corpo sem progresso por %lums", (unsigned long)_timeout); return false; } // Servidor parado
+            _clock.delayMs(1); // Cede a CPU
+            continue; // Espera mais dados
+        }
+        int n = s->read((uint8_t *)buf, sizeof(buf) - 1); // Até 128 bytes
+        if (n <= 0) continue; // Nada lido
+        total += (size_t)n; // Acumula
+        if (total > maxBytes) { LOG_ERROR("GET: corpo sem Content-Length passou de %u bytes", (unsigned)maxBytes); return false; } // Aborta sem alocar o resto
+        buf[n] = '\0'; // Termina o bloco
+        body += buf; // Acrescenta (documento de texto)
+        lastData = _clock.nowMs(); // Progresso
+    }
+    return true; // Corpo completo dentro do limite
+} // fim: readBounded()
+
+// readPacing(): cabeçalhos de ritmo da resposta (ausentes ficam em -1)
+void HttpSender::readPacing(HTTPClient &http) { // Início: readPacing()
+    String ra = http.header("Retry-After"); // Segundos ou data HTTP
+    if (ra.length()) _last.retryAfterMs = UplinkGovernor::parseRetryAfter(ra.c_str(), time(nullptr)); // -1 se inválido
+    String rem = http.header("RateLimit-Remaining"); // Requisições restantes na janela do servidor
+    if (rem.length()) _last.limitRemaining = (int32_t)rem.toInt(); // Inteiro
+    String rst = http.header("RateLimit-Reset"); // Segundos até a janela renovar
+    if (rst.length()) _last.limitResetMs = UplinkGovernor::parseRetryAfter(rst.c_str(), 0); // Mesmo formato (só segundos)
+} // fim: readPacing()
+
 // shouldRetry(): define regras de retry para códigos/transporte e tentativas
 bool HttpSender::shouldRetry(int httpCode, uint8_t attempt) const { // Regras de retry
+    if (_last.retryAfterMs >= 0) return false; // Servidor disse quando voltar: o UplinkGovernor espera sem bloquear o loop
     if (httpCode < 0) return true; // Erro de transporte: tentar de novo
-    if (httpCode == 429) return true; // Rate limited: aguardar e tentar
+    if (httpCode == 429) return false; // Rate limited: insistir agora só piora (o governador espaça)
     if (httpCode >= 500 && httpCode < 600) return true; // Erro 5xx do servidor
     return false; // Outros códigos: não insistir
 } // fim: shouldRetry()
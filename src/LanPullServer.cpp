@@ -0,0 +1,263 @@
+/*
+    Arquivo: src/LanPullServer.cpp
+    Propósito: Implementa o LanPullServer: aceita um cliente por vez na LAN,
+    lê a requisição HTTP com prazo, responde /status e /ack com corpos curtos
+    e transmite /backlog em chunks montados direto do UidBuffer, alguns por
+    iteração do loop (o restante do firmware segue rodando entre eles).
+*/
+
+#include "LanPullServer.h" // Declarações da classe
+#include "Log.h" // Macros de log
+#include <stdio.h> // snprintf, sscanf
+#include <stdlib.h> // strtoul
+#include <string.h> // strstr, strncmp, strcspn, memset
+#include <strings.h> // strncasecmp (nome de cabeçalho sem diferenciar maiúsculas)
+
+#if LAN_PULL_ENABLE && !defined(LAN_PULL_TOKEN) // A fila inteira ficaria exposta a qualquer cliente da LAN
+#error "LAN_PULL_ENABLE requer LAN_PULL_TOKEN"
+#endif // fim: checagem de LAN_PULL_TOKEN
+
+// Construtor: servidor ainda fechado (abre com o primeiro link)
+LanPullServer::LanPullServer(UidBuffer &buffer, Clock &clock) // Início: construtor
+    : _buffer(buffer), _clock(clock), _server(LAN_PULL_PORT), _listening(false), _served(false), _lastServedMs(0), _state(PullState::IDLE), // Estado inicial
+      _epoch(0), _deadlineMs(0), _streamStartMs(0), _reqLen(0), _nextSeq(0), _endSeq(0), _sent(0) { // ...
+    _req[0] = '\0'; // Sem requisição
+    memset(&_stats, 0, sizeof(_stats)); // Métricas zeradas
+} // fim: LanPullServer::LanPullServer()
+
+// begin(): época deste boot (as sequências do UidBuffer recomeçam em 0 a cada reinício)
+void LanPullServer::begin() { // Início: begin()
+    _epoch = (uint32_t)random(1, 0x7FFFFFFF); // Nunca 0 (0 = parâmetro ausente no ack)
+} // fim: begin()
+
+// loop(): uma fatia do atendimento; nunca espera por rede
+void LanPullServer::loop(bool linkUp) { // Início: loop()
+    if (!linkUp) { // Sem Wi‑Fi: o cliente atual não tem como continuar
+        if (_state != PullState::IDLE) finish(false); // Fecha (stream conta como interrompido)
+        return; // Nada a fazer
+    }
+    if (!_listening) { // Primeiro link: abre o socket de escuta
+        _server.begin(); // Escuta em todas as interfaces
+        _server.setNoDelay(true); // Chunks saem sem esperar o Nagle
+        _listening = true; // Não repete
+        LOG_INFO("Coleta LAN na porta %u (epoch=%lu)", (unsigned)LAN_PULL_PORT, (unsigned long)_epoch); // Diagnóstico
+    }
+    if (_state == PullState::IDLE) { // Sem cliente: aceita o próximo
+        WiFiClient c = _server.accept(); // Não bloqueia
+        if (!c) return; // Ninguém esperando
+        _client = c; // Cliente em atendimento
+        _reqLen = 0; // Requisição vazia
+        _req[0] = '\0'; // ...
+        _deadlineMs = _clock.nowMs() + LAN_PULL_REQ_TIMEOUT_MS; // Prazo do cabeçalho
+        _state = PullState::REQUEST; // Lê já nesta iteração
+    }
+    uint32_t t0 = _clock.nowUs(); // Início da fatia
+    if (_state == PullState::REQUEST) readRequest(); // Acumula cabeçalho
+    else if (_state == PullState::STREAM) streamChunks(); // Continua o stream
+    uint32_t slice = _clock.nowUs() - t0; // Tempo do loop ocupado pelo atendimento
+    if (slice > _stats.maxSliceUs) _stats.maxSliceUs = slice; // Pior fatia
+} // fim: loop()
+
+// readRequest(): lê o que chegou; despacha ao ver a linha em branco do fim do cabeçalho
+void LanPullServer::readRequest() { // Início: readRequest()
+    int avail = _client.available(); // Bytes recebidos
+    if (avail > 0 && _reqLen < LAN_PULL_MAX_REQ_BYTES) { // Há dados e espaço
+        size_t room = LAN_PULL_MAX_REQ_BYTES - _reqLen; // Espaço restante
+        int n = _client.read((uint8_t *)_req + _reqLen, (size_t)avail < room ? (size_t)avail : room); // Copia
+        if (n > 0) _reqLen += (size_t)n; // Acumula
+        _req[_reqLen] = '\0'; // Terminação NUL (strstr)
+    }
+    if (strstr(_req, "\r\n\r\n")) { dispatch(); return; } // Cabeçalho completo (corpo é ignorado)
+    if (_reqLen >= LAN_PULL_MAX_REQ_BYTES) { respond(431, "Request Header Fields Too Large", "{\"error\":\"header\"}"); return; } // Grande demais
+    if (!_client.connected()) { finish(false); return; } // Cliente desistiu
+    if ((int32_t)(_clock.nowMs() - _deadlineMs) >= 0) respond(408, "Request Timeout", "{\"error\":\"timeout\"}"); // Cliente mudo
+} // fim: readRequest()
+
+// dispatch(): roteia GET /status, GET /backlog e POST /ack
+void LanPullServer::dispatch() { // Início: dispatch()
+    _stats.requests++; // Conta requisição
+    char method[8], target[160]; // Linha de requisição
+    if (sscanf(_req, "%7s %159s", method, target) != 2) { respond(400, "Bad Request", "{\"error\":\"request\"}"); return; } // Malformada
+    if (!authorized()) { respond(401, "Unauthorized", "{\"error\":\"token\"}"); return; } // Token ausente/errado
+    char *query = strchr(target, '?'); // Parâmetros
+    if (query) *query++ = '\0'; // Separa caminho e query
+    else query = target + strlen(target); // Query vazia
+    bool get = strcmp(method, "GET") == 0; // Método
+    bool post = strcmp(method, "POST") == 0; // ...
+    char body[128]; // Corpo das respostas curtas
+
+    if (strcmp(target, "/status") == 0 && get) { // Resumo da fila
+        snprintf(body, sizeof(body), "{\"epoch\":%lu,\"first\":%lu,\"end\":%lu,\"pending\":%u,\"dropped\":%lu}", // JSON
+                 (unsigned long)_epoch, (unsigned long)_buffer.firstSeq(), (unsigned long)_buffer.endSeq(), // ...
+                 (unsigned)_buffer.size(), (unsigned long)_buffer.dropped()); // ...
+        respond(200, "OK", body); // Responde e fecha
+        return; // Atendido
+    }
+    if (strcmp(target, "/backlog") == 0 && get) { // Stream da fila
+        uint32_t first = _buffer.firstSeq(); // Mais antigo disponível
+        uint32_t end = _buffer.endSeq(); // Fim atual (o stream não persegue leituras novas)
+        uint32_t from = first; // Padrão: do mais antigo
+        queryUInt(query, "from", from); // Retomada a partir de um cursor
+        if ((int32_t)(from - first) < 0) from = first; // Já saiu da fila
+        if ((int32_t)(from - end) > 0) from = end; // Além do fim
+        uint32_t count = end - from; // Registros disponíveis
+        uint32_t max = 0; // Limite pedido
+        if (queryUInt(query, "max", max) && max < count) count = max; // Lote menor
+        _nextSeq = from; // Primeiro registro
+        _endSeq = from + count; // Fim exclusivo
+        _sent = 0; // Nada enviado
+        _streamStartMs = _clock.nowMs(); // Início (métrica)
+        int n = snprintf(_chunk, sizeof(_chunk), // Cabeçalho da resposta
+                         "HTTP/1.1 200 OK\r\nContent-Type: application/x-ndjson\r\nTransfer-Encoding: chunked\r\n" // ...
+                         "X-Pull-Epoch: %lu\r\nConnection: close\r\n\r\n", (unsigned long)_epoch); // ...
+        if (_client.write((const uint8_t *)_chunk, (size_t)n) != (size_t)n) { finish(false); return; } // Cliente saiu
+        _state = PullState::STREAM; // Chunks a partir da próxima chamada
+        streamChunks(); // Primeira fatia já nesta iteração
+        return; // Em andamento
+    }
+    if (strcmp(target, "/ack") == 0 && post) { // Confirmação do coletor
+        uint32_t epoch = 0, cursor = 0; // Parâmetros obrigatórios
+        if (!queryUInt(query, "epoch", epoch) || !queryUInt(query, "cursor", cursor)) { respond(400, "Bad Request", "{\"error\":\"params\"}"); return; } // Incompleto
+        if (epoch != _epoch) { // Cursor de outro boot: sequências não correspondem
+            snprintf(body, sizeof(body), "{\"error\":\"epoch\",\"epoch\":%lu}", (unsigned long)_epoch); // Época atual
+            respond(409, "Conflict", body); // Coletor deve puxar de novo
+            return; // Nada liberado
+        }
+        if ((int32_t)(cursor - _buffer.endSeq()) > 0) { respond(400, "Bad Request", "{\"error\":\"cursor\"}"); return; } // Além do que existe
+        size_t n = _buffer.release(cursor); // Libera seq < cursor
+        _stats.released += (uint32_t)n; // Métrica
+        if (n && _onRelease) _onRelease(n); // Persiste o snapshot
+        snprintf(body, sizeof(body), "{\"released\":%u,\"first\":%lu,\"pending\":%u}", // Estado após o ack
+                 (unsigned)n, (unsigned long)_buffer.firstSeq(), (unsigned)_buffer.size()); // ...
+        LOG_INFO("Coleta LAN: ack liberou %u (pendentes=%u)", (unsigned)n, (unsigned)_buffer.size()); // Diagnóstico
+        respond(200, "OK", body); // Responde e fecha
+        return; // Atendido
+    }
+    bool known = strcmp(target, "/status") == 0 || strcmp(target, "/backlog") == 0 || strcmp(target, "/ack") == 0; // Rota existe?
+    if (known) respond(405, "Method Not Allowed", "{\"error\":\"method\"}"); // Método errado
+    else respond(404, "Not Found", "{\"error\":\"route\"}"); // Rota desconhecida
+} // fim: dispatch()
+
+// streamChunks(): monta registros NDJSON em _chunk e envia até LAN_PULL_CHUNKS_PER_LOOP chunks
+void LanPullServer::streamChunks() { // Início: streamChunks()
+    for (int k = 0; k < LAN_PULL_CHUNKS_PER_LOOP; ++k) { // Fatia desta iteração
+        if (!_client.connected()) { finish(false); return; } // Cliente saiu
+        uint32_t first = _buffer.firstSeq(); // A fila pode ter andado entre iterações (nuvem, overflow)
+        if ((int32_t)(_nextSeq - first) < 0) { // Registros já saíram da fila
+            uint32_t to = ((int32_t)(first - _endSeq) < 0) ? first : _endSeq; // Não passa do fim do stream
+            _stats.skipped += to - _nextSeq; // Lacuna visível ao coletor pelo seq
+            _nextSeq = to; // Continua do mais antigo ainda presente
+        }
+        uint32_t end = _buffer.endSeq(); // Fim atual da fila
+        uint32_t stop = ((int32_t)(_endSeq - end) < 0) ? _endSeq : end; // min(fim do stream, fim da fila)
+        char *data = _chunk + kChunkHead; // Dados após o espaço do tamanho
+        size_t len = 0; // Bytes no chunk
+        uint32_t recs = 0; // Registros no chunk
+        while (_nextSeq != stop) { // Enche o chunk
+            UidEntry e; // Registro
+            if (!_buffer.getAt(_nextSeq - first, e)) break; // Defensivo (não ocorre: índice < size)
+#if RFID_BLOCK_READ // Conteúdo do bloco junto
+            int n = snprintf(data + len, LAN_PULL_CHUNK_BYTES - len, // Uma linha NDJSON
+                             "{\"seq\":%lu,\"uid\":\"%s\",\"capture_timestamp_ms\":%lu,\"card_data\":\"%s\"}\n", // ...
+                             (unsigned long)_nextSeq, e.uid, (unsigned long)e.capture_ms, e.data); // ...
+#else // Só a UID
+            int n = snprintf(data + len, LAN_PULL_CHUNK_BYTES - len, // Uma linha NDJSON
+                             "{\"seq\":%lu,\"uid\":\"%s\",\"capture_timestamp_ms\":%lu}\n", // ...
+                             (unsigned long)_nextSeq, e.uid, (unsigned long)e.capture_ms); // ...
+#endif // fim: RFID_BLOCK_READ
+            if (n < 0 || len + (size_t)n >= LAN_PULL_CHUNK_BYTES) break; // Não coube: fica para o próximo chunk
+            len += (size_t)n; // Confirma a linha
+            _nextSeq++; // Próximo
+            recs++; // Conta
+        }
+        if (len == 0) { // Nada mais a enviar: linha final com o cursor e chunk de término
+            int n = snprintf(data, LAN_PULL_CHUNK_BYTES, "{\"next\":%lu,\"epoch\":%lu,\"records\":%lu}\n", // Cursor para o ack
+                             (unsigned long)_nextSeq, (unsigned long)_epoch, (unsigned long)_sent); // ...
+            if (!writeChunk((size_t)n) || _client.write((const uint8_t *)"0\r\n\r\n", 5) != 5) { finish(false); return; } // Término
+            _stats.streams++; // Stream concluído
+            _stats.lastStreamMs = _clock.nowMs() - _streamStartMs; // Duração
+            _stats.lastStreamRecords = _sent; // Tamanho
+            LOG_INFO("Coleta LAN: %lu registros em %lu ms (next=%lu)", (unsigned long)_sent, // Diagnóstico
+                     (unsigned long)_stats.lastStreamMs, (unsigned long)_nextSeq); // ...
+            finish(true); // Fecha a conexão
+            return; // Fim
+        }
+        if (!writeChunk(len)) { finish(false); return; } // Escrita falhou
+        _sent += recs; // Registros do stream
+        _stats.records += recs; // Métrica global
+        _stats.bytes += (uint32_t)len; // ...
+    }
+} // fim: streamChunks()
+
+// writeChunk(): "<tamanho hex>\r\n<dados>\r\n" num único write (tamanho escrito antes dos dados)
+bool LanPullServer::writeChunk(size_t len) { // Início: writeChunk()
+    char head[kChunkHead + 1]; // Tamanho em hex + CRLF
+    int h = snprintf(head, sizeof(head), "%X\r\n", (unsigned)len); // Ex.: "3FA\r\n"
+    char *start = _chunk + kChunkHead - h; // Cabeçalho encostado nos dados
+    memcpy(start, head, (size_t)h); // Sem cópia dos dados
+    _chunk[kChunkHead + len] = '\r'; // CRLF final do chunk
+    _chunk[kChunkHead + len + 1] = '\n'; // ...
+    size_t total = (size_t)h + len + 2; // Bytes do chunk
+    return _client.write((const uint8_t *)start, total) == total; // Escrita completa?
+} // fim: writeChunk()
+
+// respond(): resposta curta com Content-Length; fecha a conexão
+void LanPullServer::respond(int code, const char *reason, const char *json) { // Início: respond()
+    if (code >= 400) _stats.rejected++; // Conta recusa
+    int n = snprintf(_chunk, sizeof(_chunk), // Cabeçalho + corpo
+                     "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\nContent-Length: %u\r\nConnection: close\r\n\r\n%s", // ...
+                     code, reason, (unsigned)strlen(json), json); // ...
+    if (n > 0) _client.write((const uint8_t *)_chunk, (size_t)n); // Melhor esforço
+    finish(true); // Fecha
+} // fim: respond()
+
+// finish(): encerra o atendimento; ok=false em stream conta como interrompido
+void LanPullServer::finish(bool ok) { // Início: finish()
+    if (!ok && _state == PullState::STREAM) { // Stream incompleto
+        _stats.aborted++; // Métrica
+        LOG_ERROR("Coleta LAN interrompida apos %lu registros", (unsigned long)_sent); // Coletor pede de novo (from=)
+    }
+    _client.stop(); // Fecha o socket
+    _state = PullState::IDLE; // Próximo cliente
+    _served = true; // Sessão de coleta em andamento
+    _lastServedMs = _clock.nowMs(); // Início da pausa dos POSTs (LAN_PULL_HOLD_MS)
+} // fim: finish()
+
+// authorized(): exige "Authorization: Bearer <LAN_PULL_TOKEN>" (sem token: ninguém)
+bool LanPullServer::authorized() const { // Início: authorized()
+#ifdef LAN_PULL_TOKEN // Token configurado em ProjectConfig.h
+    static const char kToken[] = LAN_PULL_TOKEN; // Segredo compartilhado
+    const size_t tl = sizeof(kToken) - 1; // Tamanho do token
+    for (const char *p = strstr(_req, "\r\n"); p; p = strstr(p, "\r\n")) { // Cada linha de cabeçalho
+        p += 2; // Início da linha
+        if (strncasecmp(p, "Authorization:", 14) != 0) continue; // Outro cabeçalho
+        const char *v = p + 14; // Valor
+        while (*v == ' ') ++v; // Espaços
+        if (strncmp(v, "Bearer ", 7) != 0) return false; // Esquema errado
+        v += 7; // Token recebido
+        size_t vl = strcspn(v, "\r"); // Tamanho recebido (até o fim da linha)
+        uint8_t diff = (uint8_t)(vl != tl); // Tamanho diferente já reprova, sem sair antes
+        for (size_t i = 0; i < tl; ++i) diff |= (uint8_t)(kToken[i] ^ (i < vl ? v[i] : 0)); // Sem desvio por byte (não vaza a posição do erro)
+        return diff == 0; // Igual e completo
+    }
+    return false; // Sem cabeçalho
+#else // Sem token (só possível com LAN_PULL_ENABLE=0): fecha
+    return false; // Recusado
+#endif // fim: LAN_PULL_TOKEN
+} // fim: authorized()
+
+// queryUInt(): valor inteiro de "key=" na query ("a=1&b=2"); false se ausente ou não numérico
+bool LanPullServer::queryUInt(const char *query, const char *key, uint32_t &out) { // Início: queryUInt()
+    size_t kl = strlen(key); // Tamanho da chave
+    for (const char *p = query; p && *p; ) { // Cada par
+        if (strncmp(p, key, kl) == 0 && p[kl] == '=') { // Chave encontrada
+            const char *v = p + kl + 1; // Valor
+            if (*v < '0' || *v > '9') return false; // Não numérico
+            out = (uint32_t)strtoul(v, nullptr, 10); // Converte
+            return true; // Sucesso
+        }
+        p = strchr(p, '&'); // Próximo par
+        if (p) ++p; // Após '&'
+    }
+    return false; // Ausente
+} // fim: queryUInt()
@@ -0,0 +1,245 @@
+/*
+    Arquivo: src/MemTelemetry.cpp
+    Propósito: Implementa a telemetria de memória. No ESP32 usa heap_caps_* e
+    uxTaskGetStackHighWaterMark; no host usa um heap simulado (MEM_HOST_HEAP_BYTES,
+    roteirizável por hostSetHeap()) e,
+    com MEM_HOST_WRAP_MALLOC=1 (link com -Wl,--wrap=malloc,--wrap=free,--wrap=calloc,
+    --wrap=realloc; ligado pelo tools/CMakeLists.txt no Linux), conta cada
+    alocação e a atribui ao MemScope ativo.
+*/
+
+#include "MemTelemetry.h" // Declarações de MemTelemetry/MemScope
+#include <string.h> // memset
+
+#ifdef ARDUINO // Firmware (ESP32)
+#include <Arduino.h> // Tipos Arduino
+#include <esp_heap_caps.h> // heap_caps_get_free_size, largest_free_block, get_info
+#include <freertos/FreeRTOS.h> // Tipos FreeRTOS
+#include <freertos/task.h> // uxTaskGetStackHighWaterMark, xTaskGetHandle
+#include "Log.h" // Macros de log
+#else // Host (simulação/testes)
+#include "Log.h" // Macros de log (Serial simulado: silencioso com hostSerialQuiet)
+#include <stdlib.h> // malloc
+#include <malloc.h> // malloc_usable_size (glibc)
+#include <new> // std::bad_alloc
+#ifndef MEM_HOST_HEAP_BYTES // Heap simulado no host
+#define MEM_HOST_HEAP_BYTES (320u * 1024u) // Ordem de grandeza da DRAM livre do ESP32 (bytes)
+#endif // fim: MEM_HOST_HEAP_BYTES default
+#endif // fim: ARDUINO
+
+// Tasks de sistema acompanhadas além da task do loop (procuradas por nome)
+static const char *const kSystemTasks[] = { "tiT", "wifi", "sys_evt" }; // lwIP, driver Wi‑Fi, eventos
+
+static MemSiteStats g_sites[(size_t)MemSite::COUNT]; // Estatísticas por site
+static MemSite g_activeSite = MemSite::COUNT; // Site ativo (COUNT = nenhum)
+
+#ifdef ARDUINO // Primitivas de heap no ESP32
+static uint32_t heapFree() { return heap_caps_get_free_size(MALLOC_CAP_8BIT); } // Heap livre
+static uint32_t heapLargest() { return heap_caps_get_largest_free_block(MALLOC_CAP_8BIT); } // Maior bloco
+static uint32_t heapMinFree() { return heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT); } // Mínimo histórico
+// Blocos/bytes alocados no momento (percorre o heap: usar só nas bordas dos trechos)
+static void heapInUse(uint32_t &blocks, uint32_t &bytes) { // multi_heap_info_t agregado
+    multi_heap_info_t info; // Estrutura de informações do heap
+    heap_caps_get_info(&info, MALLOC_CAP_8BIT); // Soma de todas as regiões 8-bit
+    blocks = (uint32_t)info.allocated_blocks; // Blocos em uso
+    bytes = (uint32_t)info.total_allocated_bytes; // Bytes em uso
+}
+static uint32_t stackFree(void *h) { return (uint32_t)uxTaskGetStackHighWaterMark((TaskHandle_t)h); } // Bytes (StackType_t = uint8_t no ESP32)
+static void *currentTask() { return (void *)xTaskGetCurrentTaskHandle(); } // Task do loop
+static void *taskByName(const char *n) { return (void *)xTaskGetHandle(n); } // NULL se inexistente
+#else // Heap simulado no host
+static uint32_t g_hostAllocs = 0; // Alocações totais (contagem exata com o wrap)
+static uint64_t g_hostAllocBytes = 0; // Bytes alocados acumulados
+static uint64_t g_hostFreedBytes = 0; // Bytes liberados acumulados
+// O wrap vê o processo inteiro (estruturas do simulador incluídas): serve só à atribuição
+// por trecho (deltas no MemScope); o heap que orienta a saúde é o roteirizado abaixo.
+static uint32_t g_hostHeapFree = MEM_HOST_HEAP_BYTES; // Heap simulado livre (hostSetHeap)
+static uint32_t g_hostHeapLargest = MEM_HOST_HEAP_BYTES; // Maior bloco simulado (fragmentação roteirizada)
+static uint32_t g_hostHeapMin = MEM_HOST_HEAP_BYTES; // Menor heap livre já roteirizado
+static uint32_t heapFree() { return g_hostHeapFree; } // Heap simulado livre
+static uint32_t heapLargest() { return g_hostHeapLargest; } // Maior bloco simulado
+static uint32_t heapMinFree() { return g_hostHeapMin; } // Mínimo histórico
+static void heapInUse(uint32_t &allocs, uint32_t &bytes) { // Contagem exata (diferença módulo 2^32: só deltas importam)
+    allocs = g_hostAllocs; // Alocações desde o início do processo
+    bytes = (uint32_t)(g_hostAllocBytes - g_hostFreedBytes); // Bytes retidos
+}
+static uint32_t stackFree(void *) { return 0; } // Sem tasks no host
+static void *currentTask() { return nullptr; } // Sem tasks no host
+static void *taskByName(const char *) { return nullptr; } // Sem tasks no host
+#endif // fim: primitivas por plataforma
+
+// Construtor: zera amostras e tasks
+MemTelemetry::MemTelemetry() // Estado inicial
+    : _health(MemHealth::OK), _taskCount(0), _lastSample(0), _lastReport(0) { // Saudável até a 1ª amostra
+    memset(&_last, 0, sizeof(_last)); // Sem amostra
+    memset(_tasks, 0, sizeof(_tasks)); // Sem tasks
+}
+
+// begin(): registra a task do loop e as tasks de sistema; tira a primeira amostra
+void MemTelemetry::begin() { // Chamado no boot pelo AppController
+    watch(currentTask(), "loopTask"); // Task que executa setup()/loop()
+    for (const char *n : kSystemTasks) watch(nullptr, n); // Handles resolvidos por nome na amostragem
+    sample(); // Primeira amostra
+    updateHealth(); // Nível inicial
+}
+
+// loop(): amostra a cada MEM_SAMPLE_INTERVAL_MS e relata a cada MEM_REPORT_INTERVAL_MS
+void MemTelemetry::loop(uint32_t now) { // Barato quando fora da janela
+    if (now - _lastSample < MEM_SAMPLE_INTERVAL_MS) return; // Fora da janela de amostragem
+    _lastSample = now; // Marca amostra
+    MemHealth before = _health; // Nível anterior (para log de transição)
+    sample(); // Lê heap e pilhas
+    updateHealth(); // Aplica limiares
+    if (_health != before) { // Transição de nível
+        LOG_INFO("Memoria: %s (livre=%lu maiorBloco=%lu)", _health == MemHealth::OK ? "OK" : // Loga transição
+                 (_health == MemHealth::DEGRADED ? "DEGRADADA" : "CRITICA"),
+                 (unsigned long)_last.freeHeap, (unsigned long)_last.largestBlock);
+    }
+#if MEM_REPORT_INTERVAL_MS > 0 // Relatório periódico habilitado em build
+    if (now - _lastReport >= MEM_REPORT_INTERVAL_MS) { // Hora do relatório
+        _lastReport = now; // Marca relatório
+        report(); // Resumo no log
+    }
+#endif // fim: MEM_REPORT_INTERVAL_MS
+}
+
+// canAfford(): checagem imediata do maior bloco livre
+bool MemTelemetry::canAfford(size_t bytes) { return heapLargest() >= bytes; } // true se cabe contíguo
+
+#ifndef ARDUINO // Heap roteirizado no host
+// hostSetHeap(): define heap livre e maior bloco vistos pelas próximas amostras
+void MemTelemetry::hostSetHeap(uint32_t freeBytes, uint32_t largestBlock) { // Início: hostSetHeap()
+    g_hostHeapFree = freeBytes; // Heap livre
+    g_hostHeapLargest = largestBlock < freeBytes ? largestBlock : freeBytes; // Bloco nunca maior que o livre
+    if (freeBytes < g_hostHeapMin) g_hostHeapMin = freeBytes; // Mínimo histórico
+} // fim: hostSetHeap()
+#endif // fim: ARDUINO
+
+// site(): estatísticas acumuladas do site
+const MemSiteStats &MemTelemetry::site(MemSite s) { return g_sites[(size_t)s]; } // Acesso somente leitura
+
+// siteName(): nome legível do site
+const char *MemTelemetry::siteName(MemSite s) { // Para relatórios
+    switch (s) { // Mapeia enum -> texto
+        case MemSite::HTTP_SEND: return "http_send"; // Envio HTTP
+        case MemSite::PERSIST_SAVE: return "persist_save"; // Snapshot NVS
+        case MemSite::PERSIST_LOAD: return "persist_load"; // Restauração NVS
+        case MemSite::CONFIG_FETCH: return "config_fetch"; // Download da configuração
+        default: return "?"; // Índice inválido
+    }
+}
+
+// watch(): adiciona uma task à lista (handle pode ser resolvido depois por nome)
+void MemTelemetry::watch(void *handle, const char *name) { // Ignora quando a lista está cheia
+    if (_taskCount >= MEM_WATCH_TASK_MAX) return; // Sem espaço
+    WatchedTask &t = _tasks[_taskCount++]; // Próximo slot
+    t.handle = handle; // Handle FreeRTOS (ou nullptr)
+    t.stats.name = name; // Nome da task
+    t.stats.stackFreeMin = 0; // Sem leitura ainda
+}
+
+// sample(): lê heap e marca d'água das pilhas
+void MemTelemetry::sample() { // Custo O(1) no heap + O(tasks)
+    _last.freeHeap = heapFree(); // Heap livre
+    _last.largestBlock = heapLargest(); // Maior bloco contíguo
+    _last.minFreeHeap = heapMinFree(); // Mínimo histórico
+    _last.fragPct = _last.freeHeap ? (uint8_t)(100 - (uint64_t)_last.largestBlock * 100 / _last.freeHeap) : 100; // Fragmentação (%)
+    for (size_t i = 0; i < _taskCount; ++i) { // Atualiza pilhas
+        WatchedTask &t = _tasks[i]; // Task i
+        if (!t.handle) t.handle = taskByName(t.stats.name); // Task de sistema criada depois do boot
+        if (t.handle) t.stats.stackFreeMin = stackFree(t.handle); // Marca d'água (mínimo desde a criação)
+    } // fim: laço de tasks
+}
+
+// updateHealth(): limiares com histerese de 25% para evitar oscilação
+void MemTelemetry::updateHealth() { // OK <-> DEGRADED <-> CRITICAL
+    uint32_t blk = _last.largestBlock; // Maior bloco livre
+    uint32_t fre = _last.freeHeap; // Heap livre
+    bool critical = blk < MEM_CRITICAL_BLOCK_BYTES || fre < MEM_CRITICAL_FREE_BYTES; // Entrada em CRITICAL
+    bool degraded = blk < MEM_DEGRADED_BLOCK_BYTES; // Entrada em DEGRADED
+    if (critical) { _health = MemHealth::CRITICAL; return; } // Piora imediata
+    if (_health == MemHealth::CRITICAL && // Saída de CRITICAL exige folga
+        (blk < MEM_CRITICAL_BLOCK_BYTES * 5 / 4 || fre < MEM_CRITICAL_FREE_BYTES * 5 / 4)) return; // Permanece
+    if (degraded) { _health = MemHealth::DEGRADED; return; } // Entrada em DEGRADED
+    if (_health != MemHealth::OK && blk < MEM_DEGRADED_BLOCK_BYTES * 5 / 4) { _health = MemHealth::DEGRADED; return; } // Folga insuficiente
+    _health = MemHealth::OK; // Recuperado
+}
+
+// report(): resumo do heap, pilhas e sites no log
+void MemTelemetry::report() const { // LOG_INFO em poucas linhas
+    LOG_INFO("Mem: livre=%lu maiorBloco=%lu min=%lu frag=%u%%", (unsigned long)_last.freeHeap, // Heap
+             (unsigned long)_last.largestBlock, (unsigned long)_last.minFreeHeap, (unsigned)_last.fragPct);
+    for (size_t i = 0; i < _taskCount; ++i) { // Pilhas
+        if (!_tasks[i].handle) continue; // Task inexistente
+        LOG_INFO("Mem: pilha %s livreMin=%lu", _tasks[i].stats.name, (unsigned long)_tasks[i].stats.stackFreeMin); // Marca d'água
+    }
+    for (size_t i = 0; i < (size_t)MemSite::COUNT; ++i) { // Sites instrumentados
+        const MemSiteStats &s = g_sites[i]; // Estatísticas do site
+        if (!s.calls) continue; // Site ainda não executado
+        LOG_INFO("Mem: %s chamadas=%lu allocs=%lu retido=%ld quedaBloco=%lu", siteName((MemSite)i), // Resumo do site
+                 (unsigned long)s.calls, (unsigned long)s.allocs, (long)s.netBytes, (unsigned long)s.worstBlockDrop);
+    }
+}
+
+// MemScope: captura o estado do heap na abertura do trecho
+MemScope::MemScope(MemSite site) // Abre o trecho
+    : _site(site), _prevSite(g_activeSite), _prevActive(g_activeSite != MemSite::COUNT) { // Empilha site ativo
+    heapInUse(_allocsBefore, _bytesBefore); // Contadores na abertura
+    _blockBefore = heapLargest(); // Maior bloco na abertura
+    g_activeSite = site; // Alocações passam a ser atribuídas a este site
+}
+
+// ~MemScope: acumula deltas no site
+MemScope::~MemScope() { // Fecha o trecho
+    uint32_t allocs, bytes; // Contadores no fechamento
+    heapInUse(allocs, bytes); // Lê contadores
+    uint32_t block = heapLargest(); // Maior bloco no fechamento
+    MemSiteStats &s = g_sites[(size_t)_site]; // Estatísticas do site
+    s.calls++; // Conta execução
+#ifdef ARDUINO // ESP32: blocos líquidos retidos pelo trecho
+    if (allocs > _allocsBefore) s.allocs += allocs - _allocsBefore; // Blocos a mais após o trecho
+#else // Host: contagem exata de chamadas a malloc/calloc/realloc
+    s.allocs += allocs - _allocsBefore; // Alocações durante o trecho
+#endif // fim: contagem por plataforma
+    s.netBytes += (int32_t)(bytes - _bytesBefore); // Bytes retidos (negativo: trecho liberou)
+    if (_blockBefore > block && _blockBefore - block > s.worstBlockDrop) s.worstBlockDrop = _blockBefore - block; // Pior queda
+    g_activeSite = _prevActive ? _prevSite : MemSite::COUNT; // Restaura site anterior
+}
+
+#if !defined(ARDUINO) && MEM_HOST_WRAP_MALLOC // Host: intercepta o alocador (link com --wrap)
+extern "C" { // Símbolos C do linker
+void *__real_malloc(size_t); // malloc original
+void __real_free(void *); // free original
+void *__real_calloc(size_t, size_t); // calloc original
+void *__real_realloc(void *, size_t); // realloc original
+
+static void hostNoteAlloc(void *p) { // Conta alocação bem-sucedida
+    if (!p) return; // Falha: nada a contar
+    g_hostAllocs++; // Contagem exata
+    g_hostAllocBytes += malloc_usable_size(p); // Tamanho real do bloco
+}
+
+void *__wrap_malloc(size_t n) { void *p = __real_malloc(n); hostNoteAlloc(p); return p; } // malloc contado
+void *__wrap_calloc(size_t c, size_t n) { void *p = __real_calloc(c, n); hostNoteAlloc(p); return p; } // calloc contado
+void __wrap_free(void *p) { // free contado
+    if (p) g_hostFreedBytes += malloc_usable_size(p); // Bytes devolvidos
+    __real_free(p); // Libera de fato
+}
+void *__wrap_realloc(void *p, size_t n) { // realloc = free + malloc para a contabilidade
+    size_t old = p ? malloc_usable_size(p) : 0; // Tamanho anterior
+    void *q = __real_realloc(p, n); // Realoca
+    if (!q) return q; // Falha: bloco antigo intacto
+    g_hostFreedBytes += old; // Bloco antigo devolvido
+    hostNoteAlloc(q); // Bloco novo contado
+    return q; // Novo ponteiro
+}
+} // extern "C"
+
+// operator new/delete do host passam por malloc/free (as chamadas de libstdc++.so não seriam interceptadas)
+void *operator new(size_t n) { void *p = malloc(n ? n : 1); if (!p) throw std::bad_alloc(); return p; } // new contado
+void *operator new[](size_t n) { void *p = malloc(n ? n : 1); if (!p) throw std::bad_alloc(); return p; } // new[] contado
+void operator delete(void *p) noexcept { free(p); } // delete contado
+void operator delete[](void *p) noexcept { free(p); } // delete[] contado
+void operator delete(void *p, size_t) noexcept { free(p); } // delete dimensionado
+void operator delete[](void *p, size_t) noexcept { free(p); } // delete[] dimensionado
+#endif // fim: wrap do alocador no host
@@ -1,14 +1,348 @@
 /*
     Arquivo: src/NetManager.cpp
-    Propósito: Unidade de compilação associada a NetManager.h. A maior parte da
-    lógica está inline no header por simplicidade/eficiência; este arquivo existe
-    para permitir mover implementações mais pesadas para cá no futuro sem quebrar
-    pontos de inclusão.
+    Propósito: Implementa o NetManager: reconexão Wi‑Fi com backoff exponencial
+    + jitter e caminho rápido de reconexão. O último link bom (BSSID, canal e
+    lease DHCP) é salvo na NVS; numa queda, tenta-se primeiro uma conexão
+    direcionada a esse AP (sem varredura e, opcionalmente, sem DHCP) e, se não
+    houver IP dentro de WIFI_FAST_CONNECT_TIMEOUT_MS, cai para a varredura completa.
+    O lease só é reaproveitado se veio de um DHCP deste boot e ainda não passou da
+    metade de WIFI_DHCP_LEASE_MS; falha de HTTP/DNS logo após reaproveitá-lo força DHCP.
+    Os tempos de cada fase (link e DHCP) ficam disponíveis em stats().
+    Com mais de uma rede em WIFI_NETWORKS, o AP é escolhido por varredura
+    assíncrona e, conectado, o RSSI é checado periodicamente: link degradado
+    dispara nova varredura e roaming com histerese (regras em NetSelector).
 */
 
 #include "NetManager.h" // Declarações da classe NetManager
 #include "Log.h" // Macros de log (consistência com o header)
 
-// Nota: Hoje a implementação de NetManager está no header (leve/inline)
-// Este arquivo existe como ponto de extensão: se a lógica crescer, mova métodos
-// para cá para manter o header enxuto e reduzir recompilações
+#ifdef WIFI_STATIC_IP // IP fixo configurado: completa campos opcionais
+#ifndef WIFI_STATIC_GATEWAY // Gateway é obrigatório com IP fixo
+#error "WIFI_STATIC_IP requer WIFI_STATIC_GATEWAY"
+#endif // fim: checagem de WIFI_STATIC_GATEWAY
+#ifndef WIFI_STATIC_SUBNET // Máscara padrão /24
+#define WIFI_STATIC_SUBNET "255.255.255.0" // Máscara de sub-rede padrão
+#endif // fim: WIFI_STATIC_SUBNET default
+#ifndef WIFI_STATIC_DNS // DNS padrão: o próprio gateway
+#define WIFI_STATIC_DNS WIFI_STATIC_GATEWAY // DNS primário
+#endif // fim: WIFI_STATIC_DNS default
+#endif // fim: WIFI_STATIC_IP
+
+// Lista de redes candidatas: WIFI_NETWORKS (ProjectConfig.h) ou o par único WIFI_SSID/WIFI_PASSWORD
+#ifdef WIFI_NETWORKS // Várias redes configuradas
+static const WifiCandidate kNetworks[] = WIFI_NETWORKS; // Ex.: { {"A","senhaA"}, {"B","senhaB"} }
+#else // Configuração clássica de rede única
+static const WifiCandidate kNetworks[] = { { WIFI_SSID, WIFI_PASSWORD } }; // Rede única
+#endif // fim: WIFI_NETWORKS
+static const uint8_t kNetworkCount = (uint8_t)(sizeof(kNetworks) / sizeof(kNetworks[0])); // Nº de candidatas
+
+// Construtor: configura tempos de backoff e estado inicial
+NetManager::NetManager(unsigned long baseRetryMs, unsigned long maxRetryMs, Clock &clock) // Construtor com tempos configuráveis
+    : _clock(clock), // Relógio injetado
+    _baseRetry(baseRetryMs), // Tempo base para backoff exponencial (ms)
+    _maxRetry(maxRetryMs), // Tempo máximo entre tentativas (ms)
+    _currentWait(baseRetryMs), // Janela atual de espera para próxima tentativa (ms)
+    _lastAttempt(0), // Timestamp (ms) da última tentativa
+    _onConnect(nullptr), // Callback para evento de conexão (opcional)
+    _onDisconnect(nullptr), // Callback para evento de desconexão (opcional)
+    _wasConnected(false), // Memória do estado anterior (conectado?)
+    _fastPending(false), // Nenhuma tentativa rápida em andamento
+    _roamPending(false), // Nenhum roaming em andamento
+    _fastSuppressed(false), // Caminho rápido liberado até falhar
+    _scanning(false), // Nenhuma varredura em curso
+    _lastRssiCheck(0), // Checagem de RSSI ainda não feita
+    _connectedAt(0), // Ainda não conectou
+    _leaseBoot(false), // Primeira conexão do boot sempre passa por DHCP
+    _leaseTry(false), // Nenhuma tentativa com lease
+    _leaseInUse(false), // Link atual (nenhum) não usa lease em cache
+    _selector(kNetworks, kNetworkCount), // Candidatas e regras de roaming padrão
+    _tBegin(0), _tLink(0), _tGotIp(0) { // Marcas de tempo das fases zeradas
+    memset(&_cache, 0, sizeof(_cache)); // Cache vazio (valid=false)
+    memset(&_stats, 0, sizeof(_stats)); // Métricas zeradas
+}
+
+// begin(): configura o Wi‑Fi, carrega o cache de link e dispara a primeira tentativa
+void NetManager::begin() { // Configura Wi‑Fi e inicia a primeira tentativa
+    WiFi.mode(WIFI_STA); // Define modo estação (cliente)
+    WiFi.setAutoReconnect(false); // Desliga auto-reconexão para controlar backoff manualmente
+    WiFi.persistent(false); // Evita gravar credenciais na flash
+    registerEvents(); // Mede as fases da conexão via eventos do driver
+    loadCache(); // Recupera último BSSID/canal/lease bons (se houver)
+    attemptConnect(); // Primeira tentativa imediata de conexão
+}
+
+// loop(): detecta transições, controla o prazo do caminho rápido e agenda novas tentativas
+void NetManager::loop() { // Chamar frequentemente no loop principal
+    bool connected = isConnected(); // Captura estado atual da conexão
+    if (connected && !_wasConnected) { // Transição: desconectado -> conectado
+        bool roamed = _roamPending; // recordConnected() encerra a tentativa
+        recordConnected(); // Consolida tempos por fase e atualiza cache
+        LOG_INFO("Wi-Fi conectado: %s (%s, link=%lums dhcp=%lums total=%lums)", // Loga IP e latências
+                 WiFi.localIP().toString().c_str(), roamed ? "roaming" : _stats.lastWasFast ? "rapido" : "completo",
+                 (unsigned long)_stats.lastLinkMs, (unsigned long)_stats.lastDhcpMs,
+                 (unsigned long)_stats.lastTotalMs);
+        _currentWait = _baseRetry; // Reseta janela de backoff ao básico
+        if (_onConnect) _onConnect(); // Dispara callback de conexão (se definido)
+    } else if (!connected && _wasConnected) { // Transição: conectado -> desconectado
+        LOG_ERROR("Wi-Fi desconectado"); // Loga perda de conexão
+        if (_onDisconnect) _onDisconnect(); // Dispara callback de desconexão (se definido)
+        if (!_fastPending) _lastAttempt = _clock.nowMs() - _currentWait; // Queda breve: reconecta já (roaming já tem alvo)
+    }
+    _wasConnected = connected; // Atualiza memória do estado anterior
+    unsigned long now = _clock.nowMs(); // Leitura do tempo atual (ms desde boot)
+    if (_scanning) { pollScan(); return; } // Varredura em curso: só consome o resultado quando pronto
+    if (connected) { serviceRoaming(now); return; } // Conectado: apenas vigia a qualidade do link
+    if (_fastPending) { // Tentativa rápida em andamento
+        if (now - _lastAttempt < WIFI_FAST_CONNECT_TIMEOUT_MS) return; // Ainda dentro do prazo
+        LOG_INFO("%s expirou; varredura completa", _roamPending ? "Roaming" : "Reconexao rapida"); // Cache desatualizado (AP mudou?) ou AP novo sem resposta
+        if (_roamPending) _stats.roamFallbacks++; // Conta a troca malsucedida
+        else _stats.fullFallbacks++; // Conta o fallback do caminho rápido
+        _fastPending = false; // Encerra a tentativa rápida
+        _roamPending = false; // Encerra o roaming
+        _fastSuppressed = true; // Não insiste no cache até a próxima conexão bem-sucedida
+        WiFi.disconnect(); // Aborta a associação direcionada em curso
+        connectFull(); // Fallback imediato (não consome janela de backoff)
+        return; // Próxima decisão no próximo loop
+    }
+    if (now - _lastAttempt >= _currentWait) { // Se já passou a janela de espera
+        attemptConnect(); // Faz nova tentativa de conexão
+        if (!_fastPending && !_scanning) backoffGrow(); // Cresce janela só nas tentativas completas
+    }
+}
+
+// attemptConnect(): escolhe o caminho rápido quando há cache válido; senão, completo
+void NetManager::attemptConnect() { // Realiza uma tentativa de conexão
+    LOG_DEBUG("Tentando conectar Wi‑Fi (espera=%lums)", _currentWait); // Log de tentativa
+    if (WiFi.status() == WL_CONNECTED) return; // Evita begin() redundante quando já conectado
+#if WIFI_FAST_CONNECT // Caminho rápido habilitado em build
+    if (_cache.valid && !_fastSuppressed && _cache.net < kNetworkCount) { // Há BSSID/canal utilizáveis
+        beginTargeted(_cache, leaseUsable(), true); // Tentativa direcionada
+        return; // Prazo controlado em loop()
+    }
+#endif // fim: WIFI_FAST_CONNECT
+    connectFull(); // Sem cache: caminho completo
+}
+
+// connectFull(): rede única -> begin direto; várias redes -> varredura para escolher o AP
+void NetManager::connectFull() { // Caminho completo
+    if (kNetworkCount > 1) { startScan(); return; } // Escolha por RSSI após a varredura
+    beginFull(0); // Rede única: o driver faz a varredura de canais
+}
+
+// beginFull(): varredura de todos os canais + DHCP (ou IP fixo configurado)
+void NetManager::beginFull(uint8_t net) { // WiFi.begin(ssid, senha)
+    _lastAttempt = _clock.nowMs(); // Marca hora da tentativa (ms)
+    _tBegin = _lastAttempt; _tLink = 0; _tGotIp = 0; // Reinicia cronômetro das fases
+    _stats.attempts++; // Conta tentativa
+    _leaseTry = false; // Endereço novo do DHCP (ou IP fixo)
+    applyIpConfig(nullptr); // IP fixo (se configurado) ou DHCP
+    const WifiCandidate &c = _selector.candidate(net); // Credenciais da rede
+    WiFi.begin(c.ssid, c.password); // Inicia/repete conexão com credenciais
+}
+
+// beginTargeted(): associação direta a um AP conhecido (sem varredura)
+void NetManager::beginTargeted(const LinkCache &t, bool reuseLease, bool fast, bool roam) { // WiFi.begin(ssid, senha, canal, bssid)
+    _lastAttempt = _clock.nowMs(); // Marca hora da tentativa (ms)
+    _tBegin = _lastAttempt; _tLink = 0; _tGotIp = 0; // Reinicia cronômetro das fases
+    _stats.attempts++; // Conta tentativa
+    if (fast && !roam) _stats.fastAttempts++; // Conta tentativa rápida (roaming já contado em roams)
+    _fastPending = fast; // loop() vigia o prazo WIFI_FAST_CONNECT_TIMEOUT_MS
+    _roamPending = roam; // Sucesso/expiração vão para os contadores de roaming
+    _leaseTry = reuseLease; // recordConnected() sabe se houve DHCP
+    applyIpConfig(reuseLease ? &t : nullptr); // Reaproveita lease quando permitido
+    const WifiCandidate &c = _selector.candidate(t.net); // Credenciais da rede alvo
+    LOG_DEBUG("Conexao direcionada: %s canal=%ld bssid=%02X:%02X:%02X:%02X:%02X:%02X", // Detalhe do alvo
+              c.ssid, (long)t.channel, t.bssid[0], t.bssid[1], t.bssid[2],
+              t.bssid[3], t.bssid[4], t.bssid[5]);
+    WiFi.begin(c.ssid, c.password, t.channel, t.bssid, true); // Associação direcionada
+}
+
+// leaseUsable(): lease do cache ainda confiável para pular o DHCP
+bool NetManager::leaseUsable() const { // Início: leaseUsable()
+    if (!WIFI_REUSE_DHCP_LEASE || !_leaseBoot) return false; // Desligado ou ainda sem DHCP neste boot
+    if (_cache.ip == 0 || _cache.leaseMs == 0) return false; // Sem lease (IP fixo ou cache antigo)
+    return (uint32_t)(_clock.nowMs() - _cache.leaseAtMs) < _cache.leaseMs / 2; // Antes do T1: o servidor ainda reserva o endereço
+} // fim: leaseUsable()
+
+// reportTransportFailure(): HTTP/DNS falhou; se o link acabou de reaproveitar o lease, força DHCP
+void NetManager::reportTransportFailure() { // Início: reportTransportFailure()
+    if (!_leaseInUse || !isConnected()) return; // Endereço veio do DHCP (ou IP fixo): falha é de outra origem
+    if (_clock.nowMs() - _connectedAt >= WIFI_LEASE_VERIFY_MS) return; // Lease já se mostrou bom
+    LOG_ERROR("Falha de rede logo apos reaproveitar o lease; reconectando com DHCP"); // Conflito de IP provável
+    _leaseInUse = false; // Link atual descartado
+    _leaseBoot = false; // Nada de lease até o próximo DHCP
+    _stats.leaseRevoked++; // Métrica
+    WiFi.disconnect(); // loop() vê a queda e reconecta (caminho rápido, agora com DHCP)
+} // fim: reportTransportFailure()
+
+// applyIpConfig(): IP fixo de configuração > lease em cache > DHCP
+void NetManager::applyIpConfig(const LinkCache *lease) { // Define origem do endereço IP
+#ifdef WIFI_STATIC_IP // IP fixo configurado: sempre pula DHCP
+    IPAddress ip, gw, sn, dns; // Endereços convertidos das strings de configuração
+    ip.fromString(WIFI_STATIC_IP); // IP local
+    gw.fromString(WIFI_STATIC_GATEWAY); // Gateway
+    sn.fromString(WIFI_STATIC_SUBNET); // Máscara
+    dns.fromString(WIFI_STATIC_DNS); // DNS primário
+    WiFi.config(ip, gw, sn, dns); // Aplica configuração estática
+    (void)lease; // Lease em cache é irrelevante com IP fixo
+#else // Sem IP fixo: lease em cache (rápido) ou DHCP
+    if (lease) { // Reaproveita o último lease recebido
+        WiFi.config(IPAddress(lease->ip), IPAddress(lease->gateway), IPAddress(lease->subnet), IPAddress(lease->dns)); // Pula DHCP
+    } else { // Volta ao DHCP
+        WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE); // Zera config estática -> DHCP
+    }
+#endif // fim: WIFI_STATIC_IP
+}
+
+// startScan(): varredura assíncrona; o resultado é consumido em pollScan()
+void NetManager::startScan() { // Não bloqueia o loop principal
+    if (!isConnected()) WiFi.disconnect(); // Para tentativas pendentes (varredura e associação competem pelo rádio)
+    if (WiFi.scanNetworks(true) == WIFI_SCAN_FAILED) { // Driver recusou a varredura
+        LOG_ERROR("Falha ao iniciar varredura Wi-Fi"); // Tenta de novo na próxima janela
+        _lastAttempt = _clock.nowMs(); // Conta como tentativa para o backoff
+        return; // Sem varredura em curso
+    }
+    _scanning = true; // loop() passa a consultar scanComplete()
+    _lastAttempt = _clock.nowMs(); // Janela de backoff conta a partir daqui
+    _stats.scans++; // Conta varredura
+}
+
+// pollScan(): quando a varredura termina, escolhe AP (desconectado) ou decide roaming (conectado)
+void NetManager::pollScan() { // Chamado a cada loop enquanto _scanning
+    int16_t n = WiFi.scanComplete(); // Nº de APs, WIFI_SCAN_RUNNING ou WIFI_SCAN_FAILED
+    if (n == WIFI_SCAN_RUNNING) return; // Ainda varrendo
+    _scanning = false; // Varredura encerrada (com ou sem sucesso)
+    WifiScanResult res[WIFI_SCAN_MAX_RESULTS]; // Cópia compacta dos resultados
+    size_t count = 0; // Resultados copiados
+    for (int16_t i = 0; i < n && count < WIFI_SCAN_MAX_RESULTS; ++i) { // Copia até o limite
+        WifiScanResult &r = res[count++]; // Próximo slot
+        strncpy(r.ssid, WiFi.SSID(i).c_str(), sizeof(r.ssid) - 1); // SSID
+        r.ssid[sizeof(r.ssid) - 1] = '\0'; // Garante terminação NUL
+        const uint8_t *b = WiFi.BSSID(i); // MAC do AP
+        if (b) memcpy(r.bssid, b, sizeof(r.bssid)); else memset(r.bssid, 0, sizeof(r.bssid)); // BSSID
+        r.channel = WiFi.channel(i); // Canal
+        r.rssi = (int8_t)WiFi.RSSI(i); // RSSI (dBm)
+    } // fim: cópia dos resultados
+    WiFi.scanDelete(); // Libera a lista interna do driver
+    if (n < 0) { LOG_ERROR("Varredura Wi-Fi falhou"); return; } // Próxima janela tenta de novo
+
+    NetChoice choice{}; // AP escolhido (zerado: preenchido só quando há alvo)
+    bool roaming = isConnected(); // Varredura feita a partir de um link ativo?
+    if (roaming) { // Varredura de roaming
+        int8_t rssi = (int8_t)WiFi.RSSI(); // Sinal atual
+        const uint8_t *cur = WiFi.BSSID(); // AP atual
+        uint8_t curBssid[6] = {0}; // Cópia segura do BSSID atual
+        if (cur) memcpy(curBssid, cur, sizeof(curBssid)); // Copia BSSID
+        if (!_selector.shouldRoam(rssi, curBssid, res, count, _clock.nowMs(), choice)) return; // Fica no AP atual
+        LOG_INFO("Roaming: %s %ddBm -> %ddBm (canal %ld)", _selector.candidate(choice.candidate).ssid, // Loga a troca
+                 (int)rssi, (int)choice.rssi, (long)choice.channel);
+        _stats.roams++; // Conta roaming
+        WiFi.disconnect(); // Deixa o AP atual
+    } else if (!_selector.pickBest(res, count, choice)) { // Seleção inicial sem AP conhecido
+        LOG_INFO("Nenhuma rede conhecida na varredura (%d APs)", (int)n); // Aguarda próxima janela
+        backoffGrow(); // Espaça a próxima varredura
+        return; // Sem alvo
+    }
+    LinkCache t; // Alvo da associação
+    memset(&t, 0, sizeof(t)); // Sem lease: DHCP no novo AP
+    memcpy(t.bssid, choice.bssid, sizeof(t.bssid)); // BSSID escolhido
+    t.channel = choice.channel; // Canal escolhido
+    t.net = choice.candidate; // Rede escolhida
+    t.valid = true; // Alvo utilizável
+    beginTargeted(t, false, roaming, roaming); // Roaming tem prazo curto (fallback completo); seleção inicial segue o backoff
+    if (!roaming) backoffGrow(); // Seleção inicial conta como tentativa completa
+}
+
+// serviceRoaming(): lê o RSSI periodicamente e agenda varredura quando o link degrada
+void NetManager::serviceRoaming(unsigned long now) { // Só roda conectado e sem varredura em curso
+    if (now - _lastRssiCheck < WIFI_ROAM_CHECK_MS) return; // Respeita o período
+    _lastRssiCheck = now; // Marca checagem
+    _stats.lastRssi = (int8_t)WiFi.RSSI(); // Amostra de qualidade do link
+    if (kNetworkCount < 2 && !WIFI_ROAM_SAME_SSID) return; // Sem alternativa configurada
+    if (!_selector.needsScan(_stats.lastRssi, now)) return; // Link aceitável ou troca recente
+    LOG_DEBUG("RSSI %ddBm abaixo do limiar; varrendo", (int)_stats.lastRssi); // Diagnóstico
+    startScan(); // Busca AP melhor sem bloquear
+}
+
+// backoffGrow(): exponencial com jitter (±10%), limitado por _maxRetry
+void NetManager::backoffGrow() { // Atualiza a janela de espera
+    unsigned long next = _currentWait * 2; // Dobra a janela atual
+    if (next > _maxRetry) next = _maxRetry; // Aplica teto de espera
+    long jitter = (long)(next * 0.1f); // Calcula 10% de jitter (aleatoriedade)
+    long delta = (long)random(-jitter, jitter); // Offset aleatório no intervalo [−jitter, +jitter)
+    long candidate = (long)next + delta; // Soma jitter à janela dobrada
+    if (candidate < (long)_baseRetry) candidate = (long)_baseRetry; // Garante piso no baseRetry
+    _currentWait = (unsigned long)candidate; // Atualiza a janela resultante
+}
+
+// registerEvents(): marca os instantes de associação e obtenção de IP
+void NetManager::registerEvents() { // Handlers rodam na task de eventos do Wi‑Fi
+    // O driver não expõe evento separado para o handshake WPA: STA_CONNECTED
+    // já inclui associação + autenticação (fase "link").
+    WiFi.onEvent([this](WiFiEvent_t, WiFiEventInfo_t) { // Associado e autenticado
+        _tLink = _clock.nowMs(); // Fim da fase de link
+    }, ARDUINO_EVENT_WIFI_STA_CONNECTED);
+    WiFi.onEvent([this](WiFiEvent_t, WiFiEventInfo_t) { // Endereço IP disponível
+        _tGotIp = _clock.nowMs(); // Fim da fase de DHCP
+    }, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+}
+
+// recordConnected(): calcula tempos por fase e salva o link atual no cache
+void NetManager::recordConnected() { // Executado no loop (fora da task de eventos)
+    uint32_t now = _clock.nowMs(); // Fallback quando um evento não foi observado
+    uint32_t tIp = _tGotIp ? _tGotIp : now; // Instante do IP
+    uint32_t tLink = _tLink ? _tLink : tIp; // Instante do link
+    _stats.lastLinkMs = tLink - _tBegin; // Associação + autenticação
+    _stats.lastDhcpMs = tIp - tLink; // DHCP (≈0 com IP fixo/lease reaproveitado)
+    _stats.lastTotalMs = tIp - _tBegin; // Latência total de reconexão
+    _stats.lastWasFast = _fastPending && !_roamPending; // Conectou ainda dentro da tentativa rápida?
+    if (_roamPending) _stats.roamSuccess++; // Conta troca de AP concluída
+    else if (_fastPending) _stats.fastSuccess++; // Conta sucesso do caminho rápido
+    _fastPending = false; // Tentativa concluída
+    _roamPending = false; // Roaming concluído
+    _fastSuppressed = false; // Cache volta a ser elegível
+    _connectedAt = now; // Início da janela WIFI_LEASE_VERIFY_MS
+    _leaseInUse = _leaseTry; // Endereço reaproveitado, sem DHCP?
+    _leaseTry = false; // Tentativa consumida
+    if (_leaseInUse) _stats.leaseReuses++; // Métrica
+
+    LinkCache c; // Novo retrato do link atual
+    memset(&c, 0, sizeof(c)); // Zera padding para comparação por memcmp
+    const uint8_t *bssid = WiFi.BSSID(); // MAC do AP associado
+    if (bssid) memcpy(c.bssid, bssid, sizeof(c.bssid)); // Copia BSSID
+    c.channel = WiFi.channel(); // Canal atual
+    c.ip = (uint32_t)WiFi.localIP(); // Lease: IP
+    c.gateway = (uint32_t)WiFi.gatewayIP(); // Lease: gateway
+    c.subnet = (uint32_t)WiFi.subnetMask(); // Lease: máscara
+    c.dns = (uint32_t)WiFi.dnsIP(); // Lease: DNS
+#ifndef WIFI_STATIC_IP // Endereço veio de um lease
+    if (_leaseInUse) { c.leaseMs = _cache.leaseMs; c.leaseAtMs = _cache.leaseAtMs; } // Mesmo lease: validade não renova
+    else { c.leaseMs = WIFI_DHCP_LEASE_MS; c.leaseAtMs = tIp; _leaseBoot = true; } // DHCP agora: lease novo
+#endif // fim: WIFI_STATIC_IP
+    int net = _selector.indexOf(WiFi.SSID().c_str()); // Rede candidata em uso
+    c.net = (uint8_t)(net < 0 ? 0 : net); // Índice (0 se SSID não reconhecido)
+    _selector.noteConnected(now); // Inicia permanência mínima antes de novo roaming
+    _lastRssiCheck = now; // Primeira checagem de RSSI após um período
+    c.valid = (bssid != nullptr && c.channel > 0); // Só é útil com BSSID e canal
+    saveCache(c); // Persiste se diferente do atual
+}
+
+// loadCache(): lê o último link bom da NVS
+void NetManager::loadCache() { // Chamado uma vez em begin()
+#if WIFI_FAST_CONNECT // Apenas com caminho rápido habilitado
+    _prefs.begin("netcache", false); // Namespace próprio (rw)
+    if (_prefs.getBytesLength("link") == sizeof(_cache)) { // Layout compatível com esta versão
+        _prefs.getBytes("link", &_cache, sizeof(_cache)); // Carrega blob
+    } // fim: leitura condicional
+    if (_cache.valid) { LOG_DEBUG("Cache Wi-Fi: canal=%ld", (long)_cache.channel); } // Diagnóstico
+#endif // fim: WIFI_FAST_CONNECT
+}
+
+// saveCache(): grava na NVS somente quando o link mudou (poupa a flash)
+void NetManager::saveCache(const LinkCache &c) { // Chamado após cada conexão
+    if (memcmp(&c, &_cache, sizeof(c)) == 0) return; // Nada mudou: evita escrita
+    _cache = c; // Atualiza cópia em RAM
+#if WIFI_FAST_CONNECT // Persistência apenas com caminho rápido habilitado
+    _prefs.putBytes("link", &_cache, sizeof(_cache)); // Grava blob na NVS
+#endif // fim: WIFI_FAST_CONNECT
+}
@@ -4,6 +4,8 @@
     conversa com o MFRC522 e aplica deduplicação temporal por UID (cache + janela)
     via RfidDedupCache para evitar relatórios repetidos do mesmo cartão dentro do
     intervalo configurado, inclusive quando alterna entre diferentes tags.
+    Com RFID_BLOCK_READ, lê e decodifica o bloco configurado de cada cartão
+    aceito (cache por UID, orçamento de tempo e rodízio de chaves).
 */
 
 #include "RfidReader.h" // Declarações da classe RfidReader e tipos associados
@@ -20,11 +22,27 @@
 #  include "ProjectConfig.h" // Constantes de configuração definidas pelo usuário
 #endif
 
+#if RFID_BLOCK_READ // Chaves MIFARE tentadas em ordem (a última aceita vai primeiro)
+#ifdef RFID_BLOCK_KEYS // Definidas em ProjectConfig.h
+static const byte kBlockKeys[][6] = RFID_BLOCK_KEYS; // Ex.: { {0xA0,0xA1,0xA2,0xA3,0xA4,0xA5}, {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF} }
+#else // Sem chaves configuradas
+static const byte kBlockKeys[][6] = { { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF } }; // Chave de fábrica
+#endif // fim: RFID_BLOCK_KEYS
+static const uint8_t kBlockKeyCount = (uint8_t)(sizeof(kBlockKeys) / sizeof(kBlockKeys[0])); // Nº de chaves
+static_assert(RFID_BLOCK_OFFSET + RFID_BLOCK_LEN <= 16 && RFID_BLOCK_LEN > 0, "RFID_BLOCK_OFFSET/LEN fora do bloco de 16 bytes"); // Faixa
+static_assert(RFID_BLOCK_ADDR < 128 ? RFID_BLOCK_ADDR % 4 != 3 : RFID_BLOCK_ADDR % 16 != 15, "RFID_BLOCK_ADDR e o trailer de um setor"); // Chaves não são dados
+static_assert(RFID_RF_TIMEOUT_MS == 0 || RFID_RF_TIMEOUT_MS >= RFID_BLOCK_MIN_TIMEOUT_MS, "RFID_RF_TIMEOUT_MS curto demais para autenticar o bloco"); // Sem valor explícito vale o da biblioteca
+#endif // fim: RFID_BLOCK_READ
+
 // RfidReader::RfidReader(): cria o objeto MFRC522 com os pinos SDA(SS) e RST
-RfidReader::RfidReader(uint8_t sda, uint8_t rst) // Início: construtor
+RfidReader::RfidReader(uint8_t sda, uint8_t rst, Clock &clock) // Início: construtor
     : _mfrc522(sda, rst), // Inicializa driver MFRC522 com pinos informados
-        _lastUidCapture(0) { // Zera timestamp do último UID capturado
+        _clock(clock), // Relógio injetado
+        _lastUidCapture(0), // Zera timestamp do último UID capturado
+        _keyHint(0) { // Primeira chave de RFID_BLOCK_KEYS
     _lastUid[0] = '\0'; // Limpa último UID (string vazia)
+    memset(&_stats, 0, sizeof(_stats)); // Métricas zeradas
+    memset(&_blockStats, 0, sizeof(_blockStats)); // Idem (leitura de bloco)
     _dedup.clear(); // Limpa cache de deduplicação por UID
 } // fim: RfidReader::RfidReader()
 
@@ -32,17 +50,23 @@ RfidReader::RfidReader(uint8_t sda, uint8_t rst) // Início: construtor
 void RfidReader::begin() { // Início: begin()
     SPI.begin(PIN_SCK, PIN_MISO, PIN_MOSI, PIN_SDA); // Inicializa o SPI com pinos definidos
     _mfrc522.PCD_Init(); // Inicializa o leitor MFRC522
+#if RFID_RF_TIMEOUT_MS > 0 // Só com valor explícito: encurta o timer (prescaler da biblioteca: 40 kHz, 25 µs por tick)
+    uint16_t reload = (uint16_t)(RFID_RF_TIMEOUT_MS * 40); // Ticks do timeout
+    _mfrc522.PCD_WriteRegister(MFRC522::TReloadRegH, (byte)(reload >> 8)); // Byte alto
+    _mfrc522.PCD_WriteRegister(MFRC522::TReloadRegL, (byte)(reload & 0xFF)); // Byte baixo
+#endif // fim: RFID_RF_TIMEOUT_MS
     LOG_INFO("MFRC522 inicializado"); // Loga inicialização bem-sucedida
 } // fim: begin()
 
 // RfidReader::read(): tenta ler um novo cartão; true se UID válido e não duplicado (por UID na janela)
-bool RfidReader::read(char *outHex, size_t outLen, uint32_t &captureMs) { // Início: read()
+bool RfidReader::read(char *outHex, size_t outLen, uint32_t &captureMs, char *outData, size_t dataLen) { // Início: read()
+    _dedup.sweep(_clock.nowMs()); // Expira janelas vencidas (barato: DEDUP_CACHE_SIZE comparações)
     if (!_mfrc522.PICC_IsNewCardPresent()) return false; // Sem novo cartão presente
     if (!_mfrc522.PICC_ReadCardSerial()) return false; // Falha ao ler o serial do cartão
 
     char hex[32]; // Buffer local para UID em hexadecimal
     uidToHex(_mfrc522.uid, hex, sizeof(hex)); // Converte bytes do UID para string HEX
-    uint32_t now = millis(); // Timestamp atual (ms desde o boot)
+    uint32_t now = _clock.nowMs(); // Timestamp atual (ms desde o boot)
 
     // Se esta UID já foi enviada dentro da janela (cache por UID), ignora
     if (isDuplicate(hex, now)) { // Deduplicação temporal por UID usando cache
@@ -57,6 +81,11 @@ bool RfidReader::read(char *outHex, size_t outLen, uint32_t &captureMs) { // In
     _lastUid[sizeof(_lastUid)-1] = '\0'; // Garante terminação NUL
     _lastUidCapture = now; // Atualiza timestamp da última captura
     _dedup.remember(hex, now); // Atualiza/insere no cache de deduplicação por UID
+#if RFID_BLOCK_READ // Conteúdo do bloco com o cartão ainda selecionado
+    if (outData && dataLen) cardData(_mfrc522.uid, hex, now, outData, dataLen); // Cache ou leitura autenticada
+#else // Só a UID
+    if (outData && dataLen) outData[0] = '\0'; // Sem conteúdo
+#endif // fim: RFID_BLOCK_READ
 
     // Entrega ao chamador
     captureMs = now; // Timestamp de captura para o chamador
@@ -70,6 +99,141 @@ bool RfidReader::read(char *outHex, size_t outLen, uint32_t &captureMs) { // In
     return true; // Sinaliza sucesso da leitura
 } // fim: read()
 
+// RfidReader::readInventory(): enumera todos os cartões do campo num ciclo de RF.
+// Cada iteração envia REQA (só cartões em IDLE respondem), resolve a anticolisão
+// com PICC_Select (um cartão vence) e coloca o vencedor em HALT; o próximo REQA
+// acorda o cartão seguinte. O ciclo termina quando ninguém responde ou após 'max'
+// seleções (os demais ficam em IDLE para o próximo ciclo).
+size_t RfidReader::readInventory(UidEntry *out, size_t max) { // Início: readInventory()
+    _dedup.sweep(_clock.nowMs()); // Expira janelas vencidas
+    uint32_t t0 = _clock.nowUs(); // Início do ciclo (µs)
+    size_t accepted = 0; // Cartões aceitos
+    uint8_t seen = 0; // Cartões selecionados neste ciclo
+    while (seen < max) { // Limita o tempo bloqueado
+        if (!_mfrc522.PICC_IsNewCardPresent()) break; // REQA sem resposta: campo esgotado
+        if (_mfrc522.PICC_Select(&_mfrc522.uid) != MFRC522::STATUS_OK) break; // Falha de anticolisão/CRC: tenta no próximo ciclo
+        seen++; // Conta seleção
+
+        char hex[32]; // UID em HEX
+        uidToHex(_mfrc522.uid, hex, sizeof(hex)); // Converte bytes do UID
+        uint32_t now = _clock.nowMs(); // Instante da captura deste cartão
+        if (isDuplicate(hex, now)) { // Dentro da janela: descarta, mas ainda coloca em HALT
+            LOG_DEBUG("RFID ignorado (duplicado na janela) UID=%s", hex); // Diagnóstico
+        } else { // Leitura nova
+            _dedup.remember(hex, now); // Registra no cache
+            strncpy(_lastUid, hex, sizeof(_lastUid) - 1); // Último UID aceito
+            _lastUid[sizeof(_lastUid) - 1] = '\0'; // Terminação NUL
+            _lastUidCapture = now; // Timestamp do último aceito
+            strncpy(out[accepted].uid, hex, sizeof(out[accepted].uid) - 1); // Copia UID
+            out[accepted].uid[sizeof(out[accepted].uid) - 1] = '\0'; // Terminação NUL
+            out[accepted].capture_ms = now; // Timestamp de captura
+#if RFID_BLOCK_READ // Conteúdo do bloco com o cartão ainda selecionado
+            cardData(_mfrc522.uid, hex, now, out[accepted].data, sizeof(out[accepted].data)); // Cache ou leitura autenticada
+#endif // fim: RFID_BLOCK_READ
+            accepted++; // Conta aceite
+        }
+        _mfrc522.PICC_HaltA(); // Silencia o cartão até sair do campo
+#if RFID_BLOCK_READ // Cartão autenticado: encerra a sessão cripto antes do próximo REQA
+        _mfrc522.PCD_StopCrypto1(); // Sem isso o leitor não fala com o cartão seguinte
+#endif // fim: RFID_BLOCK_READ
+    } // fim: laço de inventário
+    _mfrc522.PCD_StopCrypto1(); // Garante leitor sem sessão cripto
+    if (seen == 0) return 0; // Campo vazio: não entra nas métricas
+
+    uint32_t dt = _clock.nowUs() - t0; // Duração do ciclo (µs, seguro no wrap)
+    _stats.cycles++; // Ciclo com cartão
+    _stats.cards += seen; // Cartões selecionados
+    _stats.accepted += (uint32_t)accepted; // Aceitos
+    _stats.lastCycleUs = dt; // Último ciclo
+    if (dt > _stats.maxCycleUs) _stats.maxCycleUs = dt; // Pior ciclo
+    _stats.lastCards = seen; // Cartões no último ciclo
+    if (seen > _stats.maxCards) _stats.maxCards = seen; // Pico de cartões
+    _stats.busyUs += dt; // Tempo de RF ocupado
+    if (seen > 1) { LOG_DEBUG("Inventario: %u cartoes (%u novos) em %lu us", (unsigned)seen, (unsigned)accepted, (unsigned long)dt); } // Ciclo multi-cartão
+    return accepted; // Quantidade escrita em 'out'
+} // fim: readInventory()
+
+#if RFID_BLOCK_READ // Leitura de bloco
+// RfidReader::cardData(): conteúdo do cache ou do cartão; só leituras bem-sucedidas entram no cache
+void RfidReader::cardData(MFRC522::Uid &uid, const char *hex, uint32_t now, char *out, size_t outLen) { // Início: cardData()
+    _blockStats.lookups++; // Cartão aceito
+    if (_cache.lookup(hex, now, out, outLen)) { _blockStats.hits++; return; } // Visitante conhecido: sem criptografia
+    uint32_t t0 = _clock.nowUs(); // Início da leitura no cartão
+    bool ok = readBlock(uid, out, outLen); // Autenticação + leitura
+    uint32_t dt = _clock.nowUs() - t0; // Duração (µs, seguro no wrap)
+    _blockStats.reads++; // Leitura no cartão
+    _blockStats.lastReadUs = dt; // Última
+    if (dt > _blockStats.maxReadUs) _blockStats.maxReadUs = dt; // Pior
+    _blockStats.totalReadUs += dt; // Soma
+    if (ok) { _cache.store(hex, out, now); return; } // Lembra para a próxima visita
+    out[0] = '\0'; // Registro sai só com a UID
+    _blockStats.failures++; // Falha
+    LOG_DEBUG("RFID bloco %u nao lido UID=%s (%lu us)", (unsigned)RFID_BLOCK_ADDR, hex, (unsigned long)dt); // Diagnóstico
+} // fim: cardData()
+
+// RfidReader::readBlock(): PCD_Authenticate + MIFARE_Read do bloco configurado. Uma autenticação
+// recusada ou uma leitura perdida devolve o cartão a IDLE: a próxima tentativa o re-seleciona
+// pela UID (REQA + SELECT) e usa a chave seguinte (recusa) ou a mesma (leitura perdida).
+bool RfidReader::readBlock(MFRC522::Uid &uid, char *out, size_t outLen) { // Início: readBlock()
+    const byte trailer = RFID_BLOCK_ADDR < 128 ? (RFID_BLOCK_ADDR | 0x03) : (RFID_BLOCK_ADDR | 0x0F); // Trailer do setor (1K/4K)
+    const byte cmd = RFID_BLOCK_KEY_B ? MFRC522::PICC_CMD_MF_AUTH_KEY_B : MFRC522::PICC_CMD_MF_AUTH_KEY_A; // Tipo de chave
+    uint32_t t0 = _clock.nowUs(); // Início (orçamento)
+    uint8_t key = _keyHint < kBlockKeyCount ? _keyHint : 0; // Última chave aceita primeiro
+    uint8_t tries = (uint8_t)(kBlockKeyCount + RFID_BLOCK_READ_RETRIES); // Uma por chave + novas tentativas
+    bool selected = true; // O cartão chega selecionado (SELECT de read()/readInventory())
+    while (tries-- > 0 && _clock.nowUs() - t0 < RFID_BLOCK_READ_BUDGET_US) { // Tentativas dentro do orçamento
+        if (!selected) { // Cartão voltou a IDLE: re-seleção pela UID conhecida
+            _mfrc522.PCD_StopCrypto1(); // Sessão anterior encerrada
+            _blockStats.retries++; // Conta
+            byte atqa[2]; byte size = sizeof(atqa); // Resposta do REQA
+            MFRC522::StatusCode st = _mfrc522.PICC_RequestA(atqa, &size); // Acorda cartões em IDLE
+            if (st != MFRC522::STATUS_OK && st != MFRC522::STATUS_COLLISION) return false; // Saiu do campo
+            if (_mfrc522.PICC_Select(&uid, (byte)(uid.size * 8)) != MFRC522::STATUS_OK) return false; // SELECT pela UID completa (sem anticolisão)
+            selected = true; // Pronto para autenticar
+        }
+        MFRC522::MIFARE_Key k; // Chave da vez
+        memcpy(k.keyByte, kBlockKeys[key], sizeof(k.keyByte)); // Copia
+        if (_mfrc522.PCD_Authenticate(cmd, trailer, &k, &uid) != MFRC522::STATUS_OK) { // Recusada ou sem resposta
+            _blockStats.authFails++; // Conta
+            selected = false; // Cartão em IDLE
+            key = (uint8_t)((key + 1) % kBlockKeyCount); // Próxima chave
+            continue; // Nova tentativa
+        }
+        byte buf[18]; byte size = sizeof(buf); // 16 bytes + CRC
+        if (_mfrc522.MIFARE_Read(RFID_BLOCK_ADDR, buf, &size) == MFRC522::STATUS_OK) { // Lido
+            decodeBlock(buf, out, outLen); // Bytes -> texto
+            _keyHint = key; // Próximo cartão começa por esta chave
+            return true; // Sucesso
+        }
+        selected = false; // Leitura perdida: mesma chave de novo
+    }
+    return false; // Chaves, tentativas ou orçamento esgotados
+} // fim: readBlock()
+
+// RfidReader::decodeBlock(): bytes [RFID_BLOCK_OFFSET, +RFID_BLOCK_LEN) -> texto conforme RFID_BLOCK_FORMAT
+void RfidReader::decodeBlock(const byte *block, char *out, size_t outLen) { // Início: decodeBlock()
+    const byte *p = block + RFID_BLOCK_OFFSET; // Primeiro byte usado
+    size_t n = RFID_BLOCK_LEN; // Bytes usados
+    size_t pos = 0; // Posição de escrita
+#if RFID_BLOCK_FORMAT == 1 // Hex maiúsculo
+    for (size_t i = 0; i < n && pos + 2 < outLen; ++i) { out[pos++] = nibbleHex(p[i] >> 4); out[pos++] = nibbleHex(p[i] & 0x0F); } // Dois dígitos por byte
+#elif RFID_BLOCK_FORMAT == 2 // Inteiro sem sinal big-endian em decimal
+    uint64_t v = 0; // Valor
+    for (size_t i = 0; i < n && i < 8; ++i) v = (v << 8) | p[i]; // Até 8 bytes
+    char digits[21]; size_t len = 0; // Dígitos em ordem inversa
+    do { digits[len++] = (char)('0' + v % 10); v /= 10; } while (v); // Conversão
+    if (len < outLen) while (len > 0) out[pos++] = digits[--len]; // Não cabe: vazio (nunca um número truncado)
+#else // ASCII: preenchimento final (NUL, espaço, 0xFF) removido
+    while (n > 0 && (p[n - 1] == 0x00 || p[n - 1] == 0x20 || p[n - 1] == 0xFF)) n--; // Apara o fim
+    for (size_t i = 0; i < n && pos + 1 < outLen; ++i) { // Cada byte
+        byte c = p[i]; // Caractere
+        out[pos++] = (c >= 0x20 && c < 0x7F && c != '"' && c != '\\') ? (char)c : '?'; // Imprimível e seguro em JSON
+    }
+#endif // fim: RFID_BLOCK_FORMAT
+    out[pos] = '\0'; // Terminação NUL
+} // fim: decodeBlock()
+#endif // fim: RFID_BLOCK_READ
+
 // RfidReader::isDuplicate(): verifica se o UID é repetido dentro da janela (per-UID)
 bool RfidReader::isDuplicate(const char *hex, uint32_t now) { // Início: isDuplicate()
     return _dedup.isDuplicate(hex, now); // Delega ao componente de cache
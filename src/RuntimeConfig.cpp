@@ -0,0 +1,149 @@
+/*
+    Arquivo: src/RuntimeConfig.cpp
+    Propósito: Implementa o RuntimeConfig: tabela de descritores (chave, faixa,
+    padrão, ao vivo/boot), carga e gravação na NVS, interpretação do JSON plano
+    vindo do backend e agenda do download com ETag. O GET em si fica no
+    HttpSender; aqui só entram código HTTP, corpo e ETag.
+*/
+
+#include "RuntimeConfig.h" // Declarações da classe
+#include "Log.h" // Macros de log
+#include <stdlib.h> // strtoull
+#include <string.h> // strstr, strncpy
+
+static_assert(HTTP_RETRY_MAX <= HTTP_RETRY_MAX_LIMIT, "HTTP_RETRY_MAX acima de HTTP_RETRY_MAX_LIMIT"); // Padrão dentro da faixa
+
+// Tabela de descritores (mesma ordem de RuntimeParamId)
+static const RuntimeParamDesc kParams[RP_COUNT] = { // key, min, max, padrão, ao vivo
+    { "dedup_ms", 0, 86400000UL, DEDUP_INTERVAL_MS, true }, // Janela de dedup: até 24 h
+    { "dedup_slots", 1, DEDUP_CACHE_SIZE, DEDUP_CACHE_SIZE, true }, // Slots ativos (máximo de compilação)
+    { "drain_ms", 10, 600000UL, QUEUE_DRAIN_INTERVAL_MS, true }, // Cadência de envio: 10 ms a 10 min
+    { "retry_max", 0, HTTP_RETRY_MAX_LIMIT, HTTP_RETRY_MAX, true }, // Retries extras por POST
+    { "retry_base_ms", 10, 10000, HTTP_RETRY_BASE_DELAY_MS, true }, // Base do backoff (cabe em 16 bits)
+    { "http_timeout_ms", 500, 30000, HTTP_TIMEOUT_MS, true }, // Timeout HTTP (próxima sessão)
+    { "buf_cap", 1, UID_BUFFER_CAPACITY, UID_BUFFER_CAPACITY, false }, // Capacidade efetiva: só no boot
+    { "agg_window_ms", 0, 86400000UL, AGG_WINDOW_MS, true }, // Agregação: 0 (desligada) até 24 h
+    { "up_rate_pm", 0, 60000, UPLINK_RATE_PER_MIN, true }, // Fichas de POST por minuto (0 = sem limite)
+    { "up_burst", 1, 1000, UPLINK_BURST, true }, // Rajada do balde de fichas
+}; // fim: kParams
+
+// Construtor: todos os valores nos padrões de compilação
+RuntimeConfig::RuntimeConfig(Clock &clock) // Início: construtor
+    : _clock(clock), _open(false), _bootBufCap(UID_BUFFER_CAPACITY), _nextFetchMs(0) { // Estado inicial
+    for (uint8_t i = 0; i < RP_COUNT; ++i) _v[i] = kParams[i].def; // Padrões
+    _etag[0] = '\0'; // Nenhuma versão remota aplicada
+    memset(&_stats, 0, sizeof(_stats)); // Métricas zeradas
+} // fim: RuntimeConfig::RuntimeConfig()
+
+// begin(): carrega os valores persistidos; fora da faixa (ex.: máximo de compilação reduzido) volta ao padrão
+void RuntimeConfig::begin() { // Início: begin()
+    _prefs.begin("rtcfg", false); // Namespace próprio (rw)
+    _open = true; // NVS disponível
+    bool stale = false; // Algum valor gravado foi rejeitado?
+    for (uint8_t i = 0; i < RP_COUNT; ++i) { // Percorre parâmetros
+        if (!_prefs.isKey(kParams[i].key)) continue; // Nunca alterado: padrão
+        uint32_t v = _prefs.getUInt(kParams[i].key, kParams[i].def); // Valor gravado
+        if (v < kParams[i].min || v > kParams[i].max) { // Incompatível com este firmware
+            LOG_ERROR("Config %s=%lu fora da faixa; usando padrao", kParams[i].key, (unsigned long)v); // Diagnóstico
+            stale = true; // Documento remoto precisa ser reaplicado
+            continue; // Mantém o padrão
+        }
+        _v[i] = v; // Aplica
+    }
+    _bootBufCap = _v[RP_BUF_CAP]; // Capacidade efetiva deste boot
+    String e = _prefs.getString("etag", ""); // ETag da última versão aplicada
+    strncpy(_etag, e.c_str(), sizeof(_etag) - 1); // Copia com limite
+    _etag[sizeof(_etag) - 1] = '\0'; // Terminação NUL
+    if (stale) _etag[0] = '\0'; // Sem If-None-Match: força 200 com o documento completo
+    _nextFetchMs = _clock.nowMs(); // Primeiro download assim que houver rede
+} // fim: begin()
+
+// desc(): descritor do parâmetro
+const RuntimeParamDesc &RuntimeConfig::desc(RuntimeParamId id) { return kParams[id]; } // Tabela constante
+
+// liveMask(): parâmetros aplicados sem reinício
+uint32_t RuntimeConfig::liveMask() { // Máscara 1 << id
+    uint32_t m = 0; // Acumulador
+    for (uint8_t i = 0; i < RP_COUNT; ++i) if (kParams[i].live) m |= 1UL << i; // Só os ao vivo
+    return m; // Máscara
+} // fim: liveMask()
+
+// set(): valida, aplica e persiste; true se mudou
+bool RuntimeConfig::set(RuntimeParamId id, uint32_t value) { // Início: set()
+    if (id >= RP_COUNT) return false; // Identificador inválido
+    if (value < kParams[id].min || value > kParams[id].max) return false; // Fora da faixa
+    if (_v[id] == value) return false; // Sem mudança (não grava flash)
+    _v[id] = value; // Aplica
+    persist(id); // Grava na NVS
+    return true; // Mudou
+} // fim: set()
+
+// persist(): grava um valor (chamado só em mudanças, poupa a flash)
+void RuntimeConfig::persist(RuntimeParamId id) { // Início: persist()
+    if (_open) _prefs.putUInt(kParams[id].key, _v[id]); // NVS aberta em begin()
+} // fim: persist()
+
+// parseUInt(): procura "key" seguido de ':' e de um inteiro sem sinal no JSON plano
+bool RuntimeConfig::parseUInt(const char *json, const char *key, uint32_t &out, bool &present) { // Início: parseUInt()
+    char pat[24]; // "chave" com aspas
+    snprintf(pat, sizeof(pat), "\"%s\"", key); // Monta padrão
+    const char *p = strstr(json, pat); // Procura a chave
+    present = (p != nullptr); // Encontrada?
+    if (!p) return false; // Ausente
+    p += strlen(pat); // Após a chave
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') ++p; // Espaços
+    if (*p != ':') return false; // Não é um par chave:valor
+    ++p; // Após ':'
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') ++p; // Espaços
+    if (*p < '0' || *p > '9') return false; // Não é inteiro sem sinal (negativo, string, null)
+    char *end = nullptr; // Fim do número
+    unsigned long long v = strtoull(p, &end, 10); // Converte
+    if (v > 0xFFFFFFFFULL) return false; // Não cabe em 32 bits
+    if (*end == '.' || *end == 'e' || *end == 'E') return false; // Não é inteiro
+    out = (uint32_t)v; // Valor
+    return true; // Sucesso
+} // fim: parseUInt()
+
+// applyJson(): documento completo do backend; ausentes voltam ao padrão, inválidos mantêm o atual
+uint32_t RuntimeConfig::applyJson(const char *json) { // Início: applyJson()
+    uint32_t mask = 0; // Parâmetros alterados
+    for (uint8_t i = 0; i < RP_COUNT; ++i) { // Percorre parâmetros
+        RuntimeParamId id = (RuntimeParamId)i; // Identificador
+        uint32_t v = kParams[i].def; // Ausente: padrão de compilação
+        bool present = false; // Chave no documento?
+        bool ok = parseUInt(json, kParams[i].key, v, present); // Lê valor
+        if (present && (!ok || v < kParams[i].min || v > kParams[i].max)) { // Valor inválido
+            LOG_ERROR("Config remota: %s invalido (faixa %lu..%lu)", kParams[i].key, (unsigned long)kParams[i].min, (unsigned long)kParams[i].max); // Diagnóstico
+            _stats.rejected++; // Conta rejeição
+            continue; // Mantém o atual
+        }
+        if (!present) v = kParams[i].def; // Volta ao padrão
+        if (set(id, v)) mask |= 1UL << i; // Mudou
+    }
+    return mask; // Máscara de mudanças
+} // fim: applyJson()
+
+// onFetchResult(): interpreta o GET e reagenda o próximo download
+uint32_t RuntimeConfig::onFetchResult(int httpCode, const String &body, const String &etag) { // Início: onFetchResult()
+    uint32_t now = _clock.nowMs(); // Agora
+    _stats.fetches++; // Conta tentativa
+    _stats.lastCode = httpCode; // Último código
+    if (httpCode == 304) { // Versão já aplicada
+        _stats.notModified++; // Conta 304
+        _nextFetchMs = now + CONFIG_FETCH_INTERVAL_MS; // Período normal
+        return 0; // Nada mudou
+    }
+    if (httpCode != 200 || body.length() == 0 || body.length() > CONFIG_MAX_BYTES) { // Falha ou corpo inesperado
+        _stats.errors++; // Conta erro
+        LOG_ERROR("Config remota: falha (code=%d, %u bytes)", httpCode, (unsigned)body.length()); // Diagnóstico
+        _nextFetchMs = now + CONFIG_FETCH_RETRY_MS; // Tenta de novo em breve
+        return 0; // Valores atuais mantidos
+    }
+    uint32_t mask = applyJson(body.c_str()); // Aplica documento
+    strncpy(_etag, etag.c_str(), sizeof(_etag) - 1); // Versão aplicada
+    _etag[sizeof(_etag) - 1] = '\0'; // Terminação NUL
+    if (_open) _prefs.putString("etag", _etag); // Persiste (sobrevive a reboot: próximo GET pode dar 304)
+    _stats.updates++; // Conta atualização
+    _nextFetchMs = now + CONFIG_FETCH_INTERVAL_MS; // Período normal
+    return mask; // Parâmetros alterados
+} // fim: onFetchResult()
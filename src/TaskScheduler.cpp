@@ -0,0 +1,135 @@
+/*
+    Arquivo: src/TaskScheduler.cpp
+    Propósito: Implementa o escalonador cooperativo (ver TaskScheduler.h):
+    passada com orçamento de tempo, tarefas periódicas por prioridade com
+    prazo implícito e tarefas de fundo em fatias na folga, com espera máxima.
+*/
+
+#include "TaskScheduler.h" // Declarações
+
+// Construtor: sem tarefas, métricas zeradas
+TaskScheduler::TaskScheduler(Clock &clock, uint32_t passBudgetUs) // Início: construtor
+    : _clock(clock), _budgetUs(passBudgetUs), _tasks(), _order(), _count(0), _pass() {} // Sem tarefas; métricas da passada zeradas
+
+// add(): reserva a próxima posição e a insere na ordem de prioridade (após as de mesma prioridade)
+int8_t TaskScheduler::add(const char *name, uint8_t priority) { // Início: add()
+    if (_count >= SCHED_MAX_TASKS) return -1; // Vetor cheio (SCHED_MAX_TASKS)
+    uint8_t id = _count++; // Id = ordem de registro
+    Task &t = _tasks[id]; // Nova tarefa
+    t = Task(); // Limpa estado e métricas
+    t.name = name; // Literal (não copiado)
+    t.prio = priority; // 0 = mais alta
+    t.enabled = true; // Participa desde já
+    t.releaseMs = _clock.nowMs(); // Vence na primeira passada / espera conta daqui
+    uint8_t pos = id; // Posição na ordem
+    while (pos > 0 && _tasks[_order[pos - 1]].prio > priority) { _order[pos] = _order[pos - 1]; --pos; } // Inserção estável
+    _order[pos] = id; // Encaixa
+    return (int8_t)id; // Id para setPeriod()/wake()/stats()
+} // fim: add()
+
+// addPeriodic(): tarefa de primeiro plano
+int8_t TaskScheduler::addPeriodic(const char *name, uint8_t priority, uint32_t periodMs, uint32_t budgetUs, SchedFn fn) { // Início: addPeriodic()
+    int8_t id = add(name, priority); // Reserva
+    if (id < 0) return id; // Sem espaço
+    Task &t = _tasks[id]; // Tarefa reservada
+    t.fn = fn; // Callback
+    t.periodMs = periodMs; // 0 = toda passada
+    t.budgetUs = budgetUs; // 0 = sem detecção de estouro
+    return id; // Id registrado
+} // fim: addPeriodic()
+
+// addBackground(): tarefa de fundo (começa pendente)
+int8_t TaskScheduler::addBackground(const char *name, uint8_t priority, uint32_t sliceUs, uint32_t maxWaitMs, SchedSliceFn fn) { // Início: addBackground()
+    int8_t id = add(name, priority); // Reserva
+    if (id < 0) return id; // Sem espaço
+    Task &t = _tasks[id]; // Tarefa reservada
+    t.slice = fn; // Callback
+    t.bg = true; // Fundo
+    t.pending = true; // Primeira fatia descobre se há trabalho
+    t.budgetUs = sliceUs ? sliceUs : 1; // Fatia nominal
+    t.maxWaitMs = maxWaitMs; // 0 = nunca força
+    return id; // Id registrado
+} // fim: addBackground()
+
+// setPeriod(): a próxima liberação já agendada é mantida; o novo período vale a partir dela
+void TaskScheduler::setPeriod(int8_t id, uint32_t periodMs) { // Início: setPeriod()
+    if (id >= 0 && id < _count) _tasks[id].periodMs = periodMs; // Id válido
+} // fim: setPeriod()
+
+// setEnabled(): religar uma periódica a faz vencer na próxima passada
+void TaskScheduler::setEnabled(int8_t id, bool on) { // Início: setEnabled()
+    if (id < 0 || id >= _count) return; // Id inválido
+    Task &t = _tasks[id]; // Tarefa
+    if (on && !t.enabled) { t.releaseMs = _clock.nowMs(); t.started = false; } // Sem intervalo falso desde o desligamento
+    t.enabled = on; // Novo estado
+} // fim: setEnabled()
+
+// wake(): fundo com trabalho novo; uma tarefa já pendente mantém o início da espera
+void TaskScheduler::wake(int8_t id) { // Início: wake()
+    if (id < 0 || id >= _count || _tasks[id].pending) return; // Inválido ou já pendente
+    _tasks[id].pending = true; // Há trabalho
+    _tasks[id].releaseMs = _clock.nowMs(); // Espera máxima conta daqui
+} // fim: wake()
+
+// resetStats(): zera métricas (o agendamento continua)
+void TaskScheduler::resetStats() { // Início: resetStats()
+    for (uint8_t i = 0; i < _count; ++i) { _tasks[i].st = SchedTaskStats(); _tasks[i].started = false; } // Tarefas
+    _pass = SchedPassStats(); // Passadas
+} // fim: resetStats()
+
+// account(): duração, estouro e intervalo entre inícios; devolve a duração
+uint32_t TaskScheduler::account(Task &t, uint32_t startUs, uint32_t budgetUs) { // Início: account()
+    uint32_t us = _clock.nowUs() - startUs; // Duração (seguro no wrap)
+    SchedTaskStats &s = t.st; // Métricas
+    s.runs++; // Mais uma execução
+    s.lastUs = us; // Última
+    s.totalUs += us; // Acumulado
+    if (us > s.maxUs) s.maxUs = us; // Pico
+    if (budgetUs && us > budgetUs) s.overruns++; // Estouro
+    if (t.started && startUs - t.lastStartUs > s.maxGapUs) s.maxGapUs = startUs - t.lastStartUs; // Latência de atendimento
+    t.lastStartUs = startUs; // Referência do próximo intervalo
+    t.started = true; // Intervalos a partir daqui
+    return us; // Duração
+} // fim: account()
+
+// runPass(): periódicas vencidas (prioridade), depois fundo enquanto houver folga
+void TaskScheduler::runPass() { // Início: runPass()
+    uint32_t passUs = _clock.nowUs(); // Início da passada
+    for (uint8_t k = 0; k < _count; ++k) { // Primeiro plano, da maior prioridade para a menor
+        Task &t = _tasks[_order[k]]; // Próxima candidata
+        if (t.bg || !t.enabled) continue; // Fundo fica para a folga
+        uint32_t startMs = _clock.nowMs(); // Instante de início
+        if (t.periodMs && (int32_t)(startMs - t.releaseMs) < 0) continue; // Ainda não venceu
+        uint32_t startUs = _clock.nowUs(); // Início da execução
+        bool late = t.periodMs == 0 && t.started && startUs - t.lastStartUs > _budgetUs; // Toda passada: prazo = orçamento
+        t.fn(); // Executa
+        account(t, startUs, t.budgetUs); // Duração e estouro
+        if (t.periodMs) { // Periódica: prazo = período a partir da liberação
+            uint32_t endMs = _clock.nowMs(); // Término
+            late = endMs - t.releaseMs > t.periodMs; // Terminou depois do prazo
+            t.releaseMs += t.periodMs; // Próxima liberação no ritmo
+            if ((int32_t)(t.releaseMs - startMs) <= 0) t.releaseMs = startMs + t.periodMs; // Atrasada: sem rajada de recuperação
+        }
+        if (late) t.st.misses++; // Prazo perdido
+    }
+    for (uint8_t k = 0; k < _count; ++k) { // Fundo, por prioridade, enquanto houver folga
+        Task &t = _tasks[_order[k]]; // Próxima candidata
+        if (!t.bg || !t.enabled || !t.pending) continue; // Sem trabalho
+        uint32_t used = _clock.nowUs() - passUs; // Já consumido da passada
+        uint32_t slack = used < _budgetUs ? _budgetUs - used : 0; // Folga restante
+        uint32_t need = t.st.runs ? t.st.lastUs : 0; // Custo estimado: a última fatia (a primeira mede); ininterrompível maior que a folga só roda forçada
+        bool forced = t.maxWaitMs && _clock.nowMs() - t.releaseMs >= t.maxWaitMs; // Fome: roda mesmo sem folga
+        if ((slack == 0 || slack < need) && !forced) continue; // Não cabe nesta passada
+        uint32_t budget = forced && slack < t.budgetUs ? t.budgetUs : (slack < t.budgetUs ? slack : t.budgetUs); // Tempo concedido
+        uint32_t startUs = _clock.nowUs(); // Início da fatia
+        t.pending = t.slice(budget); // Executa; false = sem trabalho até wake()
+        account(t, startUs, budget); // Duração e estouro da fatia
+        t.releaseMs = _clock.nowMs(); // Espera máxima recomeça
+        if (forced && (slack == 0 || slack < need)) { t.st.misses++; _pass.forced++; } // Rodou sem folga
+        else _pass.slices++; // Rodou na folga
+    }
+    uint32_t us = _clock.nowUs() - passUs; // Duração da passada
+    _pass.passes++; // Mais uma
+    if (us > _pass.maxPassUs) _pass.maxPassUs = us; // Pico
+    if (us > _budgetUs) _pass.overBudget++; // Acima do orçamento
+} // fim: runPass()
@@ -0,0 +1,203 @@
+/*
+    Arquivo: src/UdpUplink.cpp
+    Propósito: Implementa o UdpUplink: a cada loop() lê os ACKs do coletor,
+    libera a fila até o cursor confirmado, retransmite os datagramas cujo RTO
+    venceu e envia lotes novos quando o lote enche ou a espera (linger) vence.
+    O trabalho por chamada é limitado (UDP_RX_PER_LOOP / UDP_TX_PER_LOOP) para
+    não atrasar a leitura do RFID; nenhum envio bloqueia esperando resposta.
+*/
+
+#include "UdpUplink.h" // Declarações da classe
+#include "Log.h" // Macros de log
+#include <string.h> // strncpy, strncmp
+#include <time.h> // time() (relógio de parede no envio)
+
+#if UDP_UPLINK_ENABLE && RFID_BLOCK_READ // O DATA leva só UID/captura: o card_data seria descartado sem aviso
+#error "UDP_UPLINK_ENABLE nao transporta card_data: desligue RFID_BLOCK_READ ou use o uplink HTTP"
+#endif // fim: checagem de RFID_BLOCK_READ
+
+#if defined(UDP_COLLECTOR_HOST) && defined(UDP_HMAC_KEY) // Coletor e chave em ProjectConfig.h
+static const char kCollectorHost[] = UDP_COLLECTOR_HOST; // Nome ou IP do coletor
+static const char kKey[] = UDP_HMAC_KEY; // Chave HMAC da frota
+static const bool kConfigured = true; // Uplink utilizável
+#else // Sem configuração: enabled() fica falso e a fila segue por HTTP
+static const char kCollectorHost[] = ""; // Nenhum
+static const char kKey[] = ""; // Nenhuma
+static const bool kConfigured = false; // Uplink inutilizável
+#endif // fim: configuração do coletor
+
+static const uint8_t *keyBytes() { return (const uint8_t *)kKey; } // Chave como bytes
+static const size_t kKeyLen = sizeof(kKey) - 1; // Sem o NUL
+
+// Construtor: socket fechado e janela vazia (abre com o primeiro link)
+UdpUplink::UdpUplink(UidBuffer &buffer, Clock &clock) // Início: construtor
+    : _buffer(buffer), _clock(clock), _configured(kConfigured), _bound(false), _resolved(false), _resolveAtMs(0), // Estado inicial
+      _epoch(0), _primed(false), _nextSeq(0), _lingering(false), _lingerStartMs(0) { // ...
+    memset(_flight, 0, sizeof(_flight)); // Nenhum datagrama em voo
+    memset(&_stats, 0, sizeof(_stats)); // Métricas zeradas
+} // fim: UdpUplink::UdpUplink()
+
+// begin(): época deste boot (as sequências do UidBuffer recomeçam a cada reinício)
+void UdpUplink::begin() { // Início: begin()
+    _epoch = (uint32_t)random(1, 0x7FFFFFFF); // Nunca 0
+    if (UDP_UPLINK_ENABLE && !_configured) LOG_ERROR("UDP_UPLINK_ENABLE sem UDP_COLLECTOR_HOST/UDP_HMAC_KEY: fila segue por HTTP"); // Configuração incompleta
+} // fim: begin()
+
+// inFlight(): slots ocupados da janela
+size_t UdpUplink::inFlight() const { // Início: inFlight()
+    size_t n = 0; // Contagem
+    for (const Flight &f : _flight) if (f.used) n++; // Slots ocupados
+    return n; // Datagramas sem ACK
+} // fim: inFlight()
+
+// loop(): uma fatia do uplink; nunca espera por rede
+void UdpUplink::loop(bool linkUp) { // Início: loop()
+    if (!enabled() || !linkUp) return; // Sem uplink ou sem Wi‑Fi (slots em voo retransmitem quando o link voltar)
+    uint32_t now = _clock.nowMs(); // Tempo atual
+    if (!_bound) { // Primeiro link: abre o socket dos ACKs
+        _udp.begin(UDP_LOCAL_PORT); // Escuta em todas as interfaces
+        _bound = true; // Não repete
+    }
+    if (!_resolved) { // Coletor ainda sem endereço
+        if ((int32_t)(now - _resolveAtMs) < 0) return; // Espera a próxima tentativa
+        if (WiFi.hostByName(kCollectorHost, _collector) != 1 || (uint32_t)_collector == 0) { // IP literal não consulta o DNS
+            LOG_ERROR("UDP: coletor %s sem endereco; nova tentativa em %u ms", kCollectorHost, (unsigned)UDP_RESOLVE_RETRY_MS); // Diagnóstico
+            _resolveAtMs = now + UDP_RESOLVE_RETRY_MS; // Reagenda
+            _stats.resolveFails++; // AppController repassa ao NetManager (lease reaproveitado?)
+            return; // Nada a enviar
+        }
+        _resolved = true; // Endereço fixo até o próximo boot
+        LOG_INFO("UDP: coletor %s -> %s:%u (epoch=%lu)", kCollectorHost, _collector.toString().c_str(), (unsigned)UDP_COLLECTOR_PORT, (unsigned long)_epoch); // Diagnóstico
+    }
+    uint32_t t0 = _clock.nowUs(); // Início da fatia
+    receiveAcks(); // Confirmações primeiro: liberam slots e fila
+    clip(); // Fila pode ter perdido itens (overflow, coleta na LAN)
+    sendNew(sendDue(UDP_TX_PER_LOOP)); // Retransmissões antes dos lotes novos
+    uint32_t slice = _clock.nowUs() - t0; // Tempo do loop ocupado pelo uplink
+    if (slice > _stats.maxSliceUs) _stats.maxSliceUs = slice; // Pior fatia
+} // fim: loop()
+
+// receiveAcks(): lê, autentica e aplica até UDP_RX_PER_LOOP datagramas
+void UdpUplink::receiveAcks() { // Início: receiveAcks()
+    for (int i = 0; i < UDP_RX_PER_LOOP; ++i) { // Limite por loop
+        if (_udp.parsePacket() <= 0) return; // Nada recebido
+        int len = _udp.read(_pkt, sizeof(_pkt)); // Copia o datagrama
+        udpproto::Ack a; // Confirmação decodificada
+        if (len <= 0 || (uint32_t)_udp.remoteIP() != (uint32_t)_collector || // Origem errada
+            !udpproto::verify(keyBytes(), kKeyLen, _pkt, (size_t)len) || !udpproto::decodeAck(_pkt, (size_t)len, a)) { // Etiqueta/formato
+            _stats.rejected++; // Descarta
+            continue; // Próximo
+        }
+        handleAck(a); // Aplica
+    }
+} // fim: receiveAcks()
+
+// handleAck(): libera a fila até 'cum' e os slots confirmados (cumulativo ou por faixa)
+void UdpUplink::handleAck(const udpproto::Ack &a) { // Início: handleAck()
+    if (strncmp(a.id, DEVICE_ID, udpproto::kMaxIdLen) != 0 || a.epoch != _epoch || // Outro leitor ou boot anterior
+        (int32_t)(a.cum - _nextSeq) > 0) { // Confirma o que nunca foi enviado
+        _stats.rejected++; // Descarta
+        return; // Sem efeito
+    }
+    _stats.acks++; // Aceito
+    uint32_t now = _clock.nowMs(); // RTT
+    for (Flight &f : _flight) { // Slots em voo
+        if (!f.used) continue; // Livre
+        uint32_t end = f.first + f.count; // Fim (exclusivo)
+        bool done = (int32_t)(a.cum - end) >= 0; // Coberto pelo cursor
+        for (uint8_t r = 0; r < a.nranges && !done; ++r) // Ou por uma faixa
+            done = (int32_t)(f.first - a.ranges[r].start) >= 0 && (int32_t)(a.ranges[r].start + a.ranges[r].len - end) >= 0; // Contido
+        if (!done) continue; // Ainda pendente
+        if (f.tries == 1) _stats.lastRttMs = now - f.sentMs; // Karn: RTT só de datagrama não retransmitido
+        f.used = false; // Libera o slot
+    }
+    size_t n = _buffer.release(a.cum); // Remove o que o coletor já tem
+    if (n) { // Algo saiu da fila
+        _stats.released += (uint32_t)n; // Métrica
+        if (_onRelease) _onRelease(n); // Snapshot na NVS
+    }
+} // fim: handleAck()
+
+// clip(): alinha _nextSeq e os slots ao início da fila (itens que saíram não são mais enviados)
+void UdpUplink::clip() { // Início: clip()
+    uint32_t first = _buffer.firstSeq(); // Mais antigo ainda na fila
+    if (!_primed) { _nextSeq = first; _primed = true; } // Primeira chamada (após a restauração do snapshot)
+    if ((int32_t)(first - _nextSeq) > 0) _nextSeq = first; // Não enviados que saíram (overflow)
+    for (Flight &f : _flight) { // Slots em voo
+        if (!f.used) continue; // Livre
+        uint32_t end = f.first + f.count; // Fim (exclusivo)
+        if ((int32_t)(end - first) <= 0) { f.used = false; continue; } // Faixa inteira saiu da fila
+        if ((int32_t)(first - f.first) > 0) { f.count = (uint8_t)(end - first); f.first = first; } // Recorta o início
+    }
+} // fim: clip()
+
+// sendDue(): retransmite slots com RTO vencido (backoff exponencial); devolve o orçamento restante
+int UdpUplink::sendDue(int budget) { // Início: sendDue()
+    uint32_t now = _clock.nowMs(); // Tempo atual
+    for (Flight &f : _flight) { // Slots em voo
+        if (budget <= 0) break; // Orçamento do loop esgotado
+        if (!f.used || (int32_t)(now - f.sentMs) < (int32_t)f.rtoMs) continue; // Livre ou ainda no prazo
+        if (f.tries < 255) f.tries++; // Mais um envio
+        f.rtoMs = f.rtoMs * 2 > UDP_RTO_MAX_MS ? UDP_RTO_MAX_MS : f.rtoMs * 2; // Backoff
+        if (!transmit(f)) { f.used = false; continue; } // Nada mais na faixa
+        _stats.retransmits++; // Métrica
+        budget--; // Consome
+    }
+    return budget; // Restante para lotes novos
+} // fim: sendDue()
+
+// sendNew(): abre slots para registros nunca enviados (lote cheio ou espera vencida)
+void UdpUplink::sendNew(int budget) { // Início: sendNew()
+    uint32_t now = _clock.nowMs(); // Tempo atual
+    while (budget > 0) { // Limite por loop
+        uint32_t pending = _buffer.endSeq() - _nextSeq; // Registros nunca enviados
+        if (pending == 0) { _lingering = false; return; } // Tudo enviado
+        if (!_lingering) { _lingering = true; _lingerStartMs = now; } // Primeiro registro do lote
+        if (pending < UDP_BATCH_MAX && now - _lingerStartMs < UDP_BATCH_LINGER_MS) return; // Espera completar o lote
+        Flight *f = nullptr; // Slot livre
+        for (Flight &s : _flight) if (!s.used) { f = &s; break; } // Primeiro livre
+        if (!f) return; // Janela cheia: espera ACK
+        uint32_t maxRec = UDP_BATCH_MAX < udpproto::kMaxRecords ? UDP_BATCH_MAX : udpproto::kMaxRecords; // Teto do formato
+        f->used = true; f->first = _nextSeq; f->count = (uint8_t)(pending < maxRec ? pending : maxRec); // Faixa
+        f->tries = 1; f->rtoMs = UDP_RTO_MS; // Primeiro envio
+        if (!transmit(*f)) { f->used = false; return; } // Nada coube
+        _nextSeq += f->count; // Avança (transmit pode ter encolhido a faixa)
+        _stats.records += f->count; // Métrica
+        budget--; // Consome
+        if (_nextSeq == _buffer.endSeq()) _lingering = false; // Lote seguinte começa do zero
+    }
+} // fim: sendNew()
+
+// transmit(): monta o DATA da faixa do slot a partir do UidBuffer, sela e envia
+bool UdpUplink::transmit(Flight &f) { // Início: transmit()
+    uint32_t now = _clock.nowMs(); // Tempo do envio
+    udpproto::DataHeader h; // Cabeçalho
+    strncpy(h.id, DEVICE_ID, udpproto::kMaxIdLen); h.id[udpproto::kMaxIdLen] = '\0'; // Leitor
+    time_t wall = time(nullptr); // Relógio de parede (NTP)
+    h.epoch = _epoch; h.low = _buffer.firstSeq(); h.first = f.first; h.sentMs = now; // Cursores
+    h.unixS = wall > 1600000000 ? (uint32_t)wall : 0; // 0 = sem NTP (coletor usa só capture_ms)
+    h.count = 0; // Preenchido por addRecord
+    udpproto::Writer w(_pkt, sizeof(_pkt)); // Destino
+    udpproto::beginData(w, h); // Cabeçalho
+    size_t countPos = w.len - 1; // Posição do count
+    uint32_t base = f.first - _buffer.firstSeq(); // Índice do primeiro registro na fila
+    uint8_t n = 0; // Registros escritos
+    while (n < f.count) { // Faixa do slot
+        UidEntry e; // Item da fila
+        if (!_buffer.getAt(base + n, e)) break; // Fim da fila
+        udpproto::Record r; // Registro binário
+        if (!udpproto::hexToUid(e.uid, r)) r.uidLen = 0; // UID fora do formato do RfidReader
+        r.captureMs = e.capture_ms; // Captura
+        if (!udpproto::addRecord(w, countPos, r)) break; // Datagrama cheio
+        n++; // Próximo
+    }
+    if (n == 0) return false; // Faixa vazia
+    f.count = n; // Faixa efetiva
+    f.sentMs = now; // Referência do RTO
+    size_t len = udpproto::seal(w, keyBytes(), kKeyLen); // Etiqueta
+    bool ok = len && _udp.beginPacket(_collector, UDP_COLLECTOR_PORT) && _udp.write(_pkt, len) == len && _udp.endPacket(); // Envia
+    if (!ok) { LOG_DEBUG("UDP: envio falhou (seq %lu+%u)", (unsigned long)f.first, (unsigned)n); return true; } // Retransmite no RTO
+    _stats.datagrams++; // Métrica
+    _stats.bytes += (uint32_t)len; // ...
+    return true; // Slot em voo
+} // fim: transmit()
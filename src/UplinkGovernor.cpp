@@ -0,0 +1,144 @@
+/*
+    Arquivo: src/UplinkGovernor.cpp
+    Propósito: Implementa o governador do envio HTTP (ver UplinkGovernor.h):
+    balde de fichas com recarga exata em inteiros, esperas pedidas pelo
+    servidor com acréscimo aleatório, backoff com jitter descorrelacionado e
+    disjuntor com sonda única.
+*/
+
+#include "UplinkGovernor.h" // Declarações
+#include <ctype.h> // isdigit
+#include <stdio.h> // sscanf
+#include <string.h> // strchr, strstr
+
+// Construtor: balde cheio, sem espera, disjuntor fechado
+UplinkGovernor::UplinkGovernor(Clock &clock) // Início: construtor
+    : _clock(clock), _ratePerMin(0), _capacity(kUnit), _credit(kUnit), _refillMs(0), _hold(false), _notBeforeMs(0), // ...
+      _sleepMs(0), _openMs(0), _fails(0), _breaker(BreakerState::CLOSED), _stats() { // ...
+    setRate(UPLINK_RATE_PER_MIN, UPLINK_BURST); // Padrões de compilação até applyConfig()
+} // fim: construtor
+
+// setRate(): troca ritmo e rajada; as fichas acumuladas são mantidas (limitadas à nova rajada)
+void UplinkGovernor::setRate(uint32_t perMin, uint16_t burst) { // Início: setRate()
+    refill(_clock.nowMs()); // Fecha a conta no ritmo anterior
+    _ratePerMin = perMin; // 0 = sem limite
+    _capacity = (uint32_t)(burst ? burst : 1) * kUnit; // Ao menos uma ficha
+    if (_credit > _capacity) _credit = _capacity; // Rajada menor
+} // fim: setRate()
+
+// refill(): soma 'rate' unidades por ms decorrido (sem arredondamento)
+void UplinkGovernor::refill(uint32_t now) { // Início: refill()
+    uint32_t dt = now - _refillMs; // Seguro no wrap
+    _refillMs = now; // Próxima recarga a partir daqui
+    if (!_ratePerMin) { _credit = _capacity; return; } // Sem limite: sempre cheio
+    uint32_t room = _capacity - _credit; // Espaço no balde
+    if ((uint64_t)dt * _ratePerMin >= room) _credit = _capacity; // Enche (também protege contra overflow)
+    else _credit += dt * _ratePerMin; // Recarga proporcional
+} // fim: refill()
+
+// spread(): acréscimo aleatório de até UPLINK_HOLD_SPREAD_PCT (leitores não voltam juntos)
+uint32_t UplinkGovernor::spread(uint32_t ms) { // Início: spread()
+    uint32_t extra = (uint32_t)((uint64_t)ms * UPLINK_HOLD_SPREAD_PCT / 100); // Acréscimo máximo
+    return ms + (extra ? (uint32_t)random(0, (long)extra + 1) : 0); // Uniforme em [ms, ms + extra]
+} // fim: spread()
+
+// holdUntil(): nenhum POST antes de now + ms (mantém uma espera mais longa já em curso)
+void UplinkGovernor::holdUntil(uint32_t now, uint32_t ms) { // Início: holdUntil()
+    uint32_t until = now + ms; // Fim pedido
+    if (!_hold || (int32_t)(until - _notBeforeMs) > 0) _notBeforeMs = until; // Estende
+    _hold = true; // Espera ativa
+} // fim: holdUntil()
+
+// allow(): espera vencida, disjuntor fechado (ou sonda) e uma ficha no balde
+bool UplinkGovernor::allow() { // Início: allow()
+    uint32_t now = _clock.nowMs(); // Tempo atual
+    if (_hold) { // Espera em curso
+        if ((int32_t)(now - _notBeforeMs) < 0) { _stats.held++; return false; } // Ainda não
+        _hold = false; // Venceu
+    }
+    if (_breaker == BreakerState::OPEN) _breaker = BreakerState::HALF_OPEN; // Pausa venceu: libera uma sonda
+    refill(now); // Fichas desde a última consulta
+    if (_credit < kUnit) { _stats.throttled++; return false; } // Balde vazio
+    _credit -= kUnit; // Consome uma ficha
+    _stats.allowed++; // Métrica
+    return true; // Pode enviar
+} // fim: allow()
+
+// onResult(): aplica o ritmo pedido pelo servidor, o backoff e o disjuntor
+void UplinkGovernor::onResult(const UplinkResponse &r) { // Início: onResult()
+    uint32_t now = _clock.nowMs(); // Tempo atual
+    bool ok = r.code >= 200 && r.code < 300; // Entregue
+    uint32_t server = 0; // Espera pedida pelo servidor
+    if (!ok && r.retryAfterMs >= 0) server = (uint32_t)r.retryAfterMs; // Retry-After (429/503)
+    if (r.limitRemaining == 0 && r.limitResetMs > 0 && (uint32_t)r.limitResetMs > server) server = (uint32_t)r.limitResetMs; // Cota esgotada
+    if (server) { _stats.serverHolds++; server = spread(server); } // Espalha a volta da frota
+    if (ok) { // Sucesso: tudo volta ao normal (sonda bem-sucedida fecha o disjuntor)
+        _fails = 0; _sleepMs = 0; _openMs = 0; _breaker = BreakerState::CLOSED; // Reinicia
+        _stats.lastWaitMs = server; // Só a cota, se esgotada
+        if (server) holdUntil(now, server); // Respeita RateLimit-Reset
+        return; // Pronto
+    }
+    _stats.failures++; // Métrica
+    uint32_t hi = _sleepMs ? (_sleepMs > UPLINK_BACKOFF_CAP_MS / 3 ? UPLINK_BACKOFF_CAP_MS : _sleepMs * 3) : UPLINK_BACKOFF_BASE_MS; // Limite superior
+    _sleepMs = UPLINK_BACKOFF_BASE_MS + (hi > UPLINK_BACKOFF_BASE_MS ? (uint32_t)random(0, (long)(hi - UPLINK_BACKOFF_BASE_MS) + 1) : 0); // Jitter descorrelacionado
+    if (_sleepMs > UPLINK_BACKOFF_CAP_MS) _sleepMs = UPLINK_BACKOFF_CAP_MS; // Teto
+    uint32_t wait = _sleepMs > server ? _sleepMs : server; // A maior das duas
+    bool serverFault = (r.code <= 0 || r.code == 429 || r.code >= 500) && r.retryAfterMs < 0; // Servidor mal e sem instrução
+    if (serverFault && _fails < 0xFFFF) _fails++; // Falhas seguidas
+    if (serverFault && UPLINK_BREAKER_FAILS && (_breaker == BreakerState::HALF_OPEN || _fails >= UPLINK_BREAKER_FAILS)) { // Abre
+        _openMs = _breaker == BreakerState::HALF_OPEN ? (_openMs >= UPLINK_BREAKER_MAX_MS / 2 ? UPLINK_BREAKER_MAX_MS : _openMs * 2) // Sonda falhou: dobra
+                                                      : UPLINK_BREAKER_OPEN_MS; // Primeira abertura
+        _breaker = BreakerState::OPEN; // Pausa os envios
+        _stats.breakerTrips++; // Métrica
+        uint32_t open = spread(_openMs); // Sondas da frota espalhadas
+        if (open > wait) wait = open; // Pausa do disjuntor
+    } else if (_breaker == BreakerState::HALF_OPEN) { // Sonda respondida (4xx ou com Retry-After): servidor vivo
+        _breaker = BreakerState::CLOSED; _openMs = 0; // Fecha
+    }
+    _stats.lastWaitMs = wait; // Métrica
+    holdUntil(now, wait); // Próxima tentativa
+} // fim: onResult()
+
+// waitMs(): quanto falta até allow() poder liberar (espera ou ficha)
+uint32_t UplinkGovernor::waitMs() { // Início: waitMs()
+    uint32_t now = _clock.nowMs(); // Tempo atual
+    if (_hold && (int32_t)(now - _notBeforeMs) < 0) return _notBeforeMs - now; // Espera em curso
+    refill(now); // Fichas atuais
+    if (_credit >= kUnit) return 0; // Já pode
+    return (kUnit - _credit + _ratePerMin - 1) / _ratePerMin; // Até completar uma ficha (rate > 0 aqui)
+} // fim: waitMs()
+
+// daysFromCivil(): dias desde 1970-01-01 (calendário gregoriano proléptico)
+static int32_t daysFromCivil(int32_t y, uint32_t m, uint32_t d) { // Início: daysFromCivil()
+    y -= m <= 2; // Ano começa em março
+    int32_t era = (y >= 0 ? y : y - 399) / 400; // Ciclos de 400 anos
+    uint32_t yoe = (uint32_t)(y - era * 400); // Ano na era
+    uint32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1; // Dia no ano (de março)
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy; // Dia na era
+    return era * 146097 + (int32_t)doe - 719468; // Desde a época Unix
+} // fim: daysFromCivil()
+
+// parseRetryAfter(): "segundos" ou IMF-fixdate ("Sun, 06 Nov 1994 08:49:37 GMT")
+int32_t UplinkGovernor::parseRetryAfter(const char *v, time_t nowUnix) { // Início: parseRetryAfter()
+    if (!v) return -1; // Ausente
+    while (*v == ' ') ++v; // Espaços iniciais
+    if (isdigit((unsigned char)*v)) { // delta-seconds
+        uint32_t s = 0; // Segundos
+        for (; isdigit((unsigned char)*v); ++v) { s = s * 10 + (uint32_t)(*v - '0'); if (s >= UPLINK_RETRY_AFTER_MAX_MS / 1000) return (int32_t)UPLINK_RETRY_AFTER_MAX_MS; } // Limitado
+        return (*v == '\0' || *v == ' ') ? (int32_t)(s * 1000) : -1; // Só dígitos
+    }
+    if (nowUnix < 1609459200) return -1; // Data exige relógio de parede (NTP)
+    const char *c = strchr(v, ','); // Após o dia da semana
+    if (!c) return -1; // Formato inválido
+    static const char kMon[] = "JanFebMarAprMayJunJulAugSepOctNovDec"; // Meses
+    char mon[4] = {0}; // Mês lido
+    unsigned d = 0, y = 0, hh = 0, mm = 0, ss = 0; // Campos
+    if (sscanf(c + 1, " %2u %3s %4u %2u:%2u:%2u", &d, mon, &y, &hh, &mm, &ss) != 6) return -1; // IMF-fixdate
+    const char *p = strstr(kMon, mon); // Posição do mês
+    if (!p || mon[0] == '\0' || (p - kMon) % 3 || d < 1 || d > 31 || hh > 23 || mm > 59 || ss > 60) return -1; // Campos inválidos
+    int64_t t = (int64_t)daysFromCivil((int32_t)y, (uint32_t)((p - kMon) / 3 + 1), d) * 86400 + hh * 3600 + mm * 60 + ss; // Instante
+    int64_t delta = t - (int64_t)nowUnix; // Segundos até lá
+    if (delta <= 0) return 0; // Já passou: pode tentar
+    if (delta >= (int64_t)(UPLINK_RETRY_AFTER_MAX_MS / 1000)) return (int32_t)UPLINK_RETRY_AFTER_MAX_MS; // Limitado
+    return (int32_t)(delta * 1000); // ms
+} // fim: parseRetryAfter()
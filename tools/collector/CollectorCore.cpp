@@ -0,0 +1,119 @@
+/*
+    Arquivo: tools/collector/CollectorCore.cpp
+    Propósito: Implementa a deduplicação por sequência e a montagem dos ACKs
+    do coletor UDP (ver CollectorCore.h).
+*/
+
+#include "CollectorCore.h" // Declarações
+#include <stdio.h> // snprintf
+
+// Construtor: sem leitores
+CollectorCore::CollectorCore(const std::string &key) : _key(key), _tick(0), _stats() {} // Chave da frota
+
+// stream(): época já conhecida do leitor ou uma nova no lugar da menos usada; nullptr enquanto
+// alguma época do leitor teve registro novo há menos de kEpochHoldMs (replay de um boot antigo)
+CollectorCore::Stream *CollectorCore::stream(Device &dev, uint32_t epoch, uint32_t low, uint64_t nowMs) { // Início: stream()
+    for (Stream &st : dev.s) if (st.used && st.epoch == epoch) return &st; // Conhecida
+    for (const Stream &st : dev.s) if (st.used && nowMs - st.activeMs < kEpochHoldMs) { _stats.staleEpoch++; return nullptr; } // Leitor ativo
+    Stream &st = !dev.s[0].used ? dev.s[0] : !dev.s[1].used ? dev.s[1] : // Slot livre
+                 (dev.s[0].lastUse < dev.s[1].lastUse ? dev.s[0] : dev.s[1]); // Ou a época mais antiga
+    st = Stream(); // Zera o bitmap
+    st.used = true; st.epoch = epoch; st.cum = low; st.top = low; st.lastUse = ++_tick; st.activeMs = nowMs; // Começa no mais antigo que o leitor guarda
+    _stats.epochs++; // Boot novo (ou época esquecida)
+    return &st; // Nova
+} // fim: stream()
+
+// advanceTo(): o leitor não guarda mais nada abaixo de low; o que não chegou é contado como abandonado
+void CollectorCore::advanceTo(Stream &st, uint32_t low) { // Início: advanceTo()
+    uint32_t gap = low - st.cum; // Sequências a pular
+    if (gap >= kWindow) { // Janela inteira para trás
+        uint32_t seen = 0; // Bits marcados (chegaram)
+        for (uint64_t w : st.bits) seen += (uint32_t)__builtin_popcountll(w); // Conta
+        _stats.skipped += gap - seen; // Restante não chegou
+        for (uint64_t &w : st.bits) w = 0; // Limpa
+    } else { // Parte da janela
+        for (uint32_t s = st.cum; s != low; ++s) { if (!st.test(s)) _stats.skipped++; st.clear(s); } // Uma a uma
+    }
+    st.cum = low; // Novo cursor
+    if ((int32_t)(st.top - st.cum) < 0) st.top = st.cum; // Nada recebido acima
+} // fim: advanceTo()
+
+// slide(): cum avança enquanto a próxima sequência já chegou
+void CollectorCore::slide(Stream &st) { // Início: slide()
+    while (st.cum != st.top && st.test(st.cum)) { st.clear(st.cum); st.cum++; } // Contíguos
+} // fim: slide()
+
+// fillAck(): cursor e até kMaxRanges faixas recebidas acima dele (mais antigas primeiro)
+void CollectorCore::fillAck(const std::string &device, const Stream &st, udpproto::Ack &ack) { // Início: fillAck()
+    size_t n = device.size() < udpproto::kMaxIdLen ? device.size() : udpproto::kMaxIdLen; // Limite do formato
+    device.copy(ack.id, n); ack.id[n] = '\0'; // Leitor
+    ack.epoch = st.epoch; ack.cum = st.cum; ack.nranges = 0; // Cabeçalho
+    uint32_t s = st.cum; // Varredura (bit de cum está sempre limpo)
+    while (s != st.top && ack.nranges < udpproto::kMaxRanges) { // Até o maior recebido
+        if (!st.test(s)) { ++s; continue; } // Lacuna
+        uint32_t start = s; // Início da faixa
+        while (s != st.top && st.test(s) && s - start < 0xFFFF) ++s; // Fim da faixa
+        ack.ranges[ack.nranges].start = start; ack.ranges[ack.nranges].len = (uint16_t)(s - start); // Faixa
+        ack.nranges++; // Próxima
+    }
+} // fim: fillAck()
+
+// ingest(): autentica, decodifica, deduplica e atualiza o cursor do leitor
+CollectorCore::Verdict CollectorCore::ingest(const uint8_t *d, size_t n, uint64_t nowMs, std::vector<CollectorRecord> &out, udpproto::Ack &ack) { // Início: ingest()
+    if (udpproto::type(d, n) != udpproto::kTypeData || // Outro protocolo/tipo
+        !udpproto::verify((const uint8_t *)_key.data(), _key.size(), d, n)) { _stats.badTag++; return Verdict::BAD_TAG; } // Ou etiqueta inválida
+    udpproto::DataHeader h; // Cabeçalho
+    udpproto::Record recs[udpproto::kMaxRecords]; // Registros
+    if (!udpproto::decodeData(d, n, h, recs)) { _stats.malformed++; return Verdict::MALFORMED; } // Autêntico mas inválido
+    std::string id(h.id); // Chave do leitor
+    Stream *sp = stream(_devices[id], h.epoch, h.low, nowMs); // Estado da época
+    if (!sp) return Verdict::STALE_EPOCH; // Época desconhecida com o leitor ativo: sem ACK
+    Stream &st = *sp; // Época aceita
+    _stats.datagrams++; // Aceito
+    bool fresh = false; // Registro novo ou cursor avançado (um replay só traz duplicatas)
+    if ((int32_t)(h.low - st.cum) > 0) { advanceTo(st, h.low); fresh = true; } // Leitor abandonou sequências
+    for (uint8_t i = 0; i < h.count; ++i) { // Cada registro
+        uint32_t seq = h.first + i; // Sequência
+        if ((int32_t)(seq - st.cum) < 0 || st.test(seq)) { _stats.duplicates++; continue; } // Já recebido
+        if (seq - st.cum >= kWindow) { _stats.beyond++; continue; } // Fora do bitmap: sem ACK, volta depois
+        st.set(seq); // Marca
+        if ((int32_t)(seq + 1 - st.top) > 0) st.top = seq + 1; // Maior recebido
+        CollectorRecord r; // Registro novo
+        r.device = id; r.epoch = h.epoch; r.seq = seq; // Identidade
+        udpproto::uidToHex(recs[i], r.uid); // UID
+        r.captureMs = recs[i].captureMs; // Captura (millis do leitor)
+        r.captureUnixMs = h.unixS ? (uint64_t)h.unixS * 1000 - (uint32_t)(h.sentMs - recs[i].captureMs) : 0; // Hora de parede
+        out.push_back(r); // Para o backend
+        _stats.records++; // Métrica
+        fresh = true; // Época em uso
+    }
+    if (fresh) { st.lastUse = ++_tick; st.activeMs = nowMs; } // LRU e atividade: duplicatas reenviadas não renovam
+    slide(st); // Cursor cumulativo
+    fillAck(id, st, ack); // Estado atual
+    return Verdict::OK; // Aceito
+} // fim: ingest()
+
+// ackFor(): estado atual de um leitor/época (ACK enviado depois do repasse ao backend)
+bool CollectorCore::ackFor(const std::string &device, uint32_t epoch, udpproto::Ack &ack) const { // Início: ackFor()
+    std::unordered_map<std::string, Device>::const_iterator it = _devices.find(device); // Leitor
+    if (it == _devices.end()) return false; // Desconhecido
+    for (const Stream &st : it->second.s) if (st.used && st.epoch == epoch) { fillAck(device, st, ack); return true; } // Época
+    return false; // Época esquecida
+} // fim: ackFor()
+
+// encodeAck(): sela com a chave do coletor
+size_t CollectorCore::encodeAck(const udpproto::Ack &ack, uint8_t *out, size_t cap) const { // Início: encodeAck()
+    return udpproto::encodeAck(ack, (const uint8_t *)_key.data(), _key.size(), out, cap); // Formato compartilhado
+} // fim: encodeAck()
+
+// appendJson(): {"device_id","epoch","seq","uid","capture_timestamp_ms"[,"capture_unix_ms"]}\n
+void CollectorCore::appendJson(const CollectorRecord &r, std::string &out) { // Início: appendJson()
+    char buf[96]; // Campos numéricos
+    out += "{\"device_id\":\""; // DEVICE_ID
+    for (char c : r.device) out += (c == '"' || c == '\\' || (unsigned char)c < 0x20) ? '_' : c; // Sem escapes JSON: troca o que precisaria
+    snprintf(buf, sizeof(buf), "\",\"epoch\":%u,\"seq\":%u,\"uid\":\"", (unsigned)r.epoch, (unsigned)r.seq); out += buf; // Identidade
+    out += r.uid; // UID
+    snprintf(buf, sizeof(buf), "\",\"capture_timestamp_ms\":%u", (unsigned)r.captureMs); out += buf; // Mesmo nome do HttpSender
+    if (r.captureUnixMs) { snprintf(buf, sizeof(buf), ",\"capture_unix_ms\":%llu", (unsigned long long)r.captureUnixMs); out += buf; } // Com NTP no leitor
+    out += "}\n"; // Fim da linha
+} // fim: appendJson()
@@ -0,0 +1,88 @@
+/*
+    Arquivo: tools/collector/CollectorCore.h
+    Propósito: Lógica do coletor UDP, sem sockets: autentica e decodifica os
+    datagramas DATA (include/UdpProto.h), deduplica por (leitor, época,
+    sequência) e monta o ACK cumulativo + faixas seletivas de cada leitor.
+    Usada pelo daemon rfid_collector (epoll/recvmmsg) e, em processo, pelo
+    simulador sim_udp. Por leitor guarda as duas épocas mais recentes (um
+    datagrama atrasado do boot anterior ainda é deduplicado) com um cursor e um
+    bitmap de kWindow sequências acima dele. Uma época desconhecida só ocupa um
+    slot depois de kEpochHoldMs sem registro novo nas épocas do leitor: um DATA
+    autêntico de um boot antigo, gravado e reenviado por terceiros, não
+    consegue despejar a época em uso (e reentregar o que ela já confirmou).
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <stdint.h> // Tipos inteiros de largura fixa
+#include <string> // Chave e identificadores
+#include <unordered_map> // Leitores por DEVICE_ID
+#include <vector> // Registros aceitos
+#include "UdpProto.h" // Formato dos datagramas
+
+// Um registro novo (primeira vez que a sequência chega)
+struct CollectorRecord { // Repassado em lote ao backend
+    std::string device; // DEVICE_ID
+    uint32_t epoch; // Época do boot do leitor
+    uint32_t seq; // Sequência na época
+    char uid[2 * udpproto::kMaxUidBytes + 1]; // UID em hex maiúsculo
+    uint32_t captureMs; // millis() da captura no leitor
+    uint64_t captureUnixMs; // Hora de parede da captura (0 se o leitor não tinha NTP)
+}; // fim: struct CollectorRecord
+
+// Contadores do coletor
+struct CollectorStats { // Lidos pelo daemon/simulador
+    uint64_t datagrams; // DATA aceitos (etiqueta válida)
+    uint64_t records; // Registros novos
+    uint64_t duplicates; // Registros já recebidos (retransmissão ou duplicação na rede)
+    uint64_t beyond; // Registros além da janela do bitmap (não confirmados; o leitor reenvia)
+    uint64_t skipped; // Sequências abandonadas pelo leitor sem chegar (overflow/coleta na LAN)
+    uint64_t badTag; // Etiqueta HMAC inválida
+    uint64_t malformed; // Formato inválido (etiqueta válida)
+    uint64_t epochs; // Épocas novas (boots de leitores)
+    uint64_t staleEpoch; // DATA de época desconhecida recusados com o leitor ativo (replay ou reinício recente)
+}; // fim: struct CollectorStats
+
+// Estado de dedup/ACK de todos os leitores
+class CollectorCore { // Início da definição da classe CollectorCore
+public: // Seção pública
+    static const uint32_t kWindow = 1024; // Sequências rastreadas acima do cursor (potência de 2)
+    static const uint32_t kEpochHoldMs = 5000; // Silêncio do leitor antes de aceitar uma época nova (o boot já consome boa parte)
+    enum class Verdict { OK, BAD_TAG, MALFORMED, STALE_EPOCH }; // Resultado de ingest()
+
+    explicit CollectorCore(const std::string &key); // Chave HMAC da frota
+    // ingest(): processa um datagrama recebido em nowMs (relógio monotônico do coletor); registros
+    // novos vão para out (na ordem do datagrama). Em OK, ack recebe o estado atual do leitor/época
+    // (pronto para encodeAck); STALE_EPOCH não gera ACK (o leitor reenvia após o RTO)
+    Verdict ingest(const uint8_t *d, size_t n, uint64_t nowMs, std::vector<CollectorRecord> &out, udpproto::Ack &ack); // Um datagrama
+    bool ackFor(const std::string &device, uint32_t epoch, udpproto::Ack &ack) const; // Estado atual (ACK adiado)
+    size_t encodeAck(const udpproto::Ack &ack, uint8_t *out, size_t cap) const; // ACK selado com a chave
+    size_t devices() const { return _devices.size(); } // Leitores vistos
+    const CollectorStats &stats() const { return _stats; } // Contadores
+
+    static void appendJson(const CollectorRecord &r, std::string &out); // Uma linha NDJSON
+private: // Seção privada
+    // Janela de uma época: tudo abaixo de cum chegou (ou foi abandonado); bits = chegou acima de cum
+    struct Stream { // Por (leitor, época)
+        bool used = false; // Slot em uso
+        uint32_t epoch = 0; // Época
+        uint32_t cum = 0; // Cursor cumulativo
+        uint32_t top = 0; // Maior sequência recebida + 1
+        uint64_t lastUse = 0; // Para substituir a época menos usada (só avança com registro novo)
+        uint64_t activeMs = 0; // Último registro novo ou cursor avançado (duplicatas não contam)
+        uint64_t bits[kWindow / 64] = {}; // Recebidos em [cum, cum + kWindow)
+        bool test(uint32_t s) const { return (bits[(s & (kWindow - 1)) >> 6] >> (s & 63)) & 1u; } // Chegou?
+        void set(uint32_t s) { bits[(s & (kWindow - 1)) >> 6] |= 1ull << (s & 63); } // Marca
+        void clear(uint32_t s) { bits[(s & (kWindow - 1)) >> 6] &= ~(1ull << (s & 63)); } // Desmarca
+    }; // fim: struct Stream
+    struct Device { Stream s[2]; }; // Duas épocas por leitor
+
+    std::string _key; // Chave HMAC
+    std::unordered_map<std::string, Device> _devices; // Estado por leitor
+    uint64_t _tick; // Relógio lógico (LRU das épocas)
+    CollectorStats _stats; // Contadores
+
+    Stream *stream(Device &dev, uint32_t epoch, uint32_t low, uint64_t nowMs); // Época existente ou nova (cursor em low); nullptr se recusada
+    void advanceTo(Stream &st, uint32_t low); // Leitor abandonou tudo abaixo de low
+    static void slide(Stream &st); // Avança cum sobre os bits contíguos
+    static void fillAck(const std::string &device, const Stream &st, udpproto::Ack &ack); // Cursor + faixas
+}; // Fim da classe CollectorCore
@@ -0,0 +1,296 @@
+/*
+    Arquivo: tools/collector/rfid_collector.cpp
+    Propósito: Daemon coletor do uplink UDP (Linux). Um único socket UDP não
+    bloqueante atendido por epoll; cada evento drena o socket com recvmmsg em
+    rajadas de --burst datagramas. Os registros novos (CollectorCore) acumulam
+    num buffer NDJSON repassado em lote ao backend (arquivo/stdout ou POST
+    HTTP), ao juntar --batch registros ou a cada --flush-ms (timerfd). Os ACKs
+    só saem depois que o lote foi aceito pelo destino, todos numa rajada de
+    sendmmsg: um leitor nunca libera da fila algo que o coletor ainda pode
+    perder. Se o destino falha, nada é confirmado e, acima de --max-pending
+    bytes, datagramas novos são recusados até o repasse voltar (os leitores
+    retransmitem). SIGINT/SIGTERM (signalfd) fazem um último repasse e saem.
+
+      rfid_collector --key CHAVE [--port 47474] [--bind 0.0.0.0] [--out arquivo|-]
+                     [--forward http://host:porta/caminho] [--batch 2000]
+                     [--flush-ms 100] [--burst 64] [--rcvbuf 8388608]
+                     [--max-pending 67108864] [--stats-s 10]
+    A chave também pode vir de RFID_UDP_KEY (evita expor em ps).
+*/
+
+#include "CollectorCore.h" // Dedup e ACKs
+#include <arpa/inet.h> // inet_pton, htons
+#include <errno.h> // errno
+#include <fcntl.h> // O_* (arquivo de saída)
+#include <netdb.h> // getaddrinfo (destino HTTP)
+#include <netinet/in.h> // sockaddr_in
+#include <signal.h> // sigprocmask
+#include <stdio.h> // fprintf
+#include <stdlib.h> // strtoul, getenv
+#include <string.h> // strcmp, strerror
+#include <sys/epoll.h> // epoll
+#include <sys/signalfd.h> // signalfd
+#include <sys/socket.h> // recvmmsg, sendmmsg
+#include <sys/timerfd.h> // timerfd
+#include <time.h> // clock_gettime
+#include <unistd.h> // read, write, close
+#include <algorithm> // std::min
+#include <map> // ACKs pendentes por leitor/época
+#include <string> // Buffers
+#include <vector> // Rajadas
+
+// Parâmetros de linha de comando
+struct Options { // Valores padrão de produção
+    std::string key; // Chave HMAC da frota
+    std::string bind = "0.0.0.0"; // Interface
+    uint16_t port = 47474; // UDP_COLLECTOR_PORT do firmware
+    std::string out = "-"; // Arquivo NDJSON ("-" = stdout)
+    std::string forward; // URL http:// do backend (vazio = arquivo)
+    size_t batch = 2000; // Registros por repasse
+    uint32_t flushMs = 100; // Repasse periódico (menor que UDP_RTO_MS do firmware)
+    unsigned burst = 64; // Datagramas por recvmmsg
+    int rcvbuf = 8 << 20; // SO_RCVBUF (absorve rajadas durante um repasse lento)
+    size_t maxPending = 64u << 20; // Bytes NDJSON sem repasse antes de recusar datagramas
+    uint32_t statsS = 10; // Linha de métricas em stderr (0 = desligado)
+}; // fim: struct Options
+
+static uint64_t monoMs() { timespec t; clock_gettime(CLOCK_MONOTONIC, &t); return (uint64_t)t.tv_sec * 1000 + t.tv_nsec / 1000000; } // Relógio monotônico
+
+// Destino do repasse: arquivo/stdout ou POST HTTP/1.1 com conexão persistente
+class Sink { // Início da definição da classe Sink
+public: // Seção pública
+    explicit Sink(const Options &o) : _o(o) {} // Configuração
+    ~Sink() { closeConn(); if (_fd > 1) close(_fd); } // Libera
+    bool open(); // Abre o arquivo ou valida a URL
+    bool deliver(const std::string &body); // true se o destino aceitou
+private: // Seção privada
+    const Options &_o; // Configuração
+    int _fd = -1; // Arquivo de saída
+    int _sock = -1; // Conexão HTTP
+    std::string _host, _port = "80", _path = "/"; // URL decomposta
+    bool httpPost(const std::string &body); // Uma tentativa
+    void closeConn() { if (_sock >= 0) close(_sock); _sock = -1; } // Fecha a conexão
+    static bool writeAll(int fd, const char *p, size_t n); // write() até o fim
+}; // Fim da classe Sink
+
+bool Sink::writeAll(int fd, const char *p, size_t n) { // Escrita completa
+    while (n > 0) { // Até acabar
+        ssize_t w = write(fd, p, n); // Parcial
+        if (w < 0 && errno == EINTR) continue; // Sinal
+        if (w <= 0) return false; // Erro
+        p += w; n -= (size_t)w; // Avança
+    }
+    return true; // Tudo escrito
+}
+
+bool Sink::open() { // Prepara o destino
+    if (_o.forward.empty()) { // Arquivo
+        _fd = _o.out == "-" ? 1 : ::open(_o.out.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644); // stdout ou arquivo
+        if (_fd < 0) { fprintf(stderr, "rfid_collector: %s: %s\n", _o.out.c_str(), strerror(errno)); return false; } // Falhou
+        return true; // Pronto
+    }
+    const std::string &u = _o.forward; // http://host[:porta][/caminho]
+    if (u.compare(0, 7, "http://") != 0) { fprintf(stderr, "rfid_collector: --forward aceita apenas http:// (TLS fica no proxy do backend)\n"); return false; } // Sem TLS
+    size_t hs = 7, pe = u.find('/', hs); // Início do host, início do caminho
+    std::string hp = u.substr(hs, pe == std::string::npos ? std::string::npos : pe - hs); // host[:porta]
+    if (pe != std::string::npos) _path = u.substr(pe); // Caminho
+    size_t c = hp.rfind(':'); // Porta explícita?
+    _host = c == std::string::npos ? hp : hp.substr(0, c); // Host
+    if (c != std::string::npos) _port = hp.substr(c + 1); // Porta
+    return !_host.empty(); // Válida
+}
+
+bool Sink::httpPost(const std::string &body) { // POST do lote
+    if (_sock < 0) { // Conecta (ou reconecta)
+        addrinfo hints = {}, *res = nullptr; hints.ai_socktype = SOCK_STREAM; // TCP
+        if (getaddrinfo(_host.c_str(), _port.c_str(), &hints, &res) != 0 || !res) return false; // Resolução
+        _sock = socket(res->ai_family, SOCK_STREAM, 0); // Socket bloqueante (com prazo)
+        timeval tv = {2, 0}; // Prazo de envio/recepção
+        setsockopt(_sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv)); setsockopt(_sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)); // ...
+        bool ok = connect(_sock, res->ai_addr, res->ai_addrlen) == 0; // Conecta
+        freeaddrinfo(res); // Libera
+        if (!ok) { closeConn(); return false; } // Backend fora
+    }
+    char head[512]; // Cabeçalho
+    int hn = snprintf(head, sizeof(head), "POST %s HTTP/1.1\r\nHost: %s\r\nContent-Type: application/x-ndjson\r\nContent-Length: %zu\r\n\r\n", // Requisição
+                      _path.c_str(), _host.c_str(), body.size()); // ...
+    if (!writeAll(_sock, head, (size_t)hn) || !writeAll(_sock, body.data(), body.size())) { closeConn(); return false; } // Envio
+    std::string resp; char buf[1024]; size_t hdrEnd; // Resposta
+    while ((hdrEnd = resp.find("\r\n\r\n")) == std::string::npos) { // Até o fim do cabeçalho
+        ssize_t r = read(_sock, buf, sizeof(buf)); // Bloqueia até o prazo
+        if (r <= 0 || resp.size() > 16384) { closeConn(); return false; } // Fechou, prazo ou cabeçalho absurdo
+        resp.append(buf, (size_t)r); // Acumula
+    }
+    int code = 0; sscanf(resp.c_str(), "HTTP/%*s %d", &code); // Código
+    size_t cl = 0, p = resp.find("Content-Length:"); if (p == std::string::npos) p = resp.find("content-length:"); // Corpo da resposta
+    if (p != std::string::npos && p < hdrEnd) cl = strtoul(resp.c_str() + p + 15, nullptr, 10); // Tamanho
+    size_t have = resp.size() - hdrEnd - 4; // Já lido do corpo
+    while (have < cl) { ssize_t r = read(_sock, buf, sizeof(buf)); if (r <= 0) { closeConn(); break; } have += (size_t)r; } // Drena (conexão reaproveitada)
+    if (p == std::string::npos || resp.find("Connection: close") != std::string::npos) closeConn(); // Sem tamanho ou servidor fecha
+    return code >= 200 && code < 300; // Aceito
+}
+
+bool Sink::deliver(const std::string &body) { // Repasse
+    if (_o.forward.empty()) return writeAll(_fd, body.data(), body.size()); // Arquivo/stdout
+    if (httpPost(body)) return true; // Backend aceitou
+    return httpPost(body); // Uma nova tentativa (conexão persistente pode ter caído)
+}
+
+// Estado do laço de eventos
+struct Collector { // Daemon
+    Options o; // Configuração
+    CollectorCore core; // Dedup e ACKs
+    Sink sink; // Destino
+    int udp = -1; // Socket UDP
+    std::string pending; // NDJSON ainda não repassado
+    size_t pendingRecords = 0; // Registros em pending
+    std::map<std::pair<std::string, uint32_t>, sockaddr_in> toAck; // Leitores/épocas a confirmar após o repasse
+    std::vector<CollectorRecord> recs; // Registros de um datagrama
+    uint64_t acksSent = 0, shed = 0, forwards = 0, forwardFails = 0; // Métricas do daemon
+    explicit Collector(const Options &opt) : o(opt), core(opt.key), sink(o) {} // Monta
+
+    void onReadable(); // Drena o socket
+    void flush(); // Repasse + ACKs
+}; // fim: struct Collector
+
+void Collector::onReadable() { // recvmmsg em rajadas até EAGAIN
+    std::vector<uint8_t> bufs(o.burst * udpproto::kMaxDatagram); // Datagramas da rajada
+    std::vector<mmsghdr> msgs(o.burst); std::vector<iovec> iov(o.burst); std::vector<sockaddr_in> from(o.burst); // Descritores
+    for (;;) { // Até esvaziar
+        for (unsigned i = 0; i < o.burst; ++i) { // Prepara a rajada
+            iov[i].iov_base = &bufs[i * udpproto::kMaxDatagram]; iov[i].iov_len = udpproto::kMaxDatagram; // Buffer
+            msgs[i].msg_hdr = msghdr(); msgs[i].msg_hdr.msg_iov = &iov[i]; msgs[i].msg_hdr.msg_iovlen = 1; // ...
+            msgs[i].msg_hdr.msg_name = &from[i]; msgs[i].msg_hdr.msg_namelen = sizeof(from[i]); // Origem
+        }
+        int n = recvmmsg(udp, msgs.data(), o.burst, MSG_DONTWAIT, nullptr); // Uma chamada de sistema por rajada
+        if (n <= 0) return; // EAGAIN (ou erro transitório)
+        uint64_t now = monoMs(); // Recepção da rajada (época nova só após o silêncio do leitor)
+        for (int i = 0; i < n; ++i) { // Cada datagrama
+            if (pending.size() > o.maxPending) { shed++; continue; } // Destino parado: recusa (leitor retransmite)
+            udpproto::Ack ack; recs.clear(); // Saídas
+            if (core.ingest((const uint8_t *)iov[i].iov_base, msgs[i].msg_len, now, recs, ack) != CollectorCore::Verdict::OK) continue; // Inválido
+            for (const CollectorRecord &r : recs) CollectorCore::appendJson(r, pending); // NDJSON
+            pendingRecords += recs.size(); // Contagem
+            toAck[std::make_pair(std::string(ack.id), ack.epoch)] = from[i]; // Confirma no próximo repasse (duplicata também: ACK perdido)
+        }
+        if (pendingRecords >= o.batch) flush(); // Lote cheio
+        if ((unsigned)n < o.burst) return; // Socket vazio
+    }
+}
+
+void Collector::flush() { // Repasse e ACKs
+    if (!pending.empty()) { // Há registros
+        if (!sink.deliver(pending)) { forwardFails++; return; } // Sem confirmação até o destino aceitar
+        forwards++; pending.clear(); pendingRecords = 0; // Repassado
+    }
+    if (toAck.empty()) return; // Nada a confirmar
+    std::vector<uint8_t> bufs(toAck.size() * udpproto::kMaxDatagram); // ACKs
+    std::vector<mmsghdr> msgs(toAck.size()); std::vector<iovec> iov(toAck.size()); std::vector<sockaddr_in> to(toAck.size()); // Descritores
+    size_t k = 0; // ACKs montados
+    for (auto &e : toAck) { // Leitor/época
+        udpproto::Ack ack; // Estado atual (inclui o que chegou depois do datagrama)
+        if (!core.ackFor(e.first.first, e.first.second, ack)) continue; // Época esquecida
+        uint8_t *b = &bufs[k * udpproto::kMaxDatagram]; // Destino
+        size_t len = core.encodeAck(ack, b, udpproto::kMaxDatagram); // Selado
+        if (!len) continue; // Não coube (não ocorre)
+        to[k] = e.second; iov[k].iov_base = b; iov[k].iov_len = len; // Endereço e carga
+        msgs[k].msg_hdr = msghdr(); msgs[k].msg_hdr.msg_iov = &iov[k]; msgs[k].msg_hdr.msg_iovlen = 1; // ...
+        msgs[k].msg_hdr.msg_name = &to[k]; msgs[k].msg_hdr.msg_namelen = sizeof(to[k]); // ...
+        k++; // Próximo
+    }
+    for (size_t off = 0; off < k;) { // sendmmsg em rajadas (limite do kernel por chamada)
+        int s = sendmmsg(udp, msgs.data() + off, (unsigned)std::min<size_t>(k - off, 1024), 0); // Envia
+        if (s <= 0) break; // Buffer cheio: leitores retransmitem e recebem o ACK depois
+        off += (size_t)s; acksSent += (uint64_t)s; // Avança
+    }
+    toAck.clear(); // Confirmados
+}
+
+static bool parseArgs(int argc, char **argv, Options &o) { // Linha de comando
+    for (int i = 1; i < argc; ++i) { // Cada opção
+        std::string a = argv[i]; // Nome
+        const char *v = i + 1 < argc ? argv[i + 1] : nullptr; // Valor
+        if (a == "--help" || a == "-h") return false; // Uso
+        if (!v) { fprintf(stderr, "rfid_collector: %s sem valor\n", a.c_str()); return false; } // Toda opção tem valor
+        if (a == "--key") o.key = v; // Chave
+        else if (a == "--port") o.port = (uint16_t)strtoul(v, nullptr, 10); // Porta
+        else if (a == "--bind") o.bind = v; // Interface
+        else if (a == "--out") o.out = v; // Arquivo
+        else if (a == "--forward") o.forward = v; // Backend HTTP
+        else if (a == "--batch") o.batch = strtoul(v, nullptr, 10); // Registros por repasse
+        else if (a == "--flush-ms") o.flushMs = (uint32_t)strtoul(v, nullptr, 10); // Período
+        else if (a == "--burst") o.burst = (unsigned)strtoul(v, nullptr, 10); // Rajada
+        else if (a == "--rcvbuf") o.rcvbuf = (int)strtoul(v, nullptr, 10); // SO_RCVBUF
+        else if (a == "--max-pending") o.maxPending = strtoul(v, nullptr, 10); // Limite sem repasse
+        else if (a == "--stats-s") o.statsS = (uint32_t)strtoul(v, nullptr, 10); // Métricas
+        else { fprintf(stderr, "rfid_collector: opcao desconhecida %s\n", a.c_str()); return false; } // Erro
+        ++i; // Consome o valor
+    }
+    if (o.key.empty() && getenv("RFID_UDP_KEY")) o.key = getenv("RFID_UDP_KEY"); // Chave pelo ambiente
+    if (o.key.empty()) { fprintf(stderr, "rfid_collector: --key (ou RFID_UDP_KEY) obrigatoria\n"); return false; } // Sem chave
+    if (o.burst == 0) o.burst = 1; // Mínimo
+    if (o.flushMs == 0) o.flushMs = 1; // Mínimo
+    return true; // Válido
+}
+
+int main(int argc, char **argv) { // Início: main()
+    Options opt; // Configuração
+    if (!parseArgs(argc, argv, opt)) { // Uso
+        fprintf(stderr, "uso: rfid_collector --key CHAVE [--port 47474] [--bind 0.0.0.0] [--out arquivo|-] [--forward http://host:porta/caminho]\n" // ...
+                        "                      [--batch 2000] [--flush-ms 100] [--burst 64] [--rcvbuf 8388608] [--max-pending 67108864] [--stats-s 10]\n"); // ...
+        return 2; // Erro de uso
+    }
+    Collector c(opt); // Estado
+    if (!c.sink.open()) return 1; // Destino inválido
+
+    c.udp = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0); // Socket UDP
+    int one = 1; setsockopt(c.udp, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)); // Reinício rápido
+    setsockopt(c.udp, SOL_SOCKET, SO_RCVBUF, &opt.rcvbuf, sizeof(opt.rcvbuf)); // Absorve rajadas
+    sockaddr_in addr = {}; addr.sin_family = AF_INET; addr.sin_port = htons(opt.port); // Endereço local
+    if (inet_pton(AF_INET, opt.bind.c_str(), &addr.sin_addr) != 1 || bind(c.udp, (sockaddr *)&addr, sizeof(addr)) != 0) { // Abre a porta
+        fprintf(stderr, "rfid_collector: bind %s:%u: %s\n", opt.bind.c_str(), (unsigned)opt.port, strerror(errno)); return 1; // Falhou
+    }
+
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK); // Repasse periódico
+    itimerspec its = {}; its.it_interval.tv_sec = opt.flushMs / 1000; its.it_interval.tv_nsec = (long)(opt.flushMs % 1000) * 1000000L; its.it_value = its.it_interval; // Período
+    timerfd_settime(tfd, 0, &its, nullptr); // Arma
+    sigset_t mask; sigemptyset(&mask); sigaddset(&mask, SIGINT); sigaddset(&mask, SIGTERM); // Encerramento
+    sigprocmask(SIG_BLOCK, &mask, nullptr); // Entregues só pelo signalfd
+    int sfd = signalfd(-1, &mask, SFD_NONBLOCK); // ...
+
+    int ep = epoll_create1(0); // Laço de eventos
+    epoll_event ev = {}; ev.events = EPOLLIN; // Leitura
+    ev.data.fd = c.udp; epoll_ctl(ep, EPOLL_CTL_ADD, c.udp, &ev); // Datagramas
+    ev.data.fd = tfd; epoll_ctl(ep, EPOLL_CTL_ADD, tfd, &ev); // Timer
+    ev.data.fd = sfd; epoll_ctl(ep, EPOLL_CTL_ADD, sfd, &ev); // Sinais
+    fprintf(stderr, "rfid_collector: escutando %s:%u (lote %zu, repasse %u ms, %s)\n", opt.bind.c_str(), (unsigned)opt.port, opt.batch, // Diagnóstico
+            (unsigned)opt.flushMs, opt.forward.empty() ? opt.out.c_str() : opt.forward.c_str()); // ...
+
+    uint64_t lastStats = monoMs(); CollectorStats prev = c.core.stats(); // Janela das métricas
+    bool running = true; // Até SIGINT/SIGTERM
+    while (running) { // Laço de eventos
+        epoll_event evs[4]; // Prontos
+        int n = epoll_wait(ep, evs, 4, -1); // Espera
+        if (n < 0 && errno == EINTR) continue; // Sinal não bloqueado
+        for (int i = 0; i < n; ++i) { // Cada descritor pronto
+            if (evs[i].data.fd == c.udp) c.onReadable(); // Datagramas
+            else if (evs[i].data.fd == tfd) { uint64_t x; if (read(tfd, &x, sizeof(x)) > 0) c.flush(); } // Período
+            else if (evs[i].data.fd == sfd) running = false; // Encerrar
+        }
+        uint64_t now = monoMs(); // Métricas periódicas
+        if (opt.statsS && now - lastStats >= opt.statsS * 1000ull) { // Venceu
+            const CollectorStats &s = c.core.stats(); double dt = (now - lastStats) / 1000.0; // Janela
+            fprintf(stderr, "rfid_collector: %.0f datagramas/s %.0f registros/s | leitores %zu dup %llu fora-janela %llu abandonados %llu etiqueta %llu epoca-velha %llu recusados %llu acks %llu repasses %llu falhas %llu\n", // Linha
+                    (s.datagrams - prev.datagrams) / dt, (s.records - prev.records) / dt, c.core.devices(), (unsigned long long)s.duplicates, // ...
+                    (unsigned long long)s.beyond, (unsigned long long)s.skipped, (unsigned long long)s.badTag, (unsigned long long)s.staleEpoch, (unsigned long long)c.shed, // ...
+                    (unsigned long long)c.acksSent, (unsigned long long)c.forwards, (unsigned long long)c.forwardFails); // ...
+            lastStats = now; prev = s; // Próxima janela
+        }
+    }
+    c.flush(); // Último repasse (e ACKs)
+    const CollectorStats &s = c.core.stats(); // Totais
+    fprintf(stderr, "rfid_collector: encerrado | datagramas %llu registros %llu duplicados %llu leitores %zu pendentes %zu\n", // Resumo
+            (unsigned long long)s.datagrams, (unsigned long long)s.records, (unsigned long long)s.duplicates, c.core.devices(), c.pendingRecords); // ...
+    close(ep); close(sfd); close(tfd); close(c.udp); // Libera
+    return c.pending.empty() ? 0 : 1; // 1: registros não repassados
+} // fim: main()
@@ -0,0 +1,281 @@
+/*
+    Arquivo: tools/collector/udp_loadgen.cpp
+    Propósito: Gerador de carga para o rfid_collector. Simula N leitores com o
+    mesmo protocolo do UdpUplink (lote até --batch ou --linger-ms, janela de
+    --window datagramas, RTO com backoff, retransmissão do que não foi
+    confirmado), sobre sockets UDP reais distribuídos em --sockets portas
+    locais. Cada leitor gera --rate leituras/s durante --seconds; depois o
+    gerador espera os ACKs por até --drain-s. Relata vazão confirmada,
+    datagramas/s, retransmissões e latência do ACK; sai com 1 se algum
+    registro ficou sem confirmação. --loss descarta uma fração dos envios
+    (exercita retransmissão e deduplicação no coletor).
+
+      rfid_collector --key k --out /dev/null &
+      udp_loadgen --key k [--target 127.0.0.1:47474] [--devices 1000] [--rate 2]
+                  [--seconds 10] [--batch 32] [--linger-ms 200] [--window 4]
+                  [--rto-ms 500] [--sockets 16] [--loss 0] [--drain-s 20] [--seed 1]
+*/
+
+#include "UdpProto.h" // Formato dos datagramas
+#include <arpa/inet.h> // inet_pton
+#include <errno.h> // errno
+#include <netinet/in.h> // sockaddr_in
+#include <stdio.h> // printf
+#include <stdlib.h> // strtoul, strtod
+#include <string.h> // strerror
+#include <sys/epoll.h> // epoll
+#include <sys/socket.h> // sendmmsg, recvmmsg
+#include <time.h> // clock_gettime, time
+#include <unistd.h> // close
+#include <algorithm> // std::sort, std::min
+#include <random> // std::mt19937
+#include <string> // Argumentos
+#include <vector> // Leitores, rajadas
+
+// Parâmetros de linha de comando
+struct Options { // Cenário
+    std::string key; // Chave HMAC
+    std::string target = "127.0.0.1:47474"; // Coletor
+    unsigned devices = 1000; // Leitores simulados
+    double rate = 2; // Leituras/s por leitor
+    double seconds = 10; // Duração da geração
+    unsigned batch = 32; // UDP_BATCH_MAX
+    unsigned lingerMs = 200; // UDP_BATCH_LINGER_MS
+    unsigned window = 4; // UDP_WINDOW
+    unsigned rtoMs = 500; // UDP_RTO_MS
+    unsigned rtoMaxMs = 8000; // UDP_RTO_MAX_MS
+    unsigned sockets = 16; // Portas locais
+    double loss = 0; // Fração de envios descartados
+    double drainS = 20; // Espera final pelos ACKs (> 2 x UDP_RTO_MAX_MS: uma perda após o backoff)
+    uint32_t seed = 1; // Semente
+}; // fim: struct Options
+
+static uint64_t nowUs() { timespec t; clock_gettime(CLOCK_MONOTONIC, &t); return (uint64_t)t.tv_sec * 1000000 + t.tv_nsec / 1000; } // Relógio monotônico
+
+// Datagrama em voo de um leitor (mesma estrutura do UdpUplink)
+struct Flight { bool used; uint32_t first; uint8_t count; uint8_t tries; uint64_t sentUs; uint32_t rtoMs; }; // Slot da janela
+
+// Leitor simulado
+struct Device { // Estado de um leitor
+    char id[16]; // DEVICE_ID
+    uint32_t epoch; // Época
+    uint32_t end; // Próxima sequência a gerar (= registros gerados)
+    uint32_t next; // Próxima sequência a enviar
+    uint32_t cum; // Confirmado pelo coletor (fila do leitor começa aqui)
+    uint64_t nextReadUs; // Próxima leitura
+    bool lingering; uint64_t lingerUs; // Espera do lote
+    std::vector<Flight> fl; // Janela
+    unsigned sock; // Índice do socket
+}; // fim: struct Device
+
+// Datagramas a enviar numa rajada de sendmmsg por socket
+struct OutQueue { std::vector<uint8_t> bytes; std::vector<size_t> off, len; }; // Arena + fatias
+
+// Gerador
+struct LoadGen { // Estado do processo
+    Options o; // Cenário
+    sockaddr_in target = {}; // Coletor
+    std::vector<int> socks; // Sockets locais
+    std::vector<OutQueue> out; // Envios pendentes por socket
+    std::vector<Device> devs; // Leitores
+    std::mt19937 rng; // Aleatoriedade
+    uint64_t t0 = 0; // Início
+    uint64_t datagrams = 0, dropped = 0, retransmits = 0, acks = 0, rejected = 0, bytes = 0; // Métricas
+    std::vector<uint32_t> latUs; // Latência do ACK (datagramas não retransmitidos)
+
+    const uint8_t *key() const { return (const uint8_t *)o.key.data(); } // Chave como bytes
+    bool transmit(Device &d, Flight &f, uint64_t now); // Monta e enfileira o datagrama do slot
+    void service(Device &d, uint64_t now, bool generating); // Leituras, retransmissões, lotes novos
+    void flushOut(); // sendmmsg por socket
+    void receive(int fd); // recvmmsg + ACKs
+    void onAck(const udpproto::Ack &a, uint64_t now); // Aplica um ACK
+}; // fim: struct LoadGen
+
+bool LoadGen::transmit(Device &d, Flight &f, uint64_t now) { // Monta o DATA da faixa
+    udpproto::DataHeader h; // Cabeçalho
+    memcpy(h.id, d.id, sizeof(d.id)); // Leitor
+    h.epoch = d.epoch; h.low = d.cum; h.first = f.first; h.sentMs = (uint32_t)((now - t0) / 1000); h.unixS = (uint32_t)time(nullptr); h.count = 0; // Cursores
+    uint8_t pkt[udpproto::kMaxDatagram]; udpproto::Writer w(pkt, sizeof(pkt)); // Destino
+    udpproto::beginData(w, h); size_t countPos = w.len - 1; // Cabeçalho
+    for (uint8_t i = 0; i < f.count; ++i) { // Registros
+        uint32_t seq = f.first + i; // Sequência
+        uint32_t x = (uint32_t)(&d - devs.data()) * 2654435761u ^ seq * 40503u; // UID determinística
+        udpproto::Record r; r.uidLen = 4; r.uid[0] = (uint8_t)(x >> 24); r.uid[1] = (uint8_t)(x >> 16); r.uid[2] = (uint8_t)(x >> 8); r.uid[3] = (uint8_t)x; // 4 bytes
+        r.captureMs = seq; // Irrelevante para o coletor
+        if (!udpproto::addRecord(w, countPos, r)) { f.count = i; break; } // Não coube
+    }
+    size_t len = udpproto::seal(w, key(), o.key.size()); // Etiqueta
+    f.sentUs = now; // Referência do RTO
+    if (!len || f.count == 0) return false; // Faixa vazia
+    if (o.loss > 0 && std::uniform_real_distribution<double>(0, 1)(rng) < o.loss) { dropped++; return true; } // "Perdido na rede"
+    OutQueue &q = out[d.sock]; // Socket do leitor
+    q.off.push_back(q.bytes.size()); q.len.push_back(len); q.bytes.insert(q.bytes.end(), pkt, pkt + len); // Enfileira
+    datagrams++; bytes += len; // Métricas
+    return true; // Em voo
+}
+
+void LoadGen::service(Device &d, uint64_t now, bool generating) { // Uma passada do leitor
+    double periodUs = 1e6 / o.rate; // Intervalo médio entre leituras
+    while (generating && d.nextReadUs <= now) { // Leituras vencidas
+        d.end++; // Nova leitura na fila
+        d.nextReadUs += (uint64_t)(std::exponential_distribution<double>(1.0)(rng) * periodUs) + 1; // Processo de Poisson
+    }
+    for (Flight &f : d.fl) { // Retransmissões
+        if (!f.used || now - f.sentUs < (uint64_t)f.rtoMs * 1000) continue; // No prazo
+        if (f.tries < 255) f.tries++; // Mais um envio
+        f.rtoMs = std::min(f.rtoMs * 2, o.rtoMaxMs); // Backoff
+        if (transmit(d, f, now)) retransmits++; else f.used = false; // Reenvia
+    }
+    for (;;) { // Lotes novos
+        uint32_t pending = d.end - d.next; // Nunca enviados
+        if (pending == 0) { d.lingering = false; return; } // Tudo enviado
+        if (!d.lingering) { d.lingering = true; d.lingerUs = now; } // Começa o lote
+        if (pending < o.batch && now - d.lingerUs < (uint64_t)o.lingerMs * 1000) return; // Espera completar
+        Flight *f = nullptr; for (Flight &s : d.fl) if (!s.used) { f = &s; break; } // Slot livre
+        if (!f) return; // Janela cheia
+        f->used = true; f->first = d.next; f->count = (uint8_t)std::min<uint32_t>(pending, std::min<unsigned>(o.batch, udpproto::kMaxRecords)); // Faixa
+        f->tries = 1; f->rtoMs = o.rtoMs; // Primeiro envio
+        if (!transmit(d, *f, now)) { f->used = false; return; } // Nada coube
+        d.next += f->count; // Avança
+        if (d.next == d.end) d.lingering = false; // Próximo lote do zero
+    }
+}
+
+void LoadGen::flushOut() { // Uma rajada por socket
+    for (size_t s = 0; s < socks.size(); ++s) { // Cada socket
+        OutQueue &q = out[s]; // Fila
+        if (q.off.empty()) continue; // Nada
+        std::vector<mmsghdr> msgs(q.off.size()); std::vector<iovec> iov(q.off.size()); // Descritores
+        for (size_t i = 0; i < q.off.size(); ++i) { // Cada datagrama
+            iov[i].iov_base = &q.bytes[q.off[i]]; iov[i].iov_len = q.len[i]; // Carga
+            msgs[i].msg_hdr = msghdr(); msgs[i].msg_hdr.msg_iov = &iov[i]; msgs[i].msg_hdr.msg_iovlen = 1; // ...
+            msgs[i].msg_hdr.msg_name = &target; msgs[i].msg_hdr.msg_namelen = sizeof(target); // Coletor
+        }
+        for (size_t off = 0; off < msgs.size();) { // Limite por chamada
+            int n = sendmmsg(socks[s], msgs.data() + off, (unsigned)std::min<size_t>(msgs.size() - off, 1024), 0); // Envia
+            if (n <= 0) { dropped += msgs.size() - off; break; } // Buffer cheio: conta como perda (RTO reenvia)
+            off += (size_t)n; // Avança
+        }
+        q.bytes.clear(); q.off.clear(); q.len.clear(); // Esvazia
+    }
+}
+
+void LoadGen::onAck(const udpproto::Ack &a, uint64_t now) { // Aplica um ACK
+    unsigned idx = (unsigned)strtoul(a.id + 5, nullptr, 10); // "load-NNNNNN"
+    if (idx >= devs.size() || devs[idx].epoch != a.epoch || (int32_t)(a.cum - devs[idx].next) > 0) { rejected++; return; } // Inválido
+    Device &d = devs[idx]; acks++; // Leitor
+    for (Flight &f : d.fl) { // Slots em voo
+        if (!f.used) continue; // Livre
+        uint32_t end = f.first + f.count; // Fim
+        bool done = (int32_t)(a.cum - end) >= 0; // Cumulativo
+        for (uint8_t r = 0; r < a.nranges && !done; ++r) done = (int32_t)(f.first - a.ranges[r].start) >= 0 && (int32_t)(a.ranges[r].start + a.ranges[r].len - end) >= 0; // Faixa
+        if (!done) continue; // Pendente
+        if (f.tries == 1) latUs.push_back((uint32_t)std::min<uint64_t>(now - f.sentUs, UINT32_MAX)); // Latência (Karn)
+        f.used = false; // Libera
+    }
+    if ((int32_t)(a.cum - d.cum) > 0) d.cum = a.cum; // Fila do leitor encolhe
+    for (Flight &f : d.fl) if (f.used && (int32_t)(f.first + f.count - d.cum) <= 0) f.used = false; // Faixas já cobertas
+}
+
+void LoadGen::receive(int fd) { // Drena ACKs do socket
+    const unsigned kBurst = 64; // Rajada
+    static uint8_t bufs[kBurst][udpproto::kMaxDatagram]; // Datagramas
+    mmsghdr msgs[kBurst]; iovec iov[kBurst]; // Descritores
+    for (;;) { // Até EAGAIN
+        for (unsigned i = 0; i < kBurst; ++i) { iov[i].iov_base = bufs[i]; iov[i].iov_len = sizeof(bufs[i]); msgs[i].msg_hdr = msghdr(); msgs[i].msg_hdr.msg_iov = &iov[i]; msgs[i].msg_hdr.msg_iovlen = 1; } // Prepara
+        int n = recvmmsg(fd, msgs, kBurst, MSG_DONTWAIT, nullptr); // Lote
+        if (n <= 0) return; // Vazio
+        uint64_t now = nowUs(); // Recepção
+        for (int i = 0; i < n; ++i) { // Cada ACK
+            udpproto::Ack a; // Decodificado
+            if (!udpproto::verify(key(), o.key.size(), bufs[i], msgs[i].msg_len) || !udpproto::decodeAck(bufs[i], msgs[i].msg_len, a)) { rejected++; continue; } // Inválido
+            onAck(a, now); // Aplica
+        }
+        if ((unsigned)n < kBurst) return; // Esvaziou
+    }
+}
+
+static bool parseArgs(int argc, char **argv, Options &o) { // Linha de comando
+    for (int i = 1; i + 1 < argc; i += 2) { // Pares --opção valor
+        std::string a = argv[i]; const char *v = argv[i + 1]; // Nome e valor
+        if (a == "--key") o.key = v; else if (a == "--target") o.target = v; // Chave, coletor
+        else if (a == "--devices") o.devices = (unsigned)strtoul(v, nullptr, 10); else if (a == "--rate") o.rate = strtod(v, nullptr); // Frota, taxa
+        else if (a == "--seconds") o.seconds = strtod(v, nullptr); else if (a == "--batch") o.batch = (unsigned)strtoul(v, nullptr, 10); // Duração, lote
+        else if (a == "--linger-ms") o.lingerMs = (unsigned)strtoul(v, nullptr, 10); else if (a == "--window") o.window = (unsigned)strtoul(v, nullptr, 10); // Espera, janela
+        else if (a == "--rto-ms") o.rtoMs = (unsigned)strtoul(v, nullptr, 10); else if (a == "--sockets") o.sockets = (unsigned)strtoul(v, nullptr, 10); // RTO, sockets
+        else if (a == "--loss") o.loss = strtod(v, nullptr); else if (a == "--drain-s") o.drainS = strtod(v, nullptr); // Perda, espera final
+        else if (a == "--seed") o.seed = (uint32_t)strtoul(v, nullptr, 10); // Semente
+        else { fprintf(stderr, "udp_loadgen: opcao desconhecida %s\n", a.c_str()); return false; } // Erro
+    }
+    if (o.key.empty() && getenv("RFID_UDP_KEY")) o.key = getenv("RFID_UDP_KEY"); // Chave pelo ambiente
+    return !o.key.empty() && o.devices > 0 && o.devices <= 999999 && o.rate > 0 && o.window > 0 && o.batch > 0 && o.sockets > 0; // Válido
+}
+
+int main(int argc, char **argv) { // Início: main()
+    LoadGen g; // Estado
+    if (!parseArgs(argc, argv, g.o)) { // Uso
+        fprintf(stderr, "uso: udp_loadgen --key CHAVE [--target 127.0.0.1:47474] [--devices 1000] [--rate 2] [--seconds 10] [--batch 32]\n" // ...
+                        "                   [--linger-ms 200] [--window 4] [--rto-ms 500] [--sockets 16] [--loss 0] [--drain-s 20] [--seed 1]\n"); // ...
+        return 2; // Erro de uso
+    }
+    const Options &o = g.o; // Atalho
+    size_t c = o.target.rfind(':'); // host:porta
+    g.target.sin_family = AF_INET; g.target.sin_port = htons((uint16_t)strtoul(o.target.c_str() + c + 1, nullptr, 10)); // Porta
+    if (c == std::string::npos || inet_pton(AF_INET, o.target.substr(0, c).c_str(), &g.target.sin_addr) != 1) { fprintf(stderr, "udp_loadgen: --target invalido\n"); return 2; } // IPv4
+    g.rng.seed(o.seed); // Reprodutível
+
+    int ep = epoll_create1(0); // Espera por ACKs
+    for (unsigned s = 0; s < o.sockets; ++s) { // Sockets locais (portas efêmeras)
+        int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0); // UDP
+        int sz = 4 << 20; setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &sz, sizeof(sz)); setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sz, sizeof(sz)); // Rajadas
+        epoll_event ev = {}; ev.events = EPOLLIN; ev.data.fd = fd; epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev); // Registra
+        g.socks.push_back(fd); // Guarda
+    }
+    g.out.resize(o.sockets); // Filas de envio
+    g.t0 = nowUs(); // Início
+    g.devs.resize(o.devices); // Frota
+    for (unsigned i = 0; i < o.devices; ++i) { // Cada leitor
+        Device &d = g.devs[i]; // Estado
+        snprintf(d.id, sizeof(d.id), "load-%06u", i); // DEVICE_ID
+        d.epoch = g.rng() | 1; d.end = d.next = d.cum = 0; d.lingering = false; d.lingerUs = 0; // Boot
+        d.nextReadUs = g.t0 + (uint64_t)(std::uniform_real_distribution<double>(0, 1e6 / o.rate)(g.rng)); // Fase aleatória
+        d.fl.assign(o.window, Flight()); d.sock = i % o.sockets; // Janela e socket
+    }
+
+    uint64_t genEnd = g.t0 + (uint64_t)(o.seconds * 1e6), deadline = genEnd + (uint64_t)(o.drainS * 1e6); // Fases
+    uint64_t lastReport = g.t0; // Progresso
+    for (;;) { // Laço principal (passadas de ~1 ms)
+        uint64_t now = nowUs(); // Tempo atual
+        bool generating = now < genEnd; // Ainda gerando leituras
+        for (Device &d : g.devs) g.service(d, now, generating); // Todos os leitores
+        g.flushOut(); // Envia
+        epoll_event evs[64]; int n = epoll_wait(ep, evs, 64, 1); // ACKs (ou 1 ms)
+        for (int i = 0; i < n; ++i) g.receive(evs[i].data.fd); // Drena
+        uint64_t generated = 0, acked = 0; // Totais
+        for (const Device &d : g.devs) { generated += d.end; acked += d.cum; } // Soma
+        if (!generating && acked == generated) break; // Tudo confirmado
+        if (now >= deadline) break; // Desiste
+        if (now - lastReport >= 1000000) { // Progresso a cada segundo
+            fprintf(stderr, "udp_loadgen: t=%.0f s gerados %llu confirmados %llu datagramas %llu retransmissoes %llu\n", (now - g.t0) / 1e6, // ...
+                    (unsigned long long)generated, (unsigned long long)acked, (unsigned long long)g.datagrams, (unsigned long long)g.retransmits); // ...
+            lastReport = now; // Próximo
+        }
+    }
+    double elapsed = (nowUs() - g.t0) / 1e6; // Duração total
+    uint64_t generated = 0, acked = 0; // Totais finais
+    for (const Device &d : g.devs) { generated += d.end; acked += d.cum; } // Soma
+    std::sort(g.latUs.begin(), g.latUs.end()); // Percentis
+    auto pct = [&](double p) { return g.latUs.empty() ? 0u : g.latUs[std::min(g.latUs.size() - 1, (size_t)(p * g.latUs.size()))]; }; // Percentil
+    printf("udp_loadgen: %u leitores x %.1f leituras/s por %.0f s (lote %u, espera %u ms, janela %u, perda %.1f%%)\n", o.devices, o.rate, o.seconds, o.batch, // ...
+           o.lingerMs, o.window, o.loss * 100); // ...
+    printf("  registros: gerados %llu, confirmados %llu (%.2f%%) em %.2f s -> %.0f registros/s\n", (unsigned long long)generated, (unsigned long long)acked, // ...
+           generated ? 100.0 * acked / generated : 100.0, elapsed, acked / elapsed); // ...
+    printf("  datagramas: %llu enviados (%.0f/s, %.1f registros/datagrama, %.0f bytes/registro), %llu retransmissoes, %llu descartados\n", // ...
+           (unsigned long long)g.datagrams, g.datagrams / elapsed, g.datagrams ? (double)acked / g.datagrams : 0.0, acked ? (double)g.bytes / acked : 0.0, // ...
+           (unsigned long long)g.retransmits, (unsigned long long)g.dropped); // ...
+    printf("  acks: %llu aceitos, %llu recusados | latencia p50 %u us, p99 %u us, max %u us\n", (unsigned long long)g.acks, (unsigned long long)g.rejected, // ...
+           pct(0.50), pct(0.99), g.latUs.empty() ? 0u : g.latUs.back()); // ...
+    for (int fd : g.socks) close(fd); // Libera
+    close(ep); // ...
+    return acked == generated ? 0 : 1; // 1: ficou registro sem confirmação
+} // fim: main()
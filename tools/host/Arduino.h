@@ -0,0 +1,92 @@
+/*
+    Arquivo: tools/host/Arduino.h
+    Propósito: Camada Arduino mínima para compilar o firmware no host (Linux)
+    sem alterar src/. millis()/delay() delegam ao relógio padrão (Clock.h), que
+    no host é o VirtualClock de hostClock(): o tempo só avança quando o
+    simulador manda. random() é determinístico a partir de randomSeed().
+    Serial escreve em stdout e pode ser silenciado (hostSerialQuiet).
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <stdint.h> // Tipos inteiros de largura fixa
+#include <stddef.h> // size_t
+#include <stdio.h> // vprintf
+#include <stdlib.h> // atoi
+#include <string.h> // strlen, memcpy
+#include <time.h> // time(), gmtime_r, strftime
+#include <string> // std::string (armazenamento do String)
+#include "Clock.h" // defaultClock(): VirtualClock no host
+
+typedef uint8_t byte; // Tipo byte do Arduino
+
+#define PROGMEM // Sem memória de programa separada no host
+#define PSTR(s) (s) // Literais ficam na RAM
+#define F(s) (s) // Idem para F()
+#define OUTPUT 1 // pinMode
+#define INPUT 0 // pinMode
+#define LOW 0 // digitalWrite
+#define HIGH 1 // digitalWrite
+
+// Tempo: sempre do relógio padrão (virtual no host)
+inline unsigned long millis() { return defaultClock().nowMs(); } // ms (wrap em 2^32)
+inline unsigned long micros() { return defaultClock().nowUs(); } // µs (wrap em 2^32)
+inline void delay(unsigned long ms) { defaultClock().delayMs((uint32_t)ms); } // Avança o tempo simulado
+inline void yield() {} // Sem escalonador no host
+
+// GPIO sem efeito
+inline void pinMode(int, int) {} // no-op
+inline void digitalWrite(int, int) {} // no-op
+
+// Aleatoriedade determinística (mesma semente -> mesma sequência)
+void randomSeed(unsigned long seed); // Reinicia o gerador
+long random(long maxExcl); // [0, max)
+long random(long minIncl, long maxExcl); // [min, max)
+
+// NTP: no host o relógio de parede vem do sistema operacional
+inline void configTime(long, int, const char *, const char * = nullptr, const char * = nullptr) {} // no-op
+
+// String do Arduino sobre std::string (apenas o que o firmware usa)
+class String { // Início da definição da classe String
+public: // Seção pública
+    String(const char *s = "") : _s(s ? s : "") {} // De literal
+    String(const std::string &s) : _s(s) {} // De std::string
+    String(char c) : _s(1, c) {} // De caractere
+    String(int v) : _s(std::to_string(v)) {} // De inteiros
+    String(unsigned v) : _s(std::to_string(v)) {} // ...
+    String(long v) : _s(std::to_string(v)) {} // ...
+    String(unsigned long v) : _s(std::to_string(v)) {} // ...
+    String &operator+=(const String &o) { _s += o._s; return *this; } // Concatenação
+    String &operator+=(const char *o) { _s += (o ? o : ""); return *this; } // ...
+    String &operator+=(char c) { _s += c; return *this; } // ...
+    String &operator+=(int v) { _s += std::to_string(v); return *this; } // ...
+    String &operator+=(unsigned v) { _s += std::to_string(v); return *this; } // ...
+    String &operator+=(long v) { _s += std::to_string(v); return *this; } // ...
+    String &operator+=(unsigned long v) { _s += std::to_string(v); return *this; } // ...
+    friend String operator+(String a, const String &b) { a += b; return a; } // a + b
+    bool operator==(const String &o) const { return _s == o._s; } // Igualdade
+    bool operator!=(const String &o) const { return _s != o._s; } // Diferença
+    const char *c_str() const { return _s.c_str(); } // Ponteiro C
+    unsigned length() const { return (unsigned)_s.size(); } // Tamanho
+    bool isEmpty() const { return _s.empty(); } // Vazia?
+    bool reserve(unsigned n) { _s.reserve(n); return true; } // Pré-aloca
+    bool startsWith(const String &p) const { return _s.compare(0, p._s.size(), p._s) == 0; } // Prefixo
+    int indexOf(const String &p) const { size_t r = _s.find(p._s); return r == std::string::npos ? -1 : (int)r; } // Busca
+    String substring(unsigned a) const { return String(_s.substr(a)); } // Sufixo
+    String substring(unsigned a, unsigned b) const { return String(_s.substr(a, b - a)); } // Trecho [a, b)
+    long toInt() const { return atol(_s.c_str()); } // Conversão numérica
+    void trim(); // Remove espaços nas pontas
+private: // Seção privada
+    std::string _s; // Conteúdo
+}; // Fim da classe String
+
+// Serial -> stdout (silenciável para simulações longas)
+class HardwareSerial { // Início da definição da classe HardwareSerial
+public: // Seção pública
+    void begin(unsigned long) {} // Sem UART no host
+    int printf(const char *fmt, ...); // printf formatado
+    int printf_P(const char *fmt, ...); // Igual a printf (sem PROGMEM)
+    size_t print(const char *s); // Texto sem quebra
+    size_t println(const char *s = ""); // Texto com quebra
+}; // Fim da classe HardwareSerial
+extern HardwareSerial Serial; // Instância global
+extern bool hostSerialQuiet; // true: descarta toda saída do Serial
@@ -0,0 +1,90 @@
+/*
+    Arquivo: tools/host/HTTPClient.h
+    Propósito: HTTPClient simulado para o host. Cada POST é entregue ao
+    handler global hostHttp().handler, que representa o servidor: devolve o
+    código HTTP e pode avançar o relógio virtual para modelar latência. Sem
+    handler, responde 200. Se hostHttp().postHandler estiver definido, ele
+    substitui o handler e também preenche os cabeçalhos da resposta (ex.:
+    Retry-After). GETs vão para hostHttp().getHandler, que também preenche
+    corpo e cabeçalhos da resposta (sem handler: 404); com
+    HostHttpResponse::chunked, a resposta vem sem Content-Length (getSize() = -1)
+    e o corpo também pode ser lido por getStreamPtr(). Sem Wi‑Fi conectado,
+    falha como erro de transporte.
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <WiFi.h> // WiFiClient, estado do Wi‑Fi simulado
+#include <functional> // std::function
+#include <map> // Cabeçalhos
+#include <memory> // std::shared_ptr (conexão do corpo em getStreamPtr)
+#include <string> // std::string
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1) // Falha de conexão (código do core)
+
+// Requisição vista pelo servidor simulado
+struct HostHttpRequest { // Passada ao handler
+    std::string url; // URL completa
+    std::string body; // Corpo enviado
+    std::string method = "POST"; // "POST" ou "GET"
+    std::map<std::string, std::string> headers; // Cabeçalhos enviados (addHeader)
+}; // fim: struct HostHttpRequest
+
+// Resposta montada pelo servidor simulado
+struct HostHttpResponse { // Preenchida por getHandler/postHandler
+    std::string body; // Corpo
+    std::map<std::string, std::string> headers; // Cabeçalhos (ex.: ETag)
+    bool chunked = false; // true: sem Content-Length (chunked/fechamento da conexão): getSize() = -1
+}; // fim: struct HostHttpResponse
+
+// Servidor simulado do processo
+struct HostHttpControl { // Acesso via hostHttp()
+    std::function<int(const HostHttpRequest &)> handler; // Resposta do servidor (código HTTP)
+    std::function<int(const HostHttpRequest &, HostHttpResponse &)> getHandler; // Resposta a GET (código + corpo/cabeçalhos)
+    std::function<int(const HostHttpRequest &, HostHttpResponse &)> postHandler; // POST com cabeçalhos na resposta (prioridade sobre handler)
+    uint32_t requests = 0; // POSTs recebidos
+    uint32_t gets = 0; // GETs recebidos
+    size_t unreadBytes = 0; // Corpo deixado no stream no último end() (leitura abortada pelo cliente)
+}; // fim: struct HostHttpControl
+inline HostHttpControl &hostHttp() { static HostHttpControl c; return c; } // Servidor único
+
+class HTTPClient { // Início da definição da classe HTTPClient
+public: // Seção pública: subconjunto da API do arduino-esp32
+    void setConnectTimeout(int32_t) {} // Sem rede real
+    void setTimeout(uint16_t) {} // Sem rede real
+    bool begin(WiFiClient &, const String &url) { _req = HostHttpRequest(); _req.url = url.c_str(); _resp = HostHttpResponse(); _streamConn.reset(); _stream = WiFiClient(); return true; } // Abre "sessão"
+    void useHTTP10(bool) {} // Respostas simuladas já vêm sem codificação chunked no stream
+    void addHeader(const String &k, const String &v) { _req.headers[k.c_str()] = v.c_str(); } // Visto pelo servidor
+    int POST(const String &payload) { // Entrega ao servidor simulado
+        if (WiFi.status() != WL_CONNECTED) return HTTPC_ERROR_CONNECTION_REFUSED; // Sem link
+        HostHttpControl &srv = hostHttp(); // Servidor
+        srv.requests++; // Conta requisição
+        _resp = HostHttpResponse(); // Resposta nova
+        _req.method = "POST"; _req.body = payload.c_str(); // Requisição
+        if (srv.postHandler) return srv.postHandler(_req, _resp); // Código + cabeçalhos
+        if (!srv.handler) return 200; // Servidor sempre OK
+        return srv.handler(_req); // Código decidido pelo cenário
+    }
+    int GET() { // Entrega ao servidor simulado
+        if (WiFi.status() != WL_CONNECTED) return HTTPC_ERROR_CONNECTION_REFUSED; // Sem link
+        HostHttpControl &srv = hostHttp(); // Servidor
+        srv.gets++; // Conta requisição
+        if (!srv.getHandler) return 404; // Nada publicado
+        _req.method = "GET"; // Requisição
+        return srv.getHandler(_req, _resp); // Código + resposta
+    }
+    void collectHeaders(const char *[], size_t) {} // Todos os cabeçalhos ficam disponíveis
+    String header(const char *k) { auto it = _resp.headers.find(k); return it == _resp.headers.end() ? String() : String(it->second); } // Cabeçalho da resposta
+    int getSize() { return _resp.chunked ? -1 : (int)_resp.body.size(); } // Content-Length (-1 se ausente)
+    String getString() { return String(_resp.body); } // Corpo
+    WiFiClient *getStreamPtr() { // Corpo cru numa conexão que o servidor fecha ao fim
+        if (!_streamConn) { _streamConn = std::make_shared<HostTcpConn>(); _streamConn->toServer = _resp.body; _streamConn->peerClosed = true; } // Uma por resposta
+        _stream = WiFiClient(_streamConn); // Cliente sobre a conexão
+        return &_stream; // Ponteiro válido até end()
+    }
+    void end() { hostHttp().unreadBytes = _streamConn ? _streamConn->toServer.size() : 0; _streamConn.reset(); _stream = WiFiClient(); } // Libera "sessão"
+private: // Seção privada
+    HostHttpRequest _req; // Requisição da sessão
+    HostHttpResponse _resp; // Resposta da última requisição
+    std::shared_ptr<HostTcpConn> _streamConn; // Conexão do corpo (getStreamPtr)
+    WiFiClient _stream; // Cliente devolvido por getStreamPtr()
+}; // Fim da classe HTTPClient
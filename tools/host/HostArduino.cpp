@@ -0,0 +1,60 @@
+/*
+    Arquivo: tools/host/HostArduino.cpp
+    Propósito: Implementa as partes não-inline da camada Arduino do host:
+    gerador aleatório determinístico, String::trim e Serial em stdout.
+*/
+
+#include <Arduino.h> // Declarações da camada Arduino do host
+#include <stdarg.h> // va_list
+#include <ctype.h> // isspace
+#include <random> // std::mt19937
+
+HardwareSerial Serial; // Instância global do Serial
+bool hostSerialQuiet = false; // Saída habilitada por padrão
+
+static std::mt19937 &rng() { static std::mt19937 g(1); return g; } // Gerador único do processo
+
+void randomSeed(unsigned long seed) { rng().seed((uint32_t)seed); } // Reinicia sequência
+
+long random(long maxExcl) { return maxExcl <= 0 ? 0 : (long)(rng()() % (unsigned long)maxExcl); } // [0, max)
+
+long random(long minIncl, long maxExcl) { // [min, max)
+    if (maxExcl <= minIncl) return minIncl; // Intervalo vazio
+    return minIncl + random(maxExcl - minIncl); // Desloca para o intervalo
+}
+
+void String::trim() { // Remove espaços nas pontas
+    size_t a = 0, b = _s.size(); // Limites do conteúdo útil
+    while (a < b && isspace((unsigned char)_s[a])) ++a; // Avança início
+    while (b > a && isspace((unsigned char)_s[b - 1])) --b; // Recua fim
+    _s = _s.substr(a, b - a); // Aplica corte
+}
+
+int HardwareSerial::printf(const char *fmt, ...) { // printf para stdout
+    if (hostSerialQuiet) return 0; // Silenciado
+    va_list ap; // Argumentos variádicos
+    va_start(ap, fmt); // Início
+    int n = vprintf(fmt, ap); // Imprime
+    va_end(ap); // Fim
+    return n; // Bytes escritos
+}
+
+int HardwareSerial::printf_P(const char *fmt, ...) { // Igual a printf no host
+    if (hostSerialQuiet) return 0; // Silenciado
+    va_list ap; // Argumentos variádicos
+    va_start(ap, fmt); // Início
+    int n = vprintf(fmt, ap); // Imprime
+    va_end(ap); // Fim
+    return n; // Bytes escritos
+}
+
+size_t HardwareSerial::print(const char *s) { // Texto sem quebra
+    if (hostSerialQuiet) return 0; // Silenciado
+    fputs(s, stdout); // Escreve
+    return strlen(s); // Bytes escritos
+}
+
+size_t HardwareSerial::println(const char *s) { // Texto + quebra de linha
+    if (hostSerialQuiet) return 0; // Silenciado
+    return (size_t)printf("%s\n", s); // Reaproveita printf
+}
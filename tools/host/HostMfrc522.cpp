@@ -0,0 +1,198 @@
+/*
+    Arquivo: tools/host/HostMfrc522.cpp
+    Propósito: Implementa o MFRC522 simulado, o campo de RF do host e a
+    memória MIFARE Classic dos cartões (leitura autenticada).
+*/
+
+#include <MFRC522.h> // Declarações do leitor simulado
+#include <SPI.h> // SPIClass
+#include "Clock.h" // hostClock(): custo dos comandos
+
+SPIClass SPI; // Instância global do barramento simulado
+
+HostRfidField &hostRfid() { static HostRfidField f; return f; } // Campo único do processo
+
+int HostRfidField::find(const byte *uid, byte size) const { // Busca por UID
+    for (size_t i = 0; i < _cards.size(); ++i) { // Percorre cartões
+        if (_cards[i].size == size && memcmp(_cards[i].uid, uid, size) == 0) return (int)i; // Achou
+    }
+    return -1; // Ausente
+}
+
+void HostRfidField::enter(const byte *uid, byte size, uint32_t leaveAtMs) { // Cartão aproximado
+    if (size > sizeof(HostCard::uid) || find(uid, size) >= 0) return; // Inválido ou já presente
+    HostCard c = {}; // Novo cartão (bytes não usados do UID zerados)
+    memcpy(c.uid, uid, size); // UID
+    c.size = size; // Tamanho
+    c.state = HostCard::IDLE; // Energizado: responde a REQA
+    c.leaveAtMs = leaveAtMs; // Saída agendada (0: nenhuma)
+    _cards.push_back(c); // Entra no campo
+}
+
+void HostRfidField::leave(const byte *uid, byte size) { // Cartão afastado (perde energia)
+    int i = find(uid, size); // Localiza
+    if (i >= 0) _cards.erase(_cards.begin() + i); // Sai do campo
+}
+
+void HostRfidField::expire() { // Saídas agendadas (o firmware só percebe no próximo comando)
+    uint32_t now = hostClock().nowMs(); // Instante atual
+    for (size_t i = _cards.size(); i-- > 0;) { // Do fim para o início (erase)
+        if (_cards[i].leaveAtMs && (int32_t)(now - _cards[i].leaveAtMs) >= 0) _cards.erase(_cards.begin() + i); // Saiu
+    }
+}
+
+HostCardMemory &HostRfidField::memory(const byte *uid, byte size) { // Cria de fábrica no primeiro acesso
+    return _memory[std::string((const char *)uid, size)]; // Chave = bytes da UID
+}
+
+HostCardMemory::HostCardMemory() { // Cartão de fábrica
+    memset(blocks, 0, sizeof(blocks)); // Dados zerados
+    memset(keyA, 0xFF, sizeof(keyA)); // Chave de transporte
+    memset(keyB, 0xFF, sizeof(keyB)); // Idem
+}
+
+void HostCardMemory::setBlock(byte block, const byte *data, size_t len) { // Grava um bloco
+    if (block >= 64) return; // Fora do 1K
+    memset(blocks[block], 0, 16); // Resto zerado
+    memcpy(blocks[block], data, len < 16 ? len : 16); // Até 16 bytes
+}
+
+void HostCardMemory::setKeys(byte sector, const byte *a, const byte *b) { // Troca as chaves
+    if (sector >= 16) return; // Fora do 1K
+    if (a) memcpy(keyA[sector], a, 6); // Chave A
+    if (b) memcpy(keyB[sector], b, 6); // Chave B
+}
+
+void MFRC522::PCD_Init() { // Valores de timer da biblioteca: prescaler 40 kHz, reload 1000
+    _reload = 1000; // 25 ms
+    hostRfid().timing.timeoutUs = (uint32_t)_reload * 25; // Timeout efetivo
+    hostClock().advanceUs(hostRfid().timing.initUs); // Reset + partida do oscilador
+}
+
+void MFRC522::PCD_WriteRegister(PCD_Register reg, byte value) { // Só o timer altera o modelo
+    if (reg == TReloadRegH) _reload = (uint16_t)((_reload & 0x00FF) | ((uint16_t)value << 8)); // Byte alto
+    else if (reg == TReloadRegL) _reload = (uint16_t)((_reload & 0xFF00) | value); // Byte baixo
+    hostRfid().timing.timeoutUs = (uint32_t)_reload * 25; // 25 µs por tick
+}
+
+// Regra de anticolisão da biblioteca: no primeiro bit divergente (LSB primeiro em cada byte), vence o bit 1
+static bool winsAnticollision(const HostCard &a, const HostCard &b) { // true se 'a' vence 'b'
+    for (byte i = 0; i < 10; ++i) { // Bytes na ordem de transmissão
+        byte diff = a.uid[i] ^ b.uid[i]; // Bits em colisão
+        if (!diff) continue; // Byte idêntico
+        byte bit = diff & (byte)(-diff); // Primeiro bit divergente (o menos significativo)
+        return (a.uid[i] & bit) != 0; // Cartão com bit 1 continua
+    }
+    return false; // UIDs iguais (não ocorre)
+}
+
+int MFRC522::active() { // Cartão selecionado (por estado: robusto a saídas do campo)
+    hostRfid().expire(); // Saídas agendadas até agora
+    std::vector<HostCard> &cards = hostRfid().cards(); // Campo
+    for (size_t i = 0; i < cards.size(); ++i) if (cards[i].state == HostCard::ACTIVE) return (int)i; // Só um por vez
+    return -1; // Nenhum
+}
+
+MFRC522::StatusCode MFRC522::fail() { // Comando sem resposta
+    int a = active(); // Selecionado (se ainda no campo)
+    if (a >= 0) hostRfid().cards()[a].state = HostCard::IDLE; // Perde a seleção (e a autenticação)
+    _crypto = false; // Sessão encerrada
+    hostClock().advanceUs(hostRfid().timing.timeoutUs); // Espera o timer do RC522
+    return STATUS_TIMEOUT; // Como a biblioteca
+}
+
+MFRC522::StatusCode MFRC522::PICC_RequestA(byte *bufferATQA, byte *bufferSize) { // REQA só acorda cartões em IDLE
+    hostRfid().expire(); // Saídas agendadas até agora
+    if (_crypto) { hostClock().advanceUs(hostRfid().timing.timeoutUs); return STATUS_TIMEOUT; } // Quadro cifrado: nenhum cartão em IDLE entende
+    bool any = false; // Algum cartão respondeu?
+    for (const HostCard &c : hostRfid().cards()) if (c.state == HostCard::IDLE) any = true; // Procura IDLE
+    hostClock().advanceUs(any ? hostRfid().timing.reqaUs : hostRfid().timing.timeoutUs); // Custo do comando
+    if (!any) return STATUS_TIMEOUT; // Campo vazio ou só cartões em HALT
+    if (bufferATQA && bufferSize && *bufferSize >= 2) { bufferATQA[0] = 0x04; bufferATQA[1] = 0x00; *bufferSize = 2; } // ATQA MIFARE Classic
+    return STATUS_OK; // ATQA recebido (ATQAs iguais não colidem)
+}
+
+bool MFRC522::PICC_IsNewCardPresent() { // REQA com buffer interno (como a biblioteca)
+    byte atqa[2]; // Resposta
+    byte size = sizeof(atqa); // Tamanho do buffer
+    StatusCode st = PICC_RequestA(atqa, &size); // Envia REQA
+    return st == STATUS_OK || st == STATUS_COLLISION; // Mesma regra da biblioteca
+}
+
+MFRC522::StatusCode MFRC522::PICC_Select(Uid *out, byte validBits) { // Anticolisão entre os cartões em IDLE/READY
+    hostRfid().expire(); // Saídas agendadas até agora
+    std::vector<HostCard> &cards = hostRfid().cards(); // Campo
+    int pick = -1; // Cartão selecionado
+    for (size_t i = 0; i < cards.size(); ++i) { // Percorre cartões
+        if (cards[i].state != HostCard::IDLE) continue; // Só IDLE participa
+        if (validBits) { // UID conhecida: SELECT direto (re-seleção após falha)
+            if (cards[i].size == out->size && memcmp(cards[i].uid, out->uidByte, out->size) == 0) { pick = (int)i; break; } // Mesmo cartão
+            continue; // Outro cartão não responde
+        }
+        if (pick < 0 || winsAnticollision(cards[i], cards[pick])) pick = (int)i; // Vencedor da anticolisão
+    }
+    if (pick < 0) { hostClock().advanceUs(hostRfid().timing.timeoutUs); return STATUS_TIMEOUT; } // Ninguém respondeu
+    byte levels = cards[pick].size == 4 ? 1 : (cards[pick].size == 7 ? 2 : 3); // Níveis de cascata
+    hostClock().advanceUs((uint64_t)hostRfid().timing.selectUs * levels); // Custo da seleção
+    for (HostCard &c : cards) if (c.state == HostCard::ACTIVE) c.state = HostCard::IDLE; // Seleção anterior perde o canal
+    cards[pick].state = HostCard::ACTIVE; // Selecionado
+    _crypto = false; // Nova seleção começa sem autenticação
+    out->size = cards[pick].size; // Copia UID
+    memcpy(out->uidByte, cards[pick].uid, cards[pick].size); // ...
+    out->sak = 0x08; // MIFARE Classic 1K
+    if (hostRfid().onSelect) hostRfid().onSelect(*out); // Auditoria do simulador
+    return STATUS_OK; // Sucesso
+}
+
+MFRC522::StatusCode MFRC522::PICC_HaltA() { // Selecionado -> HALT
+    int a = active(); // Selecionado (se ainda no campo)
+    hostClock().advanceUs(hostRfid().timing.timeoutUs); // HLTA não tem resposta: a biblioteca espera o timeout
+    if (a < 0) return STATUS_ERROR; // Nada selecionado
+    hostRfid().cards()[a].state = HostCard::HALT; // Não responde mais a REQA
+    return STATUS_OK; // Sucesso (o cartão real não responde ao HLTA)
+}
+
+// Setor de um bloco do 1K (blocos >= 64 não existem no cartão simulado)
+static byte sectorOf(byte block) { return (byte)(block / 4); } // 4 blocos por setor
+
+MFRC522::StatusCode MFRC522::PCD_Authenticate(byte command, byte blockAddr, MIFARE_Key *key, Uid *who) { // MFAuthent
+    int a = active(); // Selecionado
+    HostRfidField &f = hostRfid(); // Campo
+    if (a < 0 || blockAddr >= 64) return fail(); // Ninguém selecionado ou bloco inexistente
+    HostCard &c = f.cards()[a]; // Cartão selecionado
+    if (who && (who->size != c.size || memcmp(who->uidByte, c.uid, c.size) != 0)) return fail(); // UID de outro cartão
+    if (c.leaveAtMs && (int32_t)(hostClock().nowMs() + (f.timing.authUs + 999) / 1000 - c.leaveAtMs) >= 0) return fail(); // Sai durante o comando
+    if (f.lost()) return fail(); // Quadro perdido
+    HostCardMemory &m = f.memory(c.uid, c.size); // Chaves do cartão
+    byte s = sectorOf(blockAddr); // Setor
+    const byte *expect = command == PICC_CMD_MF_AUTH_KEY_B ? m.keyB[s] : m.keyA[s]; // Chave esperada
+    if (memcmp(expect, key->keyByte, 6) != 0) return fail(); // Chave errada: o cartão cala e volta a IDLE
+    hostClock().advanceUs(f.timing.authUs); // Três passos do Crypto1
+    _crypto = true; // Sessão aberta
+    _authSector = s; // Setor liberado
+    return STATUS_OK; // Autenticado
+}
+
+MFRC522::StatusCode MFRC522::MIFARE_Read(byte blockAddr, byte *buffer, byte *bufferSize) { // READ (0x30)
+    if (!buffer || !bufferSize || *bufferSize < 18) return STATUS_NO_ROOM; // Como a biblioteca: 16 + CRC
+    int a = active(); // Selecionado
+    HostRfidField &f = hostRfid(); // Campo
+    if (a < 0 || !_crypto || blockAddr >= 64 || sectorOf(blockAddr) != _authSector) return fail(); // Sem sessão para o bloco
+    HostCard &c = f.cards()[a]; // Cartão selecionado
+    if (c.leaveAtMs && (int32_t)(hostClock().nowMs() + (f.timing.readUs + 999) / 1000 - c.leaveAtMs) >= 0) return fail(); // Sai durante o comando
+    if (f.lost()) return fail(); // Quadro perdido
+    hostClock().advanceUs(f.timing.readUs); // Comando + resposta
+    memcpy(buffer, f.memory(c.uid, c.size).blocks[blockAddr], 16); // Dados
+    buffer[16] = buffer[17] = 0; // CRC (não verificado pelo firmware)
+    *bufferSize = 18; // Como a biblioteca
+    return STATUS_OK; // Lido
+}
+
+const char *MFRC522::GetStatusCodeName(StatusCode code) { // Nome legível
+    switch (code) { // Códigos usados
+        case STATUS_OK: return "OK"; // Sucesso
+        case STATUS_TIMEOUT: return "TIMEOUT"; // Sem resposta
+        case STATUS_COLLISION: return "COLLISION"; // Colisão
+        default: return "ERROR"; // Demais
+    }
+}
@@ -0,0 +1,268 @@
+/*
+    Arquivo: tools/host/HostWiFi.cpp
+    Propósito: Implementa o Wi‑Fi simulado (WiFiClass) sobre o ambiente de APs
+    de hostWifi(), com todas as durações medidas no relógio virtual, a LAN
+    simulada (WiFiServer/WiFiClient) de hostLan() e o UDP (WiFiUDP) de hostUdp().
+*/
+
+#include <WiFi.h> // Declarações do Wi‑Fi simulado
+#include <WiFiUdp.h> // UDP simulado
+#include <algorithm> // std::find
+
+WiFiClass WiFi; // Instância global
+
+HostWiFiControl &hostWifi() { static HostWiFiControl c; return c; } // Ambiente único do processo
+
+// status(): aplica as transições vencidas (link -> IP) e detecta queda do AP
+wl_status_t WiFiClass::status() { // Chamado a cada loop pelo firmware
+    uint32_t now = millis(); // Tempo virtual
+    if (_connected) { // Associado: o AP continua no ar?
+        if (_ap < 0 || !hostWifi().aps[_ap].up) { // AP caiu (queda de uplink)
+            _connected = false; // Perde link
+            _status = WL_CONNECTION_LOST; // Mesmo estado do driver real
+            fire(ARDUINO_EVENT_WIFI_STA_DISCONNECTED); // Notifica
+        }
+        return _status; // Estado atual
+    }
+    if (!_pending) return _status; // Nada em curso
+    if (!_linked && (int32_t)(now - _linkDue) >= 0) { // Fase de link vencida
+        _ap = findAp(); // AP compatível no ar?
+        if (_ap < 0) { _pending = false; _status = WL_NO_SSID_AVAIL; return _status; } // Falha (sem retry do driver)
+        _linked = true; // Associado e autenticado
+        fire(ARDUINO_EVENT_WIFI_STA_CONNECTED); // Fim da fase de link
+    }
+    if (_linked && (int32_t)(now - _ipDue) >= 0) { // Fase de IP vencida
+        if (!hostWifi().aps[_ap].up) { _pending = false; _status = WL_CONNECTION_LOST; return _status; } // Caiu no meio
+        _pending = false; // Associação concluída
+        _connected = true; // Link + IP
+        _ip = (uint32_t)_staticIp ? _staticIp : hostWifi().dhcpIp; // IP fixo/lease ou DHCP
+        if (!(uint32_t)_staticIp) { _gw = IPAddress(192, 168, 0, 1); _sn = IPAddress(255, 255, 255, 0); _dns = _gw; } // Lease DHCP
+        _status = WL_CONNECTED; // Conectado
+        fire(ARDUINO_EVENT_WIFI_STA_GOT_IP); // Fim da fase de DHCP
+    }
+    return _status; // Estado atual
+}
+
+// begin(): agenda as fases da associação conforme o alvo (direcionado ou com varredura)
+wl_status_t WiFiClass::begin(const char *ssid, const char *, int32_t channel, const uint8_t *bssid, bool) { // Inicia associação
+    if (_connected) disconnect(); // Nova associação derruba a atual
+    HostWiFiControl &w = hostWifi(); // Parâmetros do ambiente
+    _ssid = String(ssid); // Alvo
+    _targetChannel = channel; // Canal pedido (0 = qualquer)
+    _hasTargetBssid = (bssid != nullptr); // BSSID pedido?
+    if (bssid) memcpy(_targetBssid, bssid, sizeof(_targetBssid)); // Copia BSSID
+    uint32_t now = millis(); // Tempo virtual
+    bool targeted = channel > 0 && bssid; // Sem varredura de canais
+    _linkDue = now + (targeted ? 0 : w.channelScanMs) + w.linkMs; // Fim da fase de link
+    _ipDue = _linkDue + ((uint32_t)_staticIp ? 0 : w.dhcpMs); // Fim da fase de IP
+    _pending = true; // Em curso
+    _linked = false; // Link ainda não emitido
+    _status = WL_DISCONNECTED; // Como o driver real durante a associação
+    return _status; // Estado imediato
+}
+
+// config(): IP fixo (ou lease reaproveitado); 0.0.0.0 volta ao DHCP
+bool WiFiClass::config(IPAddress ip, IPAddress gw, IPAddress sn, IPAddress dns1, IPAddress) { // Configuração de IP
+    _staticIp = ip; _gw = gw; _sn = sn; _dns = dns1; // Guarda para a próxima associação
+    return true; // Sempre aceito
+}
+
+// disconnect(): aborta a associação em curso ou encerra o link
+bool WiFiClass::disconnect(bool, bool) { // Encerra/aborta
+    bool was = _connected; // Havia link?
+    _pending = false; _linked = false; _connected = false; _ap = -1; // Zera estado
+    _status = WL_DISCONNECTED; // Desconectado
+    if (was) fire(ARDUINO_EVENT_WIFI_STA_DISCONNECTED); // Notifica queda voluntária
+    return true; // Sucesso
+}
+
+// hostPowerCycle(): estado do driver após um reinício (handlers do firmware anterior não sobrevivem)
+void WiFiClass::hostPowerCycle() { // Chamado pelo simulador antes de recriar o firmware
+    _handlers.clear(); // Lambdas capturam o NetManager destruído
+    _scan.clear(); _scanState = WIFI_SCAN_FAILED; // Sem varredura
+    _pending = false; _linked = false; _connected = false; _ap = -1; // Sem associação
+    _status = WL_DISCONNECTED; // Desconectado
+    _staticIp = _ip = _gw = _sn = _dns = IPAddress(); // Volta ao DHCP
+}
+
+uint8_t *WiFiClass::BSSID() { return _connected ? hostWifi().aps[_ap].bssid : nullptr; } // MAC do AP
+int32_t WiFiClass::channel() { return _connected ? hostWifi().aps[_ap].channel : 0; } // Canal
+int8_t WiFiClass::RSSI() { return _connected ? hostWifi().aps[_ap].rssi : 0; } // Sinal
+String WiFiClass::SSID() { return _connected ? _ssid : String(); } // SSID
+
+// scanNetworks(): síncrona devolve já; assíncrona termina após asyncScanMs
+int16_t WiFiClass::scanNetworks(bool async, bool, bool, uint32_t, uint8_t) { // Inicia varredura
+    _scan.clear(); // Descarta anterior
+    if (async) { _scanState = WIFI_SCAN_RUNNING; _scanDue = millis() + hostWifi().asyncScanMs; return WIFI_SCAN_RUNNING; } // Em curso
+    _scanDue = millis(); // Termina agora
+    _scanState = WIFI_SCAN_RUNNING; // Força coleta
+    return scanComplete(); // Resultado imediato
+}
+
+// scanComplete(): ao vencer o prazo, fotografa os APs no ar
+int16_t WiFiClass::scanComplete() { // Consulta da varredura
+    if (_scanState != WIFI_SCAN_RUNNING) return _scanState; // Concluída/inexistente
+    if ((int32_t)(millis() - _scanDue) < 0) return WIFI_SCAN_RUNNING; // Ainda varrendo
+    for (const HostAp &ap : hostWifi().aps) if (ap.up) _scan.push_back(ap); // APs visíveis
+    _scanState = (int16_t)_scan.size(); // Nº de resultados
+    return _scanState; // Resultado
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventFuncCb cb, WiFiEvent_t ev) { // Registra handler
+    _handlers.push_back({cb, ev}); // Guarda
+    return (wifi_event_id_t)_handlers.size(); // Id sequencial
+}
+
+void WiFiClass::fire(WiFiEvent_t ev) { // Chama handlers registrados para ev
+    WiFiEventInfo_t info = {0}; // Sem detalhes
+    for (const Handler &h : _handlers) if (h.ev == ev) h.cb(ev, info); // Despacho síncrono
+}
+
+int WiFiClass::findAp() { // AP no ar com SSID (e canal/BSSID, se pedidos) compatíveis
+    int best = -1; // Melhor candidato
+    std::vector<HostAp> &aps = hostWifi().aps; // Ambiente
+    for (size_t i = 0; i < aps.size(); ++i) { // Percorre APs
+        if (!aps[i].up || strcmp(aps[i].ssid, _ssid.c_str()) != 0) continue; // Fora do ar ou outra rede
+        if (_hasTargetBssid && memcmp(aps[i].bssid, _targetBssid, 6) != 0) continue; // Outro AP
+        if (_targetChannel > 0 && aps[i].channel != _targetChannel) continue; // Outro canal
+        if (best < 0 || aps[i].rssi > aps[best].rssi) best = (int)i; // Mais forte
+    }
+    return best; // -1 se nenhum
+}
+
+// ---- LAN simulada (servidores no dispositivo) ----
+
+HostLanControl &hostLan() { static HostLanControl c; return c; } // LAN única do processo
+
+static bool hostLinkUp() { return (uint32_t)WiFi.localIP() != 0; } // Estação com IP (sem avançar o driver)
+
+std::shared_ptr<HostTcpConn> HostLanControl::connect(uint16_t port) { // Par abre conexão
+    if (!hostLinkUp()) return nullptr; // Dispositivo fora da rede
+    if (std::find(listening.begin(), listening.end(), port) == listening.end()) return nullptr; // Porta fechada
+    auto c = std::make_shared<HostTcpConn>(); // Nova conexão
+    c->port = port; // Destino
+    pending.push_back(c); // Aguarda accept()
+    return c; // Par guarda a ponta dele
+}
+
+void WiFiServer::begin() { // Passa a escutar
+    std::vector<uint16_t> &l = hostLan().listening; // Portas abertas
+    if (std::find(l.begin(), l.end(), _port) == l.end()) l.push_back(_port); // Sem duplicar
+}
+
+void WiFiServer::end() { // Deixa de escutar
+    std::vector<uint16_t> &l = hostLan().listening; // Portas abertas
+    l.erase(std::remove(l.begin(), l.end(), _port), l.end()); // Remove a porta
+}
+
+WiFiClient WiFiServer::accept() { // Próxima conexão pendente desta porta
+    std::vector<std::shared_ptr<HostTcpConn>> &p = hostLan().pending; // Fila de conexões
+    for (size_t i = 0; i < p.size(); ++i) { // Mais antiga primeiro
+        if (p[i]->port != _port) continue; // Outra porta
+        std::shared_ptr<HostTcpConn> c = p[i]; // Conexão
+        p.erase(p.begin() + (long)i); // Sai da fila
+        if (c->peerClosed) continue; // Par desistiu antes do accept
+        c->accepted = true; // Atendida
+        return WiFiClient(c); // Cliente do firmware
+    }
+    return WiFiClient(); // Ninguém esperando
+}
+
+uint8_t WiFiClient::connected() { // Como no core: dados por ler contam como conectado
+    if (!_c || _c->serverClosed || !hostLinkUp()) return 0; // Fechada ou sem link
+    return (!_c->peerClosed || !_c->toServer.empty()) ? 1 : 0; // Par aberto ou bytes pendentes
+}
+
+int WiFiClient::read() { // Um byte
+    if (!_c || _c->toServer.empty()) return -1; // Nada recebido
+    int b = (uint8_t)_c->toServer[0]; // Primeiro byte
+    _c->toServer.erase(0, 1); // Consome
+    return b; // Byte
+}
+
+int WiFiClient::read(uint8_t *buf, size_t len) { // Até len bytes
+    if (!_c || _c->toServer.empty()) return -1; // Nada recebido
+    size_t n = std::min(len, _c->toServer.size()); // Quanto copiar
+    memcpy(buf, _c->toServer.data(), n); // Copia
+    _c->toServer.erase(0, n); // Consome
+    return (int)n; // Bytes lidos
+}
+
+size_t WiFiClient::write(const uint8_t *buf, size_t len) { // Entrega ao par
+    if (!_c || _c->serverClosed || _c->peerClosed || !hostLinkUp()) return 0; // Conexão quebrada
+    _c->toPeer.append((const char *)buf, len); // Chega ao par
+    HostLanControl &lan = hostLan(); // Enlace
+    lan.bytesWritten += len; // Métrica
+    if (lan.bytesPerMs) hostClock().advanceUs((uint64_t)len * 1000 / lan.bytesPerMs); // Tempo de transmissão
+    return len; // Tudo escrito
+}
+
+// ---- DNS e UDP simulados ----
+
+int WiFiClass::hostByName(const char *host, IPAddress &out) { // IP literal ou tabela do simulador
+    if (!host) return 0; // Nome ausente
+    if (out.fromString(host)) return 1; // "a.b.c.d" não consulta o DNS
+    if (!hostLinkUp()) return 0; // Sem rede: DNS inacessível
+    std::map<std::string, IPAddress>::const_iterator it = hostWifi().hosts.find(host); // Tabela
+    if (it == hostWifi().hosts.end()) return 0; // Nome desconhecido
+    out = it->second; // Resolvido
+    return 1; // Sucesso
+}
+
+HostUdpControl &hostUdp() { static HostUdpControl c; return c; } // Rede UDP única do processo
+
+uint8_t WiFiUDP::begin(uint16_t port) { hostUdp().boundPort = port; return 1; } // Abre
+
+void WiFiUDP::stop() { hostUdp().boundPort = 0; _building = false; } // Fecha
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) { // Começa um datagrama
+    _out.ip = ip; _out.port = port; _out.data.clear(); // Destino
+    _building = true; // Em montagem
+    return 1; // Sucesso
+}
+
+int WiFiUDP::beginPacket(const char *host, uint16_t port) { // Resolve e começa
+    IPAddress ip; // Destino
+    if (WiFi.hostByName(host, ip) != 1) return 0; // Nome desconhecido
+    return beginPacket(ip, port); // ...
+}
+
+size_t WiFiUDP::write(const uint8_t *buf, size_t len) { // Acrescenta
+    if (!_building) return 0; // Sem beginPacket
+    _out.data.append((const char *)buf, len); // Carga
+    return len; // Tudo aceito
+}
+
+int WiFiUDP::endPacket() { // Envia
+    if (!_building) return 0; // Sem beginPacket
+    _building = false; // Concluído
+    if (!hostLinkUp()) return 0; // Sem link: lwIP recusa
+    HostUdpControl &u = hostUdp(); // Rede
+    u.datagrams++; u.bytes += _out.data.size(); // Métricas
+    uint32_t bpm = hostLan().bytesPerMs; // Vazão do enlace
+    hostClock().advanceUs(u.sendUs + (bpm ? (uint64_t)_out.data.size() * 1000 / bpm : 0)); // Driver + tempo de ar
+    if (u.onSend) u.onSend(_out); // Simulador decide o destino
+    return 1; // Entregue ao driver
+}
+
+int WiFiUDP::parsePacket() { // Próximo datagrama
+    HostUdpControl &u = hostUdp(); // Rede
+    _in = HostDatagram(); _inPos = 0; // Descarta o anterior
+    if (!u.boundPort || u.toDevice.empty() || !hostLinkUp()) return 0; // Nada a entregar
+    _in = u.toDevice.front(); // Mais antigo
+    u.toDevice.pop_front(); // Consome
+    return (int)_in.data.size(); // Tamanho
+}
+
+int WiFiUDP::read() { // Um byte
+    if (_inPos >= _in.data.size()) return -1; // Nada
+    return (uint8_t)_in.data[_inPos++]; // Byte
+}
+
+int WiFiUDP::read(uint8_t *buf, size_t len) { // Até len bytes
+    size_t n = std::min(len, _in.data.size() - _inPos); // Quanto copiar
+    if (n == 0) return -1; // Nada
+    memcpy(buf, _in.data.data() + _inPos, n); // Copia
+    _inPos += n; // Consome
+    return (int)n; // Bytes lidos
+}
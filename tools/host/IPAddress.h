@@ -0,0 +1,34 @@
+/*
+    Arquivo: tools/host/IPAddress.h
+    Propósito: IPAddress do Arduino para o host (IPv4 em 4 bytes, mesma ordem
+    de bytes do lwIP: o primeiro octeto no byte menos significativo).
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <Arduino.h> // String, tipos
+
+class IPAddress { // Início da definição da classe IPAddress
+public: // Seção pública
+    IPAddress() : _v(0) {} // 0.0.0.0
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) // Octetos
+        : _v((uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24)) {} // Empacota
+    IPAddress(uint32_t v) : _v(v) {} // Valor bruto
+    operator uint32_t() const { return _v; } // Valor bruto
+    uint8_t operator[](int i) const { return (uint8_t)(_v >> (8 * i)); } // Octeto i
+    bool fromString(const char *s) { // "a.b.c.d" -> endereço
+        unsigned a, b, c, d; // Octetos lidos
+        if (!s || sscanf(s, "%u.%u.%u.%u", &a, &b, &c, &d) != 4) return false; // Formato inválido
+        if (a > 255 || b > 255 || c > 255 || d > 255) return false; // Fora da faixa
+        *this = IPAddress((uint8_t)a, (uint8_t)b, (uint8_t)c, (uint8_t)d); // Aplica
+        return true; // Sucesso
+    }
+    String toString() const { // Endereço -> "a.b.c.d"
+        char buf[16]; // Maior forma: 255.255.255.255
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]); // Formata
+        return String(buf); // Resultado
+    }
+private: // Seção privada
+    uint32_t _v; // Endereço empacotado
+}; // Fim da classe IPAddress
+
+#define INADDR_NONE IPAddress() // 0.0.0.0 (volta ao DHCP em WiFi.config)
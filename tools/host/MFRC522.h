@@ -0,0 +1,112 @@
+/*
+    Arquivo: tools/host/MFRC522.h
+    Propósito: MFRC522 simulado para o host. Os cartões ficam num "campo de RF"
+    (hostRfid()) controlado pelo simulador. Cada cartão segue os estados ISO
+    14443-3 relevantes: IDLE (responde a REQA), ACTIVE (selecionado) e HALT
+    (só volta com WUPA ou saindo e reentrando no campo). Um cartão parado no
+    campo é, portanto, lido uma única vez, como no hardware. Com vários cartões
+    em IDLE, a anticolisão segue a regra da biblioteca (no bit em colisão, vence
+    o cartão com bit 1). Cada comando avança o relógio virtual pelo custo típico
+    de RF + SPI (HostRfidField::timing), o que torna mensuráveis o tempo por
+    ciclo e a vazão de cartões/s. O timeout de comandos sem resposta segue o
+    timer do RC522 (TReloadReg, 25 µs por tick): PCD_Init() volta aos 25 ms da
+    biblioteca (e custa os 50 ms do reset do chip) e PCD_WriteRegister() no
+    TReload o altera.
+    Leitura autenticada (RFID_BLOCK_READ): cada UID tem uma memória MIFARE
+    Classic 1K (HostRfidField::memory(): 64 blocos, chaves A/B por setor, de
+    fábrica FF..FF). PCD_Authenticate() com chave errada, quadro perdido
+    (HostRfidField::loss) ou cartão saindo do campo (HostCard::leaveAtMs)
+    custa o timeout e devolve o cartão a IDLE, como no hardware; só então o
+    firmware precisa re-selecionar (PICC_Select() com a UID completa).
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <Arduino.h> // byte, tipos
+#include <functional> // std::function (observador de seleção)
+#include <map> // Memória por UID
+#include <random> // Perda de quadros (gerador próprio: não altera random() do firmware)
+#include <string> // Chave do mapa de memórias
+#include <vector> // Cartões no campo
+
+class MFRC522 { // Início da definição da classe MFRC522
+public: // Seção pública: subconjunto da API de miguelbalboa/MFRC522
+    enum StatusCode : byte { STATUS_OK, STATUS_ERROR, STATUS_COLLISION, STATUS_TIMEOUT, // Códigos de retorno
+                             STATUS_NO_ROOM, STATUS_INTERNAL_ERROR, STATUS_INVALID, // ...
+                             STATUS_CRC_WRONG, STATUS_MIFARE_NACK = 0xff }; // ...
+    enum PCD_Register : byte { TReloadRegH = 0x2C << 1, TReloadRegL = 0x2D << 1 }; // Registradores simulados (timer)
+    enum PICC_Command : byte { PICC_CMD_MF_AUTH_KEY_A = 0x60, PICC_CMD_MF_AUTH_KEY_B = 0x61 }; // Autenticação MIFARE
+    typedef struct { byte size; byte uidByte[10]; byte sak; } Uid; // UID do cartão selecionado
+    typedef struct { byte keyByte[6]; } MIFARE_Key; // Chave MIFARE Classic (6 bytes)
+    Uid uid; // Preenchido por PICC_ReadCardSerial()
+
+    MFRC522(byte, byte) : uid(), _reload(1000), _crypto(false), _authSector(0) {} // Pinos ignorados
+    void PCD_Init(); // Timer no padrão da biblioteca (25 ms)
+    void PCD_WriteRegister(PCD_Register reg, byte value); // Apenas TReloadRegH/L têm efeito
+    StatusCode PICC_RequestA(byte *bufferATQA, byte *bufferSize); // REQA: OK se algum cartão em IDLE respondeu
+    StatusCode PICC_Select(Uid *uid, byte validBits = 0); // Anticolisão + SELECT de um cartão em IDLE
+    bool PICC_IsNewCardPresent(); // REQA: há cartão em IDLE?
+    bool PICC_ReadCardSerial() { return PICC_Select(&uid) == STATUS_OK; } // Seleciona e preenche uid
+    StatusCode PICC_HaltA(); // Cartão selecionado -> HALT
+    StatusCode PCD_Authenticate(byte command, byte blockAddr, MIFARE_Key *key, Uid *uid); // Autentica o setor do bloco no cartão selecionado
+    StatusCode MIFARE_Read(byte blockAddr, byte *buffer, byte *bufferSize); // Lê 16 bytes (+2 de CRC) do setor autenticado
+    void PCD_StopCrypto1() { _crypto = false; } // Encerra a sessão autenticada
+    static const char *GetStatusCodeName(StatusCode code); // Nome legível
+private: // Seção privada
+    uint16_t _reload; // TReloadReg (ticks de 25 µs)
+    bool _crypto; // Sessão Crypto1 ativa (REQA não passa até PCD_StopCrypto1())
+    byte _authSector; // Setor autenticado
+    int active(); // Índice do cartão selecionado (-1: nenhum); expira saídas agendadas
+    StatusCode fail(); // Sem resposta: custa o timeout e o cartão selecionado volta a IDLE
+}; // Fim da classe MFRC522
+
+// Cartão presente no campo simulado
+struct HostCard { // Gerenciado por HostRfidField
+    enum State : uint8_t { IDLE, ACTIVE, HALT }; // Estados ISO 14443-3
+    byte uid[10]; // Bytes do UID
+    byte size; // 4, 7 ou 10
+    State state; // Estado atual
+    uint32_t leaveAtMs; // Sai do campo neste instante (0: só por leave())
+}; // fim: struct HostCard
+
+// Memória de um cartão MIFARE Classic 1K
+struct HostCardMemory { // Por UID, em HostRfidField::memory()
+    byte blocks[64][16]; // 16 setores de 4 blocos (trailers não são lidos pelo firmware)
+    byte keyA[16][6]; // Chave A por setor
+    byte keyB[16][6]; // Chave B por setor
+    HostCardMemory(); // Cartão de fábrica: dados zerados, chaves FF..FF
+    void setBlock(byte block, const byte *data, size_t len); // Grava até 16 bytes no bloco (resto zerado)
+    void setKeys(byte sector, const byte *a, const byte *b = nullptr); // Troca as chaves do setor (b nulo: mantém)
+}; // fim: struct HostCardMemory
+
+// Custos de cada comando no relógio virtual (µs); valores típicos com o timer padrão da biblioteca (25 ms)
+struct HostRfidTiming { // Editável pelo simulador
+    uint32_t reqaUs = 600; // REQA respondido (ATQA) + SPI
+    uint32_t timeoutUs = 25000; // Comando sem resposta (REQA com campo vazio, HLTA): segue o TReloadReg
+    uint32_t selectUs = 2500; // Anticolisão + SELECT por nível de cascata (UID de 4 bytes: 1 nível)
+    uint32_t initUs = 50000; // PCD_Init(): reset do chip (a biblioteca espera 50 ms pelo oscilador)
+    uint32_t authUs = 2000; // Autenticação MIFARE aceita (três passos + SPI)
+    uint32_t readUs = 1500; // MIFARE_Read de um bloco (18 bytes + SPI)
+}; // fim: struct HostRfidTiming
+
+// Campo de RF simulado (cartões presentes diante da antena)
+class HostRfidField { // Acesso via hostRfid()
+public: // Seção pública
+    HostRfidTiming timing; // Custos por comando
+    double loss = 0; // Probabilidade de perder um quadro de autenticação/leitura (ruído de RF)
+    void enter(const byte *uid, byte size, uint32_t leaveAtMs = 0); // Cartão entra no campo (IDLE); sai sozinho em leaveAtMs (0: não)
+    void leave(const byte *uid, byte size); // Cartão sai do campo
+    void clear() { _cards.clear(); } // Campo vazio (as memórias continuam)
+    void expire(); // Remove cartões com leaveAtMs vencido
+    HostCardMemory &memory(const byte *uid, byte size); // Memória do cartão (criada de fábrica no primeiro acesso)
+    bool lost() { return loss > 0 && std::uniform_real_distribution<double>(0, 1)(_rng) < loss; } // Sorteia uma perda
+    void seed(uint32_t s) { _rng.seed(s); } // Semente da perda de quadros
+    size_t count() const { return _cards.size(); } // Cartões presentes
+    std::vector<HostCard> &cards() { return _cards; } // Acesso do MFRC522 simulado
+    std::function<void(const MFRC522::Uid &)> onSelect; // Observador: chamado a cada seleção (auditoria do simulador)
+private: // Seção privada
+    std::vector<HostCard> _cards; // Cartões presentes
+    std::map<std::string, HostCardMemory> _memory; // Memórias por UID
+    std::mt19937 _rng; // Gerador da perda
+    int find(const byte *uid, byte size) const; // Índice do cartão (-1 se ausente)
+}; // Fim da classe HostRfidField
+HostRfidField &hostRfid(); // Campo único do processo
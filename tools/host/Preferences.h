@@ -0,0 +1,73 @@
+/*
+    Arquivo: tools/host/Preferences.h
+    Propósito: Preferences (NVS) simulado em memória. O conteúdo fica em
+    hostNvs(), compartilhado por todas as instâncias e preservado entre
+    "reboots" simulados (recriar o AppController), como a flash real.
+    hostNvsTiming() dá o custo de cada leitura/gravação (0 = instantâneo),
+    cobrado no relógio virtual para medir o boot (restauração do snapshot).
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <Arduino.h> // String, tipos
+#include "Clock.h" // hostClock(): custo das operações
+#include <map> // Namespaces e chaves
+#include <string> // Nomes
+#include <vector> // Valores binários
+
+typedef std::map<std::string, std::map<std::string, std::vector<uint8_t>>> HostNvs; // namespace -> chave -> bytes
+inline HostNvs &hostNvs() { static HostNvs n; return n; } // "Flash" do processo
+
+// Custo por operação (µs no relógio virtual); padrão 0 para não alterar as demais simulações
+struct HostNvsTiming { // Editável pelo simulador
+    uint32_t readUs = 0; // get*/isKey (busca da chave na página + cópia)
+    uint32_t writeUs = 0; // put*/remove/clear (gravação na flash)
+}; // fim: struct HostNvsTiming
+inline HostNvsTiming &hostNvsTiming() { static HostNvsTiming t; return t; } // Instância do processo
+
+class Preferences { // Início da definição da classe Preferences
+public: // Seção pública: subconjunto usado pelo firmware
+    bool begin(const char *ns, bool readOnly = false) { _ns = ns; _ro = readOnly; return true; } // Abre namespace
+    void end() {} // Fecha
+    bool clear() { cost(hostNvsTiming().writeUs); hostNvs()[_ns].clear(); return true; } // Apaga namespace
+    bool remove(const char *key) { cost(hostNvsTiming().writeUs); return hostNvs()[_ns].erase(key) > 0; } // Apaga chave
+    bool isKey(const char *key) { cost(hostNvsTiming().readUs); return hostNvs()[_ns].count(key) > 0; } // Existe?
+    size_t putBytes(const char *key, const void *v, size_t n) { cost(hostNvsTiming().writeUs); return put(key, v, n); } // Grava blob
+    size_t getBytesLength(const char *key) { cost(hostNvsTiming().readUs); return length(key); } // Tamanho do blob
+    size_t getBytes(const char *key, void *out, size_t max) { cost(hostNvsTiming().readUs); return get(key, out, max); } // Lê blob
+    size_t putUInt(const char *key, uint32_t v) { cost(hostNvsTiming().writeUs); return put(key, &v, sizeof(v)); } // Inteiro 32 bits
+    uint32_t getUInt(const char *key, uint32_t def = 0) { // Lê inteiro
+        cost(hostNvsTiming().readUs); // Uma leitura
+        uint32_t v; return length(key) == sizeof(v) && get(key, &v, sizeof(v)) ? v : def; // Ou padrão
+    }
+    size_t putString(const char *key, const char *s) { cost(hostNvsTiming().writeUs); return put(key, s, strlen(s) + 1); } // Texto (com NUL)
+    String getString(const char *key, const String &def = String()) { // Lê texto
+        cost(hostNvsTiming().readUs); // Uma leitura
+        auto &m = hostNvs()[_ns]; auto it = m.find(key); // Procura
+        return it == m.end() ? def : String((const char *)it->second.data()); // Ou padrão
+    }
+    size_t getString(const char *key, char *out, size_t max) { // Lê texto sem alocar (tamanho com NUL; 0 se ausente/não cabe)
+        cost(hostNvsTiming().readUs); // Uma leitura
+        return get(key, out, max); // Bytes gravados incluem o NUL
+    }
+private: // Seção privada
+    std::string _ns; // Namespace aberto
+    bool _ro = false; // Somente leitura?
+
+    static void cost(uint32_t us) { if (us) hostClock().advanceUs(us); } // Cobra a operação no relógio virtual
+    size_t put(const char *key, const void *v, size_t n) { // Grava blob (sem custo)
+        if (_ro) return 0; // Somente leitura
+        const uint8_t *p = (const uint8_t *)v; // Bytes
+        hostNvs()[_ns][key].assign(p, p + n); // Substitui
+        return n; // Bytes gravados
+    }
+    size_t length(const char *key) { // Tamanho do blob (sem custo)
+        auto &m = hostNvs()[_ns]; auto it = m.find(key); // Procura
+        return it == m.end() ? 0 : it->second.size(); // 0 se ausente
+    }
+    size_t get(const char *key, void *out, size_t max) { // Lê blob (sem custo)
+        auto &m = hostNvs()[_ns]; auto it = m.find(key); // Procura
+        if (it == m.end() || it->second.size() > max) return 0; // Ausente ou não cabe
+        memcpy(out, it->second.data(), it->second.size()); // Copia
+        return it->second.size(); // Bytes lidos
+    }
+}; // Fim da classe Preferences
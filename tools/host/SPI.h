@@ -0,0 +1,9 @@
+/*
+    Arquivo: tools/host/SPI.h
+    Propósito: Barramento SPI simulado (o MFRC522 do host não usa SPI).
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+
+struct SPIClass { void begin(int = -1, int = -1, int = -1, int = -1) {} }; // no-op
+extern SPIClass SPI; // Instância global (HostMfrc522.cpp)
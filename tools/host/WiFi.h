@@ -0,0 +1,161 @@
+/*
+    Arquivo: tools/host/WiFi.h
+    Propósito: Wi‑Fi simulado para o host. Mantém uma lista de APs controlada
+    pelo simulador (hostWifi()) e reproduz o comportamento do driver que o
+    NetManager observa: begin() leva tempo (varredura de canais, associação e
+    DHCP, tudo medido no relógio virtual), eventos STA_CONNECTED/GOT_IP,
+    queda quando o AP some, varredura assíncrona e WiFi.config (IP fixo/lease).
+    As transições acontecem quando o firmware consulta status(), como no loop.
+    Também simula a LAN para servidores no dispositivo (WiFiServer/WiFiClient):
+    o simulador abre conexões com hostLan().connect() e troca bytes em memória.
+    hostByName() resolve IPs literais e os nomes de hostWifi().hosts.
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <Arduino.h> // Tipos, String, millis
+#include <IPAddress.h> // Endereços IPv4
+#include <functional> // std::function (callbacks de evento)
+#include <map> // Nomes resolvidos por hostByName
+#include <memory> // std::shared_ptr (conexões TCP simuladas)
+#include <string> // std::string (dados em trânsito)
+#include <vector> // Lista de APs e de handlers
+
+typedef enum { WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL = 1, WL_SCAN_COMPLETED = 2, WL_CONNECTED = 3, // Estados do driver
+               WL_CONNECT_FAILED = 4, WL_CONNECTION_LOST = 5, WL_DISCONNECTED = 6 } wl_status_t; // ...
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1 } wifi_mode_t; // Modos usados
+typedef enum { ARDUINO_EVENT_WIFI_STA_START, ARDUINO_EVENT_WIFI_STA_CONNECTED, // Eventos usados
+               ARDUINO_EVENT_WIFI_STA_DISCONNECTED, ARDUINO_EVENT_WIFI_STA_GOT_IP } arduino_event_id_t; // ...
+typedef arduino_event_id_t WiFiEvent_t; // Alias do core
+typedef struct { int reason; } arduino_event_info_t; // Informação mínima do evento
+typedef arduino_event_info_t WiFiEventInfo_t; // Alias do core
+typedef std::function<void(WiFiEvent_t, WiFiEventInfo_t)> WiFiEventFuncCb; // Handler
+typedef int wifi_event_id_t; // Identificador do handler
+
+#define WIFI_SCAN_RUNNING (-1) // Varredura em curso
+#define WIFI_SCAN_FAILED (-2) // Nenhuma varredura/erro
+
+// Um AP do ambiente simulado
+struct HostAp { // Editado livremente pelo simulador
+    const char *ssid; // SSID anunciado
+    uint8_t bssid[6]; // MAC do AP
+    int32_t channel; // Canal
+    int8_t rssi; // Sinal visto pela estação (dBm)
+    bool up; // false: AP fora do ar (queda de uplink)
+}; // fim: struct HostAp
+
+// Parâmetros e ambiente do Wi‑Fi simulado
+struct HostWiFiControl { // Acesso via hostWifi()
+    std::vector<HostAp> aps; // APs do ambiente
+    uint32_t channelScanMs = 1800; // begin() sem canal/BSSID: varredura de todos os canais
+    uint32_t linkMs = 150; // Associação + handshake WPA
+    uint32_t dhcpMs = 400; // DHCP (0 com IP fixo/lease reaproveitado)
+    uint32_t asyncScanMs = 2500; // Duração de scanNetworks(true)
+    IPAddress dhcpIp = IPAddress(192, 168, 0, 50); // Endereço entregue pelo "servidor DHCP"
+    std::map<std::string, IPAddress> hosts; // "DNS": nome -> endereço (hostByName)
+}; // fim: struct HostWiFiControl
+HostWiFiControl &hostWifi(); // Ambiente simulado do processo
+
+class WiFiClass { // Início da definição da classe WiFiClass
+public: // Seção pública: subconjunto da API do arduino-esp32
+    bool mode(wifi_mode_t) { return true; } // Sempre STA
+    void setAutoReconnect(bool) {} // NetManager controla a reconexão
+    void persistent(bool) {} // Sem NVS do driver
+    wl_status_t status(); // Avança a máquina do driver e devolve o estado
+    wl_status_t begin(const char *ssid, const char *pass, int32_t channel = 0, // Inicia associação
+                      const uint8_t *bssid = nullptr, bool connect = true); // ...
+    bool config(IPAddress ip, IPAddress gw, IPAddress sn, IPAddress dns1 = IPAddress(), // IP fixo (0 -> DHCP)
+                IPAddress dns2 = IPAddress()); // ...
+    bool disconnect(bool wifiOff = false, bool eraseAp = false); // Encerra/aborta associação
+    IPAddress localIP() { return _connected ? _ip : IPAddress(); } // IP atual
+    IPAddress gatewayIP() { return _connected ? _gw : IPAddress(); } // Gateway
+    IPAddress subnetMask() { return _connected ? _sn : IPAddress(); } // Máscara
+    IPAddress dnsIP(uint8_t = 0) { return _connected ? _dns : IPAddress(); } // DNS
+    uint8_t *BSSID(); // MAC do AP associado (nullptr se desconectado)
+    int32_t channel(); // Canal do AP associado
+    int8_t RSSI(); // Sinal do AP associado
+    String SSID(); // SSID associado
+    int16_t scanNetworks(bool async = false, bool showHidden = false, bool passive = false, // Varredura
+                         uint32_t maxMsPerChan = 300, uint8_t channel = 0); // ...
+    int16_t scanComplete(); // Resultado da varredura assíncrona
+    void scanDelete() { _scan.clear(); _scanState = WIFI_SCAN_FAILED; } // Descarta resultados
+    String SSID(uint8_t i) { return i < _scan.size() ? String(_scan[i].ssid) : String(); } // Resultado i
+    int32_t RSSI(uint8_t i) { return i < _scan.size() ? _scan[i].rssi : 0; } // ...
+    uint8_t *BSSID(uint8_t i) { return i < _scan.size() ? _scan[i].bssid : nullptr; } // ...
+    int32_t channel(uint8_t i) { return i < _scan.size() ? _scan[i].channel : 0; } // ...
+    wifi_event_id_t onEvent(WiFiEventFuncCb cb, WiFiEvent_t ev = ARDUINO_EVENT_WIFI_STA_START); // Registra handler
+    int hostByName(const char *host, IPAddress &out); // 1 se resolveu (IP literal ou hostWifi().hosts; exige link)
+    void hostPowerCycle(); // Simulador: reinício do chip (descarta handlers, varredura, associação e IP configurado)
+private: // Seção privada: estado do "driver"
+    struct Handler { WiFiEventFuncCb cb; WiFiEvent_t ev; }; // Handler registrado
+    std::vector<Handler> _handlers; // Handlers de evento
+    std::vector<HostAp> _scan; // Últimos resultados de varredura
+    int16_t _scanState = WIFI_SCAN_FAILED; // Estado da varredura
+    uint32_t _scanDue = 0; // Fim da varredura assíncrona
+    bool _pending = false; // Associação em curso
+    bool _linked = false; // STA_CONNECTED já emitido na associação em curso
+    bool _connected = false; // GOT_IP emitido e AP ainda no ar
+    uint32_t _linkDue = 0, _ipDue = 0; // Instantes das fases da associação em curso
+    wl_status_t _status = WL_DISCONNECTED; // Último estado
+    String _ssid; // SSID alvo/associado
+    int32_t _targetChannel = 0; // Canal pedido em begin() (0 = qualquer)
+    uint8_t _targetBssid[6] = {0}; // BSSID pedido em begin()
+    bool _hasTargetBssid = false; // begin() recebeu BSSID?
+    int _ap = -1; // Índice do AP associado em hostWifi().aps
+    IPAddress _staticIp, _ip, _gw, _sn, _dns; // Configuração e endereço atual
+
+    void fire(WiFiEvent_t ev); // Chama handlers do evento
+    int findAp(); // AP no ar compatível com o alvo (maior RSSI)
+}; // Fim da classe WiFiClass
+extern WiFiClass WiFi; // Instância global
+
+// Conexão TCP simulada na LAN: os dois sentidos em memória
+struct HostTcpConn { // Compartilhada entre o WiFiClient do firmware e o par (simulador)
+    uint16_t port = 0; // Porta de destino
+    std::string toServer; // Enviado pelo par, ainda não lido pelo firmware
+    std::string toPeer; // Escrito pelo firmware, ainda não consumido pelo par
+    bool peerClosed = false; // Par fechou a conexão
+    bool serverClosed = false; // Firmware chamou stop()
+    bool accepted = false; // Servidor já aceitou
+}; // fim: struct HostTcpConn
+
+// LAN simulada: conexões pendentes por porta e vazão do enlace
+struct HostLanControl { // Acesso via hostLan()
+    std::vector<uint16_t> listening; // Portas com WiFiServer::begin()
+    std::vector<std::shared_ptr<HostTcpConn>> pending; // Conexões aguardando accept()
+    uint32_t bytesPerMs = 1000; // Vazão efetiva (escrita do firmware avança o relógio; ~8 Mbit/s)
+    uint64_t bytesWritten = 0; // Total escrito pelo firmware
+    // Abre conexão do par para 'port'; nullptr se nada escuta ou sem Wi‑Fi
+    std::shared_ptr<HostTcpConn> connect(uint16_t port); // Implementado em HostWiFi.cpp
+}; // fim: struct HostLanControl
+HostLanControl &hostLan(); // LAN simulada do processo
+
+// Cliente TCP: conexões aceitas pelo WiFiServer simulado (o HTTPClient simulado não o utiliza)
+class WiFiClient { // Início da definição da classe WiFiClient
+public: // Seção pública
+    WiFiClient() {} // Sem conexão
+    explicit WiFiClient(std::shared_ptr<HostTcpConn> c) : _c(std::move(c)) {} // Conexão aceita
+    virtual ~WiFiClient() {} // Destrutor virtual (WiFiClientSecure deriva)
+    explicit operator bool() const { return _c != nullptr; } // Há conexão?
+    uint8_t connected(); // Aberta dos dois lados (ou com dados por ler) e Wi‑Fi ativo
+    int available() { return _c ? (int)_c->toServer.size() : 0; } // Bytes por ler
+    int read(); // Um byte (-1 se nada)
+    int read(uint8_t *buf, size_t len); // Até len bytes
+    size_t write(const uint8_t *buf, size_t len); // Entrega ao par; avança o relógio pela vazão da LAN
+    void setNoDelay(bool) {} // Sem Nagle no host
+    void stop() { if (_c) _c->serverClosed = true; _c.reset(); } // Fecha
+private: // Seção privada
+    std::shared_ptr<HostTcpConn> _c; // Conexão (nullptr: nenhuma)
+}; // Fim da classe WiFiClient
+
+// Servidor TCP simulado: accept() devolve conexões abertas por hostLan().connect()
+class WiFiServer { // Início da definição da classe WiFiServer
+public: // Seção pública
+    explicit WiFiServer(uint16_t port = 80, uint8_t = 4) : _port(port) {} // Porta
+    void begin(); // Passa a escutar
+    void end(); // Deixa de escutar
+    void setNoDelay(bool) {} // Sem Nagle no host
+    WiFiClient accept(); // Próxima conexão pendente (ou cliente vazio)
+    WiFiClient available() { return accept(); } // Nome antigo do core
+private: // Seção privada
+    uint16_t _port; // Porta de escuta
+}; // Fim da classe WiFiServer
@@ -0,0 +1,13 @@
+/*
+    Arquivo: tools/host/WiFiClientSecure.h
+    Propósito: WiFiClientSecure simulado (TLS não é exercitado no host).
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <WiFi.h> // WiFiClient
+
+class WiFiClientSecure : public WiFiClient { // Início da definição da classe WiFiClientSecure
+public: // Seção pública
+    bool setCACert(const char *) { return true; } // CA sempre aceita
+    void setInsecure() {} // no-op
+}; // Fim da classe WiFiClientSecure
@@ -0,0 +1,56 @@
+/*
+    Arquivo: tools/host/WiFiUdp.h
+    Propósito: Socket UDP simulado (WiFiUDP) para o host. Datagramas enviados
+    pelo firmware vão para o callback hostUdp().onSend (o simulador decide
+    perda, atraso e reordenação); os que o simulador coloca em
+    hostUdp().toDevice são entregues por parsePacket()/read(), em ordem.
+    Cada envio avança o relógio virtual (driver + tempo de ar pela vazão da LAN).
+*/
+
+#pragma once // Garante inclusão única deste cabeçalho durante a compilação
+#include <WiFi.h> // IPAddress, hostLan() (vazão), estado do link
+#include <deque> // Fila de entrega ao firmware
+#include <functional> // std::function (saída para o simulador)
+#include <string> // Dados do datagrama
+
+// Um datagrama em trânsito (ip/port = destino no envio, origem na entrega)
+struct HostDatagram { // Copiado livremente pelo simulador
+    IPAddress ip; // Endereço remoto
+    uint16_t port = 0; // Porta remota
+    std::string data; // Carga
+}; // fim: struct HostDatagram
+
+// Rede UDP simulada do processo
+struct HostUdpControl { // Acesso via hostUdp()
+    std::function<void(const HostDatagram &)> onSend; // Datagrama do firmware (sem callback: descartado)
+    std::deque<HostDatagram> toDevice; // Entregues ao socket do firmware (se aberto)
+    uint16_t boundPort = 0; // Porta do WiFiUDP::begin() (0 = fechado)
+    uint32_t sendUs = 250; // Custo fixo por datagrama (lwIP + driver + espera do rádio)
+    uint64_t datagrams = 0; // Enviados pelo firmware
+    uint64_t bytes = 0; // Carga enviada pelo firmware
+}; // fim: struct HostUdpControl
+HostUdpControl &hostUdp(); // Implementado em HostWiFi.cpp
+
+// Subconjunto da API WiFiUDP do arduino-esp32
+class WiFiUDP { // Início da definição da classe WiFiUDP
+public: // Seção pública
+    uint8_t begin(uint16_t port); // Abre o socket local
+    void stop(); // Fecha
+    int beginPacket(IPAddress ip, uint16_t port); // Começa um datagrama
+    int beginPacket(const char *host, uint16_t port); // Idem, resolvendo o nome
+    size_t write(uint8_t b) { return write(&b, 1); } // Um byte
+    size_t write(const uint8_t *buf, size_t len); // Acrescenta ao datagrama
+    int endPacket(); // Envia (0 sem link ou sem beginPacket)
+    int parsePacket(); // Próximo datagrama recebido (tamanho ou 0)
+    int available() { return (int)(_in.data.size() - _inPos); } // Bytes não lidos do atual
+    int read(); // Um byte (-1 se nada)
+    int read(uint8_t *buf, size_t len); // Até len bytes do atual
+    int read(char *buf, size_t len) { return read((uint8_t *)buf, len); } // Idem
+    IPAddress remoteIP() const { return _in.ip; } // Origem do atual
+    uint16_t remotePort() const { return _in.port; } // Porta de origem do atual
+private: // Seção privada
+    HostDatagram _out; // Em montagem
+    bool _building = false; // beginPacket() chamado
+    HostDatagram _in; // Recebido atual
+    size_t _inPos = 0; // Bytes já lidos de _in
+}; // Fim da classe WiFiUDP
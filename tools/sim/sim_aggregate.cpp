@@ -0,0 +1,296 @@
+/*
+    Arquivo: tools/sim/sim_aggregate.cpp
+    Propósito: Compara, no host, o envio de um registro por leitura com o
+    modo agregado (EdgeAggregator) sobre exatamente o mesmo tráfego: um
+    portão movimentado (chegadas de Poisson, crachás de uma população fixa,
+    repetições logo em seguida que a deduplicação descarta) e uma queda da
+    WAN no meio do turno. Cada modo roda num processo próprio (fork), com o
+    relógio virtual e a camada simulada limpos. O modo por leitura roda sem a
+    queda e serve de gabarito: todas as leituras aceitas pelo firmware chegam
+    ao servidor, com o instante de captura. Relata:
+      - POSTs e bytes de corpo enviados em cada modo e a redução;
+      - por janela: leituras, primeira/última UID (devem bater com o gabarito)
+        e o erro da estimativa de distintas (HyperLogLog) contra o valor exato;
+      - resumos perdidos (lacuna em window_seq ou fila cheia).
+    Uso: sim_aggregate [--hours H] [--badges N] [--rate-per-min R]
+                       [--repeat-pct P] [--window-ms MS] [--outage-min M]
+                       [--seed S] [--verbose]
+    Código de saída != 0 se a contagem ou a primeira/última UID de alguma
+    janela divergirem, se uma lacuna em window_seq não for explicada pelo
+    descarte da fila de resumos, ou se o erro médio das distintas passar do
+    erro padrão do sketch.
+*/
+
+#include "AppController.h" // Firmware sob teste
+#include <WiFi.h> // hostWifi(): AP simulado
+#include <HTTPClient.h> // hostHttp(): servidor e configuração remota
+#include <MFRC522.h> // hostRfid(): campo de RF
+#include <math.h> // fabs, sqrt
+#include <algorithm> // sort
+#include <random> // Cenário
+#include <set> // Distintas exatas
+#include <string> // Corpos
+#include <vector> // Eventos e registros
+#include <sys/wait.h> // waitpid
+#include <unistd.h> // fork, pipe
+
+// Parâmetros da linha de comando
+struct Options { // Valores padrão: turno de 8 h num portão movimentado
+    uint32_t hours = 8; // Duração do turno
+    uint32_t badges = 300; // Crachás distintos
+    uint32_t ratePerMin = 20; // Passagens por minuto (média)
+    uint32_t repeatPct = 5; // % de passagens repetidas 2..10 s depois (descartadas pela dedup)
+    uint32_t windowMs = 60000; // agg_window_ms no modo agregado
+    uint32_t outageMin = 20; // Queda da WAN no meio do turno (0 = sem queda)
+    uint64_t seed = 1; // Semente do cenário
+    bool verbose = false; // Log do firmware
+}; // fim: struct Options
+
+// Uma passagem pelo leitor
+struct Tap { // Evento do cenário
+    uint64_t t; // Instante (ms desde o início do cenário)
+    uint32_t badge; // Crachá
+}; // fim: struct Tap
+
+// Registro por leitura recebido pelo servidor
+struct RawRec { // Gabarito
+    std::string uid; // UID
+    uint32_t capMs; // capture_timestamp_ms
+}; // fim: struct RawRec
+
+// Resumo recebido pelo servidor
+struct SumRec { // Modo agregado
+    uint32_t seq, startMs, windowMs, reads, distinct, firstMs, lastMs; // Campos numéricos
+    std::string firstUid, lastUid; // Primeira/última UID
+}; // fim: struct SumRec
+
+// Resultado de um modo
+struct RunResult { // Medido no processo do modo
+    uint32_t posts = 0; // POSTs aceitos (2xx)
+    uint64_t bytes = 0; // Bytes de corpo aceitos
+    uint32_t depth = 0; // Pendentes ao final (fila bruta + resumos)
+    uint32_t dropped = 0; // Descartes (fila bruta ou de resumos)
+    std::vector<RawRec> raw; // Registros por leitura
+    std::vector<SumRec> sums; // Resumos
+}; // fim: struct RunResult
+
+static Options g_opt; // Opções globais
+static std::vector<Tap> g_taps; // Cenário (igual nos dois modos)
+static const uint64_t kStartMs = 1000; // millis() no boot
+static const uint64_t kWarmMs = 20000; // Associação + configuração antes do turno
+
+static bool parseArgs(int argc, char **argv) { // Lê opções; false em erro
+    for (int i = 1; i < argc; ++i) { // Percorre argumentos
+        std::string a = argv[i]; // Argumento atual
+        auto next = [&](void) -> const char * { return (i + 1 < argc) ? argv[++i] : nullptr; }; // Valor da opção
+        const char *v = nullptr; // Valor lido
+        if (a == "--hours" && (v = next())) g_opt.hours = (uint32_t)strtoul(v, nullptr, 10); // Duração
+        else if (a == "--badges" && (v = next())) g_opt.badges = (uint32_t)strtoul(v, nullptr, 10); // População
+        else if (a == "--rate-per-min" && (v = next())) g_opt.ratePerMin = (uint32_t)strtoul(v, nullptr, 10); // Movimento
+        else if (a == "--repeat-pct" && (v = next())) g_opt.repeatPct = (uint32_t)strtoul(v, nullptr, 10); // Repetições
+        else if (a == "--window-ms" && (v = next())) g_opt.windowMs = (uint32_t)strtoul(v, nullptr, 10); // Janela
+        else if (a == "--outage-min" && (v = next())) g_opt.outageMin = (uint32_t)strtoul(v, nullptr, 10); // Queda
+        else if (a == "--seed" && (v = next())) g_opt.seed = strtoull(v, nullptr, 10); // Semente
+        else if (a == "--verbose") g_opt.verbose = true; // Log do firmware
+        else { fprintf(stderr, "opcao invalida: %s\n", a.c_str()); return false; } // Erro
+    }
+    if (g_opt.hours == 0 || g_opt.badges == 0 || g_opt.ratePerMin == 0) { fprintf(stderr, "--hours, --badges e --rate-per-min devem ser > 0\n"); return false; } // Cenário vazio
+    if (g_opt.windowMs < AGG_WINDOW_MIN_MS) { fprintf(stderr, "--window-ms deve ser >= %d\n", AGG_WINDOW_MIN_MS); return false; } // Janela válida
+    return true; // OK
+}
+
+// Gera o turno: chegadas de Poisson e repetições curtas do mesmo crachá
+static void buildScenario() { // Preenche g_taps
+    std::mt19937_64 rng(g_opt.seed); // Gerador do cenário
+    std::exponential_distribution<double> gap(g_opt.ratePerMin / 60000.0); // Intervalo entre chegadas (ms)
+    std::uniform_int_distribution<uint32_t> who(0, g_opt.badges - 1); // Crachá
+    std::uniform_int_distribution<uint32_t> pct(0, 99); // Sorteio de repetição
+    std::uniform_int_distribution<uint32_t> again(2000, 10000); // Atraso da repetição
+    const uint64_t end = (uint64_t)g_opt.hours * 3600000ULL; // Fim do turno
+    for (double t = gap(rng); t < end; t += gap(rng)) { // Chegadas
+        uint32_t b = who(rng); // Crachá
+        g_taps.push_back({(uint64_t)t, b}); // Passagem
+        if (pct(rng) < g_opt.repeatPct) g_taps.push_back({(uint64_t)t + again(rng), b}); // Encostou de novo
+    }
+    std::sort(g_taps.begin(), g_taps.end(), [](const Tap &a, const Tap &b) { return a.t < b.t; }); // Ordem temporal
+}
+
+static void badgeUid(uint32_t badge, byte uid[4]) { // UID de 4 bytes derivada do crachá
+    uint32_t h = badge * 2654435761u + 0x5EED; // Espalha
+    uid[0] = (byte)(h >> 24); uid[1] = (byte)(h >> 16); uid[2] = (byte)(h >> 8); uid[3] = (byte)h; // Bytes
+}
+
+// Valor numérico de "key": no JSON
+static uint32_t jsonU(const std::string &s, const char *key) { // Parser mínimo
+    std::string pat = std::string("\"") + key + "\":"; // Padrão
+    size_t p = s.find(pat); // Posição
+    return p == std::string::npos ? 0 : (uint32_t)strtoul(s.c_str() + p + pat.size(), nullptr, 10); // Valor
+}
+
+// Valor textual de "key":"..." no JSON
+static std::string jsonS(const std::string &s, const char *key) { // Parser mínimo
+    std::string pat = std::string("\"") + key + "\":\""; // Padrão
+    size_t p = s.find(pat); // Posição
+    if (p == std::string::npos) return std::string(); // Ausente
+    p += pat.size(); // Início do valor
+    return s.substr(p, s.find('"', p) - p); // Valor
+}
+
+// Roda o turno com agg_window_ms = windowMs (0 = um registro por leitura); outage=false ignora a queda
+static RunResult runMode(uint32_t windowMs, bool outage) { // Executa no processo atual
+    RunResult r; // Resultado
+    VirtualClock &clk = hostClock(); // Relógio
+    clk.set(kStartMs); // Mesmo boot nos dois modos
+    randomSeed((unsigned long)g_opt.seed); // random() do firmware (jitter, época)
+    const uint64_t t0 = kStartMs + kWarmMs; // Início do turno
+    const uint64_t outFrom = t0 + (uint64_t)g_opt.hours * 1800000ULL; // Queda no meio do turno
+    const uint64_t outTo = outFrom + (outage ? (uint64_t)g_opt.outageMin * 60000ULL : 0); // Fim da queda
+    hostWifi().aps.push_back({WIFI_SSID, {0x24, 0x0A, 0xC4, 0x10, 0x20, 0x30}, 6, -58, true}); // Wi‑Fi local OK
+    hostHttp().handler = [&](const HostHttpRequest &q) { // Servidor
+        uint64_t now = clk.now64(); // Agora
+        if (now >= outFrom && now < outTo) return -1; // WAN fora do ar
+        r.posts++; r.bytes += q.body.size(); // Aceito
+        if (q.body.find("\"record\":\"summary\"") != std::string::npos) { // Resumo
+            SumRec s; // Campos
+            s.seq = jsonU(q.body, "window_seq"); s.startMs = jsonU(q.body, "window_start_ms"); // ...
+            s.windowMs = jsonU(q.body, "window_ms"); s.reads = jsonU(q.body, "reads"); // ...
+            s.distinct = jsonU(q.body, "distinct_estimate"); s.firstMs = jsonU(q.body, "first_seen_ms"); // ...
+            s.lastMs = jsonU(q.body, "last_seen_ms"); s.firstUid = jsonS(q.body, "first_uid"); s.lastUid = jsonS(q.body, "last_uid"); // ...
+            r.sums.push_back(s); // Guarda
+        } else { // Registro por leitura
+            r.raw.push_back({jsonS(q.body, "uid"), jsonU(q.body, "capture_timestamp_ms")}); // Guarda
+        }
+        return 200; // OK
+    };
+    std::string doc = windowMs ? "{\"agg_window_ms\":" + std::to_string(windowMs) + "}" : "{}"; // Configuração remota
+    hostHttp().getHandler = [doc](const HostHttpRequest &, HostHttpResponse &resp) { // Backend de configuração
+        resp.body = doc; resp.headers["ETag"] = "\"v1\""; return 200; // Mesmo documento sempre
+    };
+
+    AppController app(hostClock()); // Firmware com o relógio virtual
+    app.begin(); // Boot
+    while (clk.now64() < t0) { app.loop(); clk.advance(50); } // Associa e baixa a configuração
+    const uint64_t tick = 100; // Passo do loop sem cartão
+    const uint64_t end = t0 + (uint64_t)g_opt.hours * 3600000ULL; // Fim do turno
+    const uint64_t tail = (end > outTo ? end : outTo) + windowMs + 120000; // Fecha a última janela e drena após a queda
+    size_t next = 0; // Próxima passagem
+    while (clk.now64() < tail) { // Turno + drenagem
+        if (next < g_taps.size() && t0 + g_taps[next].t <= clk.now64()) { // Passagem devida
+            byte uid[4]; badgeUid(g_taps[next++].badge, uid); // Crachá
+            hostRfid().enter(uid, 4); // Aproxima
+            app.loop(); // Firmware lê (ou deduplica)
+            hostRfid().leave(uid, 4); // Afasta
+            continue; // Próxima passagem no mesmo instante?
+        }
+        app.loop(); // Uma iteração
+        clk.advance(tick); // Resto do loop
+    }
+    r.depth = (uint32_t)(app.queueDepth() + app.aggregator().pending()); // Fila bruta + resumos pendentes
+    r.dropped = (uint32_t)app.queueDropped() + app.aggregator().stats().dropped; // Descartes
+    return r; // Resultado
+}
+
+// Serializa o resultado do processo filho (linhas de texto)
+static std::string encode(const RunResult &r) { // Formato simples
+    std::string s = std::to_string(r.posts) + " " + std::to_string(r.bytes) + " " + // Cabeçalho
+                    std::to_string(r.depth) + " " + std::to_string(r.dropped) + "\n"; // ...
+    for (const RawRec &x : r.raw) s += x.uid + " " + std::to_string(x.capMs) + "\n"; // Registros
+    return s; // Texto
+}
+
+static RunResult decode(const std::string &s) { // Inverso de encode() (só registros por leitura)
+    RunResult r; // Resultado
+    unsigned long long b = 0; // Bytes
+    sscanf(s.c_str(), "%u %llu %u %u", &r.posts, &b, &r.depth, &r.dropped); // Cabeçalho
+    r.bytes = b; // Bytes
+    size_t p = s.find('\n') + 1; // Primeiro registro
+    while (p < s.size()) { // Cada linha
+        size_t e = s.find('\n', p); // Fim
+        std::string line = s.substr(p, e - p); // Linha
+        size_t sp = line.find(' '); // Separador
+        r.raw.push_back({line.substr(0, sp), (uint32_t)strtoul(line.c_str() + sp + 1, nullptr, 10)}); // Registro
+        p = e + 1; // Próxima
+    }
+    return r; // Resultado
+}
+
+// Modo por leitura num processo filho (estado simulado limpo), resultado por pipe
+static bool runRawIsolated(RunResult &out) { // false se o filho falhar
+    int fd[2]; // Pipe
+    if (pipe(fd) != 0) return false; // Sem pipe
+    pid_t pid = fork(); // Processo do modo
+    if (pid < 0) return false; // Sem fork
+    if (pid == 0) { // Filho
+        close(fd[0]); // Só escreve
+        std::string s = encode(runMode(0, false)); // Roda (sem queda) e serializa
+        for (size_t off = 0; off < s.size();) { ssize_t n = write(fd[1], s.data() + off, s.size() - off); if (n <= 0) _exit(1); off += (size_t)n; } // Envia
+        _exit(0); // Sem destrutores estáticos
+    }
+    close(fd[1]); // Pai só lê
+    std::string s; char buf[65536]; ssize_t n; // Acumulador
+    while ((n = read(fd[0], buf, sizeof(buf))) > 0) s.append(buf, (size_t)n); // Lê tudo
+    close(fd[0]); // Fim
+    int st = 0; waitpid(pid, &st, 0); // Espera o filho
+    if (!WIFEXITED(st) || WEXITSTATUS(st) != 0 || s.empty()) return false; // Falhou
+    out = decode(s); // Resultado
+    return true; // OK
+}
+
+int main(int argc, char **argv) { // Executa os dois modos e compara
+    if (!parseArgs(argc, argv)) return 2; // Uso inválido
+    hostSerialQuiet = !g_opt.verbose; // Log do firmware só com --verbose
+    buildScenario(); // Mesmo tráfego para os dois modos
+    fflush(stdout); // Nada duplicado pelo fork
+
+    RunResult raw; // Gabarito
+    if (!runRawIsolated(raw)) { fprintf(stderr, "falha no modo por leitura\n"); return 1; } // Filho falhou
+    RunResult agg = runMode(g_opt.windowMs, true); // Modo agregado neste processo, com a queda
+
+    printf("Turno de %u h: %zu passagens (%u/min, %u crachas, %u%% repetidas), janela %u ms, queda da WAN de %u min\n", // Cabeçalho
+           (unsigned)g_opt.hours, g_taps.size(), (unsigned)g_opt.ratePerMin, (unsigned)g_opt.badges, (unsigned)g_opt.repeatPct, // ...
+           (unsigned)g_opt.windowMs, (unsigned)g_opt.outageMin); // ...
+    printf("%-24s %8s %12s %10s\n", "modo", "POSTs", "bytes", "fila/desc"); // Tabela
+    printf("%-24s %8u %12llu %6u/%u\n", "por leitura (sem queda)", raw.posts, (unsigned long long)raw.bytes, raw.depth, raw.dropped); // ...
+    printf("%-24s %8u %12llu %6u/%u\n", "agregado", agg.posts, (unsigned long long)agg.bytes, agg.depth, agg.dropped); // ...
+    printf("Reducao: %.1fx em POSTs, %.1fx em bytes\n", agg.posts ? (double)raw.posts / agg.posts : 0.0, // Ganho
+           agg.bytes ? (double)raw.bytes / agg.bytes : 0.0); // ...
+
+    // Conferência janela a janela contra o gabarito (registros por leitura, pela captura)
+    uint32_t total = 0, readsOk = 0, edgesOk = 0, dupSeq = 0; // Contadores
+    double errSum = 0, errMax = 0; // Erro relativo das distintas
+    std::vector<bool> covered(raw.raw.size(), false); // Leitura do gabarito coberta por algum resumo recebido
+    std::sort(agg.sums.begin(), agg.sums.end(), [](const SumRec &a, const SumRec &b) { return a.seq < b.seq; }); // Ordem de fechamento
+    for (size_t i = 0; i < agg.sums.size(); ++i) { // Cada resumo
+        const SumRec &s = agg.sums[i]; // Resumo
+        if (i > 0 && s.seq == agg.sums[i - 1].seq) dupSeq++; // Entregue duas vezes
+        uint32_t n = 0; std::set<std::string> ids; std::string first, last; // Gabarito da janela
+        for (size_t k = 0; k < raw.raw.size(); ++k) { // Registros com captura na janela
+            const RawRec &x = raw.raw[k]; // Registro
+            if ((uint32_t)(x.capMs - s.startMs) >= s.windowMs) continue; // Fora
+            covered[k] = true; // Coberto
+            if (n == 0) first = x.uid; // Primeira
+            last = x.uid; n++; ids.insert(x.uid); // Última, contagem, distintas
+        }
+        total += s.reads; // Soma
+        if (n == s.reads) readsOk++; // Contagem bate
+        if (first == s.firstUid && last == s.lastUid) edgesOk++; // Primeira/última batem
+        double err = ids.empty() ? 0.0 : fabs((double)s.distinct - ids.size()) / ids.size(); // Erro relativo
+        errSum += err; if (err > errMax) errMax = err; // Acumula
+    }
+    uint32_t lostReads = 0; for (bool c : covered) if (!c) lostReads++; // Leituras de janelas não recebidas
+    uint32_t missingSeq = agg.sums.empty() ? 0 : agg.sums.back().seq + 1 - (uint32_t)(agg.sums.size() - dupSeq); // Lacunas em window_seq
+    size_t w = agg.sums.size(); // Resumos
+    double sigma = 1.04 / sqrt((double)(1u << AGG_HLL_BITS)); // Erro padrão teórico
+    double errMean = w ? errSum / w : 0.0; // Erro médio
+    printf("Janelas: %zu resumos; leituras %u/%zu (conferidas %u/%zu); primeira/ultima conferidas %u/%zu\n", // Conferência
+           w, total, raw.raw.size(), readsOk, w, edgesOk, w); // ...
+    printf("Distintas (HyperLogLog, %u registradores = %u bytes): erro medio %.2f%%, maximo %.2f%% (erro padrao %.1f%%)\n", // Precisão
+           1u << AGG_HLL_BITS, 1u << AGG_HLL_BITS, errMean * 100, errMax * 100, sigma * 100); // ...
+    bool cons = total + lostReads == raw.raw.size() && missingSeq == agg.dropped && dupSeq == 0 && agg.depth == 0; // Perdas explicadas
+    printf("Conservacao: resumidas=%u + em resumos descartados (fila cheia, AGG_QUEUE_CAPACITY=%d)=%u [%u resumos] = %zu; duplicados=%u pendentes=%u -> %s\n", // Balanço
+           total, AGG_QUEUE_CAPACITY, lostReads, missingSeq, raw.raw.size(), dupSeq, agg.depth, cons ? "OK" : "FALHA"); // ...
+    bool ok = raw.depth == 0 && raw.dropped == 0 && cons && readsOk == w && edgesOk == w && w > 0 && errMean <= sigma; // Veredito
+    if (agg.dropped) printf("Aviso: queda maior que AGG_QUEUE_CAPACITY janelas descarta os resumos mais antigos\n"); // Esperado com queda longa
+    printf("Resultado: %s\n", ok ? "OK" : "FALHA"); // Veredito
+    return ok ? 0 : 1; // Código de saída
+}
@@ -0,0 +1,183 @@
+/*
+    Arquivo: tools/sim/sim_boot.cpp
+    Propósito: Mede, no host, o boot com backlog persistido (PERSIST_BUFFER=1,
+    NVS simulada com custo por leitura): um cartão já está diante da antena ao
+    ligar e outros chegam durante a restauração. Relata as marcas de fase do
+    BootProfile (leitor pronto, configuração, rede, primeiro loop, backlog
+    restaurado, primeira leitura, link), o custo da restauração incremental
+    (total e maior passo do loop) e a estimativa da ordem serial anterior
+    (restauração inteira antes do leitor). Confere:
+      - tempo até a primeira leitura dentro do orçamento (--max-first-read-ms);
+      - entrega na ordem de captura: backlog restaurado e depois as leituras do boot;
+      - snapshot regravado ao fim da restauração igual à fila (nada apagado).
+    Uso: sim_boot [--backlog N] [--nvs-read-us US] [--reset-ms MS] [--taps N]
+                  [--tap-ms MS] [--post-ms MS] [--max-first-read-ms MS]
+                  [--seed S] [--verbose]
+    Código de saída != 0 se o orçamento estourar ou a ordem/conservação falhar.
+*/
+
+#include "AppController.h" // Firmware sob teste
+#include <WiFi.h> // hostWifi(): AP simulado
+#include <HTTPClient.h> // hostHttp(): backend
+#include <MFRC522.h> // hostRfid(): campo de RF
+#include <Preferences.h> // hostNvs()/hostNvsTiming(): snapshot do boot anterior
+#include <random> // UIDs do cenário
+#include <string> // UIDs
+#include <vector> // Sequências
+
+// Parâmetros da linha de comando
+struct Options { // Valores padrão: fila cheia do boot anterior, NVS de um ESP32 típico
+    uint32_t backlog = 1000; // Entradas no snapshot
+    uint32_t nvsReadUs = 150; // Custo de uma leitura de chave na NVS
+    uint32_t resetMs = 300; // Bootloader + inicialização estática (millis() na entrada de begin())
+    uint32_t taps = 5; // Cartões apresentados durante o boot (o primeiro já no campo ao ligar)
+    uint32_t tapMs = 100; // Permanência de cada cartão diante da antena (o próximo entra quando ele sai)
+    uint32_t postMs = 80; // Latência de um POST bem-sucedido
+    uint32_t maxFirstReadMs = 150; // Orçamento do tempo até a primeira leitura (desde begin())
+    uint64_t seed = 1; // Semente dos UIDs
+    bool verbose = false; // Log do firmware
+}; // fim: struct Options
+
+static Options g_opt; // Opções globais
+
+static bool parseArgs(int argc, char **argv) { // Lê opções; false em erro
+    for (int i = 1; i < argc; ++i) { // Percorre argumentos
+        std::string a = argv[i]; // Argumento atual
+        auto next = [&](void) -> const char * { return (i + 1 < argc) ? argv[++i] : nullptr; }; // Valor da opção
+        const char *v = nullptr; // Valor lido
+        if (a == "--backlog" && (v = next())) g_opt.backlog = (uint32_t)strtoul(v, nullptr, 10); // Snapshot
+        else if (a == "--nvs-read-us" && (v = next())) g_opt.nvsReadUs = (uint32_t)strtoul(v, nullptr, 10); // NVS
+        else if (a == "--reset-ms" && (v = next())) g_opt.resetMs = (uint32_t)strtoul(v, nullptr, 10); // Bootloader
+        else if (a == "--taps" && (v = next())) g_opt.taps = (uint32_t)strtoul(v, nullptr, 10); // Cartões no boot
+        else if (a == "--tap-ms" && (v = next())) g_opt.tapMs = (uint32_t)strtoul(v, nullptr, 10); // Intervalo
+        else if (a == "--post-ms" && (v = next())) g_opt.postMs = (uint32_t)strtoul(v, nullptr, 10); // Backend
+        else if (a == "--max-first-read-ms" && (v = next())) g_opt.maxFirstReadMs = (uint32_t)strtoul(v, nullptr, 10); // Orçamento
+        else if (a == "--seed" && (v = next())) g_opt.seed = strtoull(v, nullptr, 10); // Semente
+        else if (a == "--verbose") g_opt.verbose = true; // Log do firmware
+        else { fprintf(stderr, "opcao invalida: %s\n", a.c_str()); return false; } // Erro
+    }
+    if (g_opt.backlog > UID_BUFFER_CAPACITY) { fprintf(stderr, "--backlog deve estar em 0..%d\n", UID_BUFFER_CAPACITY); return false; } // Cabe no snapshot
+    return true; // Opções válidas
+}
+
+// UID de 4 bytes do cenário (bytes + hex como o firmware formata)
+struct Card { byte uid[4]; std::string hex; }; // Cartão
+
+static Card makeCard(std::mt19937_64 &rng) { // Sorteia um cartão
+    Card c; // Resultado
+    for (byte &b : c.uid) b = (byte)rng(); // Aleatório
+    char hex[9]; snprintf(hex, sizeof(hex), "%02X%02X%02X%02X", c.uid[0], c.uid[1], c.uid[2], c.uid[3]); // HEX maiúsculo
+    c.hex = hex; // Guarda
+    return c; // Cartão
+}
+
+// UID do JSON do POST ("uid":"...")
+static std::string bodyUid(const std::string &body) { // Parser mínimo
+    size_t p = body.find("\"uid\":\""); // Campo
+    if (p == std::string::npos) return std::string(); // Não é registro por leitura
+    p += 7; // Início do valor
+    return body.substr(p, body.find('"', p) - p); // Valor
+}
+
+static const char *kPhaseName[BOOT_PHASE_COUNT] = { // Rótulos da tabela
+    "leitor pronto", "configuracao", "rede iniciada", "primeiro loop", "backlog restaurado", "primeira leitura", "Wi-Fi conectado"}; // ...
+
+int main(int argc, char **argv) { // Executa o cenário e imprime o relatório
+    if (!parseArgs(argc, argv)) return 2; // Uso inválido
+    hostSerialQuiet = !g_opt.verbose; // Log do firmware só com --verbose
+    randomSeed((unsigned long)g_opt.seed); // random() do firmware
+    std::mt19937_64 rng(g_opt.seed); // UIDs
+    VirtualClock &clk = hostClock(); // Relógio
+
+    // Snapshot deixado pelo boot anterior (gravado sem custo)
+    std::vector<std::string> expected; // Ordem de captura: backlog e depois as leituras do boot
+    { // Escopo do Preferences de preparação
+        Preferences p; p.begin("rfidbuf", false); // Mesmo namespace do PersistentStore
+        p.putUInt("count", g_opt.backlog); // Quantidade
+        for (uint32_t i = 0; i < g_opt.backlog; ++i) { // Entradas do mais antigo ao mais novo
+            Card c = makeCard(rng); // UID
+            char k[16]; snprintf(k, sizeof(k), "uid%u", (unsigned)i); p.putString(k, c.hex.c_str()); // UID
+            snprintf(k, sizeof(k), "ts%u", (unsigned)i); p.putUInt(k, 1000 + i * 500); // Captura no boot anterior
+            expected.push_back(c.hex); // Esperado no backend
+        }
+    }
+    std::vector<Card> taps; // Cartões do boot
+    for (uint32_t i = 0; i < g_opt.taps; ++i) { taps.push_back(makeCard(rng)); expected.push_back(taps.back().hex); } // Ordem de chegada
+
+    hostNvsTiming().readUs = g_opt.nvsReadUs; // A partir daqui, leituras custam tempo
+    hostWifi().aps.push_back({WIFI_SSID, {0x24, 0x0A, 0xC4, 0x10, 0x20, 0x30}, 6, -58, true}); // AP disponível
+    std::vector<std::string> got; // UIDs recebidos pelo backend, em ordem
+    hostHttp().handler = [&](const HostHttpRequest &r) { clk.advance(g_opt.postMs); got.push_back(bodyUid(r.body)); return 200; }; // Backend OK
+    hostHttp().getHandler = [&](const HostHttpRequest &, HostHttpResponse &) { return 304; }; // Configuração inalterada
+
+    clk.set(g_opt.resetMs); // millis() ao entrar em begin()
+    if (!taps.empty()) hostRfid().enter(taps[0].uid, 4); // Cartão já no campo ao ligar
+    AppController app(clk); // Firmware com o relógio virtual
+    app.begin(); // Boot
+    const uint64_t t0 = g_opt.resetMs; // Origem (entrada de begin())
+    size_t nextTap = taps.empty() ? 0 : 1; // Próximo cartão a chegar
+    int inField = taps.empty() ? -1 : 0; // Cartão diante da antena (-1 = nenhum)
+    uint64_t leaveAt = t0 + g_opt.tapMs; // Quando ele sai
+    bool snapChecked = false, snapOk = true; // Snapshot ao fim da restauração
+    uint64_t limit = t0 + 600000; // Proteção: 10 min simulados
+    uint32_t loops = 0; // Iterações até concluir a restauração
+
+    while (clk.now64() < limit) { // Até entregar tudo
+        if (inField >= 0 && clk.now64() >= leaveAt) { hostRfid().leave(taps[inField].uid, 4); inField = -1; } // Cartão se afasta
+        if (inField < 0 && nextTap < taps.size()) { // Próximo cartão
+            inField = (int)nextTap; hostRfid().enter(taps[nextTap].uid, 4); // Aproxima
+            leaveAt = clk.now64() + g_opt.tapMs; nextTap++; // Agenda a saída
+        }
+        app.loop(); // Uma iteração do firmware
+        clk.advance(1); // Resto do loop
+        const BootProfile &bp = app.bootProfile(); // Perfil
+        if (!bp.has(BOOT_RESTORED)) loops++; // Iterações com restauração em curso
+        if (bp.has(BOOT_RESTORED) && !snapChecked) { // Primeira iteração após a restauração: snapshot = fila
+            snapChecked = true; // Uma vez
+            uint32_t saved = 0; // count (leitura direta do mapa: sem custo no cenário)
+            if (hostNvs()["rfidbuf"].count("count")) memcpy(&saved, hostNvs()["rfidbuf"]["count"].data(), sizeof(saved)); // Gravado
+            snapOk = saved == app.queueDepth(); // Quantidade igual à fila
+            size_t base = expected.size(); // Posição da primeira entrada no esperado (após entregues e descartados)
+            if (saved) { const auto &v0 = hostNvs()["rfidbuf"]["uid0"]; for (size_t i = got.size(); i < expected.size(); ++i) if (!v0.empty() && expected[i] == (const char *)v0.data()) { base = i; break; } } // Localiza
+            for (uint32_t i = 0; snapOk && i < saved; ++i) { // Cada entrada: trecho contíguo do esperado
+                char k[16]; snprintf(k, sizeof(k), "uid%u", (unsigned)i); // Chave
+                const auto &v = hostNvs()["rfidbuf"][k]; // Valor
+                snapOk = !v.empty() && base + i < expected.size() && expected[base + i] == (const char *)v.data(); // Mesma ordem
+            }
+        }
+        if (bp.has(BOOT_RESTORED) && nextTap >= taps.size() && inField < 0 && app.queueDepth() == 0) break; // Tudo entregue
+    }
+
+    const BootProfile &bp = app.bootProfile(); // Perfil final
+    printf("Boot com backlog: %u entradas no snapshot, NVS %u us/leitura, reset->begin %u ms, %u cartoes de %u ms cada (o 1o ja no campo)\n", // Cabeçalho
+           (unsigned)g_opt.backlog, (unsigned)g_opt.nvsReadUs, (unsigned)g_opt.resetMs, (unsigned)g_opt.taps, (unsigned)g_opt.tapMs); // ...
+    printf("%-20s %10s %12s\n", "fase", "ms(begin)", "ms(reset)"); // Tabela
+    for (int p = 0; p < BOOT_PHASE_COUNT; ++p) { // Cada fase
+        if (bp.has((BootPhase)p)) printf("%-20s %10lu %12lu\n", kPhaseName[p], (unsigned long)bp.at((BootPhase)p), // Atingida
+                                        (unsigned long)(bp.at((BootPhase)p) + bp.startMs())); // ...
+        else printf("%-20s %10s %12s\n", kPhaseName[p], "-", "-"); // Não atingida
+    }
+    double restoreMs = bp.restoreUs() / 1000.0; // Custo total da restauração
+    printf("Restauracao: %lu entradas em %u iteracoes do loop, %.1f ms de NVS, maior passo %.2f ms (PERSIST_RESTORE_BATCH=%d)\n", // Custo
+           (unsigned long)bp.restored(), (unsigned)loops, restoreMs, bp.restoreMaxStepUs() / 1000.0, PERSIST_RESTORE_BATCH); // ...
+    bool firstOk = bp.has(BOOT_FIRST_READ) && bp.at(BOOT_FIRST_READ) <= g_opt.maxFirstReadMs; // Orçamento
+    if (bp.has(BOOT_FIRST_READ)) // Comparação com a ordem serial (espera da serial de 50 ms + restauração antes do leitor)
+        printf("Primeira leitura: %lu ms apos begin() (orcamento %u ms) -> %s; ordem serial anterior: ~%.0f ms\n", // Veredito
+               (unsigned long)bp.at(BOOT_FIRST_READ), (unsigned)g_opt.maxFirstReadMs, firstOk ? "OK" : "FALHA", // ...
+               bp.at(BOOT_FIRST_READ) + 50 + restoreMs); // Estimativa
+    else printf("Primeira leitura: nao ocorreu -> %s\n", g_opt.taps ? "FALHA" : "OK (sem cartoes)"); // Sem leitura
+    if (!g_opt.taps) firstOk = true; // Nada a medir
+
+    size_t lost = expected.size() - got.size(); // Descartados (buffer cheio na restauração)
+    bool orderOk = got.size() <= expected.size() && app.queueDepth() == 0; // Tudo entregue
+    for (size_t i = 0; orderOk && i < got.size(); ++i) orderOk = got[i] == expected[lost + i]; // Sufixo contíguo, em ordem
+    size_t cap = app.config().bufferCapacity(); // Capacidade efetiva
+    size_t maxLost = expected.size() > cap ? expected.size() - cap : 0; // Só o excedente pode faltar
+    orderOk = orderOk && lost <= maxLost; // Sem perdas além do excedente
+    printf("Entrega: %u de %u na ordem de captura (descartados por buffer cheio: %u, maximo %u) -> %s\n", // Ordem
+           (unsigned)got.size(), (unsigned)expected.size(), (unsigned)lost, (unsigned)maxLost, orderOk ? "OK" : "FALHA"); // ...
+    printf("Snapshot ao fim da restauracao = fila: %s\n", !snapChecked ? "FALHA (nao concluiu)" : snapOk ? "OK" : "FALHA"); // Nada apagado
+    bool ok = firstOk && orderOk && snapChecked && snapOk; // Resultado global
+    printf("Resultado: %s\n", ok ? "OK" : "FALHA"); // Veredito
+    return ok ? 0 : 1; // Código de saída
+}
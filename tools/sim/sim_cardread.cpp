@@ -0,0 +1,273 @@
+/*
+    Arquivo: tools/sim/sim_cardread.cpp
+    Propósito: Exercita, no host, a leitura autenticada do bloco do cartão
+    (RFID_BLOCK_READ=1, variante fw_host_block) numa portaria: funcionários
+    com a matrícula ("E000123") gravada no bloco 4, visitas repetidas com
+    popularidade tipo Zipf (respeitando a janela de deduplicação), maioria com
+    a chave da frota, parte com a chave de fábrica e alguns com chave
+    desconhecida; uma fração sai do campo no meio da autenticação e a RF perde
+    quadros. No fim, o backend cai, a fila fica na NVS e o leitor reinicia
+    (snapshot com o conteúdo) antes de o backend voltar. Confere:
+      - nenhum card_data divergente do gravado no cartão (vazio só quando a
+        leitura não foi possível; sempre vazio para a chave desconhecida);
+      - um registro por visita com seleção do cartão (sem perda nem duplicata,
+        inclusive através do reinício);
+      - leitura de bloco limitada a RFID_BLOCK_READ_BUDGET_US + um comando;
+      - acertos no cache (visitantes frequentes não autenticam de novo).
+    Relata a taxa de acerto, o custo de RF dos acertos vs leituras, falhas de
+    autenticação, re-seleções e leituras sem conteúdo.
+    Uso: sim_cardread [--employees N] [--visits N] [--zipf S] [--gap-ms MS]
+                      [--dwell-ms MS] [--short-pct P] [--factory-pct P]
+                      [--unknown-pct P] [--loss P] [--outage-visits N]
+                      [--post-ms MS] [--seed S] [--verbose]
+    Código de saída != 0 se alguma conferência falhar.
+*/
+
+#include "AppController.h" // Firmware sob teste
+#include <WiFi.h> // hostWifi(): AP simulado
+#include <HTTPClient.h> // hostHttp(): backend
+#include <MFRC522.h> // hostRfid(): campo de RF e memória dos cartões
+#include <cmath> // pow (Zipf)
+#include <map> // Registros por UID
+#include <memory> // unique_ptr (reinício)
+#include <random> // Cenário
+#include <set> // Duplicatas
+#include <string> // UIDs
+#include <vector> // População
+
+// Parâmetros da linha de comando
+struct Options { // Valores padrão: portaria de uma empresa média
+    uint32_t employees = 300; // Cartões distintos
+    uint32_t visits = 3000; // Aproximações ao leitor
+    double zipf = 1.0; // Expoente da popularidade (0 = uniforme)
+    uint32_t gapMs = 1500; // Intervalo médio entre uma saída e a próxima chegada
+    uint32_t dwellMs = 400; // Permanência média diante da antena
+    uint32_t shortPct = 5; // % de visitas que saem em poucos ms (no meio da autenticação)
+    uint32_t factoryPct = 10; // % de cartões ainda com a chave de fábrica
+    uint32_t unknownPct = 5; // % de cartões com chave desconhecida (conteúdo ilegível)
+    double loss = 0.03; // Probabilidade de perder um quadro de autenticação/leitura
+    uint32_t outageVisits = 200; // Visitas finais com o backend fora (ficam na fila para o reinício)
+    uint32_t postMs = 30; // Latência de um POST bem-sucedido
+    uint64_t seed = 1; // Semente do cenário
+    bool verbose = false; // Log do firmware
+}; // fim: struct Options
+
+static Options g_opt; // Opções globais
+
+static bool parseArgs(int argc, char **argv) { // Lê opções; false em erro
+    for (int i = 1; i < argc; ++i) { // Percorre argumentos
+        std::string a = argv[i]; // Argumento atual
+        auto next = [&](void) -> const char * { return (i + 1 < argc) ? argv[++i] : nullptr; }; // Valor da opção
+        const char *v = nullptr; // Valor lido
+        if (a == "--employees" && (v = next())) g_opt.employees = (uint32_t)strtoul(v, nullptr, 10); // População
+        else if (a == "--visits" && (v = next())) g_opt.visits = (uint32_t)strtoul(v, nullptr, 10); // Visitas
+        else if (a == "--zipf" && (v = next())) g_opt.zipf = atof(v); // Popularidade
+        else if (a == "--gap-ms" && (v = next())) g_opt.gapMs = (uint32_t)strtoul(v, nullptr, 10); // Intervalo
+        else if (a == "--dwell-ms" && (v = next())) g_opt.dwellMs = (uint32_t)strtoul(v, nullptr, 10); // Permanência
+        else if (a == "--short-pct" && (v = next())) g_opt.shortPct = (uint32_t)strtoul(v, nullptr, 10); // Saídas rápidas
+        else if (a == "--factory-pct" && (v = next())) g_opt.factoryPct = (uint32_t)strtoul(v, nullptr, 10); // Chave de fábrica
+        else if (a == "--unknown-pct" && (v = next())) g_opt.unknownPct = (uint32_t)strtoul(v, nullptr, 10); // Chave desconhecida
+        else if (a == "--loss" && (v = next())) g_opt.loss = atof(v); // Perda de RF
+        else if (a == "--outage-visits" && (v = next())) g_opt.outageVisits = (uint32_t)strtoul(v, nullptr, 10); // Backend fora
+        else if (a == "--post-ms" && (v = next())) g_opt.postMs = (uint32_t)strtoul(v, nullptr, 10); // Backend
+        else if (a == "--seed" && (v = next())) g_opt.seed = strtoull(v, nullptr, 10); // Semente
+        else if (a == "--verbose") g_opt.verbose = true; // Log do firmware
+        else { fprintf(stderr, "opcao invalida: %s\n", a.c_str()); return false; } // Erro
+    }
+    if (g_opt.employees < 2 || g_opt.factoryPct + g_opt.unknownPct > 100 || g_opt.shortPct > 100 || g_opt.loss < 0 || g_opt.loss >= 1) { // Faixas
+        fprintf(stderr, "parametros fora da faixa\n"); return false; // Erro
+    }
+    if (g_opt.outageVisits > g_opt.visits) g_opt.outageVisits = g_opt.visits; // No máximo todas
+    return true; // Opções válidas
+}
+
+// Funcionário do cenário
+struct Employee { // Cartão + o que está gravado nele
+    byte uid[4]; // UID de 4 bytes
+    std::string hex; // UID como o firmware formata
+    std::string data; // Matrícula gravada no bloco 4 (ASCII)
+    bool unknownKey; // Chave fora de RFID_BLOCK_KEYS: conteúdo ilegível
+    uint64_t lastLeaveMs; // Última saída do campo (janela de deduplicação)
+    uint32_t selectedVisits; // Visitas em que o cartão foi selecionado (registro esperado)
+}; // fim: struct Employee
+
+// Campo de texto do JSON ("nome":"valor")
+static std::string bodyField(const std::string &body, const char *name) { // Parser mínimo
+    std::string key = std::string("\"") + name + "\":\""; // Prefixo
+    size_t p = body.find(key); // Campo
+    if (p == std::string::npos) return std::string(); // Ausente
+    p += key.size(); // Início do valor
+    return body.substr(p, body.find('"', p) - p); // Valor
+}
+
+// Campo numérico do JSON ("nome":123)
+static unsigned long bodyNumber(const std::string &body, const char *name) { // Parser mínimo
+    std::string key = std::string("\"") + name + "\":"; // Prefixo
+    size_t p = body.find(key); // Campo
+    return p == std::string::npos ? 0 : strtoul(body.c_str() + p + key.size(), nullptr, 10); // Valor
+}
+
+int main(int argc, char **argv) { // Executa o cenário e imprime o relatório
+    if (!parseArgs(argc, argv)) return 2; // Uso inválido
+    hostSerialQuiet = !g_opt.verbose; // Log do firmware só com --verbose
+    randomSeed((unsigned long)g_opt.seed); // random() do firmware
+    std::mt19937_64 rng(g_opt.seed); // Cenário
+    hostRfid().seed((uint32_t)g_opt.seed); // Perda de quadros (gerador próprio)
+    hostRfid().loss = g_opt.loss; // Ruído de RF
+    VirtualClock &clk = hostClock(); // Relógio
+
+    // População: matrícula no bloco 4 (setor 1) sob a chave A do setor
+    static const byte kFleetKey[6] = {0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5}; // Primeira de RFID_BLOCK_KEYS (fw_host_block)
+    static const byte kUnknownKey[6] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66}; // Fora da lista do firmware
+    std::vector<Employee> staff(g_opt.employees); // Funcionários
+    std::map<std::string, size_t> byHex; // UID -> funcionário
+    uint32_t factory = 0, unknown = 0; // Cartões por tipo de chave
+    for (uint32_t i = 0; i < g_opt.employees; ++i) { // Cada cartão
+        Employee &e = staff[i]; // Novo
+        do { // UID única
+            for (byte &b : e.uid) b = (byte)rng(); // Aleatória
+            char hex[9]; snprintf(hex, sizeof(hex), "%02X%02X%02X%02X", e.uid[0], e.uid[1], e.uid[2], e.uid[3]); // HEX maiúsculo
+            e.hex = hex; // Guarda
+        } while (byHex.count(e.hex)); // Sorteia de novo se repetida
+        byHex[e.hex] = i; // Índice
+        char id[17]; snprintf(id, sizeof(id), "E%06u", (unsigned)(1000 + i)); // Matrícula
+        e.data = id; // Esperado no backend
+        HostCardMemory &m = hostRfid().memory(e.uid, 4); // Memória do cartão
+        m.setBlock(4, (const byte *)id, strlen(id)); // Bloco 4 (resto zerado)
+        uint32_t roll = (uint32_t)(rng() % 100); // Tipo de chave
+        e.unknownKey = roll < g_opt.unknownPct; // Chave desconhecida
+        if (e.unknownKey) { m.setKeys(1, kUnknownKey, kUnknownKey); unknown++; } // Ilegível para o firmware
+        else if (roll < g_opt.unknownPct + g_opt.factoryPct) factory++; // Mantém FF..FF
+        else m.setKeys(1, kFleetKey); // Chave da frota
+        e.lastLeaveMs = 0; e.selectedVisits = 0; // Sem visitas
+    }
+
+    // Popularidade: funcionário i com peso 1/(i+1)^s
+    std::vector<double> cdf(g_opt.employees); // Distribuição acumulada
+    double acc = 0; // Soma
+    for (uint32_t i = 0; i < g_opt.employees; ++i) { acc += 1.0 / pow((double)(i + 1), g_opt.zipf); cdf[i] = acc; } // Pesos
+    auto pick = [&]() -> size_t { // Sorteia um funcionário
+        double r = std::uniform_real_distribution<double>(0, acc)(rng); // Ponto na soma
+        return (size_t)(std::lower_bound(cdf.begin(), cdf.end(), r) - cdf.begin()); // Índice
+    };
+
+    // Backend: registra cada leitura; 503 durante a queda
+    bool outage = false; // Backend fora
+    uint32_t posts = 0, rejected = 0; // POSTs aceitos e recusados
+    std::map<std::string, uint32_t> records; // Registros por UID
+    std::set<std::string> seen; // (UID, captura) já recebidos
+    uint32_t duplicates = 0, mismatches = 0, empty = 0, unknownLeaks = 0, strangers = 0; // Conferências
+    hostWifi().aps.push_back({WIFI_SSID, {0x24, 0x0A, 0xC4, 0x10, 0x20, 0x30}, 6, -58, true}); // AP disponível
+    hostHttp().handler = [&](const HostHttpRequest &r) { // Backend
+        clk.advance(g_opt.postMs); // Latência
+        if (outage) { rejected++; return 503; } // Fora
+        std::string uid = bodyField(r.body, "uid"); // UID
+        if (uid.empty()) return 200; // Não é registro por leitura
+        posts++; // Aceito
+        auto it = byHex.find(uid); // Funcionário
+        if (it == byHex.end()) { strangers++; return 200; } // UID desconhecida (não ocorre)
+        const Employee &e = staff[it->second]; // Dono do cartão
+        if (!seen.insert(uid + "@" + std::to_string(bodyNumber(r.body, "capture_timestamp_ms"))).second) duplicates++; // Mesmo registro de novo
+        records[uid]++; // Conta
+        std::string data = bodyField(r.body, "card_data"); // Conteúdo lido
+        if (data.empty()) { empty++; if (!e.unknownKey) return 200; } // Sem conteúdo (permitido)
+        else if (e.unknownKey) unknownLeaks++; // Não poderia ter sido lido
+        else if (data != e.data) mismatches++; // Divergente
+        return 200; // OK
+    };
+    hostHttp().getHandler = [&](const HostHttpRequest &, HostHttpResponse &) { return 304; }; // Configuração inalterada
+
+    // Visitas: um cartão por vez diante da antena
+    int current = -1; // Funcionário no campo (-1 = nenhum)
+    bool currentSelected = false; // Selecionado nesta visita
+    hostRfid().onSelect = [&](const MFRC522::Uid &u) { // Auditoria: seleção = registro aceito (visitas fora da janela)
+        if (current >= 0 && u.size == 4 && memcmp(u.uidByte, staff[current].uid, 4) == 0) currentSelected = true; // Visita atual
+    };
+    std::unique_ptr<AppController> app(new AppController(clk)); // Firmware com o relógio virtual
+    app->begin(); // Boot
+    const uint64_t window = DEDUP_INTERVAL_MS + 500; // Revisita só após a janela (+ folga do ciclo)
+    std::exponential_distribution<double> gapDist(1.0 / (g_opt.gapMs ? g_opt.gapMs : 1)); // Chegadas
+    uint32_t shortVisits = 0, skipped = 0; // Saídas rápidas; sorteios refeitos (janela)
+    uint64_t leaveAt = 0, arriveAt = clk.now64() + 2000; // Saída da visita atual; próxima chegada (após o boot)
+    uint32_t visit = 0; // Visitas iniciadas
+
+    auto step = [&]() { app->loop(); clk.advance(1); }; // Uma iteração do firmware
+    while (visit < g_opt.visits || current >= 0) { // Todas as visitas
+        uint64_t now = clk.now64(); // Instante
+        if (current >= 0 && (now >= leaveAt || hostRfid().count() == 0)) { // Fim da visita (leaveAtMs tira o cartão sozinho)
+            hostRfid().leave(staff[current].uid, 4); // Afasta
+            staff[current].lastLeaveMs = now; // Janela conta daqui
+            if (currentSelected) staff[current].selectedVisits++; // Registro esperado
+            current = -1; // Campo vazio
+            arriveAt = now + (uint64_t)gapDist(rng); // Próxima chegada
+        }
+        if (current < 0 && visit < g_opt.visits && now >= arriveAt) { // Chegada
+            size_t who = pick(); // Funcionário
+            for (int tries = 0; tries < 50 && staff[who].lastLeaveMs && now - staff[who].lastLeaveMs < window; ++tries) { who = pick(); skipped++; } // Fora da janela
+            if (staff[who].lastLeaveMs && now - staff[who].lastLeaveMs < window) { arriveAt = now + 100; continue; } // Todos recentes: espera
+            if (visit == g_opt.visits - g_opt.outageVisits) outage = true; // Backend cai nas visitas finais
+            current = (int)who; currentSelected = false; visit++; // Nova visita
+            bool quick = rng() % 100 < g_opt.shortPct; // Sai no meio da autenticação
+            uint32_t dwell = quick ? (uint32_t)(3 + rng() % 15) : (uint32_t)(g_opt.dwellMs / 2 + rng() % (g_opt.dwellMs + 1)); // Permanência
+            if (quick) shortVisits++; // Conta
+            hostRfid().enter(staff[who].uid, 4, quick ? (uint32_t)(now + dwell) : 0); // Rápida: sai sozinha durante os comandos
+            leaveAt = now + dwell; // Fim previsto
+        }
+        step(); // Firmware
+    }
+    RfidBlockStats bs = app->rfidBlockStats(); // Métricas antes do reinício
+    uint64_t settle = clk.now64() + 5000; // Fila gravada na NVS com o backend ainda fora
+    while (clk.now64() < settle) step(); // Snapshot em dia
+    size_t backlog = app->queueDepth(); // Fila levada ao reinício
+
+    // Reinício com a fila persistida; o backend volta
+    app.reset(); // Desliga
+    WiFi.hostPowerCycle(); // Driver reinicia junto (handlers do NetManager destruído)
+    hostRfid().clear(); // Campo vazio
+    outage = false; // Backend de volta
+    app.reset(new AppController(clk)); // Novo boot
+    app->begin(); // Restaura o snapshot (UID + conteúdo)
+    uint64_t limit = clk.now64() + 600000; // Proteção: 10 min simulados
+    while (clk.now64() < limit && (!app->bootProfile().has(BOOT_RESTORED) || app->queueDepth() > 0)) step(); // Esvazia a fila
+    for (int i = 0; i < 2000; ++i) step(); // Entregas atrasadas (duplicatas apareceriam aqui)
+
+    // Conservação: um registro por visita com seleção
+    uint32_t expected = 0, lost = 0, extra = 0; // Totais
+    for (const Employee &e : staff) { // Cada cartão
+        expected += e.selectedVisits; // Esperados
+        uint32_t got = records.count(e.hex) ? records[e.hex] : 0; // Recebidos
+        if (got < e.selectedVisits) lost += e.selectedVisits - got; // Faltaram
+        else extra += got - e.selectedVisits; // Sobraram
+    }
+
+    const uint32_t slackUs = hostRfid().timing.reqaUs + hostRfid().timing.selectUs + hostRfid().timing.authUs + hostRfid().timing.timeoutUs; // Um comando iniciado dentro do orçamento
+    printf("Portaria: %u funcionarios (%u chave de fabrica, %u chave desconhecida), %u visitas (Zipf %.2f, %u saidas rapidas), perda de RF %.1f%%\n", // Cabeçalho
+           (unsigned)g_opt.employees, (unsigned)factory, (unsigned)unknown, (unsigned)g_opt.visits, g_opt.zipf, (unsigned)shortVisits, g_opt.loss * 100); // ...
+    printf("Bloco %d (%u bytes, formato %d), chaves da frota + fabrica, cache de %d UIDs, orcamento %d us por cartao\n", // Configuração
+           RFID_BLOCK_ADDR, (unsigned)RFID_BLOCK_LEN, RFID_BLOCK_FORMAT, RFID_BLOCK_CACHE_SIZE, RFID_BLOCK_READ_BUDGET_US); // ...
+    printf("Cartoes aceitos: %lu; cache: %lu acertos (%lu%%, 0 us de RF), %lu leituras (media %lu us, max %lu us)\n", // Cache
+           (unsigned long)bs.lookups, (unsigned long)bs.hits, (unsigned long)bs.hitRatePct(), (unsigned long)bs.reads, // ...
+           (unsigned long)bs.avgReadUs(), (unsigned long)bs.maxReadUs); // ...
+    double perCard = bs.lookups ? (double)bs.totalReadUs / bs.lookups : 0; // RF média por cartão com o cache
+    printf("RF por cartao: %.0f us com cache vs ~%lu us autenticando sempre (%.1f s economizados)\n", // Ganho estimado
+           perCard, (unsigned long)bs.avgReadUs(), bs.hits * (double)bs.avgReadUs() / 1e6); // ...
+    printf("Autenticacoes recusadas/perdidas: %lu, re-selecoes: %lu, leituras sem conteudo: %lu (%u registros com card_data vazio)\n", // Falhas
+           (unsigned long)bs.authFails, (unsigned long)bs.retries, (unsigned long)bs.failures, (unsigned)empty); // ...
+    printf("Queda do backend: %u visitas finais, %u POSTs recusados, fila de %u registros levada ao reinicio\n", // Reinício
+           (unsigned)g_opt.outageVisits, (unsigned)rejected, (unsigned)backlog); // ...
+
+    bool dataOk = mismatches == 0 && unknownLeaks == 0 && strangers == 0; // Conteúdo
+    bool countOk = lost == 0 && extra == 0 && duplicates == 0 && app->queueDepth() == 0; // Conservação
+    bool budgetOk = bs.maxReadUs <= (uint32_t)RFID_BLOCK_READ_BUDGET_US + slackUs; // Latência limitada
+    bool cacheOk = bs.hits > 0; // Cache em uso
+    printf("card_data: %u divergentes, %u lidos de chave desconhecida -> %s\n", (unsigned)mismatches, (unsigned)unknownLeaks, dataOk ? "OK" : "FALHA"); // Conteúdo
+    printf("Registros: %u recebidos de %u esperados (perdidos %u, a mais %u, duplicados %u) -> %s\n", // Conservação
+           (unsigned)posts, (unsigned)expected, (unsigned)lost, (unsigned)extra, (unsigned)duplicates, countOk ? "OK" : "FALHA"); // ...
+    printf("Leitura mais longa: %lu us (limite %lu us = orcamento + um comando) -> %s\n", // Orçamento
+           (unsigned long)bs.maxReadUs, (unsigned long)(RFID_BLOCK_READ_BUDGET_US + slackUs), budgetOk ? "OK" : "FALHA"); // ...
+    printf("Cache com acertos: %s\n", cacheOk ? "OK" : "FALHA"); // Cache
+    bool ok = dataOk && countOk && budgetOk && cacheOk && backlog > 0; // Resultado global (a queda precisa deixar fila)
+    if (backlog == 0) printf("Reinicio sem fila pendente: cenario nao exercitou o snapshot -> FALHA\n"); // Cenário fraco
+    printf("Resultado: %s\n", ok ? "OK" : "FALHA"); // Veredito
+    return ok ? 0 : 1; // Código de saída
+}
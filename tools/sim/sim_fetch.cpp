@@ -0,0 +1,120 @@
+/*
+    Arquivo: tools/sim/sim_fetch.cpp
+    Propósito: Exercita, no host, o limite de corpo do GET condicional
+    (HttpSender::fetch, usado pela configuração remota) com respostas com e sem
+    Content-Length. Sem Content-Length (chunked ou delimitada pelo fechamento),
+    o corpo é lido do stream e a leitura precisa ser abortada assim que passa
+    de maxBytes, sem consumir (nem alocar) o resto da resposta. Confere:
+      - corpo dentro do limite, com e sem Content-Length: 200, corpo e ETag;
+      - corpo no limite exato aceito, um byte acima rejeitado (sem Content-Length);
+      - corpo grande com Content-Length rejeitado sem leitura;
+      - corpo grande sem Content-Length rejeitado com quase todo o corpo ainda no stream;
+      - 304 sem corpo;
+      - POST com a política de retry mais longa aceita da configuração remota
+        contra um backend em 503: a espera somada na chamada não passa de
+        HTTP_RETRY_WAIT_BUDGET_MS.
+    Uso: sim_fetch [--max-bytes N] [--big-bytes N] [--verbose]
+    Código de saída != 0 se alguma conferência falhar.
+*/
+
+#include "HttpSender.h" // Firmware sob teste
+#include "RuntimeConfig.h" // CONFIG_MAX_BYTES (limite usado pelo AppController)
+#include <WiFi.h> // hostWifi(): AP simulado
+#include <HTTPClient.h> // hostHttp(): servidor de GET
+#include <string> // Corpos
+
+// Parâmetros da linha de comando
+struct Options { // Valores padrão: limite da configuração remota e uma resposta de 64 KiB
+    size_t maxBytes = CONFIG_MAX_BYTES; // Limite passado ao fetch()
+    size_t bigBytes = 65536; // Corpo grande demais
+    bool verbose = false; // Log do firmware
+}; // fim: struct Options
+
+static Options g_opt; // Opções globais
+
+static bool parseArgs(int argc, char **argv) { // Lê opções; false em erro
+    for (int i = 1; i < argc; ++i) { // Percorre argumentos
+        std::string a = argv[i]; // Argumento atual
+        auto next = [&](void) -> const char * { return (i + 1 < argc) ? argv[++i] : nullptr; }; // Valor da opção
+        const char *v = nullptr; // Valor lido
+        if (a == "--max-bytes" && (v = next())) g_opt.maxBytes = (size_t)strtoul(v, nullptr, 10); // Limite
+        else if (a == "--big-bytes" && (v = next())) g_opt.bigBytes = (size_t)strtoul(v, nullptr, 10); // Corpo grande
+        else if (a == "--verbose") g_opt.verbose = true; // Log do firmware
+        else { fprintf(stderr, "opcao invalida: %s\n", a.c_str()); return false; } // Erro
+    }
+    if (g_opt.maxBytes < 16 || g_opt.bigBytes < 2 * g_opt.maxBytes) { fprintf(stderr, "--max-bytes >= 16 e --big-bytes >= 2x --max-bytes\n"); return false; } // Cenário útil
+    return true; // Opções válidas
+}
+
+static bool g_ok = true; // Resultado global
+
+static void check(bool cond, const char *what) { // Imprime uma conferência e acumula o veredito
+    printf("  %-62s %s\n", what, cond ? "OK" : "FALHA"); // Linha do relatório
+    if (!cond) g_ok = false; // Reprova o cenário
+}
+
+static std::string doc(size_t n) { // Documento de n bytes (JSON plano preenchido)
+    std::string s = "{\"pad\":\""; // Início
+    while (s.size() + 2 < n) s += 'x'; // Preenchimento
+    s += "\"}"; // Fim
+    return s.substr(0, n); // Tamanho exato
+}
+
+int main(int argc, char **argv) { // Executa os casos e imprime o relatório
+    if (!parseArgs(argc, argv)) return 2; // Uso inválido
+    hostSerialQuiet = !g_opt.verbose; // Log do firmware só com --verbose
+    VirtualClock &clk = hostClock(); // Relógio
+    hostWifi().aps.push_back({WIFI_SSID, {0x24, 0x0A, 0xC4, 0x10, 0x20, 0x30}, 6, -58, true}); // AP disponível
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD); // Associa
+    while (WiFi.status() != WL_CONNECTED && clk.now64() < 60000) clk.advance(1); // Até o IP
+
+    std::string served; bool chunked = false; int status = 200; // Resposta roteirizada
+    hostHttp().getHandler = [&](const HostHttpRequest &, HostHttpResponse &r) { // Servidor de configuração
+        r.body = served; r.chunked = chunked; r.headers["ETag"] = "\"v7\""; // Corpo, modo e versão
+        return status; // Código
+    };
+    HttpSender http(HTTP_TIMEOUT_MS, clk); // Cliente sob teste
+    struct Result { int code; size_t body; bool etag; size_t unread; }; // Observado
+    auto get = [&](size_t n, bool noLength, int code) -> Result { // Um GET roteirizado
+        served = code == 200 ? doc(n) : std::string(); chunked = noLength; status = code; // Resposta
+        String body, etag; // Saídas do fetch
+        if (code == 200) body = "lixo"; // Rejeição não pode deixar conteúdo de antes (nem parcial)
+        int c = http.fetch(CONFIG_URL, "\"v6\"", g_opt.maxBytes, body, etag); // GET condicional
+        bool sameBody = code != 200 || c != 200 || std::string(body.c_str()) == served; // Corpo íntegro quando aceito
+        if (!sameBody) return Result{-999, 0, false, 0}; // Corpo corrompido
+        return Result{c, (size_t)body.length(), etag.length() > 0, hostHttp().unreadBytes}; // Resultado
+    };
+
+    printf("fetch(%s): limite %u bytes, corpo grande de %u bytes\n", CONFIG_URL, (unsigned)g_opt.maxBytes, (unsigned)g_opt.bigBytes); // Cabeçalho
+    Result r = get(g_opt.maxBytes / 2, false, 200); // Pequeno, com Content-Length
+    check(r.code == 200 && r.body == g_opt.maxBytes / 2 && r.etag, "com Content-Length, dentro do limite: 200, corpo e ETag"); // Caminho antigo
+    r = get(g_opt.maxBytes / 2, true, 200); // Pequeno, sem Content-Length
+    check(r.code == 200 && r.body == g_opt.maxBytes / 2 && r.etag && r.unread == 0, "sem Content-Length, dentro do limite: lido do stream inteiro"); // Stream
+    r = get(g_opt.maxBytes, true, 200); // Exatamente no limite
+    check(r.code == 200 && r.body == g_opt.maxBytes, "sem Content-Length, no limite exato: aceito"); // Fronteira
+    r = get(g_opt.maxBytes + 1, true, 200); // Um byte acima
+    check(r.code <= 0 && r.body == 0 && !r.etag, "sem Content-Length, 1 byte acima: rejeitado, corpo vazio"); // Fronteira
+    r = get(g_opt.bigBytes, false, 200); // Grande, com Content-Length
+    check(r.code <= 0 && r.body == 0 && !r.etag, "com Content-Length, grande: rejeitado antes de ler"); // Sem alocação
+    r = get(g_opt.bigBytes, true, 200); // Grande, sem Content-Length (o caso que escapava)
+    printf("  sem Content-Length, %u bytes: codigo %d, %u bytes deixados no stream\n", (unsigned)g_opt.bigBytes, r.code, (unsigned)r.unread); // Detalhe
+    check(r.code <= 0 && r.body == 0 && !r.etag, "sem Content-Length, grande: rejeitado, corpo vazio"); // Limite aplicado
+    check(r.unread + g_opt.maxBytes + 128 >= g_opt.bigBytes, "leitura abortada logo apos o limite (resto nao consumido)"); // Sem ler tudo
+    r = get(0, false, 304); // Não modificado
+    check(r.code == 304 && r.body == 0 && !r.etag, "304: sem corpo nem ETag novo"); // Condicional
+
+    // Retries de POST: a política remota mais longa não segura a chamada
+    uint32_t posts = 0; // POSTs recebidos pelo backend
+    hostHttp().handler = [&](const HostHttpRequest &) { posts++; return 503; }; // Backend fora do ar
+    http.setRetryPolicy(HTTP_RETRY_MAX_LIMIT, 10000); // retry_max e retry_base_ms no máximo da faixa
+    UidEntry e = {}; snprintf(e.uid, sizeof(e.uid), "04A1B2C3"); e.capture_ms = 1; // Uma leitura
+    uint64_t t0 = clk.now64(); // Início da chamada
+    bool sent = http.postUid(e); // Envio com retries
+    uint64_t spent = clk.now64() - t0; // Tempo preso na chamada (o servidor responde na hora)
+    printf("POST com retry_max=%u e retry_base_ms=10000 contra 503: %lu tentativas, %lu ms na chamada\n", (unsigned)HTTP_RETRY_MAX_LIMIT, // Detalhe
+           (unsigned long)posts, (unsigned long)spent); // ...
+    check(!sent && posts >= 1 && http.lastResponse().code == 503, "503: falha devolvida ao chamador"); // Sem sucesso falso
+    check(spent <= HTTP_RETRY_WAIT_BUDGET_MS, "espera total <= HTTP_RETRY_WAIT_BUDGET_MS"); // Sem 320 s de bloqueio
+    printf("Resultado: %s\n", g_ok ? "OK" : "FALHA"); // Veredito
+    return g_ok ? 0 : 1; // Código de saída
+}
@@ -0,0 +1,228 @@
+/*
+    Arquivo: tools/sim/sim_fleet.cpp
+    Propósito: Frota de leitores (N AppControllers reais no mesmo processo,
+    mesmo relógio virtual) contra um backend com limite de vazão: um balde
+    global de --capacity requisições/s que responde 429 + Retry-After quando
+    esgota, RateLimit-Remaining/RateLimit-Reset nas respostas 2xx e um
+    incidente (503 sem Retry-After) no meio do cenário. Todos os leitores
+    avançam juntos a cada passo de 50 ms; cada um acumula backlog durante o
+    incidente e o despeja quando o backend volta. Compilado duas vezes: com
+    o UplinkGovernor (sim_fleet) e sem ele (sim_fleet_legacy, UPLINK_GOVERNOR=0),
+    para comparar a carga agregada. Relata:
+      - linha do tempo por 10 s: requisições, 2xx, 429, 503 e backlog da frota;
+      - requisições/s durante o incidente e pico/média após a volta;
+      - tempo até o backlog voltar ao nível anterior ao incidente;
+      - requisições por registro entregue e aberturas do disjuntor;
+      - conservação: cada leitura entregue uma única vez, ou ainda na fila.
+    Uso: sim_fleet [--devices N] [--seconds S] [--read-every-s S]
+                   [--capacity RPS] [--retry-after-s S] [--incident-at-s S]
+                   [--incident-s S] [--rate-pm R] [--burst B] [--csv ARQ]
+                   [--seed S] [--verbose]
+    --rate-pm/--burst publicam up_rate_pm/up_burst na configuração remota.
+    Código de saída != 0 se a conservação falhar ou o backlog não drenar.
+*/
+
+#include "AppController.h" // Firmware sob teste
+#include <WiFi.h> // hostWifi(): AP simulado
+#include <HTTPClient.h> // hostHttp(): backend com limite de vazão
+#include <MFRC522.h> // hostRfid(): campo de RF
+#include <algorithm> // max
+#include <map> // UIDs entregues
+#include <memory> // unique_ptr (frota no heap)
+#include <random> // Chegadas e UIDs
+#include <string> // UIDs
+#include <vector> // Frota e linha do tempo
+
+// Parâmetros da linha de comando
+struct Options { // Valores padrão: 200 leitores, backend de 40 req/s, incidente de 2 min
+    uint32_t devices = 200; // Leitores na frota
+    uint32_t seconds = 600; // Duração das leituras (s simulados)
+    double readEveryS = 10; // Intervalo médio entre leituras de um leitor (Poisson)
+    uint32_t capacity = 40; // Vazão do backend (requisições/s, rajada de 1 s)
+    uint32_t retryAfterS = 5; // Retry-After dos 429
+    uint32_t incidentAtS = 120; // Início do incidente (503)
+    uint32_t incidentS = 120; // Duração do incidente (0 = nenhum)
+    int32_t ratePm = -1; // up_rate_pm publicado (-1 = sem configuração remota)
+    int32_t burst = -1; // up_burst publicado (-1 = padrão)
+    const char *csv = nullptr; // Linha do tempo por segundo (CSV)
+    uint64_t seed = 1; // Semente
+    bool verbose = false; // Log do firmware
+}; // fim: struct Options
+
+// Contagem de um segundo do cenário
+struct Second { // Linha do tempo
+    uint32_t req = 0, ok = 0, limited = 0, unavailable = 0; // POSTs, 2xx, 429, 503
+    uint32_t backlog = 0; // Itens nas filas da frota no fim do segundo
+}; // fim: struct Second
+
+static Options g_opt; // Opções globais
+static std::mt19937_64 g_rng; // Aleatoriedade do cenário
+static std::map<std::string, uint32_t> g_read; // UIDs lidos -> vezes
+static std::map<std::string, uint32_t> g_got; // UIDs entregues (2xx) -> vezes
+static std::vector<Second> g_sec; // Linha do tempo (índice = segundo desde o início)
+static uint64_t g_t0 = 0; // Início do cenário (ms)
+
+static bool parseArgs(int argc, char **argv) { // Lê opções; false em erro
+    for (int i = 1; i < argc; ++i) { // Percorre argumentos
+        std::string a = argv[i]; // Argumento atual
+        auto next = [&](void) -> const char * { return (i + 1 < argc) ? argv[++i] : nullptr; }; // Valor da opção
+        const char *v = nullptr; // Valor lido
+        if (a == "--devices" && (v = next())) g_opt.devices = (uint32_t)strtoul(v, nullptr, 10); // Frota
+        else if (a == "--seconds" && (v = next())) g_opt.seconds = (uint32_t)strtoul(v, nullptr, 10); // Duração
+        else if (a == "--read-every-s" && (v = next())) g_opt.readEveryS = strtod(v, nullptr); // Ritmo por leitor
+        else if (a == "--capacity" && (v = next())) g_opt.capacity = (uint32_t)strtoul(v, nullptr, 10); // Backend
+        else if (a == "--retry-after-s" && (v = next())) g_opt.retryAfterS = (uint32_t)strtoul(v, nullptr, 10); // 429
+        else if (a == "--incident-at-s" && (v = next())) g_opt.incidentAtS = (uint32_t)strtoul(v, nullptr, 10); // Incidente
+        else if (a == "--incident-s" && (v = next())) g_opt.incidentS = (uint32_t)strtoul(v, nullptr, 10); // ...
+        else if (a == "--rate-pm" && (v = next())) g_opt.ratePm = (int32_t)strtol(v, nullptr, 10); // Configuração remota
+        else if (a == "--burst" && (v = next())) g_opt.burst = (int32_t)strtol(v, nullptr, 10); // ...
+        else if (a == "--csv" && (v = next())) g_opt.csv = v; // Linha do tempo
+        else if (a == "--seed" && (v = next())) g_opt.seed = strtoull(v, nullptr, 10); // Semente
+        else if (a == "--verbose") g_opt.verbose = true; // Log do firmware
+        else { fprintf(stderr, "opcao invalida: %s\n", a.c_str()); return false; } // Erro
+    }
+    return g_opt.devices > 0 && g_opt.capacity > 0 && g_opt.readEveryS > 0; // Cenário válido
+}
+
+static Second &secondAt(uint64_t nowMs) { // Conta do segundo corrente
+    size_t i = (size_t)((nowMs - g_t0) / 1000); // Índice
+    if (i >= g_sec.size()) g_sec.resize(i + 1); // Cresce
+    return g_sec[i]; // Conta
+}
+
+// Intervalo exponencial até a próxima leitura de um leitor (ms)
+static uint64_t nextGapMs() { return (uint64_t)(std::exponential_distribution<double>(1.0 / (g_opt.readEveryS * 1000))(g_rng)) + 1; } // Poisson
+
+// Um cartão novo passa pelo leitor (entra, uma iteração, sai)
+static void tap(AppController &app) { // Leitura única e distinta
+    byte uid[4]; // UID de 4 bytes
+    for (byte &b : uid) b = (byte)g_rng(); // Aleatório
+    char hex[9]; snprintf(hex, sizeof(hex), "%02X%02X%02X%02X", uid[0], uid[1], uid[2], uid[3]); // Como o firmware formata
+    g_read[hex]++; // Esperado no backend
+    hostRfid().enter(uid, 4); // Aproxima
+    app.loop(); // Firmware lê
+    hostRfid().leave(uid, 4); // Afasta
+}
+
+int main(int argc, char **argv) { // Executa o cenário e imprime o relatório
+    if (!parseArgs(argc, argv)) return 2; // Uso inválido
+    hostSerialQuiet = !g_opt.verbose; // Log do firmware só com --verbose
+    randomSeed((unsigned long)g_opt.seed); // random() do firmware (jitter)
+    g_rng.seed(g_opt.seed); // Cenário
+    hostWifi().aps.push_back({WIFI_SSID, {0x24, 0x0A, 0xC4, 0x10, 0x20, 0x30}, 6, -58, true}); // Wi‑Fi local OK
+    VirtualClock &clk = hostClock(); // Relógio
+
+    // Configuração remota (opcional): ajusta o balde de fichas de toda a frota
+    std::string doc = "{"; // Documento JSON plano
+    if (g_opt.ratePm >= 0) doc += "\"up_rate_pm\":" + std::to_string(g_opt.ratePm); // Ritmo
+    if (g_opt.burst >= 0) doc += std::string(doc.size() > 1 ? "," : "") + "\"up_burst\":" + std::to_string(g_opt.burst); // Rajada
+    doc += "}"; // Fecha
+    if (doc.size() > 2) hostHttp().getHandler = [doc](const HostHttpRequest &, HostHttpResponse &resp) { // Backend de configuração
+        resp.body = doc; resp.headers["ETag"] = "\"v1\""; return 200; // Mesmo documento sempre
+    };
+
+    // Backend: balde global de 'capacity' req/s, incidente com 503
+    double tokens = g_opt.capacity; // Balde cheio
+    uint64_t refillAt = 0; // Última recarga (ms)
+    uint64_t incFrom = 0, incTo = 0; // Incidente (ms absolutos, definidos após o boot)
+    hostHttp().postHandler = [&](const HostHttpRequest &req, HostHttpResponse &resp) { // Um POST da frota
+        uint64_t now = clk.now64(); // Tempo do leitor que envia
+        Second &s = secondAt(now); s.req++; // Linha do tempo
+        if (g_opt.incidentS && now >= incFrom && now < incTo) { s.unavailable++; return 503; } // Backend fora (sem Retry-After)
+        if (now > refillAt) { tokens = std::min<double>(g_opt.capacity, tokens + (now - refillAt) * g_opt.capacity / 1000.0); refillAt = now; } // Recarga
+        if (tokens < 1) { // Acima da vazão
+            s.limited++; resp.headers["Retry-After"] = std::to_string(g_opt.retryAfterS); return 429; // Volte depois
+        }
+        tokens -= 1; s.ok++; // Aceito
+        resp.headers["RateLimit-Remaining"] = std::to_string((int)tokens); // Cota restante
+        resp.headers["RateLimit-Reset"] = "1"; // Janela de 1 s
+        size_t p = req.body.find("\"uid\":\""); // Registro por leitura
+        if (p != std::string::npos) g_got[req.body.substr(p + 7, req.body.find('"', p + 7) - p - 7)]++; // Entregue
+        return 200; // OK
+    };
+
+    // Frota: todos ligam juntos e associam ao mesmo AP
+    std::vector<std::unique_ptr<AppController>> fleet; // Leitores
+    std::vector<uint64_t> devClock(g_opt.devices, 0), nextRead(g_opt.devices, 0); // Tempo local e próxima leitura
+    for (uint32_t d = 0; d < g_opt.devices; ++d) { fleet.emplace_back(new AppController(clk)); clk.set(0); fleet[d]->begin(); devClock[d] = clk.now64(); } // Boot
+    const uint64_t tickMs = 50; // Passo da frota
+    uint64_t tick = 0; // Tempo global (ms)
+    auto step = [&](uint32_t d, bool read) { // Uma iteração do leitor d no passo atual
+        clk.set(std::max(tick, devClock[d])); // Leitores em paralelo; tempo local nunca volta
+        if (read) tap(*fleet[d]); else fleet[d]->loop(); // Leitura ou iteração comum
+        devClock[d] = clk.now64(); // Onde o leitor parou
+    };
+    for (; tick < 30000; tick += tickMs) for (uint32_t d = 0; d < g_opt.devices; ++d) step(d, false); // Associa e baixa a configuração
+    g_t0 = tick; // Início do cenário
+    incFrom = g_t0 + (uint64_t)g_opt.incidentAtS * 1000; incTo = incFrom + (uint64_t)g_opt.incidentS * 1000; // Incidente
+    for (uint32_t d = 0; d < g_opt.devices; ++d) nextRead[d] = g_t0 + nextGapMs(); // Primeira leitura
+    tokens = g_opt.capacity; refillAt = g_t0; g_sec.clear(); g_got.clear(); // Backend limpo (boot não conta)
+
+    printf("Frota: %u leitores, leitura a cada %.1f s (media), backend %u req/s (429 + Retry-After %u s), incidente 503 de %u s a partir de %u s, governador %s", // Cabeçalho
+           (unsigned)g_opt.devices, g_opt.readEveryS, (unsigned)g_opt.capacity, (unsigned)g_opt.retryAfterS, (unsigned)g_opt.incidentS, // ...
+           (unsigned)g_opt.incidentAtS, UPLINK_GOVERNOR ? "ligado" : "DESLIGADO"); // ...
+    if (UPLINK_GOVERNOR) printf(" (up_rate_pm=%lu up_burst=%u)", (unsigned long)fleet[0]->config().upRatePerMin(), (unsigned)fleet[0]->config().upBurst()); // Ritmo efetivo
+    printf("\n"); // Fim do cabeçalho
+
+    const uint64_t readsEnd = g_t0 + (uint64_t)g_opt.seconds * 1000; // Fim das leituras
+    const uint64_t limit = readsEnd + 1800000ULL; // Proteção: 30 min simulados para drenar
+    uint64_t drainedAt = 0; // Filas vazias após as leituras
+    for (; tick < limit; tick += tickMs) { // Passos da frota
+        for (uint32_t d = 0; d < g_opt.devices; ++d) { // Cada leitor
+            bool read = tick < readsEnd && tick >= nextRead[d]; // Cartão chegando
+            if (read) nextRead[d] += nextGapMs(); // Próxima leitura deste leitor
+            step(d, read); // Iteração
+        }
+        if ((tick + tickMs - g_t0) % 1000 == 0) { // Fim de um segundo
+            uint32_t backlog = 0; // Filas da frota
+            for (const auto &app : fleet) backlog += (uint32_t)app->queueDepth(); // Soma
+            secondAt(tick).backlog = backlog; // Linha do tempo
+            if (tick >= readsEnd && backlog == 0) { drainedAt = tick; break; } // Tudo entregue
+        }
+    }
+
+    // Métricas agregadas
+    const size_t incA = (size_t)g_opt.incidentAtS, incB = incA + g_opt.incidentS; // Incidente (s)
+    uint64_t reqInc = 0, reqAll = 0, okAll = 0; // Requisições no incidente, totais e 2xx
+    for (size_t i = 0; i < g_sec.size(); ++i) { reqAll += g_sec[i].req; okAll += g_sec[i].ok; if (i >= incA && i < incB) reqInc += g_sec[i].req; } // Soma
+    uint32_t before = incA > 0 && incA - 1 < g_sec.size() ? g_sec[incA - 1].backlog : 0; // Backlog logo antes do incidente
+    size_t recoveredAt = 0; uint32_t peak = 0, overSeconds = 0; uint64_t reqAfter = 0; // Volta ao normal
+    for (size_t i = incB; i < g_sec.size(); ++i) { // Após o incidente
+        if (!recoveredAt && g_sec[i].backlog <= std::max<uint32_t>(before, g_opt.devices / 20)) recoveredAt = i; // Backlog normal
+        if (recoveredAt) break; // Fim da janela de recuperação
+        peak = std::max(peak, g_sec[i].req); reqAfter += g_sec[i].req; if (g_sec[i].req > g_opt.capacity) overSeconds++; // Carga
+    }
+    uint32_t trips = 0; // Aberturas do disjuntor na frota
+    for (const auto &app : fleet) trips += app->uplinkGovernor().stats().breakerTrips; // Soma
+
+    printf("\n   s |  req |   2xx |   429 |   503 | backlog\n"); // Linha do tempo por 10 s
+    for (size_t i = 0; i < g_sec.size(); i += 10) { // Blocos de 10 s
+        Second b; // Soma do bloco
+        for (size_t j = i; j < i + 10 && j < g_sec.size(); ++j) { b.req += g_sec[j].req; b.ok += g_sec[j].ok; b.limited += g_sec[j].limited; b.unavailable += g_sec[j].unavailable; b.backlog = g_sec[j].backlog; } // ...
+        printf("%4u | %4u | %5u | %5u | %5u | %6u%s\n", (unsigned)i, b.req, b.ok, b.limited, b.unavailable, b.backlog, // Linha
+               (i + 10 > incA && i < incB && g_opt.incidentS) ? "  (incidente)" : ""); // Marca
+    }
+    if (g_opt.csv) { // Linha do tempo por segundo
+        FILE *f = fopen(g_opt.csv, "w"); // Arquivo
+        if (f) { fprintf(f, "s,req,ok,limited,unavailable,backlog\n"); for (size_t i = 0; i < g_sec.size(); ++i) fprintf(f, "%u,%u,%u,%u,%u,%u\n", (unsigned)i, g_sec[i].req, g_sec[i].ok, g_sec[i].limited, g_sec[i].unavailable, g_sec[i].backlog); fclose(f); } // ...
+    }
+    printf("\nIncidente: %.1f req/s (media) contra o backend fora do ar; disjuntor abriu %u vezes na frota\n", // Carga no backend caído
+           g_opt.incidentS ? (double)reqInc / g_opt.incidentS : 0.0, (unsigned)trips); // ...
+    printf("Recuperacao: backlog normal %s%u s apos a volta; pico %u req/s, media %.1f req/s, %u s acima da capacidade (%u req/s)\n", // Volta
+           recoveredAt ? "" : "NAO em ", (unsigned)(recoveredAt ? recoveredAt - incB : g_sec.size() - incB), peak, // ...
+           (recoveredAt > incB) ? (double)reqAfter / (recoveredAt - incB) : 0.0, overSeconds, (unsigned)g_opt.capacity); // ...
+    printf("Total: %llu requisicoes para %llu entregas (%.2f req/entrega); filas drenadas %.1f s apos a ultima leitura\n", // Eficiência
+           (unsigned long long)reqAll, (unsigned long long)okAll, okAll ? (double)reqAll / okAll : 0.0, // ...
+           drainedAt ? (drainedAt - readsEnd) / 1000.0 : -1.0); // ...
+
+    uint32_t missing = 0, dup = 0, extra = 0, total = 0, queued = 0, dropped = 0; // Conservação
+    for (const auto &kv : g_read) { total += kv.second; auto it = g_got.find(kv.first); if (it == g_got.end()) missing += kv.second; else if (it->second > kv.second) dup += it->second - kv.second; } // Lidos
+    for (const auto &kv : g_got) if (!g_read.count(kv.first)) extra += kv.second; // Inventados
+    for (const auto &app : fleet) { queued += (uint32_t)app->queueDepth(); dropped += (uint32_t)app->queueDropped(); } // Filas
+    bool cons = dup == 0 && extra == 0 && missing == queued + dropped; // Entregue uma vez ou ainda no leitor
+    printf("Conservacao: leituras=%u entregues=%u fila=%u descartados=%u duplicados=%u -> %s\n", total, total - missing, queued, dropped, dup, // Veredito
+           cons ? "OK" : "FALHA"); // ...
+    bool ok = cons && drainedAt != 0; // Resultado global
+    printf("Resultado: %s\n", ok ? "OK" : "FALHA"); // Veredito
+    return ok ? 0 : 1; // Código de saída
+}
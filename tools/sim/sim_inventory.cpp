@@ -0,0 +1,140 @@
+/*
+    Arquivo: tools/sim/sim_inventory.cpp
+    Propósito: Compara, no host, a leitura de um cartão por chamada (read())
+    com o inventário por ciclo de RF (readInventory()) quando vários cartões
+    entram juntos no campo (pilha de crachás, carteira com 2 cartões). Usa o
+    RfidReader real (src/) sobre o MFRC522 simulado, cujos comandos avançam o
+    relógio virtual pelo custo típico de RF. Para cada tamanho de grupo relata:
+      - chamadas (iterações do loop) até ler todos os cartões do grupo;
+      - tempo até a seleção do último cartão (inclui o restante do loop entre
+        chamadas, que no firmware pode conter um POST HTTP);
+      - duração média/máxima de um ciclo de leitura e vazão em cartões/s;
+      - cartões perdidos quando o grupo sai do campo antes de ser lido.
+    Uso: sim_inventory [--max N] [--trials N] [--loop-ms MS] [--dwell-ms MS]
+                       [--seed S] [--uid7 PCT]
+    Código de saída != 0 se o inventário perder cartão que read() leu.
+*/
+
+#include "RfidReader.h" // Leitor sob teste
+#include <MFRC522.h> // hostRfid(): campo de RF
+#include <random> // Gerador do cenário
+#include <vector> // Cartões do grupo
+
+// Parâmetros da linha de comando
+struct Options { // Valores padrão: grupos de 1 a 8 cartões
+    uint32_t maxGroup = RFID_INVENTORY_MAX; // Maior grupo simulado
+    uint32_t trials = 200; // Repetições por tamanho de grupo
+    uint32_t loopMs = 20; // Restante do loop entre duas chamadas (rede, LED, fila)
+    uint32_t dwellMs = 250; // Tempo do grupo diante da antena
+    uint64_t seed = 1; // Semente dos UIDs
+    uint32_t uid7Pct = 20; // % de cartões com UID de 7 bytes (2 níveis de cascata)
+}; // fim: struct Options
+
+// Resultado de um modo para um tamanho de grupo
+struct ModeStat { // Agregado das repetições
+    uint64_t calls = 0; // Chamadas até ler o grupo (ou até ele sair)
+    uint64_t readUs = 0; // Soma do tempo até o último cartão lido
+    uint64_t cycleUs = 0; // Soma da duração das chamadas com cartão
+    uint64_t cycles = 0; // Chamadas com cartão
+    uint32_t maxCycleUs = 0; // Pior chamada
+    uint64_t cards = 0; // Cartões lidos
+    uint64_t missed = 0; // Cartões que saíram sem ser lidos
+}; // fim: struct ModeStat
+
+// Um cartão do grupo
+struct Card { byte uid[10]; byte size; }; // UID bruto
+
+static bool parseArgs(int argc, char **argv, Options &o) { // Lê opções; false em erro
+    for (int i = 1; i < argc; ++i) { // Percorre argumentos
+        std::string a = argv[i]; // Argumento atual
+        auto next = [&](void) -> const char * { return (i + 1 < argc) ? argv[++i] : nullptr; }; // Valor da opção
+        const char *v = nullptr; // Valor lido
+        if (a == "--max" && (v = next())) o.maxGroup = (uint32_t)strtoul(v, nullptr, 10); // Maior grupo
+        else if (a == "--trials" && (v = next())) o.trials = (uint32_t)strtoul(v, nullptr, 10); // Repetições
+        else if (a == "--loop-ms" && (v = next())) o.loopMs = (uint32_t)strtoul(v, nullptr, 10); // Resto do loop
+        else if (a == "--dwell-ms" && (v = next())) o.dwellMs = (uint32_t)strtoul(v, nullptr, 10); // Permanência
+        else if (a == "--seed" && (v = next())) o.seed = strtoull(v, nullptr, 10); // Semente
+        else if (a == "--uid7" && (v = next())) o.uid7Pct = (uint32_t)strtoul(v, nullptr, 10); // % UID longo
+        else { fprintf(stderr, "opcao invalida: %s\n", a.c_str()); return false; } // Erro
+    }
+    if (o.maxGroup < 1 || o.maxGroup > RFID_INVENTORY_MAX) { fprintf(stderr, "--max deve estar em 1..%d\n", RFID_INVENTORY_MAX); return false; } // Faixa
+    return o.trials > 0; // Ao menos uma repetição
+}
+
+// Executa um grupo num modo; 'inventory' escolhe readInventory() ou read()
+static void runGroup(const std::vector<Card> &group, bool inventory, const Options &o, ModeStat &st) { // Uma repetição
+    VirtualClock &clk = hostClock(); // Relógio do processo
+    RfidReader reader(0, 0, clk); // Leitor novo: cache de deduplicação vazio
+    reader.begin(); // PCD_Init(); RFID_RF_TIMEOUT_MS só altera o timer se definido no build
+    hostRfid().clear(); // Campo vazio
+    for (const Card &c : group) hostRfid().enter(c.uid, c.size); // Grupo entra junto
+    uint32_t t0us = clk.nowUs(); // Início (µs, 32 bits)
+    uint32_t read = 0; // Cartões lidos
+    uint32_t lastUs = 0; // Instante relativo da seleção do último cartão lido
+    uint32_t selUs = 0; // Instante relativo da seleção mais recente
+    hostRfid().onSelect = [&](const MFRC522::Uid &) { selUs = clk.nowUs() - t0us; }; // Marca cada seleção
+    while (read < group.size()) { // Até ler todos ou o grupo sair
+        if ((uint32_t)(clk.nowUs() - t0us) >= o.dwellMs * 1000U) break; // Grupo saiu do campo
+        uint32_t c0 = clk.nowUs(); // Início da chamada
+        uint32_t got = 0; // Cartões aceitos nesta chamada
+        if (inventory) { // Um ciclo de RF enumera o campo
+            UidEntry batch[RFID_INVENTORY_MAX]; // Saída do ciclo
+            got = (uint32_t)reader.readInventory(batch, RFID_INVENTORY_MAX); // Lote
+        } else { // Um cartão por chamada
+            char uid[32]; uint32_t cap = 0; // Saída
+            got = reader.read(uid, sizeof(uid), cap) ? 1 : 0; // Cartão único
+        }
+        uint32_t dt = clk.nowUs() - c0; // Duração da chamada
+        st.calls++; // Conta chamada
+        if (got) { // Chamada produtiva
+            st.cycles++; st.cycleUs += dt; // Duração do ciclo com cartão
+            if (dt > st.maxCycleUs) st.maxCycleUs = dt; // Pior ciclo
+            read += got; // Acumula
+            lastUs = selUs; // Seleção do último cartão aceito (não inclui o HLTA nem o REQA final)
+        }
+        clk.advance(o.loopMs); // Restante do loop (rede, LED, fila)
+    }
+    st.cards += read; // Lidos
+    st.missed += group.size() - read; // Perdidos
+    st.readUs += lastUs; // Tempo até o último lido
+    hostRfid().onSelect = nullptr; // Observador não sobrevive à repetição
+}
+
+int main(int argc, char **argv) { // Ponto de entrada
+    Options o; // Parâmetros
+    if (!parseArgs(argc, argv, o)) return 2; // Uso inválido
+    hostSerialQuiet = true; // Sem log do firmware
+    std::mt19937_64 rng(o.seed); // Gerador determinístico
+
+    printf("Inventario vs leitura unica: %u repeticoes/grupo, loop=%u ms, permanencia=%u ms, UID7=%u%%\n", // Cabeçalho
+           (unsigned)o.trials, (unsigned)o.loopMs, (unsigned)o.dwellMs, (unsigned)o.uid7Pct); // ...
+    printf("%5s | %-10s %7s %9s %9s %9s %7s %7s\n", "grupo", "modo", "chamadas", "ate_todos", "ciclo_med", "ciclo_max", "cart/s", "perdidos"); // Colunas
+    bool ok = true; // Resultado global
+    for (uint32_t n = 1; n <= o.maxGroup; ++n) { // Tamanho do grupo (2 = carteira)
+        ModeStat single, inv; // Agregados
+        for (uint32_t t = 0; t < o.trials; ++t) { // Repetições
+            std::vector<Card> group(n); // Grupo desta repetição
+            for (Card &c : group) { // UIDs aleatórios
+                c.size = (rng() % 100 < o.uid7Pct) ? 7 : 4; // Tamanho do UID
+                for (byte i = 0; i < c.size; ++i) c.uid[i] = (byte)rng(); // Bytes
+                if (c.size == 7) c.uid[0] = 0x04; // Fabricante NXP (UID duplo)
+            }
+            runGroup(group, false, o, single); // Um cartão por chamada
+            runGroup(group, true, o, inv); // Inventário
+        }
+        const ModeStat *ms[2] = {&single, &inv}; // Ordem de impressão
+        const char *names[2] = {"read()", "inventario"}; // Rótulos
+        for (int m = 0; m < 2; ++m) { // Uma linha por modo
+            const ModeStat &s = *ms[m]; // Agregado
+            double perTrial = (double)o.trials; // Divisor
+            double cps = s.cycleUs ? (double)s.cards * 1e6 / (double)s.cycleUs : 0.0; // Vazão no RF
+            printf("%5u | %-10s %7.2f %7.1fms %7.1fms %7.1fms %7.0f %7llu\n", (unsigned)n, names[m], // Linha
+                   s.calls / perTrial, s.readUs / perTrial / 1000.0, // Chamadas e tempo até todos
+                   s.cycles ? s.cycleUs / (double)s.cycles / 1000.0 : 0.0, s.maxCycleUs / 1000.0, // Ciclo médio/máx
+                   cps, (unsigned long long)s.missed); // Vazão e perdas
+        }
+        if (inv.missed > single.missed) ok = false; // Inventário nunca deve perder mais
+    }
+    printf("Resultado: %s\n", ok ? "OK" : "FALHA (inventario perdeu cartoes)"); // Veredito
+    return ok ? 0 : 1; // Código de saída
+}
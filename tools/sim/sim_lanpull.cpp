@@ -0,0 +1,243 @@
+/*
+    Arquivo: tools/sim/sim_lanpull.cpp
+    Propósito: Exercita, no host, a evacuação do backlog pela LAN
+    (LanPullServer) com o link WAN cortado: o Wi‑Fi local segue ativo, mas
+    todo POST para a nuvem falha após o timeout. Com a fila cheia, um gateway
+    simulado puxa o backlog em lotes (GET /backlog chunked), confere a
+    sequência, confirma com POST /ack e repete até esvaziar. Novas leituras
+    continuam chegando durante a coleta. Exercita também uma conexão
+    interrompida no meio do stream (retomada com from=), um ack com época
+    errada (409) e requisições sem o token ou com token errado (401). Relata:
+      - registros coletados, lotes, tempo até esvaziar e vazão (registros/s);
+      - a estimativa do mesmo escoamento pela nuvem (um POST por drain_ms);
+      - a maior iteração do loop com um cliente em atendimento (impacto na leitura RFID);
+      - conservação: cada UID lido aparece exatamente uma vez no gateway.
+    Uso: sim_lanpull [--records N] [--batch N] [--arrivals-ms MS]
+                     [--wan-timeout-ms MS] [--lan-kbps K] [--post-ms MS]
+                     [--abort-bytes N] [--seed S] [--verbose]
+    Código de saída != 0 se faltar, sobrar ou duplicar registro ou se um
+    token ausente/errado for aceito.
+*/
+
+#include "AppController.h" // Firmware sob teste
+#include <WiFi.h> // hostWifi()/hostLan(): AP e LAN simulados
+#include <HTTPClient.h> // hostHttp(): nuvem inacessível
+#include <MFRC522.h> // hostRfid(): campo de RF
+#include <map> // Contagem por UID
+#include <random> // UIDs do cenário
+#include <string> // Corpo das respostas
+#include <vector> // Lista de UIDs
+
+// Parâmetros da linha de comando
+struct Options { // Valores padrão: fila quase cheia, lotes de 256
+    uint32_t records = 1000; // Leituras acumuladas antes da coleta
+    uint32_t batch = 256; // max= de cada GET /backlog (0 = tudo)
+    uint32_t arrivalsMs = 500; // Intervalo entre leituras novas durante a coleta (0 = nenhuma)
+    uint32_t wanTimeoutMs = 2000; // Custo de cada POST para a nuvem inacessível
+    uint32_t lanKbps = 8000; // Vazão efetiva da LAN (kbit/s)
+    uint32_t postMs = 150; // Latência de um POST bem-sucedido (estimativa pela nuvem)
+    uint32_t abortBytes = 4000; // O 1º stream é cortado após N bytes (0 = nunca)
+    uint64_t seed = 1; // Semente dos UIDs
+    bool verbose = false; // Log do firmware
+}; // fim: struct Options
+
+static Options g_opt; // Opções globais
+static std::mt19937_64 g_rng; // Gerador de UIDs
+static std::map<std::string, uint32_t> g_read; // UIDs lidos pelo firmware (hex) -> vezes
+static std::map<std::string, uint32_t> g_got; // UIDs recebidos pelo gateway -> vezes
+
+static bool parseArgs(int argc, char **argv) { // Lê opções; false em erro
+    for (int i = 1; i < argc; ++i) { // Percorre argumentos
+        std::string a = argv[i]; // Argumento atual
+        auto next = [&](void) -> const char * { return (i + 1 < argc) ? argv[++i] : nullptr; }; // Valor da opção
+        const char *v = nullptr; // Valor lido
+        if (a == "--records" && (v = next())) g_opt.records = (uint32_t)strtoul(v, nullptr, 10); // Backlog
+        else if (a == "--batch" && (v = next())) g_opt.batch = (uint32_t)strtoul(v, nullptr, 10); // Lote
+        else if (a == "--arrivals-ms" && (v = next())) g_opt.arrivalsMs = (uint32_t)strtoul(v, nullptr, 10); // Leituras novas
+        else if (a == "--wan-timeout-ms" && (v = next())) g_opt.wanTimeoutMs = (uint32_t)strtoul(v, nullptr, 10); // POST falho
+        else if (a == "--lan-kbps" && (v = next())) g_opt.lanKbps = (uint32_t)strtoul(v, nullptr, 10); // Vazão da LAN
+        else if (a == "--post-ms" && (v = next())) g_opt.postMs = (uint32_t)strtoul(v, nullptr, 10); // POST bom
+        else if (a == "--abort-bytes" && (v = next())) g_opt.abortBytes = (uint32_t)strtoul(v, nullptr, 10); // Corte
+        else if (a == "--seed" && (v = next())) g_opt.seed = strtoull(v, nullptr, 10); // Semente
+        else if (a == "--verbose") g_opt.verbose = true; // Log do firmware
+        else { fprintf(stderr, "opcao invalida: %s\n", a.c_str()); return false; } // Erro
+    }
+    if (g_opt.records == 0 || g_opt.records > UID_BUFFER_CAPACITY) { fprintf(stderr, "--records deve estar em 1..%d\n", UID_BUFFER_CAPACITY); return false; } // Sem overflow
+    return g_opt.lanKbps > 0; // Vazão positiva
+}
+
+// Um cartão novo passa pelo leitor (entra, uma iteração, sai)
+static void tap(AppController &app) { // Leitura única e distinta
+    byte uid[4]; // UID de 4 bytes
+    for (byte &b : uid) b = (byte)g_rng(); // Aleatório
+    char hex[9]; snprintf(hex, sizeof(hex), "%02X%02X%02X%02X", uid[0], uid[1], uid[2], uid[3]); // Como o firmware formata
+    g_read[hex]++; // Esperado no gateway
+    hostRfid().enter(uid, 4); // Aproxima
+    app.loop(); // Firmware lê
+    hostRfid().leave(uid, 4); // Afasta
+}
+
+// Resposta HTTP vista pelo gateway
+struct Reply { // Resultado de exchange()
+    int code = 0; // Código HTTP (0 = conexão recusada/cortada)
+    std::string headers; // Cabeçalho bruto
+    std::string body; // Corpo (chunks já decodificados)
+    bool complete = false; // Chunk final (ou Content-Length) recebido
+}; // fim: struct Reply
+
+// Decodifica "<hex>\r\n<dados>\r\n ... 0\r\n\r\n"; complete=true ao ver o chunk final
+static void dechunk(const std::string &raw, std::string &out, bool &complete) { // Corpo chunked
+    size_t p = 0; // Posição
+    while (p < raw.size()) { // Cada chunk
+        size_t eol = raw.find("\r\n", p); // Fim da linha de tamanho
+        if (eol == std::string::npos) return; // Incompleto
+        size_t n = strtoul(raw.substr(p, eol - p).c_str(), nullptr, 16); // Tamanho
+        if (n == 0) { complete = true; return; } // Chunk final
+        if (eol + 2 + n > raw.size()) return; // Dados incompletos (conexão cortada)
+        out.append(raw, eol + 2, n); // Dados
+        p = eol + 2 + n + 2; // Próximo chunk
+    }
+}
+
+// Envia uma requisição ao leitor e roda o firmware até a resposta terminar;
+// abortAt > 0 corta a conexão do lado do gateway após esse número de bytes.
+// Leituras novas chegam a cada --arrivals-ms enquanto nextTap != 0.
+static Reply exchange(AppController &app, const std::string &req, size_t abortAt, uint64_t &nextTap) { // Uma troca
+    Reply r; // Resultado
+    std::shared_ptr<HostTcpConn> c = hostLan().connect(LAN_PULL_PORT); // Abre conexão
+    if (!c) return r; // Porta fechada ou sem link
+    c->toServer = req; // Requisição inteira de uma vez
+    VirtualClock &clk = hostClock(); // Relógio
+    uint64_t limit = clk.now64() + 600000; // Proteção: 10 min simulados
+    while (!c->serverClosed && clk.now64() < limit) { // Até o leitor fechar
+        if (abortAt && c->toPeer.size() >= abortAt) { c->peerClosed = true; break; } // Gateway cai no meio
+        if (nextTap && clk.now64() >= nextTap) { // Chegou alguém ao leitor
+            tap(app); // Leitura nova (uma iteração do loop)
+            nextTap = clk.now64() + g_opt.arrivalsMs; // Próxima chegada
+            continue; // Reavalia
+        }
+        app.loop(); // Uma iteração do firmware
+        clk.advance(1); // Resto do loop
+    }
+    size_t hEnd = c->toPeer.find("\r\n\r\n"); // Fim do cabeçalho
+    if (hEnd == std::string::npos) return r; // Nada útil
+    r.headers = c->toPeer.substr(0, hEnd); // Cabeçalho
+    r.code = atoi(r.headers.c_str() + 9); // "HTTP/1.1 200"
+    std::string raw = c->toPeer.substr(hEnd + 4); // Corpo bruto
+    if (r.headers.find("Transfer-Encoding: chunked") != std::string::npos) dechunk(raw, r.body, r.complete); // Stream
+    else { r.body = raw; r.complete = true; } // Content-Length
+    return r; // Resposta
+}
+
+// Cabeçalho de autenticação do gateway (LAN_PULL_TOKEN vem das definições do fw_host)
+static const std::string kAuth = "Authorization: Bearer " LAN_PULL_TOKEN "\r\n"; // Token certo
+
+// Valor numérico de "key": no JSON de uma linha
+static uint32_t jsonU(const std::string &line, const char *key) { // Parser mínimo
+    std::string pat = std::string("\"") + key + "\":"; // Padrão
+    size_t p = line.find(pat); // Posição
+    return p == std::string::npos ? 0 : (uint32_t)strtoul(line.c_str() + p + pat.size(), nullptr, 10); // Valor
+}
+
+int main(int argc, char **argv) { // Executa o cenário e imprime o relatório
+    if (!parseArgs(argc, argv)) return 2; // Uso inválido
+    hostSerialQuiet = !g_opt.verbose; // Log do firmware só com --verbose
+    randomSeed((unsigned long)g_opt.seed); // random() do firmware (época, jitter)
+    g_rng.seed(g_opt.seed); // UIDs
+    hostLan().bytesPerMs = g_opt.lanKbps / 8; // kbit/s -> bytes/ms
+    hostWifi().aps.push_back({WIFI_SSID, {0x24, 0x0A, 0xC4, 0x10, 0x20, 0x30}, 6, -58, true}); // Wi‑Fi local OK
+    uint32_t posts = 0; // POSTs tentados com a WAN cortada
+    hostHttp().handler = [&](const HostHttpRequest &) { posts++; hostClock().advance(g_opt.wanTimeoutMs); return -1; }; // WAN cortada
+    hostHttp().getHandler = [&](const HostHttpRequest &, HostHttpResponse &) { hostClock().advance(g_opt.wanTimeoutMs); return -1; }; // Idem (config)
+
+    AppController app(hostClock()); // Firmware com o relógio virtual
+    app.begin(); // Boot
+    VirtualClock &clk = hostClock(); // Relógio
+    for (int i = 0; i < 200 && (uint32_t)WiFi.localIP() == 0; ++i) { app.loop(); clk.advance(50); } // Associa
+
+    for (uint32_t i = 0; i < g_opt.records; ++i) { tap(app); clk.advance(200); } // Acumula o backlog (POSTs falhando)
+    uint32_t epoch = app.lanPull().epoch(); // Época deste boot
+    printf("Coleta na LAN: backlog=%u, lote=%u, LAN=%u kbit/s, WAN: POST falha em %u ms, chegadas a cada %u ms\n", // Cabeçalho
+           (unsigned)app.queueDepth(), (unsigned)g_opt.batch, (unsigned)g_opt.lanKbps, (unsigned)g_opt.wanTimeoutMs, // ...
+           (unsigned)g_opt.arrivalsMs); // ...
+
+    bool ok = true; // Resultado global
+    uint32_t pulls = 0, gaps = 0, aborts = 0; // Métricas
+    uint64_t nextTap = g_opt.arrivalsMs ? clk.now64() : 0; // Próxima leitura nova (ms; 0 = nenhuma)
+    const uint32_t backlogEnd = (uint32_t)app.queueDepth(); // Sequências do backlog inicial: 0..backlogEnd-1
+    uint64_t evacMs = 0; // Tempo até confirmar todo o backlog inicial
+    uint64_t t0 = clk.now64(); // Início da coleta (ms)
+    uint32_t postsBefore = posts; // POSTs falhos antes da coleta
+    uint32_t resumeFrom = 0; // Cursor de retomada (0 = do início)
+    bool haveResume = false; // Retomando após corte?
+    size_t abortAt = g_opt.abortBytes; // Primeiro stream é cortado
+
+    std::string wrong(sizeof(LAN_PULL_TOKEN) - 1, 'x'); // Mesmo tamanho do token, conteúdo errado
+    const std::string noAuth[] = { "", "Authorization: Bearer " + wrong + "\r\n", // Sem cabeçalho; token errado
+                                   "Authorization: Bearer " LAN_PULL_TOKEN "x\r\n", "Authorization: Basic " LAN_PULL_TOKEN "\r\n" }; // Token com sobra; outro esquema
+    for (const std::string &h : noAuth) { // Cada credencial inválida
+        Reply u = exchange(app, "POST /ack?epoch=" + std::to_string(epoch) + "&cursor=5 HTTP/1.1\r\n" + h + "\r\n", 0, nextTap); // Ack válido, credencial não
+        if (u.code != 401) { printf("FALHA: ack sem token valido devolveu %d (esperado 401)\n", u.code); ok = false; } // Não pode liberar
+    }
+    Reply bad = exchange(app, "POST /ack?epoch=" + std::to_string(epoch ^ 1) + "&cursor=5 HTTP/1.1\r\n" + kAuth + "\r\n", 0, nextTap); // Época errada
+    if (bad.code != 409) { printf("FALHA: ack com epoch errada devolveu %d (esperado 409)\n", bad.code); ok = false; } // Não pode liberar
+
+    while (app.queueDepth() > 0 && pulls < 1000) { // Até esvaziar
+        std::string q = "/backlog?max=" + std::to_string(g_opt.batch ? g_opt.batch : UID_BUFFER_CAPACITY); // Lote
+        if (haveResume) q += "&from=" + std::to_string(resumeFrom); // Retomada
+        Reply r = exchange(app, "GET " + q + " HTTP/1.1\r\nHost: leitor\r\n" + kAuth + "\r\n", abortAt, nextTap); // Puxa
+        pulls++; // Conta lote
+        uint32_t expect = haveResume ? resumeFrom : 0; // Próximo seq esperado
+        bool first = !haveResume; // Primeiro registro define a base
+        uint32_t next = 0; // Cursor do trailer
+        size_t p = 0; // Linha atual
+        while (p < r.body.size()) { // Cada linha NDJSON
+            size_t e = r.body.find('\n', p); // Fim da linha
+            if (e == std::string::npos) break; // Linha parcial (corte)
+            std::string line = r.body.substr(p, e - p); // Linha
+            p = e + 1; // Próxima
+            if (line.find("\"next\":") != std::string::npos) { next = jsonU(line, "next"); continue; } // Trailer
+            uint32_t seq = jsonU(line, "seq"); // Sequência
+            if (!first && seq != expect) gaps++; // Lacuna (saiu da fila durante o stream)
+            first = false; // Base definida
+            expect = seq + 1; // Próximo esperado
+            size_t u = line.find("\"uid\":\""); // UID
+            g_got[line.substr(u + 7, line.find('"', u + 7) - (u + 7))]++; // Recebido
+        }
+        if (!r.complete) { // Stream cortado: retoma do próximo não recebido, sem ack
+            aborts++; // Conta
+            resumeFrom = expect; // Cursor local
+            haveResume = true; // Próximo GET usa from=
+            abortAt = 0; // Só o primeiro é cortado
+            continue; // Puxa de novo
+        }
+        haveResume = false; // Lote completo
+        Reply a = exchange(app, "POST /ack?epoch=" + std::to_string(epoch) + "&cursor=" + std::to_string(next) + " HTTP/1.1\r\n" + kAuth + "\r\n", 0, nextTap); // Confirma
+        if (a.code != 200) { printf("FALHA: ack devolveu %d\n", a.code); ok = false; break; } // Não liberou
+        if (!evacMs && next >= backlogEnd) { evacMs = clk.now64() - t0; nextTap = 0; } // Backlog inicial evacuado; chegadas param
+    }
+    uint64_t dt = clk.now64() - t0; // Duração da coleta, incluindo o que chegou durante ela (ms)
+
+    uint32_t missing = 0, dup = 0, extra = 0, total = 0; // Conservação
+    for (const auto &kv : g_read) { total += kv.second; auto it = g_got.find(kv.first); if (it == g_got.end()) missing += kv.second; else if (it->second > kv.second) dup += it->second - kv.second; } // Lidos
+    for (const auto &kv : g_got) if (!g_read.count(kv.first)) extra += kv.second; // Inventados
+    const LanPullStats &s = app.lanPull().stats(); // Métricas do servidor
+    double secs = dt / 1e3; // Segundos
+    double evacS = evacMs / 1e3; // Segundos até confirmar o backlog inicial
+    uint32_t got = 0; for (const auto &kv : g_got) got += kv.second; // Recebidos
+    double cloudS = backlogEnd * (app.config().drainIntervalMs() + g_opt.postMs) / 1000.0; // Estimativa pela nuvem
+    printf("Lotes=%u streams=%lu cortados=%u lacunas=%u rejeitados=%lu liberados=%lu\n", pulls, (unsigned long)s.streams, // Resumo
+           aborts, gaps, (unsigned long)s.rejected, (unsigned long)s.released); // ...
+    printf("Backlog inicial (%u) confirmado em %.1f s simulados (%.0f registros/s); total coletado=%u de %u em %.1f s (%.1f KB pela LAN)\n", // Vazão
+           (unsigned)backlogEnd, evacS, evacS > 0 ? backlogEnd / evacS : 0.0, got, total, secs, s.bytes / 1024.0); // ...
+    printf("Mesmo backlog pela nuvem (1 POST a cada %lu ms + %u ms, WAN ok): ~%.0f s\n", (unsigned long)app.config().drainIntervalMs(), // Comparação
+           (unsigned)g_opt.postMs, cloudS); // ...
+    printf("Maior fatia do loop ocupada pela coleta: %.1f ms; POSTs para a nuvem durante a coleta: %u\n", // Responsividade
+           s.maxSliceUs / 1000.0, posts - postsBefore); // ...
+    bool cons = missing == 0 && dup == 0 && extra == 0 && app.queueDepth() == 0 && app.queueDropped() == 0; // Exatamente uma vez
+    printf("Conservacao: faltando=%u duplicados=%u estranhos=%u fila=%u descartados=%u -> %s\n", missing, dup, extra, // Veredito
+           (unsigned)app.queueDepth(), (unsigned)app.queueDropped(), cons ? "OK" : "FALHA"); // ...
+    ok = ok && cons; // Resultado global
+    printf("Resultado: %s\n", ok ? "OK" : "FALHA"); // Veredito
+    return ok ? 0 : 1; // Código de saída
+}
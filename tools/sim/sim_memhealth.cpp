@@ -0,0 +1,101 @@
+/*
+    Arquivo: tools/sim/sim_memhealth.cpp
+    Propósito: Exercita, no host, a reação do AppController à saúde da memória
+    com o heap roteirizado (MemTelemetry::hostSetHeap). Com backlog na fila, o
+    heap passa por CRITICAL -> DEGRADED -> OK e o cenário confere:
+      - CRITICAL: nenhum POST (serviceQueueSend pausado) e o download da
+        configuração pulado mesmo vencido (serviceConfig);
+      - DEGRADED: período da tarefa "uplink" = drain_ms x MEM_DEGRADED_DRAIN_FACTOR
+        (uplinkIntervalMs()), POSTs espaçados por ele e a configuração baixada;
+      - OK: período de volta a drain_ms e a fila drenada, cada leitura entregue
+        uma única vez.
+    Uso: sim_memhealth [--verbose]
+    Código de saída != 0 se alguma conferência falhar.
+*/
+
+#include "AppController.h" // Firmware sob teste
+#include <WiFi.h> // hostWifi(): AP simulado
+#include <HTTPClient.h> // hostHttp(): backend e configuração
+#include <MFRC522.h> // hostRfid(): campo de RF
+#include <string> // Argumentos
+#include <vector> // Instantes dos POSTs
+
+static bool g_ok = true; // Resultado global
+
+static void check(bool cond, const char *what) { // Imprime uma conferência e acumula o veredito
+    printf("  %-66s %s\n", what, cond ? "OK" : "FALHA"); // Linha do relatório
+    if (!cond) g_ok = false; // Reprova o cenário
+}
+
+static const char *healthName(MemHealth h) { // Nível legível
+    return h == MemHealth::OK ? "OK" : h == MemHealth::DEGRADED ? "DEGRADED" : "CRITICAL"; // Texto
+}
+
+int main(int argc, char **argv) { // Executa o cenário e imprime o relatório
+    bool verbose = argc == 2 && std::string(argv[1]) == "--verbose"; // Log do firmware
+    if (argc > 2 || (argc == 2 && !verbose)) { fprintf(stderr, "uso: sim_memhealth [--verbose]\n"); return 2; } // Uso inválido
+    hostSerialQuiet = !verbose; // Log do firmware só com --verbose
+    VirtualClock &clk = hostClock(); // Relógio
+    hostWifi().aps.push_back({WIFI_SSID, {0x24, 0x0A, 0xC4, 0x10, 0x20, 0x30}, 6, -58, true}); // AP disponível
+    std::vector<uint64_t> posts; // Instante de cada POST
+    hostHttp().handler = [&](const HostHttpRequest &) { posts.push_back(clk.now64()); return 200; }; // Backend sempre OK
+    hostHttp().getHandler = [](const HostHttpRequest &, HostHttpResponse &) { return 304; }; // Configuração sem mudança
+
+    AppController app(clk); // Leitor
+    app.begin(); // Boot
+    auto run = [&](uint64_t ms) { uint64_t end = clk.now64() + ms; while (clk.now64() < end) { app.loop(); clk.advance(1); } }; // Itera o firmware
+    run(10000); // Conecta e baixa a configuração do boot
+    const TaskScheduler &sched = app.scheduler(); // Tarefas
+    int8_t uplink = -1; // Id da tarefa "uplink"
+    for (uint8_t i = 0; i < sched.count(); ++i) if (std::string(sched.name(i)) == "uplink") uplink = (int8_t)i; // Procura por nome
+    const uint32_t drain = app.config().drainIntervalMs(); // Cadência normal
+    printf("Heap simulado roteirizado; drain_ms=%lu, fator degradado %u, amostra a cada %u ms, configuracao a cada %lu ms\n", // Cabeçalho
+           (unsigned long)drain, (unsigned)MEM_DEGRADED_DRAIN_FACTOR, (unsigned)MEM_SAMPLE_INTERVAL_MS, (unsigned long)CONFIG_FETCH_INTERVAL_MS); // ...
+    check(uplink >= 0 && app.memory().health() == MemHealth::OK && sched.period(uplink) == drain, "boot: memoria OK, tarefa uplink no periodo drain_ms"); // Ponto de partida
+    uint32_t gets = hostHttp().gets; // GETs da configuração até aqui
+
+    // CRITICAL: maior bloco abaixo de MEM_CRITICAL_BLOCK_BYTES; leituras chegam e ficam na fila
+    MemTelemetry::hostSetHeap(60000, MEM_CRITICAL_BLOCK_BYTES - 5000); // Heap fragmentado
+    run(MEM_SAMPLE_INTERVAL_MS + 1000); // Próxima amostra
+    const uint32_t taps = 100; // Leituras durante a crise
+    for (uint32_t i = 0; i < taps; ++i) { // Cartões distintos
+        byte uid[4] = {0x04, 0x3C, (byte)(i >> 8), (byte)i}; // UID
+        hostRfid().enter(uid, 4); run(20); hostRfid().leave(uid, 4); run(30); // Passa pelo leitor
+    }
+    run(CONFIG_FETCH_INTERVAL_MS); // Download da configuração vence durante a crise
+    printf("CRITICAL: saude %s, %u leituras na fila, %lu POSTs, %lu GETs de configuracao\n", healthName(app.memory().health()), // Estado
+           (unsigned)app.queueDepth(), (unsigned long)posts.size(), (unsigned long)(hostHttp().gets - gets)); // ...
+    check(app.memory().health() == MemHealth::CRITICAL, "maior bloco < MEM_CRITICAL_BLOCK_BYTES: CRITICAL"); // Limiar
+    check(posts.empty() && app.queueDepth() == taps, "CRITICAL: envios pausados, leituras retidas na fila"); // serviceQueueSend
+    check(hostHttp().gets == gets, "CRITICAL: configuracao vencida nao e baixada"); // serviceConfig
+
+    // DEGRADED: folga para sair do crítico, mas abaixo de MEM_DEGRADED_BLOCK_BYTES
+    MemTelemetry::hostSetHeap(200000, MEM_DEGRADED_BLOCK_BYTES - 5000); // Bloco suficiente para um POST
+    run(MEM_SAMPLE_INTERVAL_MS + 1000); // Próxima amostra (e o download pendente)
+    size_t first = posts.size(); // POSTs até aqui
+    const uint64_t window = 20000; // Janela medida
+    run(window); // Drenagem lenta
+    uint64_t minGap = UINT64_MAX; // Menor espaçamento entre POSTs na janela
+    for (size_t i = first + 1; i < posts.size(); ++i) if (posts[i] - posts[i - 1] < minGap) minGap = posts[i] - posts[i - 1]; // ...
+    const uint32_t slow = drain * MEM_DEGRADED_DRAIN_FACTOR; // Período esperado
+    printf("DEGRADED: saude %s, periodo uplink %lu ms, %lu POSTs em %lu ms (menor intervalo %lu ms), %lu GET(s) de configuracao\n", // Estado
+           healthName(app.memory().health()), (unsigned long)sched.period(uplink), (unsigned long)(posts.size() - first), // ...
+           (unsigned long)window, (unsigned long)(minGap == UINT64_MAX ? 0 : minGap), (unsigned long)(hostHttp().gets - gets)); // ...
+    check(app.memory().health() == MemHealth::DEGRADED, "maior bloco < MEM_DEGRADED_BLOCK_BYTES: DEGRADED"); // Limiar
+    check(sched.period(uplink) == slow, "periodo uplink = drain_ms x MEM_DEGRADED_DRAIN_FACTOR"); // uplinkIntervalMs()
+    check(posts.size() - first >= window / slow - 1 && posts.size() - first <= window / slow + 1 && minGap + drain >= slow, // Espaçamento
+          "POSTs espacados pelo periodo degradado"); // Tolerância: a liberação da transição ainda segue a grade de drain_ms
+    check(hostHttp().gets == gets + 1, "DEGRADED: configuracao pendente baixada"); // Só o crítico pula
+
+    // OK: heap recomposto acima da histerese
+    MemTelemetry::hostSetHeap(300000, 300000); // Heap saudável
+    run(MEM_SAMPLE_INTERVAL_MS + 1000); // Próxima amostra
+    bool fast = sched.period(uplink) == drain; // Período restaurado
+    run(30000); // Drena o resto
+    printf("OK: saude %s, periodo uplink %lu ms, fila %u, %lu POSTs no total\n", healthName(app.memory().health()), // Estado
+           (unsigned long)sched.period(uplink), (unsigned)app.queueDepth(), (unsigned long)posts.size()); // ...
+    check(app.memory().health() == MemHealth::OK && fast, "heap recomposto: OK, periodo de volta a drain_ms"); // Recuperação
+    check(app.queueDepth() == 0 && posts.size() == taps, "fila drenada: cada leitura enviada uma unica vez"); // Conservação
+    printf("Resultado: %s\n", g_ok ? "OK" : "FALHA"); // Veredito
+    return g_ok ? 0 : 1; // Código de saída
+}
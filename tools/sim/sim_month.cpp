@@ -0,0 +1,372 @@
+/*
+    Arquivo: tools/sim/sim_month.cpp
+    Propósito: Executor de cenário de longa duração no host. Roda o
+    AppController real (src/) sobre o relógio virtual (Clock.h) e a camada
+    Arduino simulada (tools/host), avançando semanas de operação em segundos.
+    O cenário é determinístico a partir da semente: passagens de crachá em
+    horário comercial (com retoques), quedas do AP e janelas de erro 503 no
+    servidor. Relata:
+      - profundidade da fila ao longo do tempo (resumo diário; por hora em CSV);
+      - conservação: aceitas = entregues + na fila + descartadas;
+      - deduplicação através do wrap de 32 bits de millis(): cada seleção de
+        cartão é reavaliada em lockstep por um RfidDedupCache (32 bits) e por
+        uma referência com tempo de 64 bits; qualquer divergência é listada;
+      - atraso de reconexão após o retorno do AP (backoff através do wrap);
+      - configuração remota: o servidor publica um documento (ETag) e, no dia
+        --config-day, uma nova versão (cadência e retries); conta GETs, 304 e
+        atualizações e confere se o firmware passou a usar os novos valores;
+      - memória por trecho (MemScope): chamadas, alocações e bytes retidos de
+        cada site; com o wrap do alocador (MEM_HOST_WRAP_MALLOC, Linux), envio
+        HTTP e download da configuração precisam ter alocações atribuídas.
+    Uso: sim_month [--days N] [--seed S] [--start-ms T] [--badges N]
+                   [--tick MS] [--idle-tick MS] [--config-day D] [--csv arquivo]
+                   [--verbose]
+    Código de saída != 0 se a conservação falhar, houver divergência, a
+    configuração publicada não for aplicada ou (com o wrap) um trecho
+    exercitado ficar sem alocações atribuídas.
+*/
+
+#include "AppController.h" // Firmware sob teste
+#include "RfidDedupCache.h" // Cache de deduplicação (lockstep)
+#include "MemTelemetry.h" // Estatísticas por trecho (MemScope)
+#include <WiFi.h> // hostWifi(): ambiente de APs
+#include <HTTPClient.h> // hostHttp(): servidor simulado
+#include <MFRC522.h> // hostRfid(): campo de RF
+#include <algorithm> // std::find
+#include <chrono> // Tempo real decorrido
+#include <map> // Referência de deduplicação
+#include <queue> // Fila de eventos
+#include <random> // Gerador do cenário
+#include <string> // UIDs
+#include <vector> // Tabelas por hora/dia
+
+static const uint64_t kSecond = 1000ULL; // ms
+static const uint64_t kMinute = 60 * kSecond; // ms
+static const uint64_t kHour = 60 * kMinute; // ms
+static const uint64_t kDay = 24 * kHour; // ms
+static const uint64_t kWrap = 1ULL << 32; // Período de millis()
+
+// Parâmetros da linha de comando
+struct Options { // Valores padrão: um mês cruzando o wrap
+    uint32_t days = 30; // Duração simulada
+    uint64_t seed = 1; // Semente do cenário
+    uint64_t startMs = kWrap - (2 * kDay + 12 * kHour); // millis() inicial: wrap no dia 2 às 12:00
+    uint32_t badges = 300; // Crachás distintos
+    uint32_t tickMs = 50; // Passo com atividade (cartão no campo ou fila drenando)
+    uint32_t idleTickMs = 500; // Passo ocioso
+    uint32_t configDay = 3; // Dia em que a nova versão da configuração é publicada
+    const char *csv = nullptr; // Saída por hora (opcional)
+    bool verbose = false; // Mostra o log do firmware
+}; // fim: struct Options
+
+// Evento do cenário
+struct Event { // Ordenado por instante
+    enum Kind : uint8_t { CARD_ENTER, CARD_LEAVE, AP_DOWN, AP_UP }; // Tipos
+    uint64_t t; // Instante (ms desde o início do cenário)
+    Kind kind; // Tipo
+    uint32_t badge; // Crachá (eventos de cartão)
+    bool operator>(const Event &o) const { return t > o.t; } // Min-heap por tempo
+}; // fim: struct Event
+
+// Intervalo [from, to) do cenário
+struct Window { uint64_t from, to; }; // Queda do AP ou erro do servidor
+
+// Estatística de uma hora simulada
+struct HourStat { // Uma linha do CSV
+    uint32_t depthMin = UINT32_MAX, depthMax = 0; // Profundidade da fila
+    double depthArea = 0; // Integral da profundidade (fila × ms)
+    uint32_t taps = 0, accepted = 0, delivered = 0; // Passagens, aceitas (referência), entregues
+    uint64_t offlineMs = 0; // Tempo sem Wi‑Fi
+}; // fim: struct HourStat
+
+// Deduplicação de referência: mesma política (janela + capacidade LRU), tempo de 64 bits
+class RefDedup { // Sem wrap: serve de gabarito
+public: // Seção pública
+    bool accept(const std::string &uid, uint64_t now) { // true se a leitura deve ser aceita
+        for (auto it = _last.begin(); it != _last.end();) { // Expira janelas vencidas
+            if (now - it->second >= DEDUP_INTERVAL_MS) it = _last.erase(it); else ++it; // Venceu?
+        }
+        if (_last.count(uid)) return false; // Duplicata dentro da janela
+        if (_last.size() >= DEDUP_CACHE_SIZE) { // Capacidade esgotada: descarta o mais antigo
+            auto oldest = _last.begin(); // Candidato
+            for (auto it = _last.begin(); it != _last.end(); ++it) if (it->second < oldest->second) oldest = it; // Menor instante
+            _last.erase(oldest); // Remove
+        }
+        _last[uid] = now; // Registra aceite
+        return true; // Aceita
+    }
+private: // Seção privada
+    std::map<std::string, uint64_t> _last; // UID -> instante do último aceite
+}; // Fim da classe RefDedup
+
+static Options g_opt; // Opções efetivas
+static std::vector<HourStat> g_hours; // Estatísticas por hora
+static std::vector<Window> g_srvErrors; // Janelas de erro 503
+static std::vector<std::vector<uint8_t>> g_uids; // UID de cada crachá
+static RfidDedupCache g_lock; // Lockstep: implementação de 32 bits
+static RefDedup g_ref; // Lockstep: referência de 64 bits
+static uint64_t g_selects = 0, g_refAccepted = 0, g_delivered = 0, g_mismatch = 0, g_nearWrap = 0; // Contadores globais
+static uint64_t g_checksum = 1469598103934665603ULL; // FNV-1a das entregas (reprodutibilidade)
+
+static uint64_t nowScenario() { return hostClock().now64() - g_opt.startMs; } // Relógio virtual -> tempo do cenário
+static HourStat &hourAt(uint64_t t) { size_t h = (size_t)(t / kHour); return g_hours[h < g_hours.size() ? h : g_hours.size() - 1]; } // Bucket
+
+static std::string toHex(const uint8_t *b, size_t n) { // Mesmo formato do RfidReader (maiúsculas)
+    static const char *d = "0123456789ABCDEF"; // Dígitos
+    std::string s; // Resultado
+    for (size_t i = 0; i < n; ++i) { s += d[b[i] >> 4]; s += d[b[i] & 0x0F]; } // Nibbles
+    return s; // UID em HEX
+}
+
+static void fmtTime(uint64_t t, char *out, size_t n) { // "dia D hh:mm:ss"
+    unsigned d = (unsigned)(t / kDay), s = (unsigned)((t % kDay) / kSecond); // Componentes
+    snprintf(out, n, "dia %u %02u:%02u:%02u", d, s / 3600, (s / 60) % 60, s % 60); // Formata
+}
+
+static bool inWindow(const std::vector<Window> &w, uint64_t t) { // t dentro de algum intervalo?
+    for (const Window &x : w) if (t >= x.from && t < x.to) return true; // Linear (poucas janelas)
+    return false; // Fora
+}
+
+static void parseArgs(int argc, char **argv) { // Linha de comando
+    for (int i = 1; i < argc; ++i) { // Percorre argumentos
+        std::string a = argv[i]; // Argumento atual
+        auto next = [&]() -> const char * { return i + 1 < argc ? argv[++i] : "0"; }; // Valor seguinte
+        if (a == "--days") g_opt.days = (uint32_t)strtoul(next(), nullptr, 10); // Duração
+        else if (a == "--seed") g_opt.seed = strtoull(next(), nullptr, 10); // Semente
+        else if (a == "--start-ms") g_opt.startMs = strtoull(next(), nullptr, 10); // millis() inicial
+        else if (a == "--badges") g_opt.badges = (uint32_t)strtoul(next(), nullptr, 10); // Crachás
+        else if (a == "--tick") g_opt.tickMs = (uint32_t)strtoul(next(), nullptr, 10); // Passo ativo
+        else if (a == "--idle-tick") g_opt.idleTickMs = (uint32_t)strtoul(next(), nullptr, 10); // Passo ocioso
+        else if (a == "--config-day") g_opt.configDay = (uint32_t)strtoul(next(), nullptr, 10); // Nova configuração
+        else if (a == "--csv") g_opt.csv = next(); // Arquivo CSV
+        else if (a == "--verbose") g_opt.verbose = true; // Log do firmware
+        else { fprintf(stderr, "argumento desconhecido: %s\n", a.c_str()); exit(2); } // Erro de uso
+    }
+    if (g_opt.days == 0) g_opt.days = 1; // Mínimo de um dia
+    if (g_opt.badges == 0) g_opt.badges = 1; // Mínimo de um crachá
+    if (g_opt.tickMs == 0) g_opt.tickMs = 1; // Passos positivos
+    if (g_opt.idleTickMs < g_opt.tickMs) g_opt.idleTickMs = g_opt.tickMs; // Ocioso >= ativo
+}
+
+// buildScenario(): passagens de crachá (com retoques), quedas do AP e erros do servidor
+static void buildScenario(std::priority_queue<Event, std::vector<Event>, std::greater<Event>> &q) { // Determinístico
+    std::mt19937_64 rng(g_opt.seed); // Gerador do cenário
+    std::uniform_real_distribution<double> u(0.0, 1.0); // Sorteios de probabilidade
+    auto uni = [&](uint64_t a, uint64_t b) { return a + (uint64_t)(u(rng) * (double)(b - a)); }; // Uniforme em [a, b)
+    auto norm = [&](double mean, double sd) { std::normal_distribution<double> n(mean, sd); double v = n(rng); return (uint64_t)(v < 0 ? 0 : v); }; // Normal truncada
+
+    std::vector<std::string> seen; // Garante UIDs distintos
+    for (uint32_t b = 0; b < g_opt.badges; ++b) { // Gera UIDs de 4 bytes
+        std::vector<uint8_t> uid(4); // NUID MIFARE Classic
+        do { for (uint8_t &x : uid) x = (uint8_t)rng(); } while (std::find(seen.begin(), seen.end(), toHex(uid.data(), 4)) != seen.end()); // Sem repetição
+        seen.push_back(toHex(uid.data(), 4)); // Registra
+        g_uids.push_back(uid); // Guarda
+    }
+
+    auto tap = [&](uint64_t t, uint32_t b) { // Uma passagem: cartão entra e sai do campo
+        uint64_t hold = uni(300, 1200); // Tempo diante da antena
+        q.push({t, Event::CARD_ENTER, b}); // Aproxima
+        q.push({t + hold, Event::CARD_LEAVE, b}); // Afasta
+        if (u(rng) < 0.08) { uint64_t r = t + hold + uni(2 * kSecond, 20 * kSecond); q.push({r, Event::CARD_ENTER, b}); q.push({r + hold, Event::CARD_LEAVE, b}); } // Retoque na janela (duplicata)
+        else if (u(rng) < 0.03) { uint64_t r = t + hold + uni(40 * kSecond, 120 * kSecond); q.push({r, Event::CARD_ENTER, b}); q.push({r + hold, Event::CARD_LEAVE, b}); } // Retoque fora da janela (nova leitura)
+    };
+
+    for (uint32_t d = 0; d < g_opt.days; ++d) { // Dia a dia (dia 0 = segunda-feira)
+        uint64_t day = d * kDay; // Início do dia
+        bool weekend = (d % 7) >= 5; // Sábado/domingo
+        for (uint32_t b = 0; b < g_opt.badges; ++b) { // Cada crachá
+            if (u(rng) >= (weekend ? 0.05 : 0.92)) continue; // Ausente hoje
+            uint64_t in = day + norm(8.0 * kHour, 30.0 * kMinute); // Chegada
+            uint64_t lunch = day + norm(12.0 * kHour, 20.0 * kMinute); // Saída para almoço
+            uint64_t back = lunch + norm(60.0 * kMinute, 10.0 * kMinute); // Retorno
+            uint64_t out = day + norm(17.5 * kHour, 45.0 * kMinute); // Saída
+            tap(in, b); // Entrada
+            if (u(rng) < 0.7) { tap(lunch, b); tap(back, b); } // Almoço fora
+            tap(out > back ? out : back + kHour, b); // Saída (sempre após o retorno)
+        }
+        if (u(rng) < 0.3) { // Queda do AP neste dia
+            uint64_t from = day + uni(0, kDay), to = from + uni(5 * kMinute, 4 * kHour); // Duração variável
+            q.push({from, Event::AP_DOWN, 0}); q.push({to, Event::AP_UP, 0}); // Agenda
+        }
+        if (u(rng) < 0.2) { // Servidor responde 503 por um período
+            uint64_t from = day + uni(6 * kHour, 20 * kHour); // Horário comercial estendido
+            g_srvErrors.push_back({from, from + uni(1 * kMinute, 30 * kMinute)}); // Janela de erro
+        }
+    }
+}
+
+// onSelect(): cada seleção de cartão é reavaliada pelas duas deduplicações no mesmo instante do firmware
+static void onSelect(const MFRC522::Uid &uid) { // Chamado pelo MFRC522 simulado
+    uint64_t now64 = hostClock().now64(); // Tempo verdadeiro (sem wrap)
+    uint32_t now32 = (uint32_t)now64; // O que millis() devolve
+    std::string hex = toHex(uid.uidByte, uid.size); // UID em HEX
+    g_lock.sweep(now32); // Mesma sequência do RfidReader::read
+    bool got = !g_lock.isDuplicate(hex.c_str(), now32); // Decisão de 32 bits
+    if (got) g_lock.remember(hex.c_str(), now32); // Registra aceite
+    bool want = g_ref.accept(hex, now64); // Decisão de referência
+    g_selects++; // Conta seleção
+    if (want) { g_refAccepted++; hourAt(nowScenario()).accepted++; } // Aceites esperados
+    uint64_t toWrap = (now64 / kWrap + 1) * kWrap - now64, sinceWrap = now64 % kWrap; // Distância ao wrap mais próximo
+    if (toWrap < DEDUP_INTERVAL_MS || sinceWrap < DEDUP_INTERVAL_MS) g_nearWrap++; // Evento na vizinhança do wrap
+    if (got != want) { // Divergência
+        if (g_mismatch < 10) { // Lista só as primeiras
+            char when[32]; fmtTime(nowScenario(), when, sizeof(when)); // Instante legível
+            printf("  DIVERGENCIA %s millis=%lu uid=%s 32bits=%s ref=%s\n", when, (unsigned long)now32, hex.c_str(), // Detalhe
+                   got ? "aceita" : "duplicada", want ? "aceita" : "duplicada");
+        }
+        g_mismatch++; // Conta
+    }
+}
+
+// field(): valor de um campo do payload JSON plano ("k":"v" ou "k":123)
+static std::string field(const std::string &body, const char *key) { // Parser mínimo (payload do HttpSender)
+    std::string k = std::string("\"") + key + "\":"; // Chave com aspas
+    size_t p = body.find(k); // Posição
+    if (p == std::string::npos) return std::string(); // Ausente
+    p += k.size(); // Início do valor
+    if (p < body.size() && body[p] == '"') ++p; // Valor texto
+    size_t e = body.find_first_of("\",}", p); // Fim do valor
+    return body.substr(p, e == std::string::npos ? std::string::npos : e - p); // Valor
+}
+
+// onPost(): servidor simulado (latência, janelas de 503, auditoria das entregas)
+static int onPost(const HostHttpRequest &req) { // Chamado pelo HTTPClient simulado
+    static std::mt19937 lat((uint32_t)g_opt.seed ^ 0x9E3779B9u); // Latência determinística
+    hostClock().advance(60 + lat() % 190); // 60..250 ms de ida e volta (bloqueia o loop, como no ESP32)
+    uint64_t t = nowScenario(); // Instante da resposta
+    if (inWindow(g_srvErrors, t)) return 503; // Servidor indisponível
+    g_delivered++; // Entrega confirmada
+    hourAt(t).delivered++; // Por hora
+    std::string key = field(req.body, "uid") + "@" + field(req.body, "capture_timestamp_ms"); // Campos determinísticos
+    for (char c : key) { g_checksum ^= (uint8_t)c; g_checksum *= 1099511628211ULL; } // FNV-1a
+    return 200; // OK
+}
+
+// Documento de configuração publicado (v2 a partir de --config-day)
+static const char *kConfigV1 = "{\"drain_ms\": 100}"; // Mesmos valores do build
+static const char *kConfigV2 = "{\"drain_ms\": 250, \"retry_max\": 2, \"retry_base_ms\": 200}"; // Ajuste de campo
+static const uint32_t kConfigV2DrainMs = 250; // Conferido no fim
+
+// onGet(): servidor de configuração com ETag (304 quando o cliente já tem a versão)
+static int onGet(const HostHttpRequest &req, HostHttpResponse &resp) { // Chamado pelo HTTPClient simulado
+    hostClock().advance(80); // Ida e volta
+    bool v2 = nowScenario() >= (uint64_t)g_opt.configDay * kDay; // Versão vigente
+    const char *etag = v2 ? "\"v2\"" : "\"v1\""; // ETag da versão
+    auto it = req.headers.find("If-None-Match"); // Versão do cliente
+    if (it != req.headers.end() && it->second == etag) return 304; // Nada mudou
+    resp.body = v2 ? kConfigV2 : kConfigV1; // Documento
+    resp.headers["ETag"] = etag; // Versão
+    return 200; // OK
+}
+
+int main(int argc, char **argv) { // Executa o cenário e imprime o relatório
+    parseArgs(argc, argv); // Opções
+    hostSerialQuiet = !g_opt.verbose; // Log do firmware só com --verbose
+    randomSeed((unsigned long)g_opt.seed); // random() do firmware (jitter do backoff)
+    hostClock().set(g_opt.startMs); // millis() inicial
+    g_hours.resize((size_t)g_opt.days * 24); // Buckets por hora
+
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> q; // Eventos pendentes
+    buildScenario(q); // Gera o mês
+    hostWifi().aps.push_back({WIFI_SSID, {0x24, 0x0A, 0xC4, 0x10, 0x20, 0x30}, 6, -58, true}); // AP único, sinal bom
+    hostHttp().handler = onPost; // Servidor simulado
+    hostHttp().getHandler = onGet; // Servidor de configuração
+    hostRfid().onSelect = onSelect; // Auditoria de deduplicação
+
+    uint64_t wrapAt = kWrap - (g_opt.startMs % kWrap); // Instante do próximo wrap (tempo do cenário)
+    char when[32]; fmtTime(wrapAt, when, sizeof(when)); // Legível
+    printf("Simulacao: %u dias, semente %llu, %u crachas, millis inicial=%llu (wrap em %s)\n", g_opt.days, // Cabeçalho
+           (unsigned long long)g_opt.seed, g_opt.badges, (unsigned long long)(g_opt.startMs % kWrap), when);
+
+    auto wall0 = std::chrono::steady_clock::now(); // Tempo real
+    AppController app(hostClock()); // Firmware com o relógio virtual
+    app.begin(); // Boot
+
+    uint64_t end = (uint64_t)g_opt.days * kDay; // Fim do cenário
+    uint64_t apUpAt = 0, outages = 0, maxReconnect = 0; // Métricas de reconexão
+    bool apUp = true, waitingReconnect = false; // Estado do AP e do cronômetro
+    uint64_t t = nowScenario(); // Tempo atual do cenário
+    while (t < end) { // Laço principal do simulador
+        while (!q.empty() && q.top().t <= t) { // Aplica eventos vencidos
+            Event ev = q.top(); q.pop(); // Próximo evento
+            const std::vector<uint8_t> &uid = g_uids[ev.badge]; // UID do crachá
+            switch (ev.kind) { // Efeito no ambiente
+                case Event::CARD_ENTER: hostRfid().enter(uid.data(), (byte)uid.size()); hourAt(t).taps++; break; // Aproxima
+                case Event::CARD_LEAVE: hostRfid().leave(uid.data(), (byte)uid.size()); break; // Afasta
+                case Event::AP_DOWN: if (apUp) { apUp = false; outages++; } hostWifi().aps[0].up = false; break; // Queda
+                case Event::AP_UP: if (!apUp) { apUp = true; apUpAt = t; waitingReconnect = true; } hostWifi().aps[0].up = true; break; // Retorno
+            }
+        }
+        app.loop(); // Uma iteração do firmware
+        t = nowScenario(); // Pode ter avançado (latência HTTP, delays)
+        bool online = (uint32_t)WiFi.localIP() != 0; // Leitura sem efeitos colaterais
+        if (waitingReconnect && online) { // Reconectou após o retorno do AP
+            uint64_t d = t - apUpAt; if (d > maxReconnect) maxReconnect = d; // Pior caso
+            waitingReconnect = false; // Cronômetro parado
+        }
+        uint32_t depth = (uint32_t)app.queueDepth(); // Profundidade atual
+        bool active = hostRfid().count() > 0 || (depth > 0 && online); // Precisa de passo fino?
+        uint64_t dt = active ? g_opt.tickMs : g_opt.idleTickMs; // Passo
+        if (!q.empty() && q.top().t > t && q.top().t - t < dt) dt = q.top().t - t; // Não pula eventos
+        if (t + dt > end) dt = end > t ? end - t : 1; // Não passa do fim
+        HourStat &h = hourAt(t); // Bucket atual
+        if (depth < h.depthMin) h.depthMin = depth; // Mínimo
+        if (depth > h.depthMax) h.depthMax = depth; // Máximo
+        h.depthArea += (double)depth * (double)dt; // Integral para a média ponderada
+        if (!online) h.offlineMs += dt; // Tempo offline
+        hostClock().advance(dt); // Avança o relógio virtual
+        t += dt; // Tempo do cenário
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count(); // Segundos reais
+
+    FILE *csv = g_opt.csv ? fopen(g_opt.csv, "w") : nullptr; // CSV por hora
+    if (csv) fprintf(csv, "hora,dia,hh,fila_min,fila_max,fila_media,passagens,aceitas,entregues,offline_ms\n"); // Cabeçalho
+    printf("\n dia sem  passagens aceitas entregues fila_max fila_media offline_min\n"); // Tabela diária
+    static const char *wd[] = {"seg", "ter", "qua", "qui", "sex", "sab", "dom"}; // Dias da semana
+    for (uint32_t d = 0; d < g_opt.days; ++d) { // Consolida por dia
+        HourStat day; double area = 0; // Acumuladores
+        for (uint32_t hh = 0; hh < 24; ++hh) { // Horas do dia
+            const HourStat &h = g_hours[d * 24 + hh]; // Bucket
+            day.taps += h.taps; day.accepted += h.accepted; day.delivered += h.delivered; day.offlineMs += h.offlineMs; // Somas
+            if (h.depthMax > day.depthMax) day.depthMax = h.depthMax; // Máximo
+            area += h.depthArea; // Integral
+            if (csv) fprintf(csv, "%u,%u,%u,%u,%u,%.2f,%u,%u,%u,%llu\n", d * 24 + hh, d, hh, // Linha por hora
+                             h.depthMin == UINT32_MAX ? 0 : h.depthMin, h.depthMax, h.depthArea / (double)kHour,
+                             h.taps, h.accepted, h.delivered, (unsigned long long)h.offlineMs);
+        }
+        printf("%4u %s %10u %7u %9u %8u %10.2f %11.1f\n", d, wd[d % 7], day.taps, day.accepted, day.delivered, // Linha diária
+               day.depthMax, area / (double)kDay, (double)day.offlineMs / (double)kMinute);
+    }
+    if (csv) fclose(csv); // Fecha CSV
+
+    uint64_t queued = app.queueDepth(), dropped = app.queueDropped(); // Estado final da fila
+    bool conserved = g_refAccepted == g_delivered + queued + dropped; // Nenhuma leitura perdida ou duplicada
+    printf("\nConservacao: aceitas(ref)=%llu entregues=%llu na_fila=%llu descartadas=%llu -> %s\n", // Balanço
+           (unsigned long long)g_refAccepted, (unsigned long long)g_delivered, (unsigned long long)queued,
+           (unsigned long long)dropped, conserved ? "OK" : "FALHA");
+    printf("Dedup (32 bits vs referencia 64 bits): selecoes=%llu perto_do_wrap=%llu divergencias=%llu -> %s\n", // Lockstep
+           (unsigned long long)g_selects, (unsigned long long)g_nearWrap, (unsigned long long)g_mismatch,
+           g_mismatch ? "FALHA" : "OK");
+    printf("Wi-Fi: quedas do AP=%llu, maior atraso de reconexao apos retorno=%.1f s\n", // Backoff
+           (unsigned long long)outages, (double)maxReconnect / 1000.0);
+    const RuntimeConfigStats &cs = app.config().stats(); // Download da configuração
+    bool cfgOk = g_opt.configDay >= g_opt.days || app.config().drainIntervalMs() == kConfigV2DrainMs; // v2 aplicada (se publicada)
+    printf("Config remota: GETs=%lu 304=%lu atualizacoes=%lu erros=%lu drain_ms=%lu -> %s\n", // Download com ETag
+           (unsigned long)cs.fetches, (unsigned long)cs.notModified, (unsigned long)cs.updates, (unsigned long)cs.errors,
+           (unsigned long)app.config().drainIntervalMs(), cfgOk ? "OK" : "FALHA");
+    bool memOk = true; // Atribuição por trecho
+    for (size_t i = 0; i < (size_t)MemSite::COUNT; ++i) { // Sites instrumentados
+        const MemSiteStats &ms = MemTelemetry::site((MemSite)i); // Estatísticas acumuladas
+        bool needed = (MemSite)i == MemSite::HTTP_SEND || (MemSite)i == MemSite::CONFIG_FETCH; // Exercitados pelo cenário
+        bool siteOk = !MEM_HOST_WRAP_MALLOC || !needed || (ms.calls > 0 && ms.allocs > 0); // Alocações atribuídas
+        memOk = memOk && siteOk; // Acumula
+        printf("Memoria %-12s chamadas=%lu allocs=%lu (%.1f/chamada) retido=%ld bytes%s\n", MemTelemetry::siteName((MemSite)i), // Site
+               (unsigned long)ms.calls, (unsigned long)ms.allocs, ms.calls ? (double)ms.allocs / ms.calls : 0.0, (long)ms.netBytes, // ...
+               needed ? (siteOk ? " -> OK" : " -> FALHA") : ""); // Veredito só nos sites exercitados
+    }
+    if (!MEM_HOST_WRAP_MALLOC) printf("Memoria: alocador sem wrap (MEM_HOST_WRAP_MALLOC=0); contagens por trecho nao conferidas\n"); // Fora do Linux
+    printf("Checksum das entregas: %016llx\n", (unsigned long long)g_checksum); // Reprodutibilidade
+    printf("Tempo real: %.2f s (%.0fx)\n", wall, wall > 0 ? (double)end / 1000.0 / wall : 0.0); // Aceleração
+    return (conserved && g_mismatch == 0 && cfgOk && memOk) ? 0 : 1; // Sinaliza falha para scripts/CI
+}
@@ -0,0 +1,210 @@
+/*
+    Arquivo: tools/sim/sim_reconnect.cpp
+    Propósito: Exercita, no host, a reconexão rápida do NetManager com um cache
+    desatualizado e a validade do lease reaproveitado. Etapas sobre o Wi‑Fi
+    simulado (hostWifi):
+      1. primeiro boot sem cache: conexão completa (varredura + DHCP) grava
+         BSSID/canal/lease no namespace "netcache";
+      2. reinício com o AP mudado de canal: a tentativa direcionada ao canal
+         antigo expira e cai para a conexão completa;
+      3. queda breve do link: o cache já corrigido reconecta pelo caminho rápido,
+         reaproveitando o lease (sem DHCP);
+      4. queda depois da metade de WIFI_DHCP_LEASE_MS: caminho rápido com DHCP;
+      5. falha de HTTP/DNS logo após reaproveitar o lease: reconecta com DHCP;
+      6. reinício com o AP no mesmo canal: caminho rápido, mas com DHCP (o lease
+         da NVS nunca é reaproveitado no primeiro link do boot).
+    Confere:
+      - fallback completo após exatamente uma tentativa rápida, no prazo
+        WIFI_FAST_CONNECT_TIMEOUT_MS, sem insistir no cache velho nas retentativas;
+      - cache invalidado: o blob da NVS passa a apontar para o canal novo;
+      - métricas por fase (link, DHCP, total) iguais às durações do driver;
+      - lease reaproveitado só enquanto válido e descartado após falha de transporte.
+    Uso: sim_reconnect [--old-channel N] [--new-channel N] [--seed S] [--verbose]
+    Código de saída != 0 se alguma conferência falhar.
+*/
+
+#include "NetManager.h" // Firmware sob teste
+#include <WiFi.h> // hostWifi(): AP simulado
+#include <Preferences.h> // hostNvs(): cache gravado pelo NetManager
+#include <string> // Argumentos
+
+// Parâmetros da linha de comando
+struct Options { // Valores padrão: AP muda do canal 6 para o 11 entre dois boots
+    int32_t oldChannel = 6; // Canal do AP no primeiro boot
+    int32_t newChannel = 11; // Canal do AP após o reinício
+    uint64_t seed = 1; // Semente do random() do firmware (jitter do backoff)
+    bool verbose = false; // Log do firmware
+}; // fim: struct Options
+
+static Options g_opt; // Opções globais
+
+static bool parseArgs(int argc, char **argv) { // Lê opções; false em erro
+    for (int i = 1; i < argc; ++i) { // Percorre argumentos
+        std::string a = argv[i]; // Argumento atual
+        auto next = [&](void) -> const char * { return (i + 1 < argc) ? argv[++i] : nullptr; }; // Valor da opção
+        const char *v = nullptr; // Valor lido
+        if (a == "--old-channel" && (v = next())) g_opt.oldChannel = (int32_t)strtol(v, nullptr, 10); // Canal antigo
+        else if (a == "--new-channel" && (v = next())) g_opt.newChannel = (int32_t)strtol(v, nullptr, 10); // Canal novo
+        else if (a == "--seed" && (v = next())) g_opt.seed = strtoull(v, nullptr, 10); // Semente
+        else if (a == "--verbose") g_opt.verbose = true; // Log do firmware
+        else { fprintf(stderr, "opcao invalida: %s\n", a.c_str()); return false; } // Erro
+    }
+    if (g_opt.oldChannel < 1 || g_opt.newChannel < 1 || g_opt.oldChannel == g_opt.newChannel) { // Cenário precisa de mudança real
+        fprintf(stderr, "--old-channel e --new-channel devem ser canais distintos (>= 1)\n"); return false; // Erro
+    }
+    return true; // Opções válidas
+}
+
+// Espelho do NetManager::LinkCache (layout do blob "link" no namespace "netcache")
+struct SimLinkCache { // Mesmos campos, mesma ordem
+    uint8_t bssid[6]; // MAC do AP
+    int32_t channel; // Canal do AP
+    uint32_t ip, gateway, subnet, dns; // Lease
+    uint32_t leaseMs, leaseAtMs; // Duração e instante do DHCP
+    uint8_t net; // Índice da rede candidata
+    bool valid; // Dados utilizáveis
+}; // fim: struct SimLinkCache
+
+static bool readCache(SimLinkCache &out) { // Blob gravado na NVS simulada (leitura direta: sem custo)
+    const std::vector<uint8_t> &v = hostNvs()["netcache"]["link"]; // Valor
+    if (v.size() != sizeof(out)) return false; // Ausente ou layout diferente
+    memcpy(&out, v.data(), sizeof(out)); // Copia
+    return true; // Lido
+}
+
+static bool g_ok = true; // Resultado global
+
+static void check(bool cond, const char *what) { // Imprime uma conferência e acumula o veredito
+    printf("  %-58s %s\n", what, cond ? "OK" : "FALHA"); // Linha do relatório
+    if (!cond) g_ok = false; // Reprova o cenário
+}
+
+int main(int argc, char **argv) { // Executa as três etapas e imprime o relatório
+    if (!parseArgs(argc, argv)) return 2; // Uso inválido
+    hostSerialQuiet = !g_opt.verbose; // Log do firmware só com --verbose
+    randomSeed((unsigned long)g_opt.seed); // random() do firmware
+    VirtualClock &clk = hostClock(); // Relógio
+    HostWiFiControl &w = hostWifi(); // Ambiente
+    const uint8_t bssid[6] = {0x24, 0x0A, 0xC4, 0x10, 0x20, 0x30}; // AP único (mesmo hardware nas três etapas)
+    w.aps.push_back({WIFI_SSID, {bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]}, g_opt.oldChannel, -58, true}); // AP no canal antigo
+    const uint32_t fullLinkMs = w.channelScanMs + w.linkMs; // Link esperado sem canal/BSSID
+    const uint32_t fastLinkMs = w.linkMs; // Link esperado direcionado
+
+    uint64_t connectedAt = 0, fallbackAt = 0; // Instantes observados
+    auto run = [&](NetManager &net, uint64_t limitMs) { // Itera até conectar (ou estourar o limite)
+        connectedAt = 0; // Ainda não conectou
+        uint32_t fallbacks = net.stats().fullFallbacks; // Para marcar o instante do fallback
+        uint64_t limit = clk.now64() + limitMs; // Proteção
+        while (clk.now64() < limit && !connectedAt) { // Até o callback de conexão
+            net.loop(); // Uma iteração
+            if (!fallbackAt && net.stats().fullFallbacks != fallbacks) fallbackAt = clk.now64(); // Caminho rápido expirou
+            clk.advance(1); // Resto do loop
+        }
+    };
+    auto begin = [&](NetManager &net) { // Registra o callback e dispara a primeira tentativa
+        net.onConnect([&]() { connectedAt = clk.now64(); }); // Instante do IP
+        net.begin(); // Carrega o cache e tenta
+    };
+
+    // 1. Primeiro boot: sem cache, caminho completo
+    printf("AP %02X:%02X:%02X:%02X:%02X:%02X \"%s\" no canal %ld; driver: varredura %u ms, link %u ms, DHCP %u ms; prazo rapido %d ms\n", // Cabeçalho
+           bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5], WIFI_SSID, (long)g_opt.oldChannel, // ...
+           (unsigned)w.channelScanMs, (unsigned)w.linkMs, (unsigned)w.dhcpMs, WIFI_FAST_CONNECT_TIMEOUT_MS); // ...
+    SimLinkCache c; // Cache lido da NVS
+    { // Escopo do primeiro firmware
+        NetManager net(2000, 30000, clk); // Mesmos tempos do AppController
+        uint64_t t0 = clk.now64(); // Boot
+        begin(net); run(net, 60000); // Conecta
+        const NetConnectStats &s = net.stats(); // Métricas
+        printf("1. Primeiro boot (sem cache): IP em %lu ms; link=%lu dhcp=%lu total=%lu ms, %lu tentativa(s)\n", // Resumo
+               (unsigned long)(connectedAt - t0), (unsigned long)s.lastLinkMs, (unsigned long)s.lastDhcpMs, // ...
+               (unsigned long)s.lastTotalMs, (unsigned long)s.attempts); // ...
+        check(connectedAt != 0, "conectou"); // Sanidade
+        check(s.fastAttempts == 0 && !s.lastWasFast, "sem cache: nenhuma tentativa rapida"); // Caminho completo
+        check(s.lastLinkMs == fullLinkMs && s.lastDhcpMs == w.dhcpMs && s.lastTotalMs == fullLinkMs + w.dhcpMs, // Fases
+              "fases = varredura+link / DHCP / soma"); // ...
+        check(readCache(c) && c.valid && c.channel == g_opt.oldChannel && memcmp(c.bssid, bssid, 6) == 0 && c.ip != 0, // Cache gravado
+              "cache na NVS: BSSID, canal antigo e lease"); // ...
+    }
+
+    // 2. Reinício com o AP em outro canal: cache velho expira e cai para o caminho completo
+    WiFi.hostPowerCycle(); // Chip reinicia (handlers do NetManager anterior descartados)
+    w.aps[0].channel = g_opt.newChannel; // AP mudou de canal enquanto o leitor estava desligado
+    clk.advance(5000); // Tempo desligado
+    { // Escopo do segundo firmware
+        NetManager net(2000, 30000, clk); // Novo boot
+        uint64_t t0 = clk.now64(); // Boot
+        fallbackAt = 0; // Marca a partir daqui
+        begin(net); run(net, 60000); // Conecta
+        const NetConnectStats &s = net.stats(); // Métricas
+        printf("2. Reinicio com o AP no canal %ld: fallback em %lu ms, IP em %lu ms; link=%lu dhcp=%lu total=%lu ms; rapidas=%lu fallbacks=%lu tentativas=%lu\n", // Resumo
+               (long)g_opt.newChannel, fallbackAt ? (unsigned long)(fallbackAt - t0) : 0UL, (unsigned long)(connectedAt - t0), // ...
+               (unsigned long)s.lastLinkMs, (unsigned long)s.lastDhcpMs, (unsigned long)s.lastTotalMs, // ...
+               (unsigned long)s.fastAttempts, (unsigned long)s.fullFallbacks, (unsigned long)s.attempts); // ...
+        check(connectedAt != 0, "conectou"); // Sanidade
+        check(s.fastAttempts == 1 && s.fastSuccess == 0, "uma unica tentativa rapida (canal antigo), sem sucesso"); // Cache velho tentado uma vez
+        check(s.fullFallbacks == 1 && fallbackAt == t0 + WIFI_FAST_CONNECT_TIMEOUT_MS, "fallback completo no prazo WIFI_FAST_CONNECT_TIMEOUT_MS"); // Prazo
+        check(s.attempts > s.fastAttempts, "retentativas seguintes pelo caminho completo"); // Não insiste no cache
+        check(!s.lastWasFast && s.lastLinkMs == fullLinkMs && s.lastDhcpMs == w.dhcpMs, "fases da conexao final = caminho completo"); // Métricas
+        check(readCache(c) && c.valid && c.channel == g_opt.newChannel && memcmp(c.bssid, bssid, 6) == 0, // Cache corrigido
+              "cache invalidado: NVS aponta para o canal novo"); // ...
+
+        // 3. Queda breve do link: o cache corrigido reconecta sem varredura nem DHCP
+        w.aps[0].up = false; // AP some por um instante
+        net.loop(); // Firmware percebe a queda e dispara a tentativa rápida
+        w.aps[0].up = true; // AP volta antes da associação
+        uint64_t t1 = clk.now64(); // Queda
+        run(net, 60000); // Reconecta
+        printf("3. Queda breve do link: IP em %lu ms; link=%lu dhcp=%lu total=%lu ms (%s); rapidas=%lu sucesso=%lu\n", // Resumo
+               (unsigned long)(connectedAt - t1), (unsigned long)s.lastLinkMs, (unsigned long)s.lastDhcpMs, // ...
+               (unsigned long)s.lastTotalMs, s.lastWasFast ? "rapido" : "completo", // ...
+               (unsigned long)s.fastAttempts, (unsigned long)s.fastSuccess); // ...
+        check(connectedAt != 0 && s.lastWasFast && s.fastAttempts == 2 && s.fastSuccess == 1, "reconexao pelo caminho rapido com o cache novo"); // Cache útil de novo
+        check(s.lastLinkMs == fastLinkMs && s.lastDhcpMs == 0 && s.lastTotalMs == fastLinkMs, "fases = link direcionado / lease reaproveitado"); // Sem varredura nem DHCP
+        check(s.fullFallbacks == 1, "nenhum fallback novo"); // Prazo não expirou
+        check(s.leaseReuses == 1, "lease reaproveitado uma vez"); // Contador
+
+        // 4. Lease além da metade da validade: caminho rápido, mas com DHCP
+        readCache(c); // Lease atual
+        clk.advance(WIFI_DHCP_LEASE_MS / 2); // Leitor segue conectado; T1 do lease passa
+        w.aps[0].up = false; net.loop(); w.aps[0].up = true; // Nova queda breve
+        uint64_t t2 = clk.now64(); // Queda
+        run(net, 60000); // Reconecta
+        SimLinkCache c2; // Lease depois do DHCP
+        printf("4. Queda apos %lu s (lease de %lu s): IP em %lu ms; link=%lu dhcp=%lu ms (%s)\n", // Resumo
+               (unsigned long)(WIFI_DHCP_LEASE_MS / 2000), (unsigned long)(WIFI_DHCP_LEASE_MS / 1000), (unsigned long)(connectedAt - t2), // ...
+               (unsigned long)s.lastLinkMs, (unsigned long)s.lastDhcpMs, s.lastWasFast ? "rapido" : "completo"); // ...
+        check(s.lastWasFast && s.lastDhcpMs == w.dhcpMs && s.leaseReuses == 1, "lease vencido (T1): caminho rapido com DHCP"); // Sem reaproveitar
+        check(readCache(c2) && c2.leaseAtMs != c.leaseAtMs && c2.leaseMs == WIFI_DHCP_LEASE_MS, "NVS: lease renovado pelo DHCP"); // Instante novo
+
+        // 5. Falha de transporte logo após reaproveitar o lease: força DHCP
+        w.aps[0].up = false; net.loop(); w.aps[0].up = true; // Queda breve com lease válido
+        run(net, 60000); // Reconecta reaproveitando
+        bool reused = s.lastDhcpMs == 0 && s.leaseReuses == 2; // Sem DHCP
+        clk.advance(1000); // POST logo depois falha (endereço em conflito)
+        net.reportTransportFailure(); // AppController repassa o erro de transporte
+        uint64_t t3 = clk.now64(); // Queda forçada
+        run(net, 60000); // Reconecta
+        printf("5. Falha de HTTP 1 s apos reaproveitar o lease: IP em %lu ms; dhcp=%lu ms; leases descartados=%lu\n", // Resumo
+               (unsigned long)(connectedAt - t3), (unsigned long)s.lastDhcpMs, (unsigned long)s.leaseRevoked); // ...
+        check(reused && s.leaseRevoked == 1 && s.lastDhcpMs == w.dhcpMs, "falha logo apos o reaproveitamento: lease descartado, DHCP"); // Conflito evitado
+        clk.advance(WIFI_LEASE_VERIFY_MS); // Link com DHCP, fora da janela
+        net.reportTransportFailure(); // Falha de WAN comum
+        check(net.isConnected() && s.leaseRevoked == 1, "falha com endereco do DHCP: nenhuma reconexao"); // Sem efeito
+    }
+
+    // 6. Reinício com o AP no mesmo canal: caminho rápido, mas o lease da NVS não vale
+    WiFi.hostPowerCycle(); // Chip reinicia
+    clk.advance(5000); // Tempo desligado
+    { // Escopo do terceiro firmware
+        NetManager net(2000, 30000, clk); // Novo boot
+        uint64_t t0 = clk.now64(); // Boot
+        begin(net); run(net, 60000); // Conecta
+        const NetConnectStats &s = net.stats(); // Métricas
+        printf("6. Reinicio com o AP no mesmo canal: IP em %lu ms; link=%lu dhcp=%lu ms (%s)\n", (unsigned long)(connectedAt - t0), // Resumo
+               (unsigned long)s.lastLinkMs, (unsigned long)s.lastDhcpMs, s.lastWasFast ? "rapido" : "completo"); // ...
+        check(s.lastWasFast && s.fastSuccess == 1 && s.lastDhcpMs == w.dhcpMs && s.leaseReuses == 0, "primeiro link do boot: caminho rapido com DHCP"); // Lease da NVS ignorado
+    }
+    printf("Resultado: %s\n", g_ok ? "OK" : "FALHA"); // Veredito
+    return g_ok ? 0 : 1; // Código de saída
+}
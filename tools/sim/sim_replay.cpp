@@ -0,0 +1,87 @@
+/*
+    Arquivo: tools/sim/sim_replay.cpp
+    Propósito: Exercita, no host, o CollectorCore diante de DATA autênticos de
+    boots antigos reenviados por terceiros (replay). O leitor passou por três
+    boots (épocas A, B e C, a atual); o atacante gravou datagramas de A e B e
+    os reenvia enquanto C está em uso. Confere:
+      - época desconhecida com o leitor ativo é recusada (STALE_EPOCH, sem
+        ACK) e a época em uso segue com o cursor e o bitmap intactos: nada do
+        que ela já confirmou volta a ser repassado;
+      - replay de uma época ainda rastreada só conta duplicatas e não
+        prolonga a atividade do leitor;
+      - um reinício legítimo (época nova) é aceito depois de kEpochHoldMs sem
+        registro novo, e não antes.
+    Uso: sim_replay
+    Código de saída != 0 se alguma conferência falhar.
+*/
+
+#include "CollectorCore.h" // Núcleo do coletor sob teste
+#include <stdio.h> // printf
+
+static const char kKey[] = "sim-fleet-key"; // Chave da frota (mesma do fw_host_udp)
+static const char kDevice[] = "leitor-01"; // DEVICE_ID
+static bool g_ok = true; // Resultado global
+
+static void check(bool cond, const char *what) { // Imprime uma conferência e acumula o veredito
+    printf("  %-70s %s\n", what, cond ? "OK" : "FALHA"); // Linha do relatório
+    if (!cond) g_ok = false; // Reprova o cenário
+}
+
+// DATA selado com count registros a partir de first (UID 04 + sequência em 16 bits)
+static std::vector<uint8_t> data(uint32_t epoch, uint32_t low, uint32_t first, uint8_t count) { // Monta como o UdpUplink
+    std::vector<uint8_t> buf(udpproto::kMaxDatagram); // Espaço
+    udpproto::Writer w(buf.data(), buf.size()); // Escritor
+    udpproto::DataHeader h = {}; // Cabeçalho
+    snprintf(h.id, sizeof(h.id), "%s", kDevice); // Leitor
+    h.epoch = epoch; h.low = low; h.first = first; h.sentMs = 1000; h.unixS = 0; h.count = 0; // Cursores (sem NTP)
+    udpproto::beginData(w, h); // Cabeçalho
+    size_t countPos = w.len - 1; // Posição do count
+    for (uint8_t i = 0; i < count; ++i) { // Cada registro
+        udpproto::Record r = {}; // Registro
+        r.uidLen = 3; r.uid[0] = 0x04; r.uid[1] = (uint8_t)((first + i) >> 8); r.uid[2] = (uint8_t)(first + i); r.captureMs = 500 + i; // UID e captura
+        udpproto::addRecord(w, countPos, r); // Acrescenta
+    }
+    buf.resize(udpproto::seal(w, (const uint8_t *)kKey, sizeof(kKey) - 1)); // Etiqueta
+    return buf; // Datagrama
+}
+
+int main(int argc, char **argv) { // Executa o cenário e imprime o relatório
+    if (argc > 1) { fprintf(stderr, "uso: sim_replay\n"); return 2; } // Sem opções
+    CollectorCore core(kKey); // Coletor
+    std::vector<CollectorRecord> recs; // Registros novos de cada datagrama
+    udpproto::Ack ack; // ACK do datagrama
+    auto ingest = [&](const std::vector<uint8_t> &d, uint64_t now) { recs.clear(); return core.ingest(d.data(), d.size(), now, recs, ack); }; // Um datagrama
+    const uint32_t A = 0x1111, B = 0x2222, C = 0x3333, D = 0x4444; // Épocas de quatro boots
+    const uint32_t hold = CollectorCore::kEpochHoldMs; // Silêncio exigido
+    printf("Coletor: duas epocas por leitor, epoca nova so apos %u ms sem registro novo\n", (unsigned)hold); // Cabeçalho
+
+    // Histórico legítimo: boots A e B, cada um seguido de silêncio (reinício)
+    std::vector<uint8_t> oldA = data(A, 0, 0, 10), oldB = data(B, 0, 0, 10); // Gravados pelo atacante
+    check(ingest(oldA, 0) == CollectorCore::Verdict::OK && recs.size() == 10, "boot A: 10 registros repassados"); // Primeiro boot
+    check(ingest(oldB, 20000) == CollectorCore::Verdict::OK && recs.size() == 10, "boot B apos o silencio de A: aceito"); // Reinício
+    check(ingest(data(C, 0, 0, 20), 40000) == CollectorCore::Verdict::OK && recs.size() == 20 && ack.cum == 20, "boot C (atual) apos o silencio de B: 20 registros, cursor 20"); // Reinício
+    // Slots: B (menos usado) e C. A já foi esquecida
+
+    // Replay com C ativo: A é desconhecida e despejaria B; uma segunda época velha despejaria C
+    const uint64_t epochs = core.stats().epochs; // Épocas até aqui
+    check(ingest(oldA, 40100) == CollectorCore::Verdict::STALE_EPOCH && recs.empty(), "replay de A (desconhecida) com C ativo: recusado, sem ACK"); // Não ocupa slot
+    check(ingest(oldB, 40200) == CollectorCore::Verdict::OK && recs.empty() && ack.epoch == B, "replay de B (ainda rastreada): so duplicatas"); // Dedup
+    check(ingest(oldA, 40300) == CollectorCore::Verdict::STALE_EPOCH, "replay de A de novo: continua recusado"); // Sem despejo
+    check(core.stats().epochs == epochs && core.stats().staleEpoch == 2, "nenhuma epoca nova criada; duas recusas contadas"); // Métricas
+    check(core.ackFor(kDevice, C, ack) && ack.cum == 20, "epoca C intacta (cursor 20)"); // Estado preservado
+    check(ingest(data(C, 0, 0, 30), 40400) == CollectorCore::Verdict::OK && recs.size() == 10 && recs.front().seq == 20 && ack.cum == 30, // Sem reentrega
+          "C continua: so as sequencias 20..29 sao repassadas"); // ...
+
+    // Duplicatas de B não prolongam a atividade: C ficou quieto a partir de 40400
+    check(ingest(oldB, 40400 + hold - 1) == CollectorCore::Verdict::OK && recs.empty(), "replay de B ao fim da janela: duplicatas apenas"); // Não renova
+    check(ingest(data(D, 0, 0, 5), 40400 + hold - 1) == CollectorCore::Verdict::STALE_EPOCH, "reinicio legitimo (D) dentro da janela: recusado (reenvia)"); // Ainda ativo
+    check(ingest(data(D, 0, 0, 5), 40400 + hold) == CollectorCore::Verdict::OK && recs.size() == 5 && ack.epoch == D, "D apos kEpochHoldMs sem registro novo: aceito"); // Reinício
+    check(core.ackFor(kDevice, D, ack) && !core.ackFor(kDevice, B, ack) && core.ackFor(kDevice, C, ack), "D ocupou o slot de B (menos usado); C ainda rastreada"); // LRU
+
+    const CollectorStats &s = core.stats(); // Totais
+    printf("Coletor: registros=%llu duplicatas=%llu epocas=%llu recusadas(epoca)=%llu\n", (unsigned long long)s.records, // Resumo
+           (unsigned long long)s.duplicates, (unsigned long long)s.epochs, (unsigned long long)s.staleEpoch); // ...
+    check(s.records == 10 + 10 + 20 + 10 + 5, "conservacao: cada registro repassado uma unica vez"); // Sem reentrega
+    printf("Resultado: %s\n", g_ok ? "OK" : "FALHA"); // Veredito
+    return g_ok ? 0 : 1; // Código de saída
+}
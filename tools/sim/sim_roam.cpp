@@ -0,0 +1,138 @@
+/*
+    Arquivo: tools/sim/sim_roam.cpp
+    Propósito: Exercita, no host, a seleção de AP e o roaming com varreduras
+    roteirizadas. Duas partes:
+      - NetSelector isolado (lista de candidatas própria): escolha inicial por
+        RSSI com desempate pela ordem da lista, limiar de link degradado,
+        permanência mínima (inclusive no wrap de millis), histerese e a regra
+        "mesmo BSSID não é roaming";
+      - NetManager sobre o Wi‑Fi simulado (hostWifi), dois APs com o mesmo SSID:
+        a degradação do link só gera varredura depois da permanência mínima,
+        ganho abaixo da histerese mantém o AP atual, uma varredura só com o
+        próprio AP não dispara troca e um AP com ganho suficiente leva ao
+        roaming (serviceRoaming -> varredura assíncrona -> shouldRoam), contado
+        em roams/roamSuccess e fora dos contadores do caminho rápido.
+    Uso: sim_roam [--verbose]
+    Código de saída != 0 se alguma conferência falhar.
+*/
+
+#include "NetManager.h" // Firmware sob teste (NetManager + NetSelector)
+#include <WiFi.h> // hostWifi(): APs simulados
+#include <string> // Argumentos
+
+static bool g_ok = true; // Resultado global
+
+static void check(bool cond, const char *what) { // Imprime uma conferência e acumula o veredito
+    printf("  %-66s %s\n", what, cond ? "OK" : "FALHA"); // Linha do relatório
+    if (!cond) g_ok = false; // Reprova o cenário
+}
+
+// Resultado de varredura roteirizado
+static WifiScanResult ap(const char *ssid, uint8_t last, int32_t channel, int8_t rssi) { // BSSID 24:0A:C4:00:00:<last>
+    WifiScanResult r; // Resultado
+    memset(&r, 0, sizeof(r)); // Zera SSID e BSSID
+    strncpy(r.ssid, ssid, sizeof(r.ssid) - 1); // SSID (literais curtos)
+    const uint8_t b[6] = {0x24, 0x0A, 0xC4, 0x00, 0x00, last}; // MAC
+    memcpy(r.bssid, b, sizeof(r.bssid)); // BSSID
+    r.channel = channel; r.rssi = rssi; // Canal e sinal
+    return r; // Resultado
+}
+
+// Parte 1: regras puras do NetSelector
+static void selectorRules() { // Varreduras roteirizadas, sem Wi‑Fi
+    static const WifiCandidate kList[] = { { "PRINCIPAL", "a" }, { "RESERVA", "b" } }; // Ordem = prioridade no empate
+    const int8_t roam = -72; const uint8_t hyst = 8; const uint32_t dwell = 60000; // Parâmetros explícitos
+    NetSelector sel(kList, 2, roam, hyst, dwell); // Seletor sob teste
+    NetChoice c{}; // Escolha
+    printf("NetSelector: limiar %d dBm, histerese %u dB, permanencia %lu ms\n", (int)roam, (unsigned)hyst, (unsigned long)dwell); // Cabeçalho
+
+    WifiScanResult tie[] = { ap("RESERVA", 2, 11, -60), ap("DESCONHECIDA", 9, 1, -30), ap("PRINCIPAL", 1, 6, -60) }; // Empate; desconhecida mais forte
+    check(sel.pickBest(tie, 3, c) && c.candidate == 0 && c.bssid[5] == 1 && c.channel == 6, "pickBest: empate de RSSI -> menor indice da lista (ordem da varredura nao importa)"); // Desempate
+    WifiScanResult stronger[] = { ap("PRINCIPAL", 1, 6, -70), ap("RESERVA", 2, 11, -69) }; // 1 dB de diferença
+    check(sel.pickBest(stronger, 2, c) && c.candidate == 1 && c.rssi == -69, "pickBest: RSSI maior vence a prioridade da lista"); // Sinal manda
+    WifiScanResult unknown[] = { ap("DESCONHECIDA", 9, 1, -30) }; // Só rede fora da lista
+    check(!sel.pickBest(unknown, 1, c), "pickBest: rede desconhecida nunca e escolhida"); // Ignorada
+
+    check(!sel.needsScan(roam, 0) && sel.needsScan(roam - 1, 0), "needsScan: so abaixo do limiar (sem conexao registrada)"); // Limiar exclusivo
+    const uint32_t t0 = 0xFFFFFFFFu - 10000; // Conexão 10 s antes do wrap de millis()
+    sel.noteConnected(t0); // Início da permanência
+    check(!sel.needsScan(-90, t0 + dwell - 1), "needsScan: link ruim mas dentro da permanencia (atravessa o wrap)"); // Dwell
+    check(sel.needsScan(-90, t0 + dwell), "needsScan: permanencia cumprida (depois do wrap)"); // Dwell vencido
+
+    const uint32_t now = t0 + dwell; // Permanência cumprida
+    const uint8_t cur[6] = {0x24, 0x0A, 0xC4, 0x00, 0x00, 1}; // Conectado ao PRINCIPAL/1
+    WifiScanResult below[] = { ap("PRINCIPAL", 1, 6, -80), ap("RESERVA", 2, 11, -73) }; // Ganho de 7 dB
+    check(!sel.shouldRoam(-80, cur, below, 2, now, c), "shouldRoam: ganho de 7 dB < histerese -> fica"); // Histerese
+    WifiScanResult at[] = { ap("PRINCIPAL", 1, 6, -80), ap("RESERVA", 2, 11, -72) }; // Ganho de 8 dB
+    check(sel.shouldRoam(-80, cur, at, 2, now, c) && c.candidate == 1 && c.bssid[5] == 2, "shouldRoam: ganho de 8 dB = histerese -> troca"); // Limite inclusivo
+    WifiScanResult self[] = { ap("PRINCIPAL", 1, 6, -50) }; // O próprio AP, mais forte na varredura
+    check(!sel.shouldRoam(-80, cur, self, 1, now, c), "shouldRoam: mesmo BSSID (mais forte na varredura) nao e roaming"); // Mesmo AP
+    WifiScanResult two[] = { ap("RESERVA", 3, 1, -64), ap("PRINCIPAL", 4, 11, -64), ap("PRINCIPAL", 1, 6, -40) }; // Dois alvos empatados + o atual
+    check(sel.shouldRoam(-80, cur, two, 3, now, c) && c.candidate == 0 && c.bssid[5] == 4, "shouldRoam: alvos empatados -> menor indice, ignorando o BSSID atual"); // Desempate
+    check(!sel.shouldRoam(-80, cur, at, 2, now - 1, c), "shouldRoam: dentro da permanencia -> fica"); // Dwell também vale aqui
+}
+
+// Parte 2: NetManager + Wi‑Fi simulado, roaming entre dois APs do mesmo SSID
+static void managerRoaming() { // serviceRoaming -> startScan -> pollScan -> shouldRoam
+    VirtualClock &clk = hostClock(); // Relógio
+    HostWiFiControl &w = hostWifi(); // Ambiente
+    w.aps.push_back({WIFI_SSID, {0x24, 0x0A, 0xC4, 0x00, 0x00, 0xA1}, 1, -55, true}); // AP A (mais forte no início)
+    w.aps.push_back({WIFI_SSID, {0x24, 0x0A, 0xC4, 0x00, 0x00, 0xB2}, 11, -70, true}); // AP B
+    HostAp &a = w.aps[0]; HostAp &b = w.aps[1]; // Atalhos (vetor não cresce mais)
+    NetManager net(2000, 30000, clk); // Mesmos tempos do AppController
+    uint64_t connectedAt = 0; // Último IP obtido
+    net.onConnect([&]() { connectedAt = clk.now64(); }); // Instante da conexão (inclui roaming)
+    net.begin(); // Primeira tentativa
+    auto runUntil = [&](uint64_t t) { while (clk.now64() < t) { net.loop(); clk.advance(1); } }; // Itera o firmware
+    auto on = [&](const HostAp &x) { const uint8_t *cur = WiFi.BSSID(); return cur && memcmp(cur, x.bssid, 6) == 0; }; // Associado a x?
+    runUntil(10000); // Conecta
+    printf("NetManager: dois APs \"%s\" (A canal 1, B canal 11), checagem de RSSI a cada %d ms, varredura de %u ms\n", // Cabeçalho
+           WIFI_SSID, WIFI_ROAM_CHECK_MS, (unsigned)w.asyncScanMs); // ...
+    check(net.isConnected() && on(a), "conecta ao AP mais forte (A)"); // Seleção inicial pelo driver
+    const NetConnectStats &s = net.stats(); // Métricas
+
+    // Link degrada logo após conectar: nada antes da permanência mínima
+    uint64_t t0 = connectedAt; // Início da permanência
+    a.rssi = -80; b.rssi = -60; // A ruim, B 20 dB melhor
+    runUntil(t0 + WIFI_ROAM_MIN_DWELL_MS - 1); // Até a véspera da permanência
+    printf("  A -80 dBm, B -60 dBm logo apos conectar: %lu varreduras em %lu ms\n", (unsigned long)s.scans, (unsigned long)(clk.now64() - t0)); // Estado
+    check(s.scans == 0 && s.roams == 0 && on(a), "permanencia minima: sem varredura nem troca antes do prazo"); // Dwell
+    runUntil(t0 + WIFI_ROAM_MIN_DWELL_MS + WIFI_ROAM_CHECK_MS + w.asyncScanMs + 1000); // Checagem + varredura + associação
+    printf("  roaming A -> B: novo IP %lu ms apos a conexao em A\n", (unsigned long)(connectedAt - t0)); // Estado
+    check(s.roams == 1 && on(b) && connectedAt - t0 >= WIFI_ROAM_MIN_DWELL_MS, "ganho de 20 dB apos a permanencia -> roaming para B"); // Troca
+
+    // Ganho abaixo da histerese: varre, mas fica
+    t0 = connectedAt; // Nova permanência
+    b.rssi = -80; a.rssi = (int8_t)(-80 + WIFI_ROAM_HYSTERESIS_DB - 1); // A só 7 dB melhor
+    uint32_t scans = s.scans; // Varreduras até aqui
+    runUntil(t0 + WIFI_ROAM_MIN_DWELL_MS + 3 * WIFI_ROAM_CHECK_MS); // Várias checagens após a permanência
+    printf("  B -80 dBm, A %d dBm: %lu varreduras, %lu trocas\n", (int)a.rssi, (unsigned long)(s.scans - scans), (unsigned long)s.roams); // Estado
+    check(s.scans > scans && s.roams == 1 && on(b), "ganho < histerese: varre e permanece em B"); // Histerese
+
+    // Só o próprio AP aparece na varredura: não é roaming
+    a.up = false; b.rssi = -85; // A some; B fraco no link
+    scans = s.scans; // Varreduras até aqui
+    runUntil(clk.now64() + 3 * WIFI_ROAM_CHECK_MS); // Mais checagens
+    check(s.scans > scans && s.roams == 1 && on(b) && net.isConnected(), "so o BSSID atual na varredura: nenhuma troca nem queda"); // Mesmo AP
+
+    // A volta forte: roaming de volta
+    a.up = true; a.rssi = -58; // Ganho de 27 dB
+    runUntil(clk.now64() + 2 * WIFI_ROAM_CHECK_MS + w.asyncScanMs + 1000); // Checagem + varredura + associação
+    printf("  A volta com -58 dBm: %lu trocas, varreduras totais %lu, tentativas %lu\n", (unsigned long)s.roams, (unsigned long)s.scans, (unsigned long)s.attempts); // Estado
+    check(s.roams == 2 && on(a), "A volta com ganho suficiente -> roaming de volta para A"); // Troca
+    printf("  trocas concluidas %lu, expiradas %lu; caminho rapido: %lu tentativas, %lu sucessos, %lu fallbacks\n", (unsigned long)s.roamSuccess, // Estado
+           (unsigned long)s.roamFallbacks, (unsigned long)s.fastAttempts, (unsigned long)s.fastSuccess, (unsigned long)s.fullFallbacks); // ...
+    check(s.roamSuccess == 2 && s.roamFallbacks == 0 && !s.lastWasFast, "roaming contado a parte (roamSuccess)"); // Contadores próprios
+    check(s.fastAttempts == 0 && s.fastSuccess == 0 && s.fullFallbacks == 0, "roaming nao infla os contadores do caminho rapido"); // Métrica do cache limpa
+}
+
+int main(int argc, char **argv) { // Executa as duas partes e imprime o relatório
+    bool verbose = argc > 1 && std::string(argv[1]) == "--verbose"; // Única opção
+    if (argc > 2 || (argc == 2 && !verbose)) { fprintf(stderr, "uso: sim_roam [--verbose]\n"); return 2; } // Uso inválido
+    hostSerialQuiet = !verbose; // Log do firmware só com --verbose
+    randomSeed(1); // random() do firmware (jitter do backoff)
+    selectorRules(); // Parte 1
+    managerRoaming(); // Parte 2
+    printf("Resultado: %s\n", g_ok ? "OK" : "FALHA"); // Veredito
+    return g_ok ? 0 : 1; // Código de saída
+}
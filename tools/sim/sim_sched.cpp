@@ -0,0 +1,175 @@
+/*
+    Arquivo: tools/sim/sim_sched.cpp
+    Propósito: Mede, no host, a latência de leitura sob trabalho de fundo com o
+    TaskScheduler do AppController (PERSIST_BUFFER=1, NVS simulada com custo
+    por leitura e gravação). O leitor liga com um backlog grande no snapshot
+    (a restauração roda em fatias na folga), o backend está fora do ar (a fila
+    só cresce) e cartões chegam em sequência, cada um por --dwell-ms diante da
+    antena — inclusive no meio de uma passada longa. Compilado duas vezes: com
+    o escalonador padrão (sim_sched) e sem orçamento de passada nem de fatia
+    (sim_sched_serial: um trecho inteiro de PERSIST_RESTORE_BATCH por passada,
+    como o loop fixo anterior), para comparar. Relata:
+      - métricas por tarefa (execuções, tempo médio/máximo, maior intervalo
+        entre inícios, estouros, prazos perdidos/fatias forçadas);
+      - passadas acima do orçamento e fatias de fundo na folga;
+      - latência de leitura (chegada do cartão -> SELECT) durante a
+        restauração e no total: média, p99 e máxima; cartões não lidos;
+      - duração da restauração, maior passo e a conferência do snapshot final.
+    Uso: sim_sched [--seconds S] [--backlog N] [--nvs-read-us US]
+                   [--nvs-write-us US] [--gap-min-ms MS] [--gap-max-ms MS]
+                   [--dwell-ms MS] [--max-read-ms MS] [--seed S] [--verbose]
+    Código de saída != 0 se algum cartão não for lido, a maior latência
+    passar de --max-read-ms (só sim_sched), a restauração não concluir ou o
+    snapshot final divergir da fila.
+*/
+
+#include "AppController.h" // Firmware sob teste
+#include <WiFi.h> // hostWifi(): AP simulado
+#include <HTTPClient.h> // hostHttp(): backend fora do ar
+#include <MFRC522.h> // hostRfid(): campo de RF
+#include <Preferences.h> // hostNvs()/hostNvsTiming(): snapshot e custo da flash
+#include <algorithm> // sort
+#include <random> // UIDs e intervalos
+#include <string> // Opções
+#include <vector> // Latências
+
+#ifndef SIM_SCHED_SERIAL // Definido pelo alvo sim_sched_serial
+#define SIM_SCHED_SERIAL 0 // Escalonador padrão
+#endif // fim: SIM_SCHED_SERIAL default
+
+// Parâmetros da linha de comando
+struct Options { // Valores padrão: fila média do boot anterior, fila de pessoas no torniquete
+    uint32_t seconds = 20; // Duração simulada
+    uint32_t backlog = 900; // Entradas no snapshot do boot anterior
+    uint32_t nvsReadUs = 600; // Custo de uma leitura de chave na NVS (trecho de 32 entradas ~38 ms)
+    uint32_t nvsWriteUs = 10; // Custo de uma gravação (a NVS não regrava valor igual: o snapshot quase todo repete)
+    uint32_t gapMinMs = 120; // Intervalo mínimo entre cartões
+    uint32_t gapMaxMs = 300; // Intervalo máximo entre cartões
+    uint32_t dwellMs = 100; // Permanência de cada cartão diante da antena
+    uint32_t maxReadMs = 25; // Orçamento da latência máxima de leitura (passada de 20 ms + SELECT)
+    uint64_t seed = 1; // Semente
+    bool verbose = false; // Log do firmware
+}; // fim: struct Options
+
+static Options g_opt; // Opções globais
+
+static bool parseArgs(int argc, char **argv) { // Lê opções; false em erro
+    for (int i = 1; i < argc; ++i) { // Percorre argumentos
+        std::string a = argv[i]; // Argumento atual
+        auto next = [&](void) -> const char * { return (i + 1 < argc) ? argv[++i] : nullptr; }; // Valor da opção
+        const char *v = nullptr; // Valor lido
+        if (a == "--seconds" && (v = next())) g_opt.seconds = (uint32_t)strtoul(v, nullptr, 10); // Duração
+        else if (a == "--backlog" && (v = next())) g_opt.backlog = (uint32_t)strtoul(v, nullptr, 10); // Snapshot
+        else if (a == "--nvs-read-us" && (v = next())) g_opt.nvsReadUs = (uint32_t)strtoul(v, nullptr, 10); // NVS
+        else if (a == "--nvs-write-us" && (v = next())) g_opt.nvsWriteUs = (uint32_t)strtoul(v, nullptr, 10); // ...
+        else if (a == "--gap-min-ms" && (v = next())) g_opt.gapMinMs = (uint32_t)strtoul(v, nullptr, 10); // Chegadas
+        else if (a == "--gap-max-ms" && (v = next())) g_opt.gapMaxMs = (uint32_t)strtoul(v, nullptr, 10); // ...
+        else if (a == "--dwell-ms" && (v = next())) g_opt.dwellMs = (uint32_t)strtoul(v, nullptr, 10); // Permanência
+        else if (a == "--max-read-ms" && (v = next())) g_opt.maxReadMs = (uint32_t)strtoul(v, nullptr, 10); // Orçamento
+        else if (a == "--seed" && (v = next())) g_opt.seed = strtoull(v, nullptr, 10); // Semente
+        else if (a == "--verbose") g_opt.verbose = true; // Log do firmware
+        else { fprintf(stderr, "opcao invalida: %s\n", a.c_str()); return false; } // Erro
+    }
+    if (g_opt.gapMaxMs < g_opt.gapMinMs || g_opt.dwellMs >= g_opt.gapMinMs) { fprintf(stderr, "exige dwell < gap-min <= gap-max\n"); return false; } // Um cartão por vez
+    return true; // Opções válidas
+}
+
+int main(int argc, char **argv) { // Executa o cenário e imprime o relatório
+    if (!parseArgs(argc, argv)) return 2; // Uso inválido
+    hostSerialQuiet = !g_opt.verbose; // Log do firmware só com --verbose
+    randomSeed((unsigned long)g_opt.seed); // random() do firmware
+    std::mt19937_64 rng(g_opt.seed); // UIDs e intervalos
+    VirtualClock &clk = hostClock(); // Relógio
+
+    // Snapshot deixado pelo boot anterior (gravado sem custo)
+    { // Escopo do Preferences de preparação
+        Preferences p; p.begin("rfidbuf", false); // Mesmo namespace do PersistentStore
+        p.putUInt("count", g_opt.backlog); // Quantidade
+        for (uint32_t i = 0; i < g_opt.backlog; ++i) { // Entradas do mais antigo ao mais novo
+            char k[16], v[16]; snprintf(k, sizeof(k), "uid%u", (unsigned)i); snprintf(v, sizeof(v), "B%07u", (unsigned)i); // Chave e UID
+            p.putString(k, v); snprintf(k, sizeof(k), "ts%u", (unsigned)i); p.putUInt(k, 1000 + i); // UID e captura
+        }
+    }
+    hostNvsTiming().readUs = g_opt.nvsReadUs; // A partir daqui, a flash custa tempo
+    hostNvsTiming().writeUs = g_opt.nvsWriteUs; // ...
+    hostWifi().aps.push_back({WIFI_SSID, {0x24, 0x0A, 0xC4, 0x10, 0x20, 0x30}, 6, -58, true}); // AP disponível
+    hostHttp().handler = [&](const HostHttpRequest &) { return 503; }; // Backend fora do ar: a fila só cresce
+    hostHttp().getHandler = [&](const HostHttpRequest &, HostHttpResponse &) { return 304; }; // Configuração inalterada
+
+    byte cur[4] = {0}; // Cartão no campo
+    bool inField = false, read = false; // Estado do cartão atual
+    uint32_t enterUs = 0; // Chegada ao campo (nowUs(), seguro no wrap)
+    bool arrivedRestoring = false; // O cartão atual chegou durante a restauração
+    std::vector<double> lat, latBoot; // Latências de leitura (ms): todas / chegadas durante a restauração
+    hostRfid().onSelect = [&](const MFRC522::Uid &u) { // SELECT do cartão no campo = leitura
+        if (!inField || read || memcmp(u.uidByte, cur, 4) != 0) return; // Outro cartão ou já lido
+        read = true; lat.push_back((clk.nowUs() - enterUs) / 1000.0); // Latência
+        if (arrivedRestoring) latBoot.push_back(lat.back()); // Parcela da restauração
+    };
+
+    clk.set(300); // millis() ao entrar em begin()
+    AppController app(clk); // Firmware com o relógio virtual
+    app.begin(); // Boot (a restauração segue em fatias)
+    uint32_t taps = 0, missed = 0; // Cartões apresentados / saíram sem leitura
+    uint64_t end = clk.now64() + (uint64_t)g_opt.seconds * 1000; // Fim das chegadas
+    uint64_t nextTap = clk.now64() + 100; // Primeiro cartão logo após o boot
+    uint64_t leaveAt = 0; // Saída do cartão atual
+    std::uniform_int_distribution<uint32_t> gap(g_opt.gapMinMs, g_opt.gapMaxMs); // Intervalo entre chegadas
+    uint64_t restoredAt = 0; // Fim da restauração (ms)
+
+    while (clk.now64() < end || inField) { // Chegadas + saída do último cartão
+        uint64_t now = clk.now64(); // Tempo atual
+        if (inField && now >= leaveAt) { hostRfid().leave(cur, 4); inField = false; if (!read) missed++; } // Sai
+        if (!inField && now >= nextTap && nextTap < end) { // Próximo cartão (chega no horário, mesmo no meio de uma passada)
+            uint64_t at = nextTap; // Chegada
+            nextTap = at + gap(rng); taps++; // Agenda o seguinte
+            for (byte &b : cur) b = (byte)rng(); // UID novo (sem efeito da deduplicação)
+            if (now >= at + g_opt.dwellMs) { missed++; continue; } // Chegou e saiu durante uma passada longa
+            hostRfid().enter(cur, 4); inField = true; read = false; arrivedRestoring = !app.bootProfile().has(BOOT_RESTORED); // Entra
+            enterUs = clk.nowUs() - (uint32_t)(now - at) * 1000; leaveAt = at + g_opt.dwellMs; // Origem da latência = chegada
+        }
+        app.loop(); // Uma passada do escalonador
+        clk.advance(1); // Resto do loop
+        if (!restoredAt && app.bootProfile().has(BOOT_RESTORED)) restoredAt = app.bootProfile().at(BOOT_RESTORED); // Marca
+    }
+    for (int i = 0; i < 100; ++i) { app.loop(); clk.advance(10); } // Snapshot coalescido pendente vence (SCHED_PERSIST_MAX_WAIT_MS)
+
+    const TaskScheduler &s = app.scheduler(); // Métricas do escalonador
+    printf("Escalonador%s: %u s, backlog %u (NVS leitura %u us, gravacao %u us), cartoes a cada %u-%u ms por %u ms, backend fora do ar (503)\n", // Cabeçalho
+           SIM_SCHED_SERIAL ? " (serial: sem orcamento de passada nem de fatia)" : "", (unsigned)g_opt.seconds, (unsigned)g_opt.backlog, // ...
+           (unsigned)g_opt.nvsReadUs, (unsigned)g_opt.nvsWriteUs, (unsigned)g_opt.gapMinMs, (unsigned)g_opt.gapMaxMs, (unsigned)g_opt.dwellMs); // ...
+    printf("%-8s %-5s %9s %9s %9s %12s %8s %7s\n", "tarefa", "tipo", "execucoes", "media_us", "max_us", "interv_max_ms", "estouros", "prazos"); // Tabela
+    for (uint8_t i = 0; i < s.count(); ++i) { // Cada tarefa
+        const SchedTaskStats &t = s.stats(i); // Métricas
+        printf("%-8s %-5s %9lu %9lu %9lu %12.1f %8lu %7lu\n", s.name(i), s.background(i) ? "fundo" : "per", (unsigned long)t.runs, // Linha
+               (unsigned long)(t.runs ? t.totalUs / t.runs : 0), (unsigned long)t.maxUs, t.maxGapUs / 1000.0, // ...
+               (unsigned long)t.overruns, (unsigned long)t.misses); // ...
+    }
+    const SchedPassStats &p = s.passStats(); // Passadas
+    printf("Passadas: %lu, maior %.1f ms, acima do orcamento (%lu us): %lu (%.2f%%); fundo: %lu fatias na folga, %lu forcadas\n", // Resumo
+           (unsigned long)p.passes, p.maxPassUs / 1000.0, (unsigned long)s.passBudgetUs(), (unsigned long)p.overBudget, // ...
+           p.passes ? 100.0 * p.overBudget / p.passes : 0.0, (unsigned long)p.slices, (unsigned long)p.forced); // ...
+
+    auto report = [](const char *label, std::vector<double> &v) { // Média, p99 e máxima
+        std::sort(v.begin(), v.end()); // Percentis
+        double avg = 0; for (double x : v) avg += x; if (!v.empty()) avg /= v.size(); // Média
+        double p99 = v.empty() ? 0 : v[std::min(v.size() - 1, (size_t)(v.size() * 0.99))]; // p99
+        printf("Leitura %s: %u cartoes, media %.1f ms, p99 %.1f ms, max %.1f ms\n", label, (unsigned)v.size(), avg, p99, v.empty() ? 0 : v.back()); // Linha
+        return v.empty() ? 0.0 : v.back(); // Máxima
+    };
+    report("durante a restauracao", latBoot); // Fundo pesado
+    double mx = report("(cartao no campo -> SELECT)", lat); // Todas
+    bool latOk = SIM_SCHED_SERIAL || mx <= g_opt.maxReadMs; // Orçamento (só o escalonador padrão)
+    printf("Maior latencia %.1f ms (orcamento %u ms%s); lidos %u de %u, perdidos %u -> %s\n", mx, (unsigned)g_opt.maxReadMs, // Veredito
+           SIM_SCHED_SERIAL ? ", referencia" : "", (unsigned)lat.size(), (unsigned)taps, (unsigned)missed, latOk && !missed ? "OK" : "FALHA"); // ...
+    printf("Restauracao: %u entradas, concluida %llu ms apos begin(), maior passo %.2f ms\n", (unsigned)app.bootProfile().restored(), // Fundo
+           (unsigned long long)restoredAt, app.bootProfile().restoreMaxStepUs() / 1000.0); // ...
+
+    uint32_t saved = 0; // count gravado (leitura direta do mapa: sem custo)
+    if (hostNvs()["rfidbuf"].count("count")) memcpy(&saved, hostNvs()["rfidbuf"]["count"].data(), sizeof(saved)); // Snapshot
+    bool snapOk = restoredAt && saved == app.queueDepth(); // Tudo persistido
+    printf("Snapshot final = fila: %u de %u -> %s\n", (unsigned)saved, (unsigned)app.queueDepth(), snapOk ? "OK" : "FALHA"); // Conferência
+    bool ok = latOk && !missed && snapOk; // Resultado global
+    printf("Resultado: %s\n", ok ? "OK" : "FALHA"); // Veredito
+    return ok ? 0 : 1; // Código de saída
+}
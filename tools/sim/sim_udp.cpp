@@ -0,0 +1,194 @@
+/*
+    Arquivo: tools/sim/sim_udp.cpp
+    Propósito: Exercita, no host, o uplink UDP (UdpUplink) do firmware real
+    contra o núcleo do coletor (tools/collector/CollectorCore) em processo,
+    sobre uma rede com perda, duplicação, atraso variável (reordenação) e uma
+    queda do coletor no meio do cenário. Como o rfid_collector, o coletor
+    simulado só confirma no repasse periódico (--flush-ms). Um ACK forjado
+    (chave errada) é injetado e precisa ser recusado. Relata:
+      - leituras, datagramas (retransmissões), registros/datagrama e bytes/registro;
+      - o equivalente pelo HttpSender (um POST HTTPS por leitura);
+      - duplicatas descartadas pelo coletor e a maior fatia do loop no uplink;
+      - conservação: cada UID lido sai do coletor exatamente uma vez.
+    Uso: sim_udp [--seconds S] [--arrivals-ms MS] [--loss P] [--dup P]
+                 [--latency-ms MS] [--jitter-ms MS] [--outage-at-s S]
+                 [--outage-s S] [--flush-ms MS] [--seed S] [--verbose]
+    Código de saída != 0 se faltar, sobrar ou duplicar registro.
+*/
+
+#include "AppController.h" // Firmware sob teste
+#include "CollectorCore.h" // Coletor (dedup + ACK)
+#include <WiFi.h> // hostWifi(): AP e "DNS" simulados
+#include <WiFiUdp.h> // hostUdp(): datagramas do firmware
+#include <HTTPClient.h> // hostHttp(): contagem de POSTs
+#include <MFRC522.h> // hostRfid(): campo de RF
+#include <map> // Contagem por UID
+#include <random> // Perda, atraso, UIDs
+#include <set> // ACKs pendentes por época
+#include <string> // UIDs
+#include <vector> // Rede em trânsito
+
+// Parâmetros da linha de comando
+struct Options { // Valores padrão: portaria movimentada numa rede ruim
+    uint32_t seconds = 120; // Duração das chegadas (s simulados)
+    uint32_t arrivalsMs = 50; // Intervalo entre leituras (20 leituras/s)
+    double loss = 0.05; // Perda por datagrama (cada sentido)
+    double dup = 0.01; // Duplicação por datagrama
+    uint32_t latencyMs = 5; // Atraso mínimo de um sentido
+    uint32_t jitterMs = 30; // Atraso extra uniforme (reordena datagramas)
+    uint32_t outageAtS = 40; // Início da queda do coletor (s)
+    uint32_t outageS = 20; // Duração da queda (0 = nenhuma)
+    uint32_t flushMs = 100; // Repasse do coletor (ACKs saem só nele)
+    uint64_t seed = 1; // Semente
+    bool verbose = false; // Log do firmware
+}; // fim: struct Options
+
+static Options g_opt; // Opções globais
+static std::mt19937_64 g_rng; // Aleatoriedade do cenário
+static std::map<std::string, uint32_t> g_read; // UIDs lidos pelo firmware -> vezes
+static std::map<std::string, uint32_t> g_got; // UIDs repassados pelo coletor -> vezes
+static const IPAddress kCollectorIp(10, 0, 0, 2); // Endereço do coletor
+
+// Datagrama em trânsito na rede simulada
+struct InFlight { uint64_t at; bool toCollector; HostDatagram d; }; // Entrega em 'at' (ms)
+static std::vector<InFlight> g_net; // Rede
+
+static bool parseArgs(int argc, char **argv) { // Lê opções; false em erro
+    for (int i = 1; i < argc; ++i) { // Percorre argumentos
+        std::string a = argv[i]; // Argumento atual
+        auto next = [&](void) -> const char * { return (i + 1 < argc) ? argv[++i] : nullptr; }; // Valor da opção
+        const char *v = nullptr; // Valor lido
+        if (a == "--seconds" && (v = next())) g_opt.seconds = (uint32_t)strtoul(v, nullptr, 10); // Duração
+        else if (a == "--arrivals-ms" && (v = next())) g_opt.arrivalsMs = (uint32_t)strtoul(v, nullptr, 10); // Ritmo
+        else if (a == "--loss" && (v = next())) g_opt.loss = strtod(v, nullptr); // Perda
+        else if (a == "--dup" && (v = next())) g_opt.dup = strtod(v, nullptr); // Duplicação
+        else if (a == "--latency-ms" && (v = next())) g_opt.latencyMs = (uint32_t)strtoul(v, nullptr, 10); // Atraso
+        else if (a == "--jitter-ms" && (v = next())) g_opt.jitterMs = (uint32_t)strtoul(v, nullptr, 10); // Reordenação
+        else if (a == "--outage-at-s" && (v = next())) g_opt.outageAtS = (uint32_t)strtoul(v, nullptr, 10); // Queda
+        else if (a == "--outage-s" && (v = next())) g_opt.outageS = (uint32_t)strtoul(v, nullptr, 10); // ...
+        else if (a == "--flush-ms" && (v = next())) g_opt.flushMs = (uint32_t)strtoul(v, nullptr, 10); // Repasse
+        else if (a == "--seed" && (v = next())) g_opt.seed = strtoull(v, nullptr, 10); // Semente
+        else if (a == "--verbose") g_opt.verbose = true; // Log do firmware
+        else { fprintf(stderr, "opcao invalida: %s\n", a.c_str()); return false; } // Erro
+    }
+    return g_opt.arrivalsMs > 0 && g_opt.flushMs > 0 && g_opt.loss < 1; // Cenário válido
+}
+
+static double uni() { return std::uniform_real_distribution<double>(0, 1)(g_rng); } // [0,1)
+
+// Coloca um datagrama na rede (perda, duplicação, atraso, coletor fora do ar)
+static void transmit(const HostDatagram &d, bool toCollector, uint64_t now, bool collectorDown) { // Um sentido
+    if (collectorDown || uni() < g_opt.loss) return; // Perdido
+    int copies = uni() < g_opt.dup ? 2 : 1; // Duplicado pela rede
+    for (int i = 0; i < copies; ++i) { // Cada cópia
+        uint64_t at = now + g_opt.latencyMs + (g_opt.jitterMs ? g_rng() % (g_opt.jitterMs + 1) : 0); // Atraso
+        g_net.push_back({at, toCollector, d}); // Em trânsito
+    }
+}
+
+// Um cartão novo passa pelo leitor (entra, uma iteração, sai)
+static void tap(AppController &app) { // Leitura única e distinta
+    byte uid[4]; // UID de 4 bytes
+    for (byte &b : uid) b = (byte)g_rng(); // Aleatório
+    char hex[9]; snprintf(hex, sizeof(hex), "%02X%02X%02X%02X", uid[0], uid[1], uid[2], uid[3]); // Como o firmware formata
+    g_read[hex]++; // Esperado no coletor
+    hostRfid().enter(uid, 4); // Aproxima
+    app.loop(); // Firmware lê
+    hostRfid().leave(uid, 4); // Afasta
+}
+
+int main(int argc, char **argv) { // Executa o cenário e imprime o relatório
+    if (!parseArgs(argc, argv)) return 2; // Uso inválido
+    hostSerialQuiet = !g_opt.verbose; // Log do firmware só com --verbose
+    randomSeed((unsigned long)g_opt.seed); // random() do firmware (época)
+    g_rng.seed(g_opt.seed); // Cenário
+    hostWifi().aps.push_back({WIFI_SSID, {0x24, 0x0A, 0xC4, 0x10, 0x20, 0x30}, 6, -58, true}); // Wi‑Fi local OK
+    hostWifi().hosts["collector.local"] = kCollectorIp; // UDP_COLLECTOR_HOST do fw_host_udp
+    uint32_t posts = 0; // POSTs da fila (não devem ocorrer com o uplink UDP)
+    hostHttp().handler = [&](const HostHttpRequest &) { posts++; return 200; }; // Nuvem HTTP
+    VirtualClock &clk = hostClock(); // Relógio
+    uint64_t outageFrom = (uint64_t)g_opt.outageAtS * 1000, outageTo = outageFrom + (uint64_t)g_opt.outageS * 1000; // Queda do coletor (ms)
+    auto collectorDown = [&](uint64_t now) { return g_opt.outageS && now >= outageFrom && now < outageTo; }; // Fora do ar?
+    hostUdp().onSend = [&](const HostDatagram &d) { // Firmware -> rede
+        if ((uint32_t)d.ip != (uint32_t)kCollectorIp || d.port != UDP_COLLECTOR_PORT) return; // Destino errado: descartado
+        transmit(d, true, clk.now64(), collectorDown(clk.now64())); // Rumo ao coletor
+    };
+
+    CollectorCore core(UDP_HMAC_KEY); // Mesma chave da frota
+    std::set<std::pair<std::string, uint32_t>> toAck; // Confirmações no próximo repasse
+    uint64_t records = 0; // Repassados pelo coletor
+
+    AppController app(hostClock()); // Firmware com o relógio virtual
+    app.begin(); // Boot
+    for (int i = 0; i < 200 && (uint32_t)WiFi.localIP() == 0; ++i) { app.loop(); clk.advance(50); } // Associa
+    printf("Uplink UDP: %u s de leituras a cada %u ms, perda %.0f%%, duplicacao %.0f%%, atraso %u+%u ms, coletor fora %u s a partir de %u s, repasse %u ms\n", // Cabeçalho
+           (unsigned)g_opt.seconds, (unsigned)g_opt.arrivalsMs, g_opt.loss * 100, g_opt.dup * 100, (unsigned)g_opt.latencyMs, // ...
+           (unsigned)g_opt.jitterMs, (unsigned)g_opt.outageS, (unsigned)g_opt.outageAtS, (unsigned)g_opt.flushMs); // ...
+
+    uint64_t t0 = clk.now64(); // Início (ms)
+    outageFrom += t0; outageTo += t0; // Relativos ao início
+    uint64_t arrivalsEnd = t0 + (uint64_t)g_opt.seconds * 1000; // Fim das chegadas
+    uint64_t limit = arrivalsEnd + 120000; // Proteção: 2 min simulados para drenar
+    uint64_t nextTap = t0, nextFlush = t0 + g_opt.flushMs; // Agenda
+    bool forged = false; uint32_t rejectedBefore = 0; bool forgedOk = true; // ACK forjado
+    uint64_t drainedAt = 0; // Fila vazia e nada em voo após as chegadas
+    while (clk.now64() < limit) { // Laço do cenário
+        uint64_t now = clk.now64(); // Tempo atual
+        for (size_t i = 0; i < g_net.size();) { // Entregas vencidas
+            if (g_net[i].at > now) { ++i; continue; } // Ainda em trânsito
+            InFlight f = g_net[i]; g_net[i] = g_net.back(); g_net.pop_back(); // Retira (ordem não importa: reordenação)
+            if (!f.toCollector) { hostUdp().toDevice.push_back(f.d); continue; } // ACK chega ao leitor
+            if (collectorDown(now)) continue; // Coletor fora do ar
+            std::vector<CollectorRecord> recs; udpproto::Ack ack; // Saídas
+            if (core.ingest((const uint8_t *)f.d.data.data(), f.d.data.size(), now, recs, ack) != CollectorCore::Verdict::OK) continue; // Inválido
+            for (const CollectorRecord &r : recs) { g_got[r.uid]++; records++; } // Repassado
+            toAck.insert(std::make_pair(std::string(ack.id), ack.epoch)); // Confirma no repasse
+        }
+        if (now >= nextFlush) { // Repasse do coletor: ACKs
+            nextFlush += g_opt.flushMs; // Próximo
+            for (const auto &k : toAck) { // Cada leitor/época tocado
+                udpproto::Ack ack; uint8_t buf[udpproto::kMaxDatagram]; // Estado atual
+                if (!core.ackFor(k.first, k.second, ack)) continue; // Época esquecida
+                HostDatagram d; d.ip = kCollectorIp; d.port = UDP_COLLECTOR_PORT; // Origem: coletor
+                size_t len = core.encodeAck(ack, buf, sizeof(buf)); d.data.assign((const char *)buf, len); // Selado
+                transmit(d, false, now, collectorDown(now)); // Rumo ao leitor
+            }
+            toAck.clear(); // Confirmados
+        }
+        if (!forged && now >= t0 + 10000) { // ACK forjado: cursor no fim, chave errada
+            forged = true; rejectedBefore = app.udpUplink().stats().rejected; // Referência
+            udpproto::Ack a = {}; strncpy(a.id, DEVICE_ID, udpproto::kMaxIdLen); a.epoch = app.udpUplink().epoch(); a.cum = 0xFFFFFFF0u; // Libera tudo
+            uint8_t buf[udpproto::kMaxDatagram]; const char *bad = "chave-errada"; // Atacante sem a chave
+            size_t len = udpproto::encodeAck(a, (const uint8_t *)bad, strlen(bad), buf, sizeof(buf)); // Selado errado
+            HostDatagram d; d.ip = kCollectorIp; d.port = UDP_COLLECTOR_PORT; d.data.assign((const char *)buf, len); // Origem forjada
+            size_t depth = app.queueDepth(); // Fila antes
+            hostUdp().toDevice.push_back(d); app.loop(); // Entrega direta
+            forgedOk = app.udpUplink().stats().rejected > rejectedBefore && app.queueDepth() >= depth; // Recusado, nada liberado
+        }
+        if (now < arrivalsEnd && now >= nextTap) { tap(app); nextTap += g_opt.arrivalsMs; continue; } // Leitura nova
+        app.loop(); // Uma iteração do firmware
+        if (now >= arrivalsEnd && app.queueDepth() == 0 && app.udpUplink().inFlight() == 0) { drainedAt = now; break; } // Tudo confirmado
+        clk.advance(1); // Resto do loop
+    }
+
+    const UdpUplinkStats &s = app.udpUplink().stats(); // Métricas do leitor
+    const CollectorStats &cs = core.stats(); // Métricas do coletor
+    uint32_t missing = 0, dup = 0, extra = 0, total = 0; // Conservação
+    for (const auto &kv : g_read) { total += kv.second; auto it = g_got.find(kv.first); if (it == g_got.end()) missing += kv.second; else if (it->second > kv.second) dup += it->second - kv.second; } // Lidos
+    for (const auto &kv : g_got) if (!g_read.count(kv.first)) extra += kv.second; // Inventados
+    printf("Leituras=%u datagramas=%lu (retransmissoes=%lu) -> %.1f registros/datagrama, %.1f bytes/registro; acks=%lu rtt=%lu ms\n", total, // Uplink
+           (unsigned long)s.datagrams, (unsigned long)s.retransmits, s.datagrams ? (double)total / s.datagrams : 0.0, // ...
+           total ? (double)s.bytes / total : 0.0, (unsigned long)s.acks, (unsigned long)s.lastRttMs); // ...
+    printf("Pelo HttpSender seriam %u POSTs HTTPS (um por leitura); POSTs da fila nesta execucao: %u\n", total, posts); // Comparação
+    printf("Coletor: repassados=%llu duplicatas descartadas=%llu abandonados=%llu fora-da-janela=%llu epocas=%llu\n", (unsigned long long)records, // Coletor
+           (unsigned long long)cs.duplicates, (unsigned long long)cs.skipped, (unsigned long long)cs.beyond, (unsigned long long)cs.epochs); // ...
+    printf("Fila drenada %.1f s apos a ultima leitura; maior fatia do loop no uplink: %.2f ms\n", // Latência e responsividade
+           drainedAt ? (drainedAt - arrivalsEnd) / 1000.0 : -1.0, s.maxSliceUs / 1000.0); // ...
+    printf("ACK forjado (chave errada): %s\n", forgedOk ? "recusado" : "ACEITO"); // Autenticação
+    bool cons = missing == 0 && dup == 0 && extra == 0 && app.queueDepth() == 0 && app.queueDropped() == 0 && posts == 0; // Exatamente uma vez
+    printf("Conservacao: faltando=%u duplicados=%u estranhos=%u fila=%u descartados=%u -> %s\n", missing, dup, extra, // Veredito
+           (unsigned)app.queueDepth(), (unsigned)app.queueDropped(), cons ? "OK" : "FALHA"); // ...
+    bool ok = cons && forgedOk && drainedAt != 0; // Resultado global
+    printf("Resultado: %s\n", ok ? "OK" : "FALHA"); // Veredito
+    return ok ? 0 : 1; // Código de saída
+}